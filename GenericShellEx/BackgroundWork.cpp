@@ -0,0 +1,313 @@
+#include <atomic>
+#include <new>
+#include <vector>
+
+#include "BackgroundWork.h"
+
+namespace {
+  /// <summary>
+  /// An <see cref="Executor"/> on a private Windows thread pool, with a
+  /// callback environment per priority.
+  /// </summary>
+  /// <remarks>
+  /// Work is counted from when it is submitted until its callback is done
+  /// with it, so a callback the pool has dequeued but not yet started is
+  /// never mistaken for no work. Once stopping, callbacks cancel their work
+  /// instead of running it, and the pool is only closed once none is
+  /// outstanding, so stopping never waits for a callback.
+  /// </remarks>
+  class ThreadpoolExecutor : public Executor {
+    struct Submission {
+      ThreadpoolExecutor* executor;
+      WorkItem item;
+    };
+
+    PTP_POOL pool = nullptr;
+    PTP_CLEANUP_GROUP group = nullptr;
+    TP_CALLBACK_ENVIRON environments[WorkPriorityCount];
+
+    /// <summary>
+    /// Guards submitting against the pool being closed.
+    /// </summary>
+    SRWLOCK lock = SRWLOCK_INIT;
+
+    std::atomic<bool> stopping = false;
+
+    /// <summary>
+    /// The number of submissions whose callbacks have not finished.
+    /// </summary>
+    LONG outstanding = 0;
+
+    bool closed = false;
+
+    static VOID CALLBACK Run(PTP_CALLBACK_INSTANCE /*instance*/, PVOID context) {
+      auto* submission = static_cast<Submission*>(context);
+      ThreadpoolExecutor* executor = submission->executor;
+
+      // Work that starts after Stop was called is cancelled
+      submission->item.run(submission->item.context, executor->IsStopping());
+
+      delete submission;
+
+      // The executor may be freed as soon as this reaches zero
+      InterlockedDecrement(&executor->outstanding);
+    }
+
+    static VOID CALLBACK CancelSubmission(PVOID objectContext, PVOID /*cleanupContext*/) {
+      auto* submission = static_cast<Submission*>(objectContext);
+      ThreadpoolExecutor* executor = submission->executor;
+
+      submission->item.run(submission->item.context, true);
+
+      delete submission;
+
+      InterlockedDecrement(&executor->outstanding);
+    }
+
+  public:
+    explicit ThreadpoolExecutor(DWORD threads) {
+      pool = CreateThreadpool(nullptr);
+
+      if (!pool) return;
+
+      SetThreadpoolThreadMaximum(pool, threads);
+
+      group = CreateThreadpoolCleanupGroup();
+
+      if (!group) return;
+
+      static constexpr TP_CALLBACK_PRIORITY Priorities[WorkPriorityCount] = { TP_CALLBACK_PRIORITY_HIGH, TP_CALLBACK_PRIORITY_NORMAL, TP_CALLBACK_PRIORITY_LOW };
+
+      for (size_t priority = 0; priority < WorkPriorityCount; ++priority) {
+        InitializeThreadpoolEnvironment(&environments[priority]);
+        SetThreadpoolCallbackPool(&environments[priority], pool);
+        SetThreadpoolCallbackCleanupGroup(&environments[priority], group, CancelSubmission);
+        SetThreadpoolCallbackPriority(&environments[priority], Priorities[priority]);
+      }
+    }
+
+    ThreadpoolExecutor(const ThreadpoolExecutor&) = delete;
+    ThreadpoolExecutor& operator=(const ThreadpoolExecutor&) = delete;
+
+    ~ThreadpoolExecutor() override {
+      if (group && !closed) {
+        stopping = true;
+        CloseThreadpoolCleanupGroupMembers(group, TRUE, nullptr);
+        Close();
+      } else if (pool && !closed) {
+        CloseThreadpool(pool);
+      }
+    }
+
+    /// <summary>
+    /// Whether the pool was created.
+    /// </summary>
+    bool IsValid() const { return group != nullptr; }
+
+    bool Submit(WorkPriority priority, WorkItem item) override {
+      auto* submission = new (std::nothrow) Submission{ this, item };
+
+      if (!submission) return false;
+
+      AcquireSRWLockShared(&lock);
+
+      bool submitted = !IsStopping();
+
+      if (submitted) {
+        InterlockedIncrement(&outstanding);
+        submitted = TrySubmitThreadpoolCallback(Run, submission, &environments[static_cast<size_t>(priority)]);
+
+        if (!submitted) InterlockedDecrement(&outstanding);
+      }
+
+      ReleaseSRWLockShared(&lock);
+
+      if (!submitted) delete submission;
+
+      return submitted;
+    }
+
+    bool Stop() override {
+      // Taken exclusively so that no submission is between checking
+      // stopping and being counted
+      AcquireSRWLockExclusive(&lock);
+
+      stopping = true;
+
+      ReleaseSRWLockExclusive(&lock);
+
+      if (closed) return true;
+
+      // Queued callbacks cancel their work as they are dequeued, and running
+      // ones finish on their own; either way Stop is called again later
+      if (InterlockedCompareExchange(&outstanding, 0, 0)) return false;
+
+      // Only waits for callbacks that are past their last use of this
+      CloseThreadpoolCleanupGroupMembers(group, TRUE, nullptr);
+      Close();
+
+      return true;
+    }
+
+    bool IsStopping() const override { return stopping.load(std::memory_order_relaxed); }
+
+  private:
+    void Close() {
+      for (TP_CALLBACK_ENVIRON& environment : environments) {
+        DestroyThreadpoolEnvironment(&environment);
+      }
+
+      CloseThreadpoolCleanupGroup(group);
+      CloseThreadpool(pool);
+      closed = true;
+    }
+  };
+
+  /// <summary>
+  /// An executor, and the reference to the DLL it holds until its threads
+  /// are gone, so that the DLL is never unloaded while one of them could run
+  /// its code, even by a host that frees it without asking.
+  /// </summary>
+  struct Retained {
+    Executor* executor;
+    HMODULE module;
+  };
+
+  /// <summary>
+  /// Guards everything below.
+  /// </summary>
+  SRWLOCK executorLock = SRWLOCK_INIT;
+
+  Retained current = {};
+
+  /// <summary>
+  /// Executors that were stopped while work was running, which are stopped
+  /// again and freed once it finishes. Each is stopped by one thread at a
+  /// time, which takes it out of here meanwhile.
+  /// </summary>
+  std::vector<Retained> retiring;
+
+  bool useThreadpool = false;
+
+  /// <summary>
+  /// When work was last submitted, from <c>GetTickCount64</c>.
+  /// </summary>
+  std::atomic<ULONGLONG> lastSubmitted = 0;
+
+  Executor* CreateExecutor() {
+    if (useThreadpool) {
+      auto* threadpool = new (std::nothrow) ThreadpoolExecutor(static_cast<DWORD>(BackgroundThreadCount));
+
+      if (threadpool && threadpool->IsValid()) return threadpool;
+
+      delete threadpool;
+    }
+
+    auto* stealing = new (std::nothrow) StealingExecutor(BackgroundThreadCount);
+
+    if (stealing && stealing->Threads()) return stealing;
+
+    delete stealing;
+
+    return nullptr;
+  }
+
+  /// <summary>
+  /// Starts an executor. The lock must be held.
+  /// </summary>
+  Retained StartExecutor() {
+    Retained started = {};
+
+    if (!GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, reinterpret_cast<LPCWSTR>(&StartExecutor), &started.module)) return {};
+
+    started.executor = CreateExecutor();
+
+    if (!started.executor) {
+      FreeLibrary(started.module);
+
+      return {};
+    }
+
+    return started;
+  }
+}
+
+void SetBackgroundThreadpool(bool threadpool) {
+  AcquireSRWLockExclusive(&executorLock);
+  useThreadpool = threadpool;
+  ReleaseSRWLockExclusive(&executorLock);
+}
+
+bool SubmitBackgroundWork(WorkPriority priority, void (*run)(void* context, bool cancelled), void* context) {
+  lastSubmitted.store(GetTickCount64(), std::memory_order_relaxed);
+
+  AcquireSRWLockShared(&executorLock);
+
+  bool submitted = current.executor && current.executor->Submit(priority, { run, context });
+  bool started = current.executor != nullptr;
+
+  ReleaseSRWLockShared(&executorLock);
+
+  if (started) return submitted;
+
+  AcquireSRWLockExclusive(&executorLock);
+
+  // Another thread may have started it meanwhile
+  if (!current.executor) current = StartExecutor();
+
+  submitted = current.executor && current.executor->Submit(priority, { run, context });
+
+  ReleaseSRWLockExclusive(&executorLock);
+
+  return submitted;
+}
+
+bool StopBackgroundWork() {
+  std::vector<Retained> stopping;
+  bool idle = GetTickCount64() - lastSubmitted.load(std::memory_order_relaxed) >= BackgroundIdleLifetime;
+
+  // Executors are only taken out under the lock, and stopped after it is
+  // released, so submitting never waits for cancelled work or threads
+  // being joined
+  AcquireSRWLockExclusive(&executorLock);
+
+  stopping.swap(retiring);
+
+  if (current.executor && idle) {
+    stopping.push_back(current);
+    current = {};
+  }
+
+  bool running = current.executor != nullptr;
+
+  ReleaseSRWLockExclusive(&executorLock);
+
+  // The caller's own reference keeps the DLL loaded while the executors'
+  // are released
+  std::erase_if(stopping, [](const Retained& retired) {
+    if (!retired.executor->Stop()) return false;
+
+    delete retired.executor;
+    FreeLibrary(retired.module);
+
+    return true;
+  });
+
+  if (stopping.empty()) {
+    AcquireSRWLockShared(&executorLock);
+
+    bool stopped = !running && retiring.empty();
+
+    ReleaseSRWLockShared(&executorLock);
+
+    return stopped;
+  }
+
+  AcquireSRWLockExclusive(&executorLock);
+
+  retiring.insert(retiring.end(), stopping.begin(), stopping.end());
+
+  ReleaseSRWLockExclusive(&executorLock);
+
+  return false;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include "framework.h"
+#include "Executor.h"
+
+/// <summary>
+/// The number of threads background work runs on.
+/// </summary>
+constexpr size_t BackgroundThreadCount = 2;
+
+/// <summary>
+/// How long, in milliseconds, no work must have been submitted before the
+/// executor is stopped, so that Explorer asking whether the DLL can be
+/// unloaded every time it is idle does not start and stop threads over and
+/// over.
+/// </summary>
+constexpr ULONGLONG BackgroundIdleLifetime = 60000;
+
+/// <summary>
+/// Chooses whether background work runs on a private Windows thread pool
+/// instead of the DLL's own <see cref="StealingExecutor"/>, from the
+/// <c>threadpool</c> configuration property.
+/// </summary>
+/// <remarks>
+/// The choice takes effect the next time the executor is started, after it
+/// has been stopped for being idle.
+/// </remarks>
+/// <param name="threadpool">Whether to use the Windows thread pool.</param>
+void SetBackgroundThreadpool(bool threadpool);
+
+/// <summary>
+/// Queues work on the DLL's executor, starting it if it is not running.
+/// </summary>
+/// <remarks>
+/// Everything the DLL does off the caller's thread goes through here, so a
+/// shell host never gets more than <see cref="BackgroundThreadCount"/>
+/// threads from it.
+/// </remarks>
+/// <param name="priority">How urgent the work is.</param>
+/// <param name="run">Runs the work, or only releases <paramref
+/// name="context"/> if <c>cancelled</c> is <c>true</c>.</param>
+/// <param name="context">The work's context.</param>
+/// <returns><c>true</c> if the work was queued, or <c>false</c> if it was
+/// not, in which case the caller still owns <paramref
+/// name="context"/>.</returns>
+bool SubmitBackgroundWork(WorkPriority priority, void (*run)(void* context, bool cancelled), void* context);
+
+/// <summary>
+/// Stops the DLL's executor, cancelling work that has not started, once no
+/// work has been submitted for <see cref="BackgroundIdleLifetime"/>, so that
+/// the DLL can be unloaded.
+/// </summary>
+/// <remarks>
+/// <para>Each executor holds a reference to the DLL until its threads are
+/// gone, which this releases, so the DLL stays loaded while an executor
+/// runs even if its host frees it without asking. Work submitted afterwards
+/// starts a new executor.</para>
+/// <para>This is only called while another reference, such as the one COM
+/// holds while it asks whether the DLL can be unloaded, keeps the DLL
+/// loaded.</para>
+/// </remarks>
+/// <returns><c>true</c> if no executor is left, or <c>false</c> if one ran
+/// recently or work is still running, in which case the DLL stays loaded and
+/// this is called again later.</returns>
+bool StopBackgroundWork();
@@ -0,0 +1,9 @@
+#include "ClsidSlotPool.h"
+
+size_t FindClsidSlot(const std::wstring& name) {
+  for (size_t i = 0; i < ClsidSlotCount; ++i) {
+    if (name == ClsidSlots[i].name) return i;
+  }
+
+  return NoClsidSlot;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include "ClsidSlots.h"
+
+/// <summary>
+/// Returned when no CLSID slot matches.
+/// </summary>
+constexpr size_t NoClsidSlot = SIZE_MAX;
+
+/// <summary>
+/// Computes the perfect hash of a CLSID slot's <c>Data1</c>.
+/// </summary>
+/// <param name="data1">The CLSID's <c>Data1</c>.</param>
+/// <returns>An index into <see cref="ClsidSlotTable"/>.</returns>
+constexpr uint32_t HashClsidSlot(uint32_t data1) {
+  return static_cast<uint32_t>(data1 * ClsidSlotHashMultiplier) >> (32 - ClsidSlotHashBits);
+}
+
+/// <summary>
+/// Finds the slot for a CLSID in constant time.
+/// </summary>
+/// <remarks>
+/// The CLSID is hashed to a table entry, and only that entry's slot is
+/// compared, so the lookup is a single probe regardless of the pool size.
+/// </remarks>
+/// <param name="clsid">The CLSID.</param>
+/// <returns>The slot index, or <see cref="NoClsidSlot"/>.</returns>
+constexpr size_t FindClsidSlot(const GUID& clsid) {
+  size_t slot = ClsidSlotTable[HashClsidSlot(clsid.Data1)];
+
+  return slot < ClsidSlotCount && GuidEquals(ClsidSlots[slot].clsid, clsid) ? slot : NoClsidSlot;
+}
+
+/// <summary>
+/// Checks that every slot is found by its own CLSID.
+/// </summary>
+constexpr bool IsClsidSlotTablePerfect() {
+  for (size_t i = 0; i < ClsidSlotCount; ++i) {
+    if (FindClsidSlot(ClsidSlots[i].clsid) != i) return false;
+  }
+
+  return true;
+}
+
+static_assert(IsClsidSlotTablePerfect(), "ClsidSlots.h is inconsistent; rerun New-ClsidSlotPool.ps1");
+static_assert(FindClsidSlot(GUID{}) == NoClsidSlot, "The null CLSID must not map to a slot");
+
+/// <summary>
+/// Finds a slot by name, such as <c>*</c> or <c>Directory#2</c>.
+/// </summary>
+/// <param name="name">The slot name.</param>
+/// <returns>The slot index, or <see cref="NoClsidSlot"/>.</returns>
+size_t FindClsidSlot(const std::wstring& name);
@@ -0,0 +1,78 @@
+#pragma once
+
+// Generated by New-ClsidSlotPool.ps1. Do not edit.
+
+#include <cstddef>
+#include <cstdint>
+#include "framework.h"
+#include "GuidParser.h"
+
+/// <summary>
+/// A CLSID registered for a shell type, to which a context menu entry can be
+/// bound.
+/// </summary>
+struct ClsidSlot {
+  GUID clsid;
+  const wchar_t* type;
+  const wchar_t* name;
+};
+
+/// <summary>
+/// The number of CLSID slots.
+/// </summary>
+constexpr size_t ClsidSlotCount = 24;
+
+/// <summary>
+/// The CLSID slots. Indexes are stable as the pool grows.
+/// </summary>
+constexpr ClsidSlot ClsidSlots[ClsidSlotCount] = {
+  { ParseGuid<GUID>("ff8b806e-83c6-4df1-9fb4-698133580803"), L"*", L"*" },
+  { ParseGuid<GUID>("aeb1215c-84ff-43cc-aec7-e02c2b56e74c"), L"Directory", L"Directory" },
+  { ParseGuid<GUID>("92fd673f-d257-4ac8-8731-c7cde82fa49e"), L"Directory\\Background", L"Directory\\Background" },
+  { ParseGuid<GUID>("9cb2a133-cc18-4c56-bc95-b1d6ad3789a2"), L"*", L"*#1" },
+  { ParseGuid<GUID>("612b7fa2-2438-4fd9-a7ce-01381d03f946"), L"*", L"*#2" },
+  { ParseGuid<GUID>("c3d15831-5449-40a1-90e2-2c703e8cfd7b"), L"*", L"*#3" },
+  { ParseGuid<GUID>("034db281-7dbf-499a-89b6-d87a9f432f11"), L"*", L"*#4" },
+  { ParseGuid<GUID>("079bf3ab-b999-4d11-bb17-647c4587e4f9"), L"*", L"*#5" },
+  { ParseGuid<GUID>("6e501103-ae36-4d6b-85c8-191af0566af3"), L"*", L"*#6" },
+  { ParseGuid<GUID>("dd8d7956-7216-494a-8550-f0a59383d818"), L"*", L"*#7" },
+  { ParseGuid<GUID>("8590b590-4438-44c8-b494-25904c679199"), L"Directory", L"Directory#1" },
+  { ParseGuid<GUID>("a63e66c1-c02e-480c-9613-690f254f5957"), L"Directory", L"Directory#2" },
+  { ParseGuid<GUID>("996c5867-8bed-417e-be1d-065138390a34"), L"Directory", L"Directory#3" },
+  { ParseGuid<GUID>("aeb4f832-e0a0-4f7b-bd4c-93f3e5b5cff3"), L"Directory", L"Directory#4" },
+  { ParseGuid<GUID>("915420fe-fda8-4019-bae1-d8a64a57df1d"), L"Directory", L"Directory#5" },
+  { ParseGuid<GUID>("d053bc55-bfc9-4fdf-9230-bbe62680458c"), L"Directory", L"Directory#6" },
+  { ParseGuid<GUID>("922ee4c7-4116-473f-9bc9-d1d01e60de81"), L"Directory", L"Directory#7" },
+  { ParseGuid<GUID>("63e91883-9c52-4986-9f69-f7505f0a61ba"), L"Directory\\Background", L"Directory\\Background#1" },
+  { ParseGuid<GUID>("cb580bec-1e06-4ddf-a914-193a730c03ba"), L"Directory\\Background", L"Directory\\Background#2" },
+  { ParseGuid<GUID>("cbb7b704-831f-482a-afa1-e413fb10a2ad"), L"Directory\\Background", L"Directory\\Background#3" },
+  { ParseGuid<GUID>("a81e6b93-9260-4e2c-8d31-8e2520f78951"), L"Directory\\Background", L"Directory\\Background#4" },
+  { ParseGuid<GUID>("16a5c539-28ad-4315-af2b-779e20e871b9"), L"Directory\\Background", L"Directory\\Background#5" },
+  { ParseGuid<GUID>("5ebd48ed-ad95-485b-a6eb-9a3d5e788f3e"), L"Directory\\Background", L"Directory\\Background#6" },
+  { ParseGuid<GUID>("aace6a39-b1b5-44e6-9ed3-2f74c028271a"), L"Directory\\Background", L"Directory\\Background#7" }
+};
+
+/// <summary>
+/// The multiplier of the perfect hash over <c>Data1</c>.
+/// </summary>
+constexpr uint32_t ClsidSlotHashMultiplier = 0x9e377a0d;
+
+/// <summary>
+/// The number of bits of the perfect hash.
+/// </summary>
+constexpr unsigned ClsidSlotHashBits = 6;
+
+/// <summary>
+/// Maps each perfect hash value to a slot index, or <c>0xff</c> if no slot
+/// hashes to it.
+/// </summary>
+constexpr uint8_t ClsidSlotTable[64] = {
+  0xff, 0xff, 0x17, 0xff, 0x04, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0x06, 0xff, 0x03, 0xff, 0x01, 0xff,
+  0x08, 0x11, 0x02, 0x0d, 0x0e, 0xff, 0xff, 0x0b,
+  0xff, 0xff, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0x12, 0xff, 0xff, 0xff, 0xff, 0xff, 0x07, 0xff,
+  0x0a, 0xff, 0xff, 0x13, 0x15, 0xff, 0xff, 0x10,
+  0xff, 0xff, 0xff, 0xff, 0x09, 0xff, 0xff, 0x14,
+  0xff, 0x05, 0xff, 0xff, 0x00, 0x16, 0xff, 0x0c
+};
@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <string>
+
+#include "ContentSniffer.h"
+#include "ShellSelection.h"
+#include "SignatureCache.h"
+
+namespace {
+  /// <summary>
+  /// The size reads are rounded up to, which covers the sector size of any
+  /// disk, as unbuffered reads require.
+  /// </summary>
+  constexpr DWORD SectorSize = 4096;
+
+  SignatureCache signatureCache(SignatureCacheCapacity);
+
+  /// <summary>
+  /// The result of reading the start of a file.
+  /// </summary>
+  enum class ReadResult {
+    Read,
+    Failed,
+    TimedOut
+  };
+
+  /// <summary>
+  /// Reads the start of a file without buffering, waiting at most
+  /// <paramref name="timeout"/> milliseconds.
+  /// </summary>
+  ReadResult ReadStart(HANDLE file, void* buffer, DWORD size, HANDLE event, DWORD timeout, DWORD& read) {
+    HANDLE reader = ReOpenFile(file, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, FILE_FLAG_NO_BUFFERING | FILE_FLAG_OVERLAPPED | FILE_FLAG_OPEN_NO_RECALL);
+
+    if (reader == INVALID_HANDLE_VALUE) return ReadResult::Failed;
+
+    OVERLAPPED overlapped = {};
+    overlapped.hEvent = event;
+    ReadResult result = ReadResult::Read;
+
+    read = 0;
+    ResetEvent(event);
+
+    if (!ReadFile(reader, buffer, size, nullptr, &overlapped) && GetLastError() != ERROR_IO_PENDING) {
+      result = GetLastError() == ERROR_HANDLE_EOF ? ReadResult::Read : ReadResult::Failed;
+    } else if (!GetOverlappedResultEx(reader, &overlapped, &read, timeout, FALSE)) {
+      DWORD error = GetLastError();
+
+      if (error == WAIT_TIMEOUT || error == WAIT_IO_COMPLETION) {
+        // The buffer must not be reused until the read is really over
+        CancelIoEx(reader, &overlapped);
+        GetOverlappedResult(reader, &overlapped, &read, TRUE);
+        result = ReadResult::TimedOut;
+      } else {
+        result = error == ERROR_HANDLE_EOF ? ReadResult::Read : ReadResult::Failed;
+      }
+
+      read = 0;
+    }
+
+    CloseHandle(reader);
+
+    return result;
+  }
+}
+
+void SniffSelection(Selection& selection, const ContentSignatures& signatures, std::chrono::steady_clock::time_point deadline) {
+  if (signatures.IsEmpty()) return;
+
+  uint64_t signaturesHash = signatures.Hash();
+  DWORD readSize = static_cast<DWORD>((std::max<size_t>(signatures.Longest(), 1) + SectorSize - 1) / SectorSize * SectorSize);
+  void* buffer = nullptr;
+  HANDLE event = nullptr;
+  std::wstring path;
+  bool late = false;
+
+  for (size_t i = 0; i < selection.Inspected(); ++i) {
+    SelectionItem item = selection.Item(i);
+
+    if (!item.length || (item.attributes & (ItemAttributeDirectory | ItemAttributeRemote))) continue;
+
+    auto now = std::chrono::steady_clock::now();
+
+    if (late || now >= deadline) {
+      late = true;
+      selection.SetSignatures(i, ContentSignatures::Unknown);
+
+      continue;
+    }
+
+    path.assign(item.path, item.length);
+
+    // Opening a file for its attributes alone neither reads it nor gets it
+    // scanned
+    HANDLE file = CreateFileW(path.c_str(), FILE_READ_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_OPEN_NO_RECALL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE) continue;
+
+    BY_HANDLE_FILE_INFORMATION information;
+    uint64_t mask = 0;
+
+    if (GetFileInformationByHandle(file, &information) && !(information.dwFileAttributes & (FILE_ATTRIBUTE_DIRECTORY | RemoteFileAttributes))) {
+      FileVersionKey key;
+      key.volume = information.dwVolumeSerialNumber;
+      key.fileId = static_cast<uint64_t>(information.nFileIndexHigh) << 32 | information.nFileIndexLow;
+      key.size = static_cast<uint64_t>(information.nFileSizeHigh) << 32 | information.nFileSizeLow;
+      key.lastWriteTime = static_cast<uint64_t>(information.ftLastWriteTime.dwHighDateTime) << 32 | information.ftLastWriteTime.dwLowDateTime;
+      key.signatures = signaturesHash;
+
+      if (key.size && !signatureCache.Find(key, mask)) {
+        if (!buffer) buffer = VirtualAlloc(nullptr, readSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+        if (!event) event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
+        DWORD read = 0;
+        ReadResult result = buffer && event ? ReadStart(file, buffer, readSize, event, static_cast<DWORD>(std::clamp<long long>(remaining, 1, INFINITE - 1)), read) : ReadResult::Failed;
+
+        if (result == ReadResult::TimedOut) {
+          late = true;
+          mask = ContentSignatures::Unknown;
+        } else if (result == ReadResult::Read) {
+          mask = signatures.Match(buffer, read);
+          signatureCache.Insert(key, mask);
+        }
+      }
+    }
+
+    CloseHandle(file);
+
+    selection.SetSignatures(i, mask);
+  }
+
+  if (buffer) VirtualFree(buffer, 0, MEM_RELEASE);
+  if (event) CloseHandle(event);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <chrono>
+#include "framework.h"
+#include "ContentSignatures.h"
+#include "Selection.h"
+
+/// <summary>
+/// The number of files whose content signatures are remembered.
+/// </summary>
+constexpr size_t SignatureCacheCapacity = 4096;
+
+/// <summary>
+/// Matches the start of each inspected file in a selection against <see
+/// cref="ContentSignatures"/>, recording the masks in the selection.
+/// </summary>
+/// <remarks>
+/// <para>Each file is first opened only to read its ID, size and last write
+/// time. If a file with that key has been matched before, the cached mask
+/// is used and the file's contents are not read.</para>
+/// <para>Otherwise, the first <see cref="ContentSignatures::Longest"/>
+/// bytes, rounded up to a sector, are read without buffering, so that
+/// sniffing does not fill the file cache, and with a timeout of whatever is
+/// left before <paramref name="deadline"/>. Files whose contents could not
+/// be read in time, and every file after them, are marked <see
+/// cref="ContentSignatures::Unknown"/>.</para>
+/// <para>Directories and remote items are skipped, and files are opened
+/// with <c>FILE_FLAG_OPEN_NO_RECALL</c>, so cloud files are never
+/// downloaded.</para>
+/// </remarks>
+/// <param name="selection">The selection, read with paths.</param>
+/// <param name="signatures">The signatures.</param>
+/// <param name="deadline">The time by which reading must stop.</param>
+void SniffSelection(Selection& selection, const ContentSignatures& signatures, std::chrono::steady_clock::time_point deadline);
@@ -1,193 +1,242 @@
-#include <atlcomcli.h>
-
-#include "ContextMenuCommand.h"
-
-ContextMenuCommand::ContextMenuCommand(std::wofstream& logFile, const ContextMenuEntry contextMenuEntry) : logFile(logFile), contextMenuEntry(contextMenuEntry) {
-  if (logFile.is_open()) {
-    logFile << L"Initializing context menu command" << std::endl;
-  }
-}
-
-std::wstring ContextMenuCommand::QuoteIfNeeded(const std::wstring& s) {
-  // Simple quote wrapper (assumes already safe content)
-  std::wstring result = L"\"";
-  result += s;
-  result += L"\"";
-  return result;
-}
-
-std::wstring ContextMenuCommand::ExpandCommand(const std::wstring& command, IShellItemArray* psiArray) {
-  std::wstring result = command;
-
-  std::wstring firstPath;
-  std::wstring allPaths;
-
-  DWORD count = 0;
-
-  if (psiArray && SUCCEEDED(psiArray->GetCount(&count))) {
-    for (DWORD i = 0; i < count; ++i) {
-      CComPtr<IShellItem> pItem;
-
-      if (SUCCEEDED(psiArray->GetItemAt(i, &pItem))) {
-        LPWSTR pszPath = nullptr;
-
-        if (SUCCEEDED(pItem->GetDisplayName(SIGDN_FILESYSPATH, &pszPath))) {
-          std::wstring quoted = QuoteIfNeeded(pszPath);
-
-          if (i == 0) firstPath = quoted;
-
-          allPaths.append(quoted);
-
-          if (i + 1 < count) allPaths.append(L" ");
-
-          CoTaskMemFree(pszPath);
-        }
-      }
-    }
-  }
-
-  // Substitute %1 (first item) and %* (all items)
-  size_t pos;
-
-  while ((pos = result.find(L"%1")) != std::wstring::npos) {
-    result.replace(pos, 2, firstPath);
-  }
-
-  while ((pos = result.find(L"%*")) != std::wstring::npos) {
-    result.replace(pos, 2, allPaths);
-  }
-
-  return result;
-}
-
-std::wstring ContextMenuCommand::GetDirectoryFromFirstItem(IShellItemArray* psiArray) {
-  if (!psiArray) return L"";
-
-  CComPtr<IShellItem> pItem;
-
-  if (SUCCEEDED(psiArray->GetItemAt(0, &pItem))) {
-    LPWSTR pszPath = nullptr;
-
-    if (SUCCEEDED(pItem->GetDisplayName(SIGDN_FILESYSPATH, &pszPath))) {
-      std::wstring fullPath(pszPath);
-      CoTaskMemFree(pszPath);
-
-      size_t lastSlash = fullPath.find_last_of(L"\\/");
-
-      if (lastSlash != std::wstring::npos) {
-        return fullPath.substr(0, lastSlash);
-      }
-    }
-  }
-  return L"";
-}
-
-bool ContextMenuCommand::Launch(std::wstring currentDirectory, std::wstring command) {
-  STARTUPINFOW si = { sizeof(si) };
-  PROCESS_INFORMATION pi = {};
-
-  BOOL success = CreateProcessW(
-    nullptr,
-    &command[0],
-    nullptr,
-    nullptr,
-    FALSE,
-    0,
-    nullptr,
-    currentDirectory.c_str(),
-    &si,
-    &pi
-  );
-
-  if (success) {
-    CloseHandle(pi.hThread);
-    CloseHandle(pi.hProcess);
-
-    if (logFile.is_open()) {
-      logFile << L"Launched in " << currentDirectory << L": " << command << std::endl;
-    }
-
-    return true;
-  }
-
-  if (logFile.is_open()) {
-    logFile << L"ERROR: CreateProcessW failed: " << GetLastError() << std::endl;
-  }
-
-  return false;
-}
-
-IFACEMETHODIMP ContextMenuCommand::QueryInterface(REFIID riid, void** ppv) {
-  if (!ppv) return E_POINTER;
-
-  *ppv = nullptr;
-
-  if (riid == IID_IUnknown || riid == IID_IExplorerCommand) {
-    *ppv = static_cast<IExplorerCommand*>(this);
-    AddRef();
-
-    return S_OK;
-  }
-
-  return E_NOINTERFACE;
-}
-
-IFACEMETHODIMP_(ULONG) ContextMenuCommand::AddRef() {
-  return InterlockedIncrement(&refCount);
-}
-
-IFACEMETHODIMP_(ULONG) ContextMenuCommand::Release() {
-  ULONG count = InterlockedDecrement(&refCount);
-
-  if (!count) delete this;
-
-  return count;
-}
-
-IFACEMETHODIMP ContextMenuCommand::GetTitle(IShellItemArray*, LPWSTR* ppszName) {
-  *ppszName = _wcsdup(contextMenuEntry.title.c_str());
-
-  return S_OK;
-}
-
-IFACEMETHODIMP ContextMenuCommand::GetIcon(IShellItemArray*, LPWSTR* ppszIcon) {
-  *ppszIcon = _wcsdup(contextMenuEntry.icon.c_str());
-
-  return S_OK;
-}
-
-IFACEMETHODIMP ContextMenuCommand::GetToolTip(IShellItemArray*, LPWSTR* ppszTip) {
-  *ppszTip = _wcsdup(contextMenuEntry.toolTip.c_str());
-
-  return S_OK;
-}
-
-IFACEMETHODIMP ContextMenuCommand::GetCanonicalName(GUID* pguidCommandName) {
-  *pguidCommandName = contextMenuEntry.clsid;
-
-  return S_OK;
-}
-
-IFACEMETHODIMP ContextMenuCommand::GetState(IShellItemArray*, BOOL, EXPCMDSTATE* pCmdState) {
-  *pCmdState = ECS_ENABLED;
-
-  return S_OK;
-}
-
-IFACEMETHODIMP ContextMenuCommand::Invoke(IShellItemArray* psiItemArray, IBindCtx*) {
-  std::wstring wCommand(ExpandCommand(contextMenuEntry.command, psiItemArray));
-
-  return Launch(GetDirectoryFromFirstItem(psiItemArray), wCommand.c_str()) ? E_UNEXPECTED : S_OK;
-}
-
-IFACEMETHODIMP ContextMenuCommand::GetFlags(EXPCMDFLAGS* pFlags) {
-  *pFlags = 0;
-  
-  return S_OK;
-}
-
-IFACEMETHODIMP ContextMenuCommand::EnumSubCommands(IEnumExplorerCommand** ppEnum) {
-  *ppEnum = nullptr;
-  
-  return E_NOTIMPL;
-}
\ No newline at end of file
+#include "ContentSniffer.h"
+#include "ContextMenuCommand.h"
+#include "ContextMenuCommandEnumerator.h"
+#include "Forwarder.h"
+#include "LaunchPreparation.h"
+#include "MarkerFinder.h"
+#include "SelectionFiles.h"
+#include "ShellSelection.h"
+#include "VolumeProbe.h"
+
+extern LONG g_cRefModule;
+
+namespace {
+  /// <summary>
+  /// The file system and process operations of Windows, for <see
+  /// cref="MenuCommand"/>.
+  /// </summary>
+  class ShellPlatform : public MenuCommandPlatform {
+  public:
+    void FindMarkers(Selection& selection, const DirectoryMarkers& markers, std::chrono::steady_clock::time_point deadline, std::chrono::milliseconds volumeTimeout) override {
+      FindSelectionMarkers(selection, markers, deadline, volumeTimeout);
+    }
+
+    void MatchContent(Selection& selection, const ContentSignatures& signatures, std::chrono::steady_clock::time_point deadline) override {
+      SniffSelection(selection, signatures, deadline);
+    }
+
+    void PrepareLaunch(std::shared_ptr<PreparedLaunch>& preparation, const SelectionFingerprint& fingerprint, const std::wstring& command) override {
+      LaunchPreparation::Start(preparation, fingerprint, command);
+    }
+
+    void ReadFiles(const Selection& selection, std::chrono::milliseconds volumeTimeout, std::vector<SelectionFileInfo>& files) override {
+      ReadSelectionFiles(selection, volumeTimeout, files);
+    }
+
+    std::wstring FindRoot(const Selection& selection, const DirectoryMarkers& markers, uint64_t mask, std::chrono::milliseconds volumeTimeout) override {
+      return FindSelectionRoot(selection, markers, mask, volumeTimeout);
+    }
+
+    bool Forward(const ForwardTarget& target, std::wstring_view message, Log& log) override {
+      return SUCCEEDED(ForwardCommand(target, message, log));
+    }
+
+    bool IsVolumeResponsive(std::wstring_view path, std::chrono::milliseconds timeout) override {
+      return ::IsVolumeResponsive(path, timeout);
+    }
+
+    bool Launch(const std::wstring& currentDirectory, std::wstring command, Log& log) override {
+      STARTUPINFOW si = { sizeof(si) };
+      PROCESS_INFORMATION pi = {};
+
+      BOOL success = CreateProcessW(
+        nullptr,
+        &command[0],
+        nullptr,
+        nullptr,
+        FALSE,
+        0,
+        nullptr,
+        currentDirectory.empty() ? nullptr : currentDirectory.c_str(),
+        &si,
+        &pi
+      );
+
+      if (success) {
+        CloseHandle(pi.hThread);
+        CloseHandle(pi.hProcess);
+
+        if (log.IsOpen()) {
+          log.Line() << L"Launched in " << currentDirectory << L": " << command;
+        }
+
+        return true;
+      }
+
+      if (log.IsOpen()) {
+        log.Line() << L"ERROR: CreateProcessW failed: " << GetLastError();
+      }
+
+      return false;
+    }
+  };
+
+  ShellPlatform shellPlatform;
+
+  TypedMenuCommandPool<ContextMenuCommand> commandPool(shellPlatform);
+
+  EXPCMDSTATE ToCommandState(VisibilityState state) {
+    switch (state) {
+    case VisibilityState::Disabled:
+      return ECS_DISABLED;
+    case VisibilityState::Hidden:
+      return ECS_HIDDEN;
+    default:
+      return ECS_ENABLED;
+    }
+  }
+
+  /// <summary>
+  /// Copies <paramref name="s"/> into memory the shell frees with
+  /// <c>CoTaskMemFree</c>.
+  /// </summary>
+  HRESULT DuplicateOutString(const std::wstring& s, LPWSTR* ppsz) {
+    *ppsz = static_cast<LPWSTR>(CoTaskMemAlloc((s.size() + 1) * sizeof(wchar_t)));
+
+    if (!*ppsz) return E_OUTOFMEMORY;
+
+    wmemcpy(*ppsz, s.c_str(), s.size() + 1);
+
+    return S_OK;
+  }
+}
+
+ContextMenuCommand::ContextMenuCommand(MenuCommandPool& pool, MenuCommandPlatform& platform, Log& log) : MenuCommand(pool, platform, log), clsid(CLSID_NULL) {}
+
+HRESULT ContextMenuCommand::Create(Log& log, std::shared_ptr<const ConfigSnapshot> snapshot, const ContextMenuEntry& contextMenuEntry, REFCLSID clsid, ContextMenuCommand** ppCommand) {
+  *ppCommand = static_cast<ContextMenuCommand*>(MenuCommand::Create(commandPool, log, std::move(snapshot), contextMenuEntry));
+
+  if (!*ppCommand) return E_OUTOFMEMORY;
+
+  (*ppCommand)->clsid = clsid;
+
+  return S_OK;
+}
+
+void ContextMenuCommand::DrainPool() {
+  commandPool.Drain();
+}
+
+void ContextMenuCommand::Initialized(const MenuCommand* parent, size_t index) {
+  // Give each subcommand a distinct canonical name derived from its
+  // parent's
+  if (parent) {
+    clsid = static_cast<const ContextMenuCommand*>(parent)->clsid;
+    clsid.Data1 += static_cast<unsigned long>(index + 1);
+  }
+
+  InterlockedIncrement(&g_cRefModule);
+}
+
+void ContextMenuCommand::Recycled() {
+  fingerprints.Clear();
+  InterlockedDecrement(&g_cRefModule);
+}
+
+HRESULT ContextMenuCommand::GetSubCommand(size_t index, IExplorerCommand** ppCommand) {
+  *ppCommand = nullptr;
+
+  if (index >= SubCommandCount()) return E_INVALIDARG;
+
+  auto* subCommand = static_cast<ContextMenuCommand*>(MenuCommand::GetSubCommand(index));
+
+  if (!subCommand) return E_OUTOFMEMORY;
+
+  return subCommand->QueryInterface(IID_IExplorerCommand, reinterpret_cast<void**>(ppCommand));
+}
+
+IFACEMETHODIMP ContextMenuCommand::QueryInterface(REFIID riid, void** ppv) {
+  if (!ppv) return E_POINTER;
+
+  *ppv = nullptr;
+
+  if (riid == IID_IUnknown || riid == IID_IExplorerCommand) {
+    *ppv = static_cast<IExplorerCommand*>(this);
+    AddRef();
+
+    return S_OK;
+  }
+
+  return E_NOINTERFACE;
+}
+
+IFACEMETHODIMP_(ULONG) ContextMenuCommand::AddRef() {
+  return MenuCommand::AddRef();
+}
+
+IFACEMETHODIMP_(ULONG) ContextMenuCommand::Release() {
+  return MenuCommand::Release();
+}
+
+IFACEMETHODIMP ContextMenuCommand::GetTitle(IShellItemArray*, LPWSTR* ppszName) {
+  return DuplicateOutString(Entry().title, ppszName);
+}
+
+IFACEMETHODIMP ContextMenuCommand::GetIcon(IShellItemArray*, LPWSTR* ppszIcon) {
+  if (Entry().icon.empty()) {
+    *ppszIcon = nullptr;
+
+    return E_NOTIMPL;
+  }
+
+  return DuplicateOutString(Entry().icon, ppszIcon);
+}
+
+IFACEMETHODIMP ContextMenuCommand::GetToolTip(IShellItemArray*, LPWSTR* ppszTip) {
+  return DuplicateOutString(Entry().toolTip, ppszTip);
+}
+
+IFACEMETHODIMP ContextMenuCommand::GetCanonicalName(GUID* pguidCommandName) {
+  *pguidCommandName = clsid;
+
+  return S_OK;
+}
+
+IFACEMETHODIMP ContextMenuCommand::GetState(IShellItemArray* psiItemArray, BOOL, EXPCMDSTATE* pCmdState) {
+  ShellItemSelection selection(psiItemArray, fingerprints);
+
+  *pCmdState = ToCommandState(MenuCommand::GetState(selection));
+
+  return S_OK;
+}
+
+IFACEMETHODIMP ContextMenuCommand::Invoke(IShellItemArray* psiItemArray, IBindCtx*) {
+  if (SubCommandCount()) return E_NOTIMPL;
+
+  ShellItemSelection selection(psiItemArray, fingerprints);
+
+  if (MenuCommand::Invoke(selection)) return S_OK;
+
+  return FAILED(selection.Result()) ? selection.Result() : E_FAIL;
+}
+
+IFACEMETHODIMP ContextMenuCommand::GetFlags(EXPCMDFLAGS* pFlags) {
+  *pFlags = SubCommandCount() ? ECF_HASSUBCOMMANDS : ECF_DEFAULT;
+
+  return S_OK;
+}
+
+IFACEMETHODIMP ContextMenuCommand::EnumSubCommands(IEnumExplorerCommand** ppEnum) {
+  *ppEnum = nullptr;
+
+  if (!SubCommandCount()) return E_NOTIMPL;
+
+  auto* enumerator = new (std::nothrow) ContextMenuCommandEnumerator(this, 0);
+
+  if (!enumerator) return E_OUTOFMEMORY;
+
+  HRESULT hr = enumerator->QueryInterface(IID_IEnumExplorerCommand, reinterpret_cast<void**>(ppEnum));
+  enumerator->Release();
+
+  return hr;
+}
@@ -0,0 +1,111 @@
+#include "ContextMenuCommand.h"
+
+#include "ContextMenuCommandEnumerator.h"
+
+ContextMenuCommandEnumerator::ContextMenuCommandEnumerator(ContextMenuCommand* parent, size_t index) : parent(parent), index(index) {
+  parent->AddRef();
+}
+
+ContextMenuCommandEnumerator::~ContextMenuCommandEnumerator() {
+  parent->Release();
+}
+
+IFACEMETHODIMP ContextMenuCommandEnumerator::QueryInterface(REFIID riid, void** ppv) {
+  if (!ppv) return E_POINTER;
+
+  *ppv = nullptr;
+
+  if (riid == IID_IUnknown || riid == IID_IEnumExplorerCommand) {
+    *ppv = static_cast<IEnumExplorerCommand*>(this);
+    AddRef();
+
+    return S_OK;
+  }
+
+  return E_NOINTERFACE;
+}
+
+IFACEMETHODIMP_(ULONG) ContextMenuCommandEnumerator::AddRef() {
+  return InterlockedIncrement(&refCount);
+}
+
+IFACEMETHODIMP_(ULONG) ContextMenuCommandEnumerator::Release() {
+  ULONG count = InterlockedDecrement(&refCount);
+
+  if (!count) delete this;
+
+  return count;
+}
+
+IFACEMETHODIMP ContextMenuCommandEnumerator::Next(ULONG celt, IExplorerCommand** pUICommand, ULONG* pceltFetched) {
+  if (!pUICommand) return E_POINTER;
+
+  ULONG fetched = 0;
+  HRESULT hr = S_OK;
+
+  AcquireSRWLockExclusive(&lock);
+
+  while (fetched < celt && index < parent->SubCommandCount()) {
+    hr = parent->GetSubCommand(index, &pUICommand[fetched]);
+
+    if (FAILED(hr)) break;
+
+    ++index;
+    ++fetched;
+  }
+
+  ReleaseSRWLockExclusive(&lock);
+
+  if (FAILED(hr)) {
+    while (fetched) {
+      pUICommand[--fetched]->Release();
+      pUICommand[fetched] = nullptr;
+    }
+  }
+
+  if (pceltFetched) *pceltFetched = fetched;
+
+  if (FAILED(hr)) return hr;
+
+  return fetched == celt ? S_OK : S_FALSE;
+}
+
+IFACEMETHODIMP ContextMenuCommandEnumerator::Skip(ULONG celt) {
+  AcquireSRWLockExclusive(&lock);
+
+  size_t remaining = parent->SubCommandCount() - index;
+  size_t skipped = celt > remaining ? remaining : celt;
+
+  index += skipped;
+
+  ReleaseSRWLockExclusive(&lock);
+
+  return skipped == celt ? S_OK : S_FALSE;
+}
+
+IFACEMETHODIMP ContextMenuCommandEnumerator::Reset() {
+  AcquireSRWLockExclusive(&lock);
+  index = 0;
+  ReleaseSRWLockExclusive(&lock);
+
+  return S_OK;
+}
+
+IFACEMETHODIMP ContextMenuCommandEnumerator::Clone(IEnumExplorerCommand** ppenum) {
+  if (!ppenum) return E_POINTER;
+
+  *ppenum = nullptr;
+
+  AcquireSRWLockShared(&lock);
+  size_t position = index;
+  ReleaseSRWLockShared(&lock);
+
+  auto* enumerator = new (std::nothrow) ContextMenuCommandEnumerator(parent, position);
+
+  if (!enumerator) return E_OUTOFMEMORY;
+
+  HRESULT hr = enumerator->QueryInterface(IID_IEnumExplorerCommand, reinterpret_cast<void**>(ppenum));
+  enumerator->Release();
+
+  return hr;
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <ShObjIdl_core.h>
+#include "framework.h"
+
+class ContextMenuCommand;
+
+/// <summary>
+/// An enumerator over a context menu command's subcommands.
+/// </summary>
+class ContextMenuCommandEnumerator : public IEnumExplorerCommand {
+  long refCount = 1;
+
+  ContextMenuCommand* parent;
+
+  /// <summary>
+  /// Guards <see cref="index"/>, since the enumerator is free-threaded like
+  /// its parent.
+  /// </summary>
+  SRWLOCK lock = SRWLOCK_INIT;
+
+  size_t index;
+
+public:
+  /// <summary>
+  /// Initializes a <see cref="ContextMenuCommandEnumerator"/>.
+  /// </summary>
+  /// <param name="parent">The command whose subcommands to enumerate. The
+  /// enumerator holds a reference to it.</param>
+  /// <param name="index">The index of the next subcommand to
+  /// enumerate.</param>
+  ContextMenuCommandEnumerator(ContextMenuCommand* parent, size_t index);
+
+  /// <summary>
+  /// Releases the parent command.
+  /// </summary>
+  ~ContextMenuCommandEnumerator();
+
+  /// <summary>
+  /// Implements <see cref="IUnknown::QueryInterface"/>.
+  /// </summary>
+  /// <remarks>
+  /// Queries a COM object for a pointer to one of its interface; identifying
+  /// the interface by a reference to its interface identifier (IID). If the
+  /// COM object implements the interface, then it returns a pointer to that
+  /// interface after calling IUnknown::AddRef on it.
+  /// </remarks>
+  /// <param name="riid">A reference to the interface identifier (IID) of the
+  /// interface being queried for.</param>
+  /// <param name="ppv">The address of a pointer to an interface with the IID
+  /// specified in the <paramref name="riid"/> parameter.</param>
+  /// <returns>Returns <c>S_OK</c> if the requested interface was found in
+  /// the table or if the requested interface was <c>IUnknown</c>. Returns
+  /// <c>E_NOINTERFACE</c> if the requested interface was not
+  /// found.</returns>
+  IFACEMETHODIMP QueryInterface(REFIID riid, void** ppv);
+
+  /// <summary>
+  /// Implements <see cref="IUnknown::AddRef"/>.
+  /// </summary>
+  /// <remarks>
+  /// Increments the reference count for an interface pointer to a COM
+  /// object. You should call this method whenever you make a copy of an
+  /// interface pointer.
+  /// </remarks>
+  /// <returns>The method returns the new reference count. This value is
+  /// intended to be used only for test purposes.</returns>
+  IFACEMETHODIMP_(ULONG) AddRef(void);
+
+  /// <summary>
+  /// Implements <see cref="IUnknown::Release"/>.
+  /// </summary>
+  /// <remarks>
+  /// Decrements the reference count for an interface on a COM object.
+  /// </remarks>
+  /// <returns>The method returns the new reference count. This value is
+  /// intended to be used only for test purposes.</returns>
+  IFACEMETHODIMP_(ULONG) Release(void);
+
+  /// <summary>
+  /// Implements <see cref="IEnumExplorerCommand::Next"/>.
+  /// </summary>
+  /// <remarks>
+  /// Retrieves a specified number of elements that directly follow the
+  /// current element. Subcommands are created as they are retrieved.
+  /// </remarks>
+  /// <param name="celt">The number of elements to retrieve.</param>
+  /// <param name="pUICommand">Receives the retrieved subcommands.</param>
+  /// <param name="pceltFetched">Receives the number of elements retrieved.
+  /// May be <c>nullptr</c>.</param>
+  /// <returns>Returns <c>S_OK</c> if <paramref name="celt"/> elements were
+  /// retrieved or <c>S_FALSE</c> if fewer were.</returns>
+  IFACEMETHODIMP Next(ULONG celt, IExplorerCommand** pUICommand, ULONG* pceltFetched);
+
+  /// <summary>
+  /// Implements <see cref="IEnumExplorerCommand::Skip"/>.
+  /// </summary>
+  /// <remarks>
+  /// Skips a specified number of elements.
+  /// </remarks>
+  /// <param name="celt">The number of elements to skip.</param>
+  /// <returns>Returns <c>S_OK</c> if <paramref name="celt"/> elements were
+  /// skipped or <c>S_FALSE</c> if the end was reached first.</returns>
+  IFACEMETHODIMP Skip(ULONG celt);
+
+  /// <summary>
+  /// Implements <see cref="IEnumExplorerCommand::Reset"/>.
+  /// </summary>
+  /// <remarks>
+  /// Resets the internal count of retrieved elements.
+  /// </remarks>
+  /// <returns>Returns <c>S_OK</c>.</returns>
+  IFACEMETHODIMP Reset(void);
+
+  /// <summary>
+  /// Implements <see cref="IEnumExplorerCommand::Clone"/>.
+  /// </summary>
+  /// <remarks>
+  /// Creates a copy of this enumerator at the same position.
+  /// </remarks>
+  /// <param name="ppenum">Receives the copy.</param>
+  /// <returns>If this method succeeds, it returns <c>S_OK</c>. Otherwise, it
+  /// returns an <c>HRESULT</c> error code.</returns>
+  IFACEMETHODIMP Clone(IEnumExplorerCommand** ppenum);
+};
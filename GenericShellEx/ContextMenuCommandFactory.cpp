@@ -1,52 +1,65 @@
-#include "ContextMenuCommand.h"
-
-#include "ContextMenuCommandFactory.h"
-
-ContextMenuCommandFactory::ContextMenuCommandFactory(std::wofstream& logFile, ContextMenuEntry contextMenuEntry) : logFile(logFile), contextMenuEntry(contextMenuEntry) {
-  if (logFile.is_open()) {
-    logFile << L"Initializing context menu command factory" << std::endl;
-  }
-}
-
-IFACEMETHODIMP ContextMenuCommandFactory::QueryInterface(REFIID riid, void** ppv) {
-  if (!ppv) return E_POINTER;
-  *ppv = nullptr;
-
-  if (riid == IID_IUnknown || riid == IID_IClassFactory) {
-    *ppv = static_cast<IClassFactory*>(this);
-    AddRef();
-
-    return S_OK;
-  }
-
-  return E_NOINTERFACE;
-}
-
-IFACEMETHODIMP_(ULONG) ContextMenuCommandFactory::AddRef() {
-  return InterlockedIncrement(&refCount);
-}
-
-IFACEMETHODIMP_(ULONG) ContextMenuCommandFactory::Release() {
-  ULONG count = InterlockedDecrement(&refCount);
-
-  if (!count) delete this;
-
-  return count;
-}
-
-IFACEMETHODIMP ContextMenuCommandFactory::CreateInstance(IUnknown* pUnkOuter, REFIID riid, void** ppv) {
-  if (pUnkOuter) return CLASS_E_NOAGGREGATION;
-
-  auto* provider = new (std::nothrow) ContextMenuCommand(logFile, contextMenuEntry);
-
-  if (!provider) return E_OUTOFMEMORY;
-
-  HRESULT hr = provider->QueryInterface(riid, ppv);
-  provider->Release();
-
-  return hr;
-}
-
-IFACEMETHODIMP ContextMenuCommandFactory::LockServer(BOOL) {
-  return S_OK;
-}
+#include "ClsidSlotPool.h"
+#include "ContextMenuCommand.h"
+
+#include "ContextMenuCommandFactory.h"
+
+extern LONG g_cRefModule;
+
+extern std::shared_ptr<const ConfigSnapshot> GetConfigSnapshot();
+
+ContextMenuCommandFactory::ContextMenuCommandFactory(Log& log, size_t slot) : log(log), slot(slot) {}
+
+IFACEMETHODIMP ContextMenuCommandFactory::QueryInterface(REFIID riid, void** ppv) {
+  if (!ppv) return E_POINTER;
+  *ppv = nullptr;
+
+  if (riid == IID_IUnknown || riid == IID_IClassFactory) {
+    *ppv = static_cast<IClassFactory*>(this);
+    AddRef();
+
+    return S_OK;
+  }
+
+  return E_NOINTERFACE;
+}
+
+IFACEMETHODIMP_(ULONG) ContextMenuCommandFactory::AddRef() {
+  InterlockedIncrement(&g_cRefModule);
+
+  return 2;
+}
+
+IFACEMETHODIMP_(ULONG) ContextMenuCommandFactory::Release() {
+  InterlockedDecrement(&g_cRefModule);
+
+  return 1;
+}
+
+IFACEMETHODIMP ContextMenuCommandFactory::CreateInstance(IUnknown* pUnkOuter, REFIID riid, void** ppv) {
+  if (pUnkOuter) return CLASS_E_NOAGGREGATION;
+
+  std::shared_ptr<const ConfigSnapshot> snapshot = GetConfigSnapshot();
+  const ContextMenuEntry* contextMenuEntry = snapshot ? snapshot->Entry(slot) : nullptr;
+
+  if (!contextMenuEntry) return CLASS_E_CLASSNOTAVAILABLE;
+
+  ContextMenuCommand* provider = nullptr;
+  HRESULT hr = ContextMenuCommand::Create(log, std::move(snapshot), *contextMenuEntry, ClsidSlots[slot].clsid, &provider);
+
+  if (FAILED(hr)) return hr;
+
+  hr = provider->QueryInterface(riid, ppv);
+  provider->Release();
+
+  return hr;
+}
+
+IFACEMETHODIMP ContextMenuCommandFactory::LockServer(BOOL fLock) {
+  if (fLock) {
+    InterlockedIncrement(&g_cRefModule);
+  } else {
+    InterlockedDecrement(&g_cRefModule);
+  }
+
+  return S_OK;
+}
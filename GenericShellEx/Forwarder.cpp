@@ -0,0 +1,168 @@
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Forwarder.h"
+
+namespace {
+  /// <summary>
+  /// Guards <see cref="deadEndpoints"/>.
+  /// </summary>
+  SRWLOCK deadEndpointsLock = SRWLOCK_INIT;
+
+  /// <summary>
+  /// Endpoints that could not be reached, and when to try them again, from
+  /// <c>GetTickCount64</c>.
+  /// </summary>
+  std::unordered_map<std::wstring, ULONGLONG> deadEndpoints;
+
+  bool IsKnownDead(const std::wstring& endpoint) {
+    AcquireSRWLockShared(&deadEndpointsLock);
+
+    auto dead = deadEndpoints.find(endpoint);
+    bool known = dead != deadEndpoints.end() && GetTickCount64() < dead->second;
+
+    ReleaseSRWLockShared(&deadEndpointsLock);
+
+    return known;
+  }
+
+  void SetDead(const std::wstring& endpoint, bool dead) {
+    AcquireSRWLockExclusive(&deadEndpointsLock);
+
+    if (dead) {
+      deadEndpoints[endpoint] = GetTickCount64() + DeadEndpointLifetime;
+    } else {
+      deadEndpoints.erase(endpoint);
+    }
+
+    ReleaseSRWLockExclusive(&deadEndpointsLock);
+  }
+
+  /// <summary>
+  /// Encodes a message as the target expects it.
+  /// </summary>
+  std::vector<char> EncodeMessage(const ForwardTarget& target, std::wstring_view message) {
+    if (target.utf16) {
+      const char* bytes = reinterpret_cast<const char*>(message.data());
+
+      return std::vector<char>(bytes, bytes + message.size() * sizeof(wchar_t));
+    }
+
+    std::vector<char> utf8;
+    int length = WideCharToMultiByte(CP_UTF8, 0, message.data(), static_cast<int>(message.size()), nullptr, 0, nullptr, nullptr);
+
+    if (length > 0) {
+      utf8.resize(length);
+      WideCharToMultiByte(CP_UTF8, 0, message.data(), static_cast<int>(message.size()), utf8.data(), length, nullptr, nullptr);
+    }
+
+    return utf8;
+  }
+
+  HRESULT WriteToPipe(const ForwardTarget& target, const std::vector<char>& bytes) {
+    ULONGLONG deadline = GetTickCount64() + target.timeout.count();
+    HANDLE pipe = INVALID_HANDLE_VALUE;
+
+    for (;;) {
+      pipe = CreateFileW(target.endpoint.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, nullptr);
+
+      if (pipe != INVALID_HANDLE_VALUE) break;
+
+      DWORD error = GetLastError();
+      ULONGLONG now = GetTickCount64();
+
+      // Every instance is busy serving someone else, so wait for one
+      if (error != ERROR_PIPE_BUSY || now >= deadline || !WaitNamedPipeW(target.endpoint.c_str(), static_cast<DWORD>(deadline - now))) {
+        return HRESULT_FROM_WIN32(error == ERROR_PIPE_BUSY ? ERROR_TIMEOUT : error);
+      }
+    }
+
+    ULONG serverProcessId = 0;
+
+    if (GetNamedPipeServerProcessId(pipe, &serverProcessId)) AllowSetForegroundWindow(serverProcessId);
+
+    OVERLAPPED overlapped = {};
+    overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+
+    if (!overlapped.hEvent) {
+      CloseHandle(pipe);
+
+      return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    DWORD written = 0;
+    HRESULT hr = S_OK;
+
+    if (!WriteFile(pipe, bytes.data(), static_cast<DWORD>(bytes.size()), nullptr, &overlapped) && GetLastError() != ERROR_IO_PENDING) {
+      hr = HRESULT_FROM_WIN32(GetLastError());
+    } else {
+      ULONGLONG now = GetTickCount64();
+      DWORD remaining = now < deadline ? static_cast<DWORD>(deadline - now) : 0;
+
+      if (WaitForSingleObject(overlapped.hEvent, remaining) != WAIT_OBJECT_0) {
+        CancelIoEx(pipe, &overlapped);
+        hr = HRESULT_FROM_WIN32(ERROR_TIMEOUT);
+      }
+
+      // Waits for a cancelled write to finish, since it refers to
+      // overlapped
+      if (!GetOverlappedResult(pipe, &overlapped, &written, TRUE) && SUCCEEDED(hr)) {
+        hr = HRESULT_FROM_WIN32(GetLastError());
+      }
+
+      if (SUCCEEDED(hr) && written != bytes.size()) hr = HRESULT_FROM_WIN32(ERROR_WRITE_FAULT);
+    }
+
+    CloseHandle(overlapped.hEvent);
+    CloseHandle(pipe);
+
+    return hr;
+  }
+
+  HRESULT SendToWindow(const ForwardTarget& target, const std::vector<char>& bytes) {
+    HWND window = FindWindowW(target.endpoint.c_str(), target.windowTitle.empty() ? nullptr : target.windowTitle.c_str());
+
+    if (!window) return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+
+    DWORD processId = 0;
+
+    if (GetWindowThreadProcessId(window, &processId)) AllowSetForegroundWindow(processId);
+
+    COPYDATASTRUCT copyData = {};
+    copyData.dwData = target.copyDataId;
+    copyData.cbData = static_cast<DWORD>(bytes.size());
+    copyData.lpData = const_cast<char*>(bytes.data());
+
+    DWORD_PTR result = 0;
+
+    if (!SendMessageTimeoutW(window, WM_COPYDATA, 0, reinterpret_cast<LPARAM>(&copyData), SMTO_ABORTIFHUNG | SMTO_BLOCK, static_cast<UINT>(target.timeout.count()), &result)) {
+      DWORD error = GetLastError();
+
+      return HRESULT_FROM_WIN32(error ? error : ERROR_TIMEOUT);
+    }
+
+    return S_OK;
+  }
+}
+
+HRESULT ForwardCommand(const ForwardTarget& target, std::wstring_view message, Log& log) {
+  if (!target.IsConfigured()) return E_INVALIDARG;
+
+  if (IsKnownDead(target.endpoint)) return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+
+  std::vector<char> bytes = EncodeMessage(target, message);
+  HRESULT hr = target.kind == ForwardKind::Pipe ? WriteToPipe(target, bytes) : SendToWindow(target, bytes);
+
+  SetDead(target.endpoint, FAILED(hr));
+
+  if (log.IsOpen()) {
+    if (SUCCEEDED(hr)) {
+      log.Line() << L"Forwarded to " << target.endpoint << L": " << message;
+    } else {
+      log.Line() << L"Unable to forward to " << target.endpoint << L", launching instead: " << static_cast<unsigned long>(HRESULT_CODE(hr));
+    }
+  }
+
+  return hr;
+}
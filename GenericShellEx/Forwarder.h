@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string_view>
+#include "framework.h"
+#include "ForwardTarget.h"
+#include "Log.h"
+
+/// <summary>
+/// How long, in milliseconds, an endpoint that could not be reached is
+/// assumed to still be unreachable.
+/// </summary>
+constexpr ULONGLONG DeadEndpointLifetime = 10000;
+
+/// <summary>
+/// Forwards a command to a running instance.
+/// </summary>
+/// <remarks>
+/// <para>Gives up after the target's timeout, so Explorer is never blocked
+/// for longer. The instance is allowed to bring itself to the
+/// foreground.</para>
+/// <para>An endpoint that cannot be reached is remembered for <see
+/// cref="DeadEndpointLifetime"/>, during which forwarding to it fails
+/// immediately rather than probing it again.</para>
+/// </remarks>
+/// <param name="target">The target.</param>
+/// <param name="message">The message, already expanded.</param>
+/// <param name="log">A <see cref="Log"/>.</param>
+/// <returns>If the message was delivered, <c>S_OK</c>. Otherwise, an
+/// <c>HRESULT</c> error code.</returns>
+HRESULT ForwardCommand(const ForwardTarget& target, std::wstring_view message, Log& log);
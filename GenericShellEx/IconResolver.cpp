@@ -0,0 +1,342 @@
+#include <ShellAPI.h>
+#include <cstring>
+#include <cwchar>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "IconResolver.h"
+#include "Selection.h"
+
+namespace {
+#pragma pack(push, 2)
+  /// <summary>
+  /// The header of an <c>RT_GROUP_ICON</c> resource.
+  /// </summary>
+  struct GroupIconHeader {
+    WORD reserved;
+    WORD type;
+    WORD count;
+  };
+
+  /// <summary>
+  /// An image in an <c>RT_GROUP_ICON</c> resource, which refers to an
+  /// <c>RT_ICON</c> resource by ID.
+  /// </summary>
+  struct GroupIconEntry {
+    BYTE width;
+    BYTE height;
+    BYTE colorCount;
+    BYTE reserved;
+    WORD planes;
+    WORD bitCount;
+    DWORD bytesInRes;
+    WORD id;
+  };
+#pragma pack(pop)
+
+  /// <summary>
+  /// An image in an <c>.ico</c> file, which refers to its data by offset.
+  /// </summary>
+  struct IconFileEntry {
+    BYTE width;
+    BYTE height;
+    BYTE colorCount;
+    BYTE reserved;
+    WORD planes;
+    WORD bitCount;
+    DWORD bytesInRes;
+    DWORD imageOffset;
+  };
+
+  /// <summary>
+  /// The broken icon locations already logged, so that reloading the
+  /// configuration does not log them again. Loads are serialized, so this
+  /// needs no lock.
+  /// </summary>
+  std::unordered_set<std::wstring> reportedLocations;
+
+  std::wstring_view Trim(std::wstring_view s) {
+    while (!s.empty() && (s.front() == L' ' || s.front() == L'"')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == L' ' || s.back() == L'"')) s.remove_suffix(1);
+
+    return s;
+  }
+
+  /// <summary>
+  /// Splits an icon location into a path and an icon index. A location
+  /// without a numeric suffix is all path, since paths may contain commas.
+  /// </summary>
+  void SplitLocation(const std::wstring& location, std::wstring& path, int& index) {
+    path = Trim(location);
+    index = 0;
+
+    size_t comma = location.rfind(L',');
+
+    if (comma == std::wstring::npos) return;
+
+    std::wstring_view suffix = Trim(std::wstring_view(location).substr(comma + 1));
+    bool negative = !suffix.empty() && suffix.front() == L'-';
+
+    if (negative) suffix.remove_prefix(1);
+    if (suffix.empty() || suffix.size() > 9) return;
+
+    int value = 0;
+
+    for (wchar_t c : suffix) {
+      if (c < L'0' || c > L'9') return;
+
+      value = value * 10 + (c - L'0');
+    }
+
+    path = Trim(std::wstring_view(location).substr(0, comma));
+    index = negative ? -value : value;
+  }
+
+  /// <summary>
+  /// Finds an icon file the way the shell would, including bare module names
+  /// such as <c>shell32.dll</c>.
+  /// </summary>
+  bool FindIconFile(const std::wstring& path, std::wstring& fullPath, WIN32_FILE_ATTRIBUTE_DATA& attributes) {
+    wchar_t buffer[MAX_PATH];
+    DWORD length = SearchPathW(nullptr, path.c_str(), nullptr, MAX_PATH, buffer, nullptr);
+
+    if (!length) return false;
+
+    if (length < MAX_PATH) {
+      fullPath.assign(buffer, length);
+    } else {
+      fullPath.assign(length, L'\0');
+      fullPath.resize(SearchPathW(nullptr, path.c_str(), nullptr, length, fullPath.data(), nullptr));
+    }
+
+    return GetFileAttributesExW(fullPath.c_str(), GetFileExInfoStandard, &attributes) && !(attributes.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY);
+  }
+
+  bool HasIcon(const std::wstring& path, int index) {
+    HICON icon = nullptr;
+    UINT extracted = ExtractIconExW(path.c_str(), index, &icon, nullptr, 1);
+
+    if (icon) DestroyIcon(icon);
+
+    return extracted && extracted != UINT_MAX && icon;
+  }
+
+  bool IsIconFile(const std::wstring& path) {
+    return path.size() >= 4 && _wcsicmp(path.c_str() + path.size() - 4, L".ico") == 0;
+  }
+
+  /// <summary>
+  /// State for <see cref="FindNthGroupIcon"/>.
+  /// </summary>
+  struct GroupIconSearch {
+    int remaining;
+    bool found = false;
+    WORD id = 0;
+    std::wstring name;
+  };
+
+  BOOL CALLBACK FindNthGroupIcon(HMODULE, LPCWSTR, LPWSTR name, LONG_PTR param) {
+    auto* search = reinterpret_cast<GroupIconSearch*>(param);
+
+    if (search->remaining--) return TRUE;
+
+    // String names are only valid during enumeration
+    if (IS_INTRESOURCE(name)) {
+      search->id = static_cast<WORD>(reinterpret_cast<ULONG_PTR>(name));
+    } else {
+      search->name = name;
+    }
+
+    search->found = true;
+
+    return FALSE;
+  }
+
+  bool LoadResourceData(HMODULE module, LPCWSTR name, LPCWSTR type, const BYTE*& data, DWORD& size) {
+    HRSRC resource = FindResourceW(module, name, type);
+
+    if (!resource) return false;
+
+    HGLOBAL loaded = LoadResource(module, resource);
+
+    if (!loaded) return false;
+
+    data = static_cast<const BYTE*>(LockResource(loaded));
+    size = SizeofResource(module, resource);
+
+    return data && size;
+  }
+
+  /// <summary>
+  /// Builds an <c>.ico</c> file from an icon group resource.
+  /// </summary>
+  /// <param name="module">The module, loaded as a data file.</param>
+  /// <param name="index">The icon index, or a negative resource ID, as
+  /// <c>ExtractIconExW</c> interprets it.</param>
+  /// <param name="file">Receives the file contents.</param>
+  /// <returns><c>true</c> on success or <c>false</c> otherwise.</returns>
+  bool BuildIconFile(HMODULE module, int index, std::vector<BYTE>& file) {
+    GroupIconSearch search{ index };
+    LPCWSTR name = nullptr;
+
+    if (index < 0) {
+      name = MAKEINTRESOURCEW(-index);
+    } else {
+      EnumResourceNamesW(module, RT_GROUP_ICON, FindNthGroupIcon, reinterpret_cast<LONG_PTR>(&search));
+
+      if (!search.found) return false;
+
+      name = search.name.empty() ? MAKEINTRESOURCEW(search.id) : search.name.c_str();
+    }
+
+    const BYTE* group = nullptr;
+    DWORD groupSize = 0;
+
+    if (!LoadResourceData(module, name, RT_GROUP_ICON, group, groupSize) || groupSize < sizeof(GroupIconHeader)) return false;
+
+    GroupIconHeader header;
+    std::memcpy(&header, group, sizeof(header));
+
+    if (!header.count || groupSize < sizeof(GroupIconHeader) + header.count * sizeof(GroupIconEntry)) return false;
+
+    size_t directorySize = sizeof(GroupIconHeader) + header.count * sizeof(IconFileEntry);
+
+    file.assign(directorySize, 0);
+    std::memcpy(file.data(), &header, sizeof(header));
+
+    for (WORD i = 0; i < header.count; ++i) {
+      GroupIconEntry groupEntry;
+      std::memcpy(&groupEntry, group + sizeof(GroupIconHeader) + i * sizeof(GroupIconEntry), sizeof(groupEntry));
+
+      const BYTE* image = nullptr;
+      DWORD imageSize = 0;
+
+      if (!LoadResourceData(module, MAKEINTRESOURCEW(groupEntry.id), RT_ICON, image, imageSize)) return false;
+
+      IconFileEntry fileEntry = {
+        groupEntry.width,
+        groupEntry.height,
+        groupEntry.colorCount,
+        0,
+        groupEntry.planes,
+        groupEntry.bitCount,
+        imageSize,
+        static_cast<DWORD>(file.size())
+      };
+
+      std::memcpy(file.data() + sizeof(GroupIconHeader) + i * sizeof(IconFileEntry), &fileEntry, sizeof(fileEntry));
+      file.insert(file.end(), image, image + imageSize);
+    }
+
+    return true;
+  }
+
+  /// <summary>
+  /// Extracts an icon from a module to an <c>.ico</c> file. The file is
+  /// written under a temporary name and then renamed, so a partly written
+  /// file is never used.
+  /// </summary>
+  bool ExtractIconFile(const std::wstring& path, int index, const std::wstring& iconPath) {
+    HMODULE module = LoadLibraryExW(path.c_str(), nullptr, LOAD_LIBRARY_AS_DATAFILE | LOAD_LIBRARY_AS_IMAGE_RESOURCE);
+
+    if (!module) return false;
+
+    std::vector<BYTE> file;
+    bool built = BuildIconFile(module, index, file);
+
+    FreeLibrary(module);
+
+    if (!built) return false;
+
+    std::wstring temporaryPath = iconPath + L".tmp";
+    HANDLE handle = CreateFileW(temporaryPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (handle == INVALID_HANDLE_VALUE) return false;
+
+    DWORD written = 0;
+    BOOL success = WriteFile(handle, file.data(), static_cast<DWORD>(file.size()), &written, nullptr) && written == file.size();
+
+    CloseHandle(handle);
+
+    if (success) success = MoveFileExW(temporaryPath.c_str(), iconPath.c_str(), MOVEFILE_REPLACE_EXISTING);
+    if (!success) DeleteFileW(temporaryPath.c_str());
+
+    return success;
+  }
+}
+
+std::wstring IconResolver::GetCachedIcon(const std::wstring& path, int index, const FILETIME& lastWriteTime) {
+  std::wstring key = path;
+  CharLowerBuffW(key.data(), static_cast<DWORD>(key.size()));
+
+  key += L'|' + std::to_wstring(index) + L'|' + std::to_wstring((static_cast<ULONGLONG>(lastWriteTime.dwHighDateTime) << 32) | lastWriteTime.dwLowDateTime);
+
+  wchar_t name[24];
+  swprintf(name, sizeof(name) / sizeof(name[0]), L"%016llx.ico", static_cast<unsigned long long>(HashBytes(key.data(), key.size() * sizeof(wchar_t))));
+
+  std::wstring iconPath = cacheDirectory + L"\\" + name;
+
+  if (GetFileAttributesW(iconPath.c_str()) != INVALID_FILE_ATTRIBUTES) return iconPath;
+
+  CreateDirectoryW(cacheDirectory.c_str(), nullptr);
+
+  if (!ExtractIconFile(path, index, iconPath)) return L"";
+
+  if (log.IsOpen()) {
+    log.Line() << L"Cached icon " << path << L"," << index << L" as " << iconPath;
+  }
+
+  return iconPath;
+}
+
+std::wstring IconResolver::ResolveLocation(const std::wstring& location) {
+  std::wstring path;
+  int index = 0;
+
+  SplitLocation(location, path, index);
+
+  std::wstring fullPath;
+  WIN32_FILE_ATTRIBUTE_DATA attributes;
+  const wchar_t* problem = nullptr;
+
+  if (!FindIconFile(path, fullPath, attributes)) {
+    problem = L"file not found";
+  } else if (!HasIcon(fullPath, index)) {
+    problem = L"no icon at that index";
+  }
+
+  if (problem) {
+    if (log.IsOpen() && reportedLocations.insert(location).second) {
+      log.Line() << L"ERROR: Icon " << location << L": " << problem;
+    }
+
+    return L"";
+  }
+
+  if (!cacheDirectory.empty() && !IsIconFile(fullPath)) {
+    std::wstring cached = GetCachedIcon(fullPath, index, attributes.ftLastWriteTime);
+
+    if (!cached.empty()) return cached;
+  }
+
+  return fullPath + L"," + std::to_wstring(index);
+}
+
+std::wstring IconResolver::Resolve(const std::wstring& location) {
+  if (location.empty()) return location;
+
+  auto result = resolved.find(location);
+
+  if (result == resolved.end()) result = resolved.emplace(location, ResolveLocation(location)).first;
+
+  return result->second;
+}
+
+void IconResolver::Resolve(ContextMenuEntry& entry) {
+  entry.icon = Resolve(entry.icon);
+
+  for (ContextMenuEntry& subCommand : entry.subCommands) {
+    Resolve(subCommand);
+  }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include "framework.h"
+#include "ContextMenuEntry.h"
+#include "Log.h"
+
+/// <summary>
+/// Resolves and validates icon locations when a configuration is loaded.
+/// </summary>
+/// <remarks>
+/// <para>An icon location is a path, optionally followed by a comma and an
+/// icon index, or a negative resource ID. Resolving one finds the file,
+/// checks that the icon exists, and produces the location <c>GetIcon</c>
+/// hands to Explorer. A broken icon is logged once and resolves to an empty
+/// string, so Explorer does not try to load it on every right-click.</para>
+/// <para>With a cache directory, icons in executables and DLLs are extracted
+/// to <c>.ico</c> files named after the source path, icon index, and the
+/// source's last write time, which Explorer can load without mapping the
+/// module.</para>
+/// </remarks>
+class IconResolver {
+  Log& log;
+
+  /// <summary>
+  /// The directory for extracted icons, or empty to not extract them.
+  /// </summary>
+  std::wstring cacheDirectory;
+
+  /// <summary>
+  /// Locations resolved so far, so each one is checked once per load.
+  /// </summary>
+  std::unordered_map<std::wstring, std::wstring> resolved;
+
+  std::wstring ResolveLocation(const std::wstring& location);
+
+  std::wstring GetCachedIcon(const std::wstring& path, int index, const FILETIME& lastWriteTime);
+
+public:
+  /// <summary>
+  /// Initializes an <see cref="IconResolver"/>.
+  /// </summary>
+  /// <param name="log">A <see cref="Log"/>.</param>
+  /// <param name="cacheDirectory">The directory for extracted icons, or an
+  /// empty string to not extract them.</param>
+  IconResolver(Log& log, std::wstring cacheDirectory) : log(log), cacheDirectory(std::move(cacheDirectory)) {}
+
+  /// <summary>
+  /// Resolves an icon location.
+  /// </summary>
+  /// <param name="location">The icon location from the configuration file,
+  /// with environment variables expanded.</param>
+  /// <returns>The location to give Explorer, or an empty string if the icon
+  /// is missing or broken.</returns>
+  std::wstring Resolve(const std::wstring& location);
+
+  /// <summary>
+  /// Resolves the icons of an entry and its subcommands, in place.
+  /// </summary>
+  /// <param name="entry">The entry.</param>
+  void Resolve(ContextMenuEntry& entry);
+};
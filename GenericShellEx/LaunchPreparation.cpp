@@ -0,0 +1,112 @@
+#include <utility>
+
+#include "BackgroundWork.h"
+#include "CommandTemplate.h"
+#include "LaunchPreparation.h"
+
+namespace {
+  /// <summary>
+  /// Finds a program to warm, adding <c>.exe</c> if it has no extension.
+  /// </summary>
+  std::wstring FindProgram(const std::wstring& program) {
+    if (program.empty()) return L"";
+
+    wchar_t buffer[MAX_PATH];
+    DWORD length = SearchPathW(nullptr, program.c_str(), L".exe", MAX_PATH, buffer, nullptr);
+
+    return length && length < MAX_PATH ? std::wstring(buffer, length) : L"";
+  }
+
+  /// <summary>
+  /// Maps a program as an image and prefetches it, so that the file cache
+  /// holds it and any antivirus scan of the image has already happened
+  /// when the process is created.
+  /// </summary>
+  void WarmImage(const std::wstring& path) {
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE) return;
+
+    HANDLE section = CreateFileMappingW(file, nullptr, PAGE_READONLY | SEC_IMAGE, 0, 0, nullptr);
+
+    // The section keeps the file open
+    CloseHandle(file);
+
+    if (!section) return;
+
+    void* view = MapViewOfFile(section, FILE_MAP_READ, 0, 0, 0);
+
+    if (view) {
+      MEMORY_BASIC_INFORMATION information;
+
+      // An image view is made of one region per run of sections with the
+      // same protection
+      for (char* address = static_cast<char*>(view); VirtualQuery(address, &information, sizeof(information)) && information.AllocationBase == view; address += information.RegionSize) {
+        WIN32_MEMORY_RANGE_ENTRY range = { address, information.RegionSize };
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+      }
+
+      UnmapViewOfFile(view);
+    }
+
+    CloseHandle(section);
+  }
+}
+
+void LaunchPreparation::Start(std::shared_ptr<PreparedLaunch>& preparation, const SelectionFingerprint& fingerprint, const std::wstring& command) {
+  // Only this class puts preparations in a command's slot
+  auto* restarted = static_cast<LaunchPreparation*>(preparation.get());
+
+  if (!restarted || restarted->busy.load(std::memory_order_acquire)) {
+    preparation.reset();
+
+    // The work for the last selection keeps the old preparation alive
+    // until it finishes
+    auto created = std::make_shared<LaunchPreparation>();
+
+    restarted = created.get();
+    preparation = std::move(created);
+  }
+
+  restarted->fingerprint = fingerprint;
+  restarted->expiry = GetTickCount64() + Lifetime;
+  restarted->command.assign(command);
+  restarted->ready = false;
+  restarted->busy = true;
+  restarted->pending = restarted->shared_from_this();
+
+  if (!SubmitBackgroundWork(WorkPriority::Prefetch, Run, restarted)) {
+    restarted->pending.reset();
+    restarted->busy = false;
+    preparation.reset();
+  }
+}
+
+void LaunchPreparation::Run(void* context, bool cancelled) {
+  auto* preparation = static_cast<LaunchPreparation*>(context);
+
+  // A cancelled preparation is never ready, so Invoke launches without it
+  if (!cancelled) preparation->Prepare();
+
+  // Once it is no longer busy the command may restart it, so the reference
+  // is taken out first and released last
+  std::shared_ptr<LaunchPreparation> self = std::move(preparation->pending);
+
+  preparation->busy.store(false, std::memory_order_release);
+}
+
+void LaunchPreparation::Prepare() {
+  std::wstring path = FindProgram(GetCommandProgram(command));
+
+  if (!path.empty()) WarmImage(path);
+
+  ready = true;
+}
+
+bool LaunchPreparation::IsFor(const SelectionFingerprint& fingerprint) const {
+  return this->fingerprint == fingerprint && GetTickCount64() < expiry;
+}
+
+bool LaunchPreparation::IsReadyFor(const SelectionFingerprint& fingerprint) const {
+  return IsFor(fingerprint) && ready;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include "framework.h"
+#include "MenuCommand.h"
+#include "Selection.h"
+
+/// <summary>
+/// Work done in the background, between a command being shown and being
+/// invoked, so that invoking it only has to call <c>CreateProcessW</c>.
+/// </summary>
+/// <remarks>
+/// <para>A preparation finds the program a command runs and warms its image
+/// by mapping it, which also gets any antivirus scan done early. It is tied
+/// to one selection and only counts as used if the command is invoked for
+/// that selection within <see cref="Lifetime"/>.</para>
+/// <para>The path found is only a guess at the program
+/// <c>CreateProcessW</c> will start, since <c>SearchPathW</c> searches in a
+/// different order and does not know that a batch file runs
+/// <c>cmd.exe</c>, so <c>CreateProcessW</c> is never given it and still
+/// finds the program itself. A wrong guess only warms the wrong file. The
+/// environment is inherited as it always was, since copying it would only
+/// repeat what <c>CreateProcessW</c> does.</para>
+/// <para>The command line and working directory are not prepared, since
+/// they depend on every selected path, which <c>Invoke</c> reads anyway,
+/// and reading shell items from another thread would only marshal the
+/// calls back to Explorer's.</para>
+/// <para>A command restarts its preparation in place once the work for the
+/// last selection has finished, so showing a menu again allocates
+/// nothing.</para>
+/// </remarks>
+class LaunchPreparation : public PreparedLaunch, public std::enable_shared_from_this<LaunchPreparation> {
+public:
+  /// <summary>
+  /// How long, in milliseconds, a preparation remains usable.
+  /// </summary>
+  static constexpr ULONGLONG Lifetime = 30000;
+
+private:
+  SelectionFingerprint fingerprint;
+  ULONGLONG expiry = 0;
+
+  /// <summary>
+  /// The command, copied, since the snapshot it came from may be released
+  /// before the work runs. Keeps its capacity when restarted.
+  /// </summary>
+  std::wstring command;
+
+  /// <summary>
+  /// Whether the background work has finished.
+  /// </summary>
+  std::atomic<bool> ready = false;
+
+  /// <summary>
+  /// Whether background work is queued or running, during which nothing
+  /// but <see cref="ready"/> may change.
+  /// </summary>
+  std::atomic<bool> busy = false;
+
+  /// <summary>
+  /// Keeps the preparation alive for the background work, which is given
+  /// the preparation itself as its context. The DLL is not unloaded while
+  /// the work runs, since unloading waits for background work to stop.
+  /// </summary>
+  std::shared_ptr<LaunchPreparation> pending;
+
+  static void Run(void* context, bool cancelled);
+
+  void Prepare();
+
+public:
+  /// <summary>
+  /// Initializes a <see cref="LaunchPreparation"/>. Use <see cref="Start"/>
+  /// instead.
+  /// </summary>
+  LaunchPreparation() = default;
+
+  /// <summary>
+  /// Starts preparing to launch a command, as <see
+  /// cref="WorkPriority::Prefetch"/> background work.
+  /// </summary>
+  /// <param name="preparation">The command's last preparation, which is
+  /// restarted if its work has finished, or replaced otherwise. Receives
+  /// <c>nullptr</c> if the preparation could not be started.</param>
+  /// <param name="fingerprint">The fingerprint of the selection the command
+  /// was shown for.</param>
+  /// <param name="command">The command.</param>
+  static void Start(std::shared_ptr<PreparedLaunch>& preparation, const SelectionFingerprint& fingerprint, const std::wstring& command);
+
+  /// <summary>
+  /// Determines whether this preparation was started for a selection and
+  /// has not expired, whether or not it has finished.
+  /// </summary>
+  bool IsFor(const SelectionFingerprint& fingerprint) const override;
+
+  /// <summary>
+  /// Determines whether the launch was prepared in time to be used: whether
+  /// it has finished, is for <paramref name="fingerprint"/>, and has not
+  /// expired. Never waits.
+  /// </summary>
+  /// <param name="fingerprint">The fingerprint of the selection being
+  /// invoked.</param>
+  /// <returns><c>true</c> if the launch was prepared or <c>false</c>
+  /// otherwise.</returns>
+  bool IsReadyFor(const SelectionFingerprint& fingerprint) const override;
+};
@@ -0,0 +1,47 @@
+#include "MappedFile.h"
+
+MappedFile::~MappedFile() {
+  if (view) UnmapViewOfFile(view);
+  if (mapping) CloseHandle(mapping);
+  if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+}
+
+HRESULT MappedFile::Open(const std::wstring& path) {
+  file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+  if (file == INVALID_HANDLE_VALUE) return HRESULT_FROM_WIN32(GetLastError());
+
+  BY_HANDLE_FILE_INFORMATION information;
+
+  if (!GetFileInformationByHandle(file, &information)) return HRESULT_FROM_WIN32(GetLastError());
+
+  ULONGLONG fileSize = (static_cast<ULONGLONG>(information.nFileSizeHigh) << 32) | information.nFileSizeLow;
+
+  if (!fileSize) return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+  if (fileSize > SIZE_MAX) return HRESULT_FROM_WIN32(ERROR_FILE_TOO_LARGE);
+
+  // Mapping exactly the size just read means a file that has since shrunk
+  // fails here rather than being read past its end
+  mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, information.nFileSizeHigh, information.nFileSizeLow, nullptr);
+
+  if (!mapping) return HRESULT_FROM_WIN32(GetLastError());
+
+  view = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, static_cast<SIZE_T>(fileSize)));
+
+  if (!view) return HRESULT_FROM_WIN32(GetLastError());
+
+  size = static_cast<size_t>(fileSize);
+  lastWriteTime = information.ftLastWriteTime;
+
+  return S_OK;
+}
+
+bool MappedFile::HasChanged() const {
+  BY_HANDLE_FILE_INFORMATION information;
+
+  if (!GetFileInformationByHandle(file, &information)) return true;
+
+  ULONGLONG fileSize = (static_cast<ULONGLONG>(information.nFileSizeHigh) << 32) | information.nFileSizeLow;
+
+  return fileSize != size || CompareFileTime(&information.ftLastWriteTime, &lastWriteTime);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include "framework.h"
+
+/// <summary>
+/// A file mapped read-only into memory.
+/// </summary>
+/// <remarks>
+/// The file is opened for sequential reading and shared with writers and
+/// deleters, so an editor saving the file is never refused. A mapped file
+/// cannot be truncated, though, so a <see cref="MappedFile"/> should be
+/// closed as soon as its contents have been read.
+/// </remarks>
+class MappedFile {
+  HANDLE file = INVALID_HANDLE_VALUE;
+  HANDLE mapping = nullptr;
+  const char* view = nullptr;
+
+  size_t size = 0;
+  FILETIME lastWriteTime = {};
+
+public:
+  MappedFile() = default;
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ~MappedFile();
+
+  /// <summary>
+  /// Opens and maps a file.
+  /// </summary>
+  /// <param name="path">The file path.</param>
+  /// <returns>If this function succeeds, it returns <c>S_OK</c>. An empty
+  /// file, which may be one an editor has truncated but not yet written,
+  /// returns <c>HRESULT_FROM_WIN32(ERROR_HANDLE_EOF)</c>. Otherwise, it
+  /// returns an <c>HRESULT</c> error code.</returns>
+  HRESULT Open(const std::wstring& path);
+
+  /// <summary>
+  /// Gets the file's contents.
+  /// </summary>
+  std::string_view Text() const { return std::string_view(view, size); }
+
+  /// <summary>
+  /// Gets the file's size when it was opened.
+  /// </summary>
+  ULONGLONG Size() const { return size; }
+
+  /// <summary>
+  /// Gets the file's last write time when it was opened.
+  /// </summary>
+  const FILETIME& LastWriteTime() const { return lastWriteTime; }
+
+  /// <summary>
+  /// Determines whether the file has been written since it was opened, in
+  /// which case its contents may be torn.
+  /// </summary>
+  /// <returns><c>true</c> if the file has changed or its state could not be
+  /// read, or <c>false</c> otherwise.</returns>
+  bool HasChanged() const;
+};
@@ -0,0 +1,116 @@
+#include "MarkerCache.h"
+#include "MarkerFinder.h"
+#include "ShellSelection.h"
+#include "VolumeProbe.h"
+
+namespace {
+  /// <summary>
+  /// Probes and watches directories with Win32.
+  /// </summary>
+  class Win32MarkerProbe : public MarkerProbe {
+  public:
+    bool Exists(const std::wstring& path) override {
+      return GetFileAttributesW(path.c_str()) != INVALID_FILE_ATTRIBUTES;
+    }
+
+    uintptr_t Watch(const std::wstring& directory) override {
+      // A change notification on a network share holds a request open on
+      // the server, which is not cheap
+      if (ClassifyVolume(directory) != VolumeKind::Local) return 0;
+
+      HANDLE notification = FindFirstChangeNotificationW(directory.c_str(), FALSE, FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME);
+
+      return notification == INVALID_HANDLE_VALUE ? 0 : reinterpret_cast<uintptr_t>(notification);
+    }
+
+    bool HasChanged(uintptr_t watch) override {
+      HANDLE notification = reinterpret_cast<HANDLE>(watch);
+
+      if (WaitForSingleObject(notification, 0) != WAIT_OBJECT_0) return false;
+
+      FindNextChangeNotification(notification);
+
+      return true;
+    }
+
+    void Unwatch(uintptr_t watch) override {
+      FindCloseChangeNotification(reinterpret_cast<HANDLE>(watch));
+    }
+  };
+
+  // The probe must outlive the cache, which unwatches through it
+  Win32MarkerProbe markerProbe;
+  MarkerCache markerCache(markerProbe, MarkerCacheCapacity, MarkerPresentLifetime, MarkerAbsentLifetime);
+}
+
+void FindSelectionMarkers(Selection& selection, const DirectoryMarkers& markers, std::chrono::steady_clock::time_point deadline, std::chrono::milliseconds volumeTimeout) {
+  if (markers.IsEmpty()) return;
+
+  std::wstring_view previous;
+  uint64_t previousMask = 0;
+  bool late = false;
+
+  for (size_t i = 0; i < selection.Inspected(); ++i) {
+    std::wstring_view directory = GetMarkerDirectory(selection.Item(i));
+
+    if (directory.empty()) continue;
+
+    // Selected items usually share a directory
+    if (directory == previous) {
+      selection.SetMarkers(i, previousMask);
+
+      continue;
+    }
+
+    uint64_t mask = DirectoryMarkers::Unknown;
+
+    if (late || std::chrono::steady_clock::now() >= deadline) {
+      late = true;
+    } else if (IsVolumeResponsive(directory, volumeTimeout)) {
+      mask = markerCache.FindInAncestors(directory, markers);
+    }
+
+    selection.SetMarkers(i, mask);
+    previous = directory;
+    previousMask = mask;
+  }
+}
+
+std::wstring FindSelectionRoot(const Selection& selection, const DirectoryMarkers& markers, uint64_t mask, std::chrono::milliseconds volumeTimeout) {
+  for (size_t i = 0; i < selection.Inspected(); ++i) {
+    SelectionItem item = selection.Item(i);
+
+    if (!item.length) continue;
+
+    bool responsive = IsVolumeResponsive(std::wstring_view(item.path, item.length), volumeTimeout);
+
+    // An item read with its path alone is only known to be a directory once
+    // its volume has been found to respond
+    if (responsive && !(item.attributes & ItemAttributeFileSystem)) {
+      DWORD fileAttributes = GetFileAttributesW(std::wstring(item.path, item.length).c_str());
+
+      if (fileAttributes != INVALID_FILE_ATTRIBUTES && (fileAttributes & FILE_ATTRIBUTE_DIRECTORY)) item.attributes |= ItemAttributeDirectory;
+      if (fileAttributes != INVALID_FILE_ATTRIBUTES && (fileAttributes & RemoteFileAttributes)) item.attributes |= ItemAttributeRemote;
+    }
+
+    std::wstring_view directory = GetMarkerDirectory(item);
+
+    if (directory.empty()) continue;
+
+    size_t length = 0;
+
+    if (mask && responsive) length = markerCache.FindNearest(directory, markers, mask);
+
+    return std::wstring(directory.substr(0, length ? length : directory.size()));
+  }
+
+  return L"";
+}
+
+uint64_t MarkerCacheHits() {
+  return markerCache.Hits();
+}
+
+uint64_t MarkerCacheMisses() {
+  return markerCache.Misses();
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "framework.h"
+#include "DirectoryMarkers.h"
+#include "Selection.h"
+
+/// <summary>
+/// The number of directories whose markers are remembered.
+/// </summary>
+constexpr size_t MarkerCacheCapacity = 1024;
+
+/// <summary>
+/// How long a directory that contains markers is remembered without
+/// probing it again, unless it is watched and changes.
+/// </summary>
+constexpr std::chrono::milliseconds MarkerPresentLifetime{ 60000 };
+
+/// <summary>
+/// How long a directory without markers is remembered, which is shorter so
+/// that a project just created on a volume that cannot be watched is
+/// noticed soon.
+/// </summary>
+constexpr std::chrono::milliseconds MarkerAbsentLifetime{ 10000 };
+
+/// <summary>
+/// Looks for <see cref="DirectoryMarkers"/> in the directory of each
+/// inspected item in a selection and in its ancestors, recording the masks
+/// in the selection.
+/// </summary>
+/// <remarks>
+/// <para>Directories are looked up in a <see cref="MarkerCache"/>. Those on
+/// local volumes are watched with change notifications while they are
+/// cached, so creating or deleting a marker takes effect on the next menu.
+/// Items that share a directory with the item before them are not looked up
+/// again.</para>
+/// <para>Items on a volume that does not respond within <paramref
+/// name="volumeTimeout"/>, and every item once <paramref name="deadline"/>
+/// has passed, are marked <see cref="DirectoryMarkers::Unknown"/>.</para>
+/// </remarks>
+/// <param name="selection">The selection, read with paths.</param>
+/// <param name="markers">The markers.</param>
+/// <param name="deadline">The time by which looking must stop.</param>
+/// <param name="volumeTimeout">How long to wait for a network or removable
+/// volume to respond.</param>
+void FindSelectionMarkers(Selection& selection, const DirectoryMarkers& markers, std::chrono::steady_clock::time_point deadline, std::chrono::milliseconds volumeTimeout);
+
+/// <summary>
+/// Finds the project directory of the first item with a path, which is the
+/// nearest of its directory and that directory's ancestors that contains
+/// one of a set of markers.
+/// </summary>
+/// <remarks>
+/// A selection read by <c>ReadShellSelectionPaths</c> has no attributes, so
+/// whether the first item is a directory is asked of the file system, once
+/// its volume has responded within <paramref name="volumeTimeout"/>.
+/// </remarks>
+/// <param name="selection">The selection, read with paths.</param>
+/// <param name="markers">The markers.</param>
+/// <param name="mask">The mask of the markers to look for.</param>
+/// <param name="volumeTimeout">How long to wait for a network or removable
+/// volume to respond.</param>
+/// <returns>The project directory, the directory looking started from if
+/// there is no project or <paramref name="mask"/> is zero, or an empty
+/// string if no item has a path.</returns>
+std::wstring FindSelectionRoot(const Selection& selection, const DirectoryMarkers& markers, uint64_t mask, std::chrono::milliseconds volumeTimeout);
+
+/// <summary>
+/// The number of directory lookups answered without probing.
+/// </summary>
+uint64_t MarkerCacheHits();
+
+/// <summary>
+/// The number of directory lookups that probed the file system.
+/// </summary>
+uint64_t MarkerCacheMisses();
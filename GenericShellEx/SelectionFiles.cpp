@@ -0,0 +1,40 @@
+#include <string>
+
+#include "SelectionFiles.h"
+#include "VolumeProbe.h"
+
+void ReadSelectionFiles(const Selection& selection, std::chrono::milliseconds volumeTimeout, std::vector<SelectionFileInfo>& files) {
+  files.assign(selection.Inspected(), SelectionFileInfo());
+
+  std::wstring path;
+
+  for (size_t i = 0; i < selection.Inspected(); ++i) {
+    SelectionItem item = selection.Item(i);
+
+    if (!item.length || (item.attributes & ItemAttributeRemote)) continue;
+
+    // The answer is remembered per volume, so only the first item on a
+    // volume can wait
+    if (!IsVolumeResponsive(std::wstring_view(item.path, item.length), volumeTimeout)) continue;
+
+    path.assign(item.path, item.length);
+
+    // Directories can only be opened with backup semantics
+    HANDLE file = CreateFileW(path.c_str(), FILE_READ_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OPEN_NO_RECALL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE) continue;
+
+    BY_HANDLE_FILE_INFORMATION information;
+
+    if (GetFileInformationByHandle(file, &information)) {
+      SelectionFileInfo& info = files[i];
+
+      info.volume = information.dwVolumeSerialNumber;
+      info.fileId = static_cast<uint64_t>(information.nFileIndexHigh) << 32 | information.nFileIndexLow;
+      info.lastWriteTime = static_cast<uint64_t>(information.ftLastWriteTime.dwHighDateTime) << 32 | information.ftLastWriteTime.dwLowDateTime;
+      info.known = true;
+    }
+
+    CloseHandle(file);
+  }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+#include "framework.h"
+#include "Selection.h"
+#include "SelectionOrder.h"
+
+/// <summary>
+/// Reads the volume serial number, file ID and last write time of each
+/// inspected item in a selection, for <see cref="ArrangeSelection"/>.
+/// </summary>
+/// <remarks>
+/// Items are opened for their attributes only, which neither reads them
+/// nor gets them scanned. Remote items and items on a volume that does not
+/// respond within <paramref name="volumeTimeout"/> are left unknown.
+/// </remarks>
+/// <param name="selection">The selection, read with paths.</param>
+/// <param name="volumeTimeout">How long to wait for a network or removable
+/// volume to respond.</param>
+/// <param name="files">Receives one entry per inspected item.</param>
+void ReadSelectionFiles(const Selection& selection, std::chrono::milliseconds volumeTimeout, std::vector<SelectionFileInfo>& files);
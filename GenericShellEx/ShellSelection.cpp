@@ -0,0 +1,649 @@
+#include <atlcomcli.h>
+#include <ShlObj_core.h>
+#include <propkey.h>
+#include <cstring>
+
+#include "ShellSelection.h"
+#include "VolumeProbe.h"
+
+namespace {
+  constexpr SFGAOF AttributeMask = SFGAO_FOLDER | SFGAO_STREAM | SFGAO_READONLY | SFGAO_HIDDEN | SFGAO_SYSTEM | SFGAO_LINK | SFGAO_COMPRESSED | SFGAO_ENCRYPTED | SFGAO_ISSLOW | SFGAO_FILESYSTEM;
+
+  /// <summary>
+  /// The number of items fetched at a time when enumerating an array.
+  /// </summary>
+  constexpr ULONG EnumerationChunk = 64;
+
+  /// <summary>
+  /// The size of the stack buffer absolute ID lists are built in. Longer ones
+  /// are allocated.
+  /// </summary>
+  constexpr size_t IdListBufferSize = 1024;
+
+  /// <summary>
+  /// Maps <c>SFGAO</c> flags and file attributes to <see
+  /// cref="SelectionItemAttributes"/>.
+  /// </summary>
+  uint32_t MapAttributes(SFGAOF sfgao, DWORD fileAttributes) {
+    uint32_t attributes = ItemAttributeNone;
+
+    // Archives such as .zip files are folders to the shell, but they are
+    // also streams
+    if ((sfgao & SFGAO_FOLDER) && !(sfgao & SFGAO_STREAM)) attributes |= ItemAttributeDirectory;
+    if (sfgao & SFGAO_READONLY) attributes |= ItemAttributeReadOnly;
+    if (sfgao & SFGAO_HIDDEN) attributes |= ItemAttributeHidden;
+    if (sfgao & SFGAO_SYSTEM) attributes |= ItemAttributeSystem;
+    if (sfgao & SFGAO_LINK) attributes |= ItemAttributeLink;
+    if (sfgao & SFGAO_COMPRESSED) attributes |= ItemAttributeCompressed;
+    if (sfgao & SFGAO_ENCRYPTED) attributes |= ItemAttributeEncrypted;
+    if (sfgao & SFGAO_ISSLOW) attributes |= ItemAttributeSlow;
+    if (sfgao & SFGAO_FILESYSTEM) attributes |= ItemAttributeFileSystem;
+    if (fileAttributes != INVALID_FILE_ATTRIBUTES && (fileAttributes & RemoteFileAttributes)) attributes |= ItemAttributeRemote;
+
+    return attributes;
+  }
+
+  /// <summary>
+  /// Reads a file's attributes from its directory entry, for items whose ID
+  /// list carries none. Unlike opening the file, this never recalls it.
+  /// </summary>
+  /// <returns>The attributes, or <c>INVALID_FILE_ATTRIBUTES</c>.</returns>
+  DWORD FindFileAttributes(const wchar_t* path, SFGAOF sfgao) {
+    // Not worth a round trip for items on slow volumes
+    if (!*path || !(sfgao & SFGAO_FILESYSTEM) || (sfgao & SFGAO_ISSLOW)) return INVALID_FILE_ATTRIBUTES;
+
+    WIN32_FIND_DATAW findData;
+    HANDLE hFind = FindFirstFileExW(path, FindExInfoBasic, &findData, FindExSearchNameMatch, nullptr, 0);
+
+    if (hFind == INVALID_HANDLE_VALUE) return INVALID_FILE_ATTRIBUTES;
+
+    FindClose(hFind);
+
+    return findData.dwFileAttributes;
+  }
+
+  /// <summary>
+  /// What to read and when to stop.
+  /// </summary>
+  struct ReadRequest {
+    bool readPaths;
+    size_t limit;
+    std::chrono::steady_clock::time_point deadline;
+    std::chrono::milliseconds volumeTimeout;
+
+    bool IsOver(size_t read) const {
+      return read >= limit || std::chrono::steady_clock::now() > deadline;
+    }
+
+    /// <summary>
+    /// Whether items at <paramref name="path"/> can be inspected without
+    /// risking a long block.
+    /// </summary>
+    bool CanInspect(const wchar_t* path) const {
+      return IsVolumeResponsive(path, volumeTimeout);
+    }
+  };
+
+  /// <summary>
+  /// Adds an item to <paramref name="selection"/> given its absolute ID list.
+  /// </summary>
+  /// <param name="path">The path already copied out of the ID list, or
+  /// empty if it could not be. Only items that aren't plain file system
+  /// paths, or whose paths are too long, go through a shell item.</param>
+  void AddIdList(PCIDLIST_ABSOLUTE pidl, const wchar_t* path, SFGAOF sfgao, DWORD fileAttributes, bool readPaths, Selection& selection) {
+    LPWSTR pszPath = nullptr;
+
+    if (readPaths && !*path) {
+      CComPtr<IShellItem> pItem;
+
+      if (SUCCEEDED(SHCreateItemFromIDList(pidl, IID_PPV_ARGS(&pItem))) && SUCCEEDED(pItem->GetDisplayName(SIGDN_FILESYSPATH, &pszPath))) {
+        path = pszPath;
+      }
+    }
+
+    if (fileAttributes == INVALID_FILE_ATTRIBUTES) fileAttributes = FindFileAttributes(path, sfgao);
+
+    if (!readPaths) path = L"";
+
+    selection.Add(path, wcslen(path), MapAttributes(sfgao, fileAttributes));
+    CoTaskMemFree(pszPath);
+  }
+
+  /// <summary>
+  /// Gets the attributes of an item in a data object's ID list.
+  /// </summary>
+  /// <remarks>
+  /// File attributes come from the find data stored in the item's ID list,
+  /// so the file is not touched.
+  /// </remarks>
+  /// <param name="pFolder">The folder the ID list's items are relative
+  /// to.</param>
+  /// <param name="child">The item, relative to <paramref
+  /// name="pFolder"/>.</param>
+  /// <param name="absolute">The item's absolute ID list, used when <paramref
+  /// name="child"/> is more than one level deep.</param>
+  /// <param name="sfgao">Receives the item's <c>SFGAO</c> flags.</param>
+  /// <param name="fileAttributes">Receives the item's file attributes, or
+  /// <c>INVALID_FILE_ATTRIBUTES</c>.</param>
+  void GetIdListAttributes(IShellFolder* pFolder, PCUIDLIST_RELATIVE child, PCIDLIST_ABSOLUTE absolute, SFGAOF& sfgao, DWORD& fileAttributes) {
+    PCUITEMID_CHILD last = nullptr;
+    CComPtr<IShellFolder> pParent;
+
+    sfgao = 0;
+    fileAttributes = INVALID_FILE_ATTRIBUTES;
+
+    if (ILIsChild(child)) {
+      last = static_cast<PCUITEMID_CHILD>(child);
+    } else if (FAILED(SHBindToParent(absolute, IID_PPV_ARGS(&pParent), &last))) {
+      return;
+    } else {
+      pFolder = pParent;
+    }
+
+    sfgao = AttributeMask;
+
+    // S_FALSE just means not every requested attribute is set
+    if (FAILED(pFolder->GetAttributesOf(1, &last, &sfgao))) sfgao = 0;
+
+    WIN32_FIND_DATAW findData;
+
+    if (SUCCEEDED(SHGetDataFromIDListW(pFolder, last, SHGDFIL_FINDDATA, &findData, sizeof(findData)))) {
+      fileAttributes = findData.dwFileAttributes;
+    }
+  }
+
+  /// <summary>
+  /// Whether the folder an ID list's items are relative to can be bound
+  /// without risking a long block.
+  /// </summary>
+  bool CanInspectParent(PCIDLIST_ABSOLUTE parent, const ReadRequest& request) {
+    wchar_t path[MAX_PATH];
+
+    // Folders that are not on a volume, such as the desktop, are fine
+    return !SHGetPathFromIDListEx(parent, path, ARRAYSIZE(path), GPFIDL_DEFAULT) || request.CanInspect(path);
+  }
+
+  /// <summary>
+  /// Gets the ID list of a shell item array's data object, which holds every
+  /// item's ID list in one block.
+  /// </summary>
+  /// <param name="medium">Receives the ID list, which the caller
+  /// releases.</param>
+  HRESULT GetIdListData(IShellItemArray* psiArray, STGMEDIUM& medium) {
+    static const CLIPFORMAT shellIdListFormat = static_cast<CLIPFORMAT>(RegisterClipboardFormatW(CFSTR_SHELLIDLIST));
+
+    CComPtr<IDataObject> pDataObject;
+
+    HRESULT hr = psiArray->BindToHandler(nullptr, BHID_DataObject, IID_PPV_ARGS(&pDataObject));
+
+    if (FAILED(hr)) return hr;
+
+    FORMATETC format = { shellIdListFormat, nullptr, DVASPECT_CONTENT, -1, TYMED_HGLOBAL };
+    medium = {};
+
+    return pDataObject->GetData(&format, &medium);
+  }
+
+  /// <summary>
+  /// Combines a folder's ID list with those of its children, in a stack
+  /// buffer where they fit.
+  /// </summary>
+  class IdListCombiner {
+    alignas(8) BYTE buffer[IdListBufferSize];
+    PCIDLIST_ABSOLUTE parent;
+    UINT parentSize;
+    bool buffered;
+    PIDLIST_ABSOLUTE combined = nullptr;
+
+  public:
+    explicit IdListCombiner(PCIDLIST_ABSOLUTE parent) : parent(parent) {
+      // Without its terminator
+      parentSize = ILGetSize(parent) - sizeof(USHORT);
+
+      // A parent too long for the buffer, such as a deep folder in a
+      // namespace with large IDs, is combined with each child on the heap
+      buffered = parentSize <= sizeof(buffer);
+
+      if (buffered) memcpy(buffer, parent, parentSize);
+    }
+
+    IdListCombiner(const IdListCombiner&) = delete;
+    IdListCombiner& operator=(const IdListCombiner&) = delete;
+
+    ~IdListCombiner() {
+      ILFree(combined);
+    }
+
+    /// <summary>
+    /// Gets a child's absolute ID list, which is valid until the next call.
+    /// </summary>
+    /// <returns>The ID list, or <c>nullptr</c> if it could not be
+    /// allocated.</returns>
+    PCIDLIST_ABSOLUTE Combine(PCUIDLIST_RELATIVE child) {
+      ILFree(combined);
+      combined = nullptr;
+
+      UINT childSize = ILGetSize(child);
+
+      if (buffered && childSize <= sizeof(buffer) - parentSize) {
+        memcpy(buffer + parentSize, child, childSize);
+
+        return reinterpret_cast<PCIDLIST_ABSOLUTE>(buffer);
+      }
+
+      return combined = ILCombine(parent, child);
+    }
+  };
+
+  /// <summary>
+  /// Reads a shell item array through the ID list of its data object, which
+  /// holds every item's ID list in one block, without creating a shell item
+  /// per item.
+  /// </summary>
+  /// <returns>If the array has no usable ID list, an <c>HRESULT</c> error
+  /// code, and <paramref name="selection"/> is left untouched.</returns>
+  HRESULT ReadIdList(IShellItemArray* psiArray, DWORD count, Selection& selection, const ReadRequest& request) {
+    STGMEDIUM medium;
+
+    HRESULT hr = GetIdListData(psiArray, medium);
+
+    if (FAILED(hr)) return hr;
+
+    const CIDA* pida = static_cast<const CIDA*>(GlobalLock(medium.hGlobal));
+    PCIDLIST_ABSOLUTE parent = pida ? HIDA_GetPIDLFolder(pida) : nullptr;
+    CComPtr<IShellFolder> pFolder;
+
+    if (!pida || pida->cidl != count) {
+      hr = E_UNEXPECTED;
+    } else if (!CanInspectParent(parent, request)) {
+      // Binding the folder would block on its volume
+      selection.Reset(count);
+      selection.Truncate();
+      hr = S_FALSE;
+    } else if (ILIsEmpty(parent)) {
+      hr = SHGetDesktopFolder(&pFolder);
+    } else {
+      hr = SHBindToObject(nullptr, parent, nullptr, IID_PPV_ARGS(&pFolder));
+    }
+
+    if (hr == S_OK) {
+      IdListCombiner combiner(parent);
+
+      selection.Reset(count);
+
+      for (DWORD i = 0; i < count; ++i) {
+        if (request.IsOver(i)) {
+          selection.Truncate();
+
+          break;
+        }
+
+        PCUIDLIST_RELATIVE child = HIDA_GetPIDLItem(pida, i);
+        PCIDLIST_ABSOLUTE absolute = combiner.Combine(child);
+        wchar_t path[MAX_PATH] = L"";
+
+        // Copied straight out of the ID list, without touching the volume
+        if (absolute && !SHGetPathFromIDListEx(absolute, path, ARRAYSIZE(path), GPFIDL_DEFAULT)) path[0] = L'\0';
+
+        bool inspect = request.CanInspect(path);
+
+        if (!absolute) {
+          selection.Add(L"", 0, ItemAttributeNone);
+        } else if (inspect) {
+          SFGAOF sfgao;
+          DWORD fileAttributes;
+
+          GetIdListAttributes(pFolder, child, absolute, sfgao, fileAttributes);
+          AddIdList(absolute, path, sfgao, fileAttributes, request.readPaths, selection);
+        }
+
+        if (!inspect) {
+          selection.Truncate();
+
+          break;
+        }
+      }
+    }
+
+    if (pida) GlobalUnlock(medium.hGlobal);
+
+    ReleaseStgMedium(&medium);
+
+    return hr;
+  }
+
+  /// <summary>
+  /// Adds a shell item to <paramref name="selection"/>.
+  /// </summary>
+  /// <param name="path">The item's path, or empty.</param>
+  void AddShellItem(IShellItem* pItem, const wchar_t* path, Selection& selection) {
+    SFGAOF sfgao = 0;
+
+    // S_FALSE just means not every requested attribute is set
+    if (FAILED(pItem->GetAttributes(AttributeMask, &sfgao))) sfgao = 0;
+
+    // Served from the item's ID list rather than the file
+    CComQIPtr<IShellItem2> pItem2(pItem);
+    DWORD fileAttributes = INVALID_FILE_ATTRIBUTES;
+
+    if (!pItem2 || FAILED(pItem2->GetUInt32(PKEY_FileAttributes, &fileAttributes))) fileAttributes = INVALID_FILE_ATTRIBUTES;
+    if (fileAttributes == INVALID_FILE_ATTRIBUTES) fileAttributes = FindFileAttributes(path, sfgao);
+
+    selection.Add(path, wcslen(path), MapAttributes(sfgao, fileAttributes));
+  }
+
+  /// <summary>
+  /// Reads a shell item array by enumerating its items a chunk at a time.
+  /// </summary>
+  HRESULT EnumerateShellItems(IShellItemArray* psiArray, DWORD count, Selection& selection, const ReadRequest& request) {
+    CComPtr<IEnumShellItems> pEnum;
+
+    HRESULT hr = psiArray->EnumItems(&pEnum);
+
+    if (FAILED(hr)) return hr;
+
+    selection.Reset(count);
+
+    IShellItem* chunk[EnumerationChunk];
+    size_t read = 0;
+    bool stopped = false;
+
+    while (!stopped) {
+      ULONG fetched = 0;
+
+      hr = pEnum->Next(EnumerationChunk, chunk, &fetched);
+
+      if (FAILED(hr)) return hr;
+
+      for (ULONG i = 0; i < fetched; ++i) {
+        if (!stopped && request.IsOver(read)) {
+          selection.Truncate();
+          stopped = true;
+        }
+
+        LPWSTR pszPath = nullptr;
+
+        // The path comes from the item's ID list, so it is read before
+        // anything that might touch the volume
+        if (!stopped && FAILED(chunk[i]->GetDisplayName(SIGDN_FILESYSPATH, &pszPath))) pszPath = nullptr;
+
+        if (!stopped && !request.CanInspect(pszPath ? pszPath : L"")) {
+          selection.Truncate();
+          stopped = true;
+        }
+
+        if (!stopped) {
+          AddShellItem(chunk[i], pszPath && request.readPaths ? pszPath : L"", selection);
+          ++read;
+        }
+
+        CoTaskMemFree(pszPath);
+        chunk[i]->Release();
+      }
+
+      if (hr == S_FALSE || !fetched) break;
+    }
+
+    return S_OK;
+  }
+
+  /// <summary>
+  /// Adds an item to <paramref name="selection"/> with its path alone.
+  /// </summary>
+  /// <param name="pidl">The item's absolute ID list, or <c>nullptr</c> if it
+  /// could not be built.</param>
+  void AddIdListPath(PCIDLIST_ABSOLUTE pidl, Selection& selection) {
+    wchar_t path[MAX_PATH] = L"";
+    LPWSTR pszPath = nullptr;
+
+    // Copied straight out of the ID list. Only items that aren't plain file
+    // system paths, or whose paths are too long, go through a shell item
+    if (pidl && !SHGetPathFromIDListEx(pidl, path, ARRAYSIZE(path), GPFIDL_DEFAULT)) {
+      CComPtr<IShellItem> pItem;
+
+      path[0] = L'\0';
+
+      if (SUCCEEDED(SHCreateItemFromIDList(pidl, IID_PPV_ARGS(&pItem))) && FAILED(pItem->GetDisplayName(SIGDN_FILESYSPATH, &pszPath))) pszPath = nullptr;
+    }
+
+    const wchar_t* itemPath = pszPath ? pszPath : path;
+
+    selection.Add(itemPath, wcslen(itemPath), ItemAttributeNone);
+    CoTaskMemFree(pszPath);
+  }
+
+  /// <summary>
+  /// Reads the paths of a shell item array's items through the ID list of
+  /// its data object, without binding the folder they are in.
+  /// </summary>
+  /// <returns>If the array has no usable ID list, an <c>HRESULT</c> error
+  /// code, and <paramref name="selection"/> is left untouched.</returns>
+  HRESULT ReadIdListPaths(IShellItemArray* psiArray, DWORD count, Selection& selection) {
+    STGMEDIUM medium;
+
+    HRESULT hr = GetIdListData(psiArray, medium);
+
+    if (FAILED(hr)) return hr;
+
+    const CIDA* pida = static_cast<const CIDA*>(GlobalLock(medium.hGlobal));
+
+    if (!pida || pida->cidl != count) {
+      hr = E_UNEXPECTED;
+    } else {
+      IdListCombiner combiner(HIDA_GetPIDLFolder(pida));
+
+      selection.Reset(count);
+
+      for (DWORD i = 0; i < count; ++i) {
+        AddIdListPath(combiner.Combine(HIDA_GetPIDLItem(pida, i)), selection);
+      }
+    }
+
+    if (pida) GlobalUnlock(medium.hGlobal);
+
+    ReleaseStgMedium(&medium);
+
+    return hr;
+  }
+
+  /// <summary>
+  /// Reads the paths of a shell item array's items by enumerating them a
+  /// chunk at a time.
+  /// </summary>
+  HRESULT EnumerateShellItemPaths(IShellItemArray* psiArray, DWORD count, Selection& selection) {
+    CComPtr<IEnumShellItems> pEnum;
+
+    HRESULT hr = psiArray->EnumItems(&pEnum);
+
+    if (FAILED(hr)) return hr;
+
+    selection.Reset(count);
+
+    IShellItem* chunk[EnumerationChunk];
+
+    for (;;) {
+      ULONG fetched = 0;
+
+      hr = pEnum->Next(EnumerationChunk, chunk, &fetched);
+
+      if (FAILED(hr)) return hr;
+
+      for (ULONG i = 0; i < fetched; ++i) {
+        LPWSTR pszPath = nullptr;
+
+        if (FAILED(chunk[i]->GetDisplayName(SIGDN_FILESYSPATH, &pszPath))) pszPath = nullptr;
+
+        selection.Add(pszPath ? pszPath : L"", pszPath ? wcslen(pszPath) : 0, ItemAttributeNone);
+        CoTaskMemFree(pszPath);
+        chunk[i]->Release();
+      }
+
+      if (hr == S_FALSE || !fetched) break;
+    }
+
+    return S_OK;
+  }
+
+  /// <summary>
+  /// Hashes the ID list of the item at <paramref name="index"/>.
+  /// </summary>
+  HRESULT HashShellItem(IShellItemArray* psiArray, DWORD index, uint64_t& hash) {
+    CComPtr<IShellItem> pItem;
+
+    HRESULT hr = psiArray->GetItemAt(index, &pItem);
+
+    if (FAILED(hr)) return hr;
+
+    PIDLIST_ABSOLUTE pidl = nullptr;
+
+    hr = SHGetIDListFromObject(pItem, &pidl);
+
+    if (FAILED(hr)) return hr;
+
+    hash = HashBytes(pidl, ILGetSize(pidl));
+    ILFree(pidl);
+
+    return S_OK;
+  }
+}
+
+HRESULT ReadShellSelection(IShellItemArray* psiArray, Selection& selection, bool readPaths, size_t limit, std::chrono::steady_clock::time_point deadline, std::chrono::milliseconds volumeTimeout) {
+  DWORD count = 0;
+
+  if (psiArray) {
+    HRESULT hr = psiArray->GetCount(&count);
+
+    if (FAILED(hr)) return hr;
+  }
+
+  if (!count) {
+    selection.Reset(0);
+
+    return S_OK;
+  }
+
+  ReadRequest request = { readPaths, limit, deadline, volumeTimeout };
+
+  if (SUCCEEDED(ReadIdList(psiArray, count, selection, request))) return S_OK;
+
+  return EnumerateShellItems(psiArray, count, selection, request);
+}
+
+HRESULT ReadShellSelectionPaths(IShellItemArray* psiArray, Selection& selection) {
+  DWORD count = 0;
+
+  if (psiArray) {
+    HRESULT hr = psiArray->GetCount(&count);
+
+    if (FAILED(hr)) return hr;
+  }
+
+  if (!count) {
+    selection.Reset(0);
+
+    return S_OK;
+  }
+
+  if (SUCCEEDED(ReadIdListPaths(psiArray, count, selection))) return S_OK;
+
+  return EnumerateShellItemPaths(psiArray, count, selection);
+}
+
+HRESULT GetShellSelectionFingerprint(IShellItemArray* psiArray, SelectionFingerprint& fingerprint) {
+  fingerprint = SelectionFingerprint();
+
+  if (!psiArray) return S_OK;
+
+  DWORD count = 0;
+
+  HRESULT hr = psiArray->GetCount(&count);
+
+  if (FAILED(hr) || !count) return hr;
+
+  fingerprint.count = count;
+
+  hr = HashShellItem(psiArray, 0, fingerprint.first);
+
+  if (FAILED(hr)) return hr;
+
+  if (count == 1) {
+    fingerprint.last = fingerprint.first;
+
+    return S_OK;
+  }
+
+  return HashShellItem(psiArray, count - 1, fingerprint.last);
+}
+
+ShellFingerprintCache::~ShellFingerprintCache() {
+  Clear();
+}
+
+HRESULT ShellFingerprintCache::Get(IShellItemArray* psiArray, SelectionFingerprint& fingerprint) {
+  if (!psiArray) return GetShellSelectionFingerprint(psiArray, fingerprint);
+
+  DWORD count = 0;
+
+  HRESULT hr = psiArray->GetCount(&count);
+
+  if (FAILED(hr)) return hr;
+
+  AcquireSRWLockShared(&lock);
+
+  bool hit = this->psiArray == psiArray && this->count == count;
+
+  if (hit) fingerprint = this->fingerprint;
+
+  ReleaseSRWLockShared(&lock);
+
+  if (hit) return S_OK;
+
+  hr = GetShellSelectionFingerprint(psiArray, fingerprint);
+
+  if (FAILED(hr)) return hr;
+
+  psiArray->AddRef();
+
+  AcquireSRWLockExclusive(&lock);
+
+  IShellItemArray* previous = this->psiArray;
+  this->psiArray = psiArray;
+  this->count = count;
+  this->fingerprint = fingerprint;
+
+  ReleaseSRWLockExclusive(&lock);
+
+  // Releasing the last reference may free the array, which is not done
+  // while holding the lock
+  if (previous) previous->Release();
+
+  return S_OK;
+}
+
+void ShellFingerprintCache::Clear() {
+  AcquireSRWLockExclusive(&lock);
+
+  IShellItemArray* previous = psiArray;
+  psiArray = nullptr;
+  count = 0;
+
+  ReleaseSRWLockExclusive(&lock);
+
+  if (previous) previous->Release();
+}
+
+bool ShellItemSelection::Fingerprint(SelectionFingerprint& fingerprint) {
+  return SUCCEEDED(fingerprints.Get(psiArray, fingerprint));
+}
+
+bool ShellItemSelection::Read(Selection& selection, bool readPaths, size_t limit, std::chrono::steady_clock::time_point deadline, std::chrono::milliseconds volumeTimeout) {
+  result = ReadShellSelection(psiArray, selection, readPaths, limit, deadline, volumeTimeout);
+
+  return SUCCEEDED(result);
+}
+
+bool ShellItemSelection::ReadPaths(Selection& selection) {
+  result = ReadShellSelectionPaths(psiArray, selection);
+
+  return SUCCEEDED(result);
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <ShObjIdl_core.h>
+#include <chrono>
+#include "framework.h"
+#include "MenuCommand.h"
+#include "Selection.h"
+
+/// <summary>
+/// File attributes of items that are not stored locally. Opening such an
+/// item recalls it, which for a cloud file means downloading it.
+/// </summary>
+constexpr DWORD RemoteFileAttributes = FILE_ATTRIBUTE_OFFLINE | FILE_ATTRIBUTE_RECALL_ON_OPEN | FILE_ATTRIBUTE_RECALL_ON_DATA_ACCESS;
+
+/// <summary>
+/// Reads a shell item array into a <see cref="Selection"/>.
+/// </summary>
+/// <remarks>
+/// <para>Items are read from the ID list of the array's data object in one
+/// go where possible, falling back to enumerating the array.</para>
+/// <para>Items are never opened, so cloud files that are not stored locally
+/// are not recalled. Their file attributes come from the ID list, and they
+/// are marked <see cref="ItemAttributeRemote"/>.</para>
+/// <para>Reading stops early, and the selection is marked truncated, once
+/// <paramref name="limit"/> items have been inspected, <paramref
+/// name="deadline"/> has passed, or an item is on a network or removable
+/// volume that does not respond within <paramref name="volumeTimeout"/>. A
+/// volume found to be slow is remembered, so later reads stop at once
+/// rather than wait again.</para>
+/// </remarks>
+/// <param name="psiArray">The shell items array. May be
+/// <c>nullptr</c>.</param>
+/// <param name="selection">The selection to fill.</param>
+/// <param name="readPaths">Whether item paths are needed, as opposed to only
+/// attributes.</param>
+/// <param name="limit">The largest number of items to inspect.</param>
+/// <param name="deadline">The time by which reading must stop.</param>
+/// <param name="volumeTimeout">How long to wait for a volume to
+/// respond.</param>
+/// <returns>If this function succeeds, it returns <c>S_OK</c>. Otherwise, it
+/// returns an <c>HRESULT</c> error code.</returns>
+HRESULT ReadShellSelection(IShellItemArray* psiArray, Selection& selection, bool readPaths, size_t limit, std::chrono::steady_clock::time_point deadline, std::chrono::milliseconds volumeTimeout);
+
+/// <summary>
+/// Reads only the paths of a shell item array's items into a <see
+/// cref="Selection"/>, as running a command needs.
+/// </summary>
+/// <remarks>
+/// <para>Paths are copied out of the ID list of the array's data object,
+/// without binding the folder the items are in or reading their attributes,
+/// so no item's volume is touched, however slow it is to respond. Only items
+/// that are not plain file system paths go through a shell item.</para>
+/// <para>Every item is read, and none has any <see
+/// cref="SelectionItemAttributes"/>.</para>
+/// </remarks>
+/// <param name="psiArray">The shell items array. May be
+/// <c>nullptr</c>.</param>
+/// <param name="selection">The selection to fill.</param>
+/// <returns>If this function succeeds, it returns <c>S_OK</c>. Otherwise, it
+/// returns an <c>HRESULT</c> error code.</returns>
+HRESULT ReadShellSelectionPaths(IShellItemArray* psiArray, Selection& selection);
+
+/// <summary>
+/// Computes a <see cref="SelectionFingerprint"/> for a shell item array from
+/// its count and the ID lists of its first and last items.
+/// </summary>
+/// <param name="psiArray">The shell items array. May be
+/// <c>nullptr</c>.</param>
+/// <param name="fingerprint">Receives the fingerprint.</param>
+/// <returns>If this function succeeds, it returns <c>S_OK</c>. Otherwise, it
+/// returns an <c>HRESULT</c> error code.</returns>
+HRESULT GetShellSelectionFingerprint(IShellItemArray* psiArray, SelectionFingerprint& fingerprint);
+
+/// <summary>
+/// Remembers the fingerprint of the last shell item array a command was
+/// asked about, so that asking again about the same array does not hash
+/// its items.
+/// </summary>
+/// <remarks>
+/// <para>Explorer passes one array to every call it makes while showing a
+/// menu. Getting an item's ID list allocates, so the array itself and its
+/// count are checked first, and ID lists are only hashed for a different
+/// array.</para>
+/// <para>The cache holds a reference to the array, so that its address
+/// cannot be reused by another array while it is remembered.</para>
+/// </remarks>
+class ShellFingerprintCache {
+  SRWLOCK lock = SRWLOCK_INIT;
+  IShellItemArray* psiArray = nullptr;
+  DWORD count = 0;
+  SelectionFingerprint fingerprint;
+
+public:
+  ShellFingerprintCache() = default;
+  ShellFingerprintCache(const ShellFingerprintCache&) = delete;
+  ShellFingerprintCache& operator=(const ShellFingerprintCache&) = delete;
+
+  ~ShellFingerprintCache();
+
+  /// <summary>
+  /// Gets the fingerprint of a shell item array, as <see
+  /// cref="GetShellSelectionFingerprint"/> does, hashing its items only if
+  /// it is not the array last asked about.
+  /// </summary>
+  /// <param name="psiArray">The shell items array. May be
+  /// <c>nullptr</c>.</param>
+  /// <param name="fingerprint">Receives the fingerprint.</param>
+  /// <returns>If this function succeeds, it returns <c>S_OK</c>. Otherwise,
+  /// it returns an <c>HRESULT</c> error code.</returns>
+  HRESULT Get(IShellItemArray* psiArray, SelectionFingerprint& fingerprint);
+
+  /// <summary>
+  /// Forgets the array, releasing it.
+  /// </summary>
+  void Clear();
+};
+
+/// <summary>
+/// A shell item array, as the <see cref="SelectionSource"/> a <see
+/// cref="MenuCommand"/> reads.
+/// </summary>
+class ShellItemSelection : public SelectionSource {
+  IShellItemArray* psiArray;
+  ShellFingerprintCache& fingerprints;
+
+  HRESULT result = S_OK;
+
+public:
+  /// <summary>
+  /// Initializes a <see cref="ShellItemSelection"/>.
+  /// </summary>
+  /// <param name="psiArray">The shell items array, which must outlive the
+  /// source. May be <c>nullptr</c>.</param>
+  /// <param name="fingerprints">The cache of the command being asked, which
+  /// fingerprints go through.</param>
+  ShellItemSelection(IShellItemArray* psiArray, ShellFingerprintCache& fingerprints) : psiArray(psiArray), fingerprints(fingerprints) {}
+
+  /// <summary>
+  /// The result of the last read, for returning to Explorer.
+  /// </summary>
+  HRESULT Result() const { return result; }
+
+  bool Fingerprint(SelectionFingerprint& fingerprint) override;
+
+  bool Read(Selection& selection, bool readPaths, size_t limit, std::chrono::steady_clock::time_point deadline, std::chrono::milliseconds volumeTimeout) override;
+
+  bool ReadPaths(Selection& selection) override;
+};
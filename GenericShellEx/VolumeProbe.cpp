@@ -0,0 +1,288 @@
+#include <cwchar>
+#include <new>
+
+#include "VolumeProbe.h"
+
+namespace {
+  /// <summary>
+  /// The number of volumes remembered. The least recently used is forgotten
+  /// first.
+  /// </summary>
+  constexpr size_t VolumeCacheCapacity = 32;
+
+  enum class VolumeState {
+    Probing,
+    Responsive,
+    Slow
+  };
+
+  struct VolumeEntry {
+    wchar_t root[MAX_PATH];
+    size_t length;
+    VolumeKind kind;
+    VolumeState state;
+    ULONGLONG expiry;
+    ULONGLONG lastUsed;
+  };
+
+  /// <summary>
+  /// Guards <see cref="volumes"/>.
+  /// </summary>
+  SRWLOCK volumesLock = SRWLOCK_INIT;
+
+  /// <summary>
+  /// Volumes by root. Entries with a zero length are free.
+  /// </summary>
+  VolumeEntry volumes[VolumeCacheCapacity] = {};
+
+  /// <summary>
+  /// A probe, shared by the thread pool callback and the caller waiting for
+  /// it. Whichever is done with it last frees it.
+  /// </summary>
+  struct ProbeWork {
+    wchar_t root[MAX_PATH];
+    size_t length;
+    VolumeKind kind;
+    HANDLE done;
+    HMODULE module;
+    LONG references;
+    bool responsive;
+  };
+
+  bool IsDriveLetter(wchar_t c) {
+    return (c | 0x20) >= L'a' && (c | 0x20) <= L'z';
+  }
+
+  /// <summary>
+  /// Gets the root of the volume a path is on, such as <c>C:\</c> or
+  /// <c>\\server\share\</c>, with any <c>\\?\</c> prefix removed.
+  /// </summary>
+  /// <returns>The length of the root, or zero if the path has none or it is
+  /// too long.</returns>
+  size_t GetVolumeRoot(std::wstring_view path, wchar_t (&root)[MAX_PATH]) {
+    std::wstring_view rest;
+    bool unc = false;
+
+    if (path.starts_with(L"\\\\?\\UNC\\")) {
+      rest = path.substr(8);
+      unc = true;
+    } else if (path.starts_with(L"\\\\?\\")) {
+      rest = path.substr(4);
+    } else if (path.starts_with(L"\\\\.\\")) {
+      return 0;
+    } else if (path.starts_with(L"\\\\")) {
+      rest = path.substr(2);
+      unc = true;
+    } else {
+      rest = path;
+    }
+
+    if (!unc) {
+      if (rest.size() < 2 || !IsDriveLetter(rest[0]) || rest[1] != L':') return 0;
+
+      root[0] = rest[0];
+      root[1] = L':';
+      root[2] = L'\\';
+      root[3] = L'\0';
+
+      return 3;
+    }
+
+    size_t server = rest.find(L'\\');
+
+    if (server == std::wstring_view::npos || !server || server + 1 == rest.size()) return 0;
+
+    size_t share = rest.find(L'\\', server + 1);
+
+    if (share == server + 1) return 0;
+    if (share == std::wstring_view::npos) share = rest.size();
+
+    // \\ plus the server and share plus \ and a terminator
+    if (share + 4 > MAX_PATH) return 0;
+
+    root[0] = L'\\';
+    root[1] = L'\\';
+    wmemcpy(root + 2, rest.data(), share);
+    root[share + 2] = L'\\';
+    root[share + 3] = L'\0';
+
+    return share + 3;
+  }
+
+  VolumeKind ClassifyRoot(const wchar_t* root) {
+    if (root[0] == L'\\') return VolumeKind::Network;
+
+    switch (GetDriveTypeW(root)) {
+    case DRIVE_FIXED:
+    case DRIVE_RAMDISK:
+      return VolumeKind::Local;
+    case DRIVE_REMOTE:
+      return VolumeKind::Network;
+    default:
+      // Drives that are gone or unknown are probed like removable ones
+      return VolumeKind::Removable;
+    }
+  }
+
+  /// <summary>
+  /// Finds a volume. The lock must be held.
+  /// </summary>
+  VolumeEntry* FindVolume(const wchar_t* root, size_t length) {
+    for (VolumeEntry& entry : volumes) {
+      if (entry.length == length && !_wcsnicmp(entry.root, root, length)) return &entry;
+    }
+
+    return nullptr;
+  }
+
+  /// <summary>
+  /// Records a volume's state, replacing the least recently used volume if
+  /// it is not known. The lock must be held.
+  /// </summary>
+  void RecordVolume(const wchar_t* root, size_t length, VolumeKind kind, VolumeState state, ULONGLONG now) {
+    VolumeEntry* entry = FindVolume(root, length);
+
+    if (!entry) {
+      entry = &volumes[0];
+
+      for (VolumeEntry& candidate : volumes) {
+        if (candidate.lastUsed < entry->lastUsed) entry = &candidate;
+      }
+
+      wmemcpy(entry->root, root, length + 1);
+      entry->length = length;
+    }
+
+    entry->kind = kind;
+    entry->state = state;
+    entry->expiry = now + (state == VolumeState::Responsive ? ResponsiveVolumeLifetime : SlowVolumeLifetime);
+    entry->lastUsed = now;
+  }
+
+  void ReleaseProbe(ProbeWork* work) {
+    if (InterlockedDecrement(&work->references)) return;
+
+    CloseHandle(work->done);
+    delete work;
+  }
+
+  VOID CALLBACK RunProbe(PTP_CALLBACK_INSTANCE instance, PVOID context) {
+    auto* work = static_cast<ProbeWork*>(context);
+
+    FreeLibraryWhenCallbackReturns(instance, work->module);
+
+    // This is the call that can block for as long as the redirector takes
+    // to give up on a share
+    work->responsive = GetFileAttributesW(work->root) != INVALID_FILE_ATTRIBUTES;
+
+    AcquireSRWLockExclusive(&volumesLock);
+    RecordVolume(work->root, work->length, work->kind, work->responsive ? VolumeState::Responsive : VolumeState::Slow, GetTickCount64());
+    ReleaseSRWLockExclusive(&volumesLock);
+
+    SetEvent(work->done);
+    ReleaseProbe(work);
+  }
+
+  /// <summary>
+  /// Starts probing a volume on the process's thread pool.
+  /// </summary>
+  /// <remarks>
+  /// Probes do not go through <see cref="SubmitBackgroundWork"/>: a probe
+  /// of a share whose server is gone blocks for as long as the redirector
+  /// takes, and two of them would hold every thread of that bounded executor
+  /// while launches and the log waited behind them. The process's pool
+  /// grows instead, and the module reference keeps the DLL loaded until the
+  /// probe returns.
+  /// </remarks>
+  /// <returns>The probe, with a reference for the caller, or
+  /// <c>nullptr</c>.</returns>
+  ProbeWork* StartProbe(const wchar_t* root, size_t length, VolumeKind kind) {
+    auto* work = new (std::nothrow) ProbeWork{};
+
+    if (!work) return nullptr;
+
+    wmemcpy(work->root, root, length + 1);
+    work->length = length;
+    work->kind = kind;
+    work->references = 2;
+    work->done = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+
+    if (work->done && GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, reinterpret_cast<LPCWSTR>(&RunProbe), &work->module)) {
+      if (TrySubmitThreadpoolCallback(RunProbe, work, nullptr)) return work;
+
+      FreeLibrary(work->module);
+    }
+
+    if (work->done) CloseHandle(work->done);
+
+    delete work;
+
+    return nullptr;
+  }
+}
+
+VolumeKind ClassifyVolume(std::wstring_view path) {
+  wchar_t root[MAX_PATH];
+
+  return GetVolumeRoot(path, root) ? ClassifyRoot(root) : VolumeKind::Local;
+}
+
+bool IsVolumeResponsive(std::wstring_view path, std::chrono::milliseconds timeout) {
+  wchar_t root[MAX_PATH];
+  size_t length = GetVolumeRoot(path, root);
+
+  if (!length) return true;
+
+  ULONGLONG now = GetTickCount64();
+
+  AcquireSRWLockExclusive(&volumesLock);
+
+  VolumeEntry* entry = FindVolume(root, length);
+  bool known = entry && now < entry->expiry;
+  bool responsive = known && entry->state == VolumeState::Responsive;
+
+  if (known) entry->lastUsed = now;
+
+  ReleaseSRWLockExclusive(&volumesLock);
+
+  if (known) return responsive;
+
+  VolumeKind kind = ClassifyRoot(root);
+
+  AcquireSRWLockExclusive(&volumesLock);
+
+  // Another caller may have started probing meanwhile
+  entry = FindVolume(root, length);
+  known = entry && now < entry->expiry;
+  responsive = known && entry->state == VolumeState::Responsive;
+
+  if (!known) RecordVolume(root, length, kind, kind == VolumeKind::Local ? VolumeState::Responsive : VolumeState::Probing, now);
+
+  ReleaseSRWLockExclusive(&volumesLock);
+
+  if (known) return responsive;
+  if (kind == VolumeKind::Local) return true;
+
+  ProbeWork* work = StartProbe(root, length, kind);
+
+  // Longer timeouts, such as milliseconds::max(), wait for as long as the
+  // probe takes rather than being truncated to a short or zero wait
+  DWORD wait = timeout >= std::chrono::milliseconds(INFINITE) ? INFINITE : timeout.count() <= 0 ? 0 : static_cast<DWORD>(timeout.count());
+
+  if (work && WaitForSingleObject(work->done, wait) == WAIT_OBJECT_0) {
+    responsive = work->responsive;
+  } else {
+    AcquireSRWLockExclusive(&volumesLock);
+
+    // Leave the result alone if the probe finished after all
+    entry = FindVolume(root, length);
+
+    if (entry && entry->state == VolumeState::Probing) RecordVolume(root, length, kind, VolumeState::Slow, GetTickCount64());
+
+    ReleaseSRWLockExclusive(&volumesLock);
+  }
+
+  if (work) ReleaseProbe(work);
+
+  return responsive;
+}
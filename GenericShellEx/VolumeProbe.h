@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <string_view>
+#include "framework.h"
+
+/// <summary>
+/// How long, in milliseconds, a volume that did not respond in time is
+/// assumed to still be slow.
+/// </summary>
+constexpr ULONGLONG SlowVolumeLifetime = 30000;
+
+/// <summary>
+/// How long, in milliseconds, a volume that responded is assumed to still
+/// respond.
+/// </summary>
+constexpr ULONGLONG ResponsiveVolumeLifetime = 15000;
+
+/// <summary>
+/// The kinds of volume a path can be on.
+/// </summary>
+enum class VolumeKind {
+  /// <summary>
+  /// A fixed disk or RAM disk, or a path without a volume root.
+  /// </summary>
+  Local,
+
+  /// <summary>
+  /// A removable disk or optical drive.
+  /// </summary>
+  Removable,
+
+  /// <summary>
+  /// A UNC path or mapped network drive.
+  /// </summary>
+  Network
+};
+
+/// <summary>
+/// Classifies the volume a path is on from its root, without touching the
+/// volume itself.
+/// </summary>
+/// <param name="path">The path.</param>
+/// <returns>A <see cref="VolumeKind"/>.</returns>
+VolumeKind ClassifyVolume(std::wstring_view path);
+
+/// <summary>
+/// Determines whether items on the volume a path is on can be inspected
+/// without risking a long block, such as on a disconnected mapped drive.
+/// </summary>
+/// <remarks>
+/// <para>Local volumes always can. Network and removable volumes are probed
+/// on the thread pool, waiting at most <paramref name="timeout"/>. The
+/// answer is remembered for <see cref="ResponsiveVolumeLifetime"/> or <see
+/// cref="SlowVolumeLifetime"/>, so later calls return at once.</para>
+/// <para>While a volume is being probed, other callers treat it as slow
+/// rather than wait as well.</para>
+/// </remarks>
+/// <param name="path">The path.</param>
+/// <param name="timeout">How long to wait for an unprobed volume.</param>
+/// <returns><c>true</c> if the volume responded or is local; otherwise,
+/// <c>false</c>.</returns>
+bool IsVolumeResponsive(std::wstring_view path, std::chrono::milliseconds timeout);
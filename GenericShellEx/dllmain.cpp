@@ -1,244 +1,576 @@
-#include <ShlObj_core.h>
-#include <initguid.h>
-#include "nlohmann/json.hpp"
-#include "guid.h"
-#include "ContextMenuCommandFactory.h"
-
-extern "C" IMAGE_DOS_HEADER __ImageBase;
-
-// Global DLL reference count
-LONG g_cRefModule = 0;
-
-std::wofstream g_logFile;
-
-/// <summary>
-/// The map of context menu entries.
-/// </summary>
-std::unordered_map<std::wstring, ContextMenuEntry> g_contextMenuEntries;
-
-/// <summary>
-/// Gets a <see cref="std::ifstream"/> for the configuration file.
-/// </summary>
-/// <returns>The configuration file.</returns>
-extern std::ifstream GetConfigFileStream() {
-  PWSTR localAppDataPath = nullptr;
-
-  if (FAILED(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, NULL, &localAppDataPath))) {
-    return std::ifstream();
-  }
-
-  std::wstring configPath(localAppDataPath);
-  configPath.append(L"\\GenericShellEx\\config.json");
-
-  CoTaskMemFree(localAppDataPath);
-
-  std::ifstream configFile(configPath);
-
-  return configFile;
-}
-
-/// <summary>
-/// Expands environment variables in <paramref name="s"/>.
-/// </summary>
-/// <param name="s">The string in which to expand environment
-/// variables.</param>
-/// <returns><paramref name="s"/>, with environment variables
-/// expanded.</returns>
-extern std::wstring ExpandEnvVars(const std::wstring& s) {
-  DWORD size = ExpandEnvironmentStringsW(s.c_str(), nullptr, 0);
-  std::wstring result(size, L'\0');
-
-  if (ExpandEnvironmentStringsW(s.c_str(), &result[0], size)) {
-    // Remove the null terminator from std::wstring
-    result.resize(static_cast<std::basic_string<wchar_t, std::char_traits<wchar_t>, std::allocator<wchar_t>>::size_type>(size) - 1);
-    return result;
-  }
-
-  return L"";
-}
-
-/// <summary>
-/// Converts a <see cref="std::string"/> to a <see cref="std::wstring"/>.
-/// </summary>
-/// <param name="s">The string to convert.</param>
-/// <returns>A <see cref="std::wstring"/>.</returns>
-extern std::wstring ConvertToWString(const std::string& s) {
-  return std::wstring(s.begin(), s.end());
-}
-
-/// <summary>
-/// Adds a context command to the map.
-/// </summary>
-/// <param name="wType">The type this context command is associated
-/// with.</param>
-/// <param name="entry">The JSON object that contains the context command's
-/// definition.</param>
-extern void AddContextCommand(const std::wstring& wType, const nlohmann::json& entry) {
-  ContextMenuEntry contextMenuEntry;
-
-  if (entry.contains("title")) {
-    contextMenuEntry.title = ConvertToWString(entry["title"].get<std::string>());
-  }
-
-  if (entry.contains("toolTip")) {
-    contextMenuEntry.toolTip = ConvertToWString(entry["toolTip"].get<std::string>());
-  }
-
-  if (entry.contains("icon")) {
-    contextMenuEntry.icon = ConvertToWString(entry["icon"].get<std::string>());
-  }
-
-  if (entry.contains("command")) {
-    contextMenuEntry.command = ConvertToWString(entry["command"].get<std::string>());
-  }
-
-  g_contextMenuEntries[wType] = contextMenuEntry;
-}
-
-extern HRESULT GetContextMenuCommandFactory(CLSID clsid, REFIID riid, void** ppv) {
-  std::wstring wType;
-
-  if (clsid == CLSID_StarContextMenuProvider) {
-    wType = L"*";
-  } else if (clsid == CLSID_DirectoryContextMenuProvider) {
-    wType = L"Directory";
-  } else if (clsid == CLSID_DirectoryBackgroundContextMenuProvider) {
-    wType = L"Directory\\Background";
-  } else {
-    if (g_logFile.is_open()) {
-      g_logFile << L"ERROR: Unable to map CLSID to type" << std::endl;
-    }
-
-    return CLASS_E_CLASSNOTAVAILABLE;
-  }
-
-  if (g_logFile.is_open()) {
-    g_logFile << L"CLSID refers to " << wType << std::endl;
-  }
-
-  auto contextMenuEntry = g_contextMenuEntries.find(wType);
-
-  if (contextMenuEntry == g_contextMenuEntries.end()) {
-    if (g_logFile.is_open()) {
-      g_logFile << L"ERROR: Config file does not define type " << wType << std::endl;
-    }
-
-    CLASS_E_CLASSNOTAVAILABLE;
-  }
-
-  contextMenuEntry->second.clsid = clsid;
-
-  auto* factory = new (std::nothrow) ContextMenuCommandFactory(g_logFile, contextMenuEntry->second);
-
-  if (!factory) return E_OUTOFMEMORY;
-
-  HRESULT hr = factory->QueryInterface(riid, ppv);
-  factory->Release();
-
-  return hr;
-}
-
-_Check_return_
-/// <summary>
-/// Retrieves the class object from a DLL object handler or object application.
-/// </summary>
-/// <param name="rclsid">The <c>CLSID</c> that will associate the correct data
-/// and code.</param>
-/// <param name="riid">A reference to the identifier of the interface that the
-/// caller is to use to communicate with the class object. Usually, this is
-/// <c>IID_IClassFactory</c> (defined in the OLE headers as the interface
-/// identifier for <c>IClassFactory</c>).</param>
-/// <param name="ppv">The address of a pointer variable that receives the
-/// interface pointer requested in <paramref name="riid"/>. Upon successful
-/// return, <c>*</c><paramref name="ppv"/> contains the requested interface
-/// pointer. If an error occurs, the interface pointer is <c>NULL</c>.</param>
-/// <returns>This function can return the standard return values
-/// <c>E_INVALIDARG</c>, <c>E_OUTOFMEMORY</c>, and <c>E_UNEXPECTED</c>, as well
-/// as <c>S_OK</c> and <c>CLASS_E_CLASSNOTAVAILABLE</c>.</returns>
-extern "C" HRESULT __stdcall DllGetClassObject(_In_ REFCLSID rclsid, _In_ REFIID riid, _Outptr_ void** ppv) {
-  std::ifstream configStream = GetConfigFileStream();
-
-  if (configStream.is_open()) {
-    nlohmann::json config;
-
-    configStream >> config;
-
-    if (config.contains("logFile") && config["logFile"].is_string()) {
-      std::wstring wLogFile(config["logFile"].get<std::string>().begin(), config["logFile"].get<std::string>().end());
-      wLogFile = ExpandEnvVars(wLogFile);
-      g_logFile.open(wLogFile.c_str(), std::ofstream::out | std::ios_base::app);
-
-      if (g_logFile.is_open()) {
-        std::time_t now = std::time(nullptr);
-#pragma warning(suppress : 4996)
-        g_logFile << std::endl << L"[" << std::put_time(std::localtime(&now), L"%F %T") << L"]" << std::endl;
-      }
-    }
-
-    if (config.contains("types") && config["types"].is_object()) {
-      for (const auto& entry : config["types"].items()) {
-        std::wstring wType(entry.key().begin(), entry.key().end());
-
-        if (entry.value().is_object()) {
-          AddContextCommand(wType, entry.value());
-        }
-
-        // This, sadly, is not supported in any meaningfully feasible way via
-        // MSIX
-        /*else if (entry.value().is_array()) {
-          for (const auto& type : entry.value().items()) {
-            if (type.value().is_object()) {
-              AddContextCommand(wType, type.value());
-            }
-          }
-        }*/
-      }
-    }
-
-    if (g_logFile.is_open()) {
-      LPOLESTR clsidString = nullptr;
-
-      if (!FAILED(StringFromCLSID(rclsid, &clsidString))) {
-        g_logFile << L"Initialized class object for CLSID " << clsidString << std::endl;
-      }
-
-      CoTaskMemFree(clsidString);
-    }
-  }
-
-  return GetContextMenuCommandFactory(rclsid, riid, ppv);
-}
-
-__control_entrypoint(DllExport)
-/// <summary>
-/// Determines whether the DLL that implements this function is in use. If not,
-/// the caller can unload the DLL from memory.
-/// </summary>
-/// <returns>If the function succeeds, the return value is <c>S_OK</c>.
-/// Otherwise, it is <c>S_FALSE</c>.</returns>
-extern "C" HRESULT __stdcall DllCanUnloadNow(void) {
-  return (g_cRefModule == 0) ? S_OK : S_FALSE;
-}
-
-/// <summary>
-/// An optional entry point into a dynamic-link library (DLL). When the system
-/// starts or terminates a process or thread, it calls the entry-point function
-/// for each loaded DLL using the first thread of the process. The system also
-/// calls the entry-point function for a DLL when it is loaded or unloaded
-/// using the <c>LoadLibrary</c> and <c>FreeLibrary</c> functions.
-/// </summary>
-/// <param name="hinstDLL">A handle to the DLL module. The value is the base
-/// address of the DLL. The <c>HINSTANCE</c> of a DLL is the same as the
-/// <c>HMODULE</c> of the DLL, so <paramref name="hinstDLL"/> can be used in
-/// calls to functions that require a module handle.</param>
-/// <param name="fdwReason">The reason code that indicates why the DLL
-/// entry-point function is being called. This parameter can be one of the
-/// following values: <c>DLL_PROCESS_ATTACH</c>, <c>DLL_PROCESS_DETACH</c>,
-/// <c>DLL_THREAD_ATTACH</c>, and <c>DLL_THREAD_DETACH</c>.</param>
-/// <returns>The function returns <c>TRUE</c> if it succeeds or <c>FALSE</c>
-/// if initialization fails.</returns>
-extern "C" BOOL APIENTRY DllMain(HMODULE hinstDLL, DWORD fdwReason, LPVOID /*lpvReserved*/) {
-  if (fdwReason == DLL_PROCESS_ATTACH) DisableThreadLibraryCalls(hinstDLL);
-
-  return TRUE;
+#include <ShlObj_core.h>
+#include <array>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <initguid.h>
+#include <memory>
+#include <optional>
+#include <utility>
+#include "guid.h"
+#include "BackgroundWork.h"
+#include "ClsidSlotPool.h"
+#include "CommandTemplate.h"
+#include "Config.h"
+#include "ConfigSnapshot.h"
+#include "ContextMenuCommand.h"
+#include "ContextMenuCommandFactory.h"
+#include "Environment.h"
+#include "IconResolver.h"
+#include "Log.h"
+#include "MappedFile.h"
+#include "MarkerFinder.h"
+
+extern "C" IMAGE_DOS_HEADER __ImageBase;
+
+// Global DLL reference count
+LONG g_cRefModule = 0;
+
+/// <summary>
+/// The log file, which <see cref="g_log"/> writes to in batches.
+/// </summary>
+std::wofstream g_logFile;
+
+/// <summary>
+/// The path <see cref="g_logFile"/> was opened with, or an empty string if
+/// it is not open. Guarded by <see cref="g_configRefreshLock"/>.
+/// </summary>
+std::wstring g_logFilePath;
+
+Log g_log;
+
+/// <summary>
+/// The current configuration. Commands hold a reference to the snapshot
+/// they were created from.
+/// </summary>
+std::shared_ptr<const ConfigSnapshot> g_configSnapshot;
+
+SRWLOCK g_configSnapshotLock = SRWLOCK_INIT;
+
+/// <summary>
+/// Serializes reloading the configuration and guards <see
+/// cref="g_configWriteTime"/>, <see cref="g_configSize"/>, and the
+/// environment check.
+/// </summary>
+SRWLOCK g_configRefreshLock = SRWLOCK_INIT;
+
+/// <summary>
+/// The last write time of the configuration file <see
+/// cref="g_configSnapshot"/> was loaded from.
+/// </summary>
+FILETIME g_configWriteTime = {};
+
+/// <summary>
+/// The size of the configuration file <see cref="g_configSnapshot"/> was
+/// loaded from.
+/// </summary>
+ULONGLONG g_configSize = 0;
+
+/// <summary>
+/// How often, in milliseconds, to check whether the environment has
+/// changed.
+/// </summary>
+constexpr ULONGLONG EnvironmentCheckInterval = 1000;
+
+/// <summary>
+/// The hash of the environment block <see cref="g_configSnapshot"/> was
+/// expanded with.
+/// </summary>
+uint64_t g_environmentHash = 0;
+
+/// <summary>
+/// When the environment was last checked, from <c>GetTickCount64</c>.
+/// </summary>
+ULONGLONG g_environmentCheckTime = 0;
+
+/// <summary>
+/// Gets the path to the configuration file.
+/// </summary>
+/// <returns>The configuration file path, or an empty string if it could not
+/// be determined.</returns>
+extern const std::wstring& GetConfigFilePath() {
+  static const std::wstring configPath = [] {
+    PWSTR localAppDataPath = nullptr;
+
+    if (FAILED(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, NULL, &localAppDataPath))) {
+      return std::wstring();
+    }
+
+    std::wstring path(localAppDataPath);
+    path.append(L"\\GenericShellEx\\config.json");
+
+    CoTaskMemFree(localAppDataPath);
+
+    return path;
+  }();
+
+  return configPath;
+}
+
+/// <summary>
+/// Gets an environment variable of this process.
+/// </summary>
+/// <param name="name">The variable name.</param>
+/// <returns>The variable's value, or <c>std::nullopt</c> if it is not
+/// set.</returns>
+extern std::optional<std::wstring> LookUpEnvironmentVariable(const std::wstring& name) {
+  wchar_t buffer[MAX_PATH];
+  DWORD length = GetEnvironmentVariableW(name.c_str(), buffer, MAX_PATH);
+
+  if (!length) return std::nullopt;
+  if (length < MAX_PATH) return std::wstring(buffer, length);
+
+  // Too long for the buffer, so length includes the null terminator
+  std::wstring value(length, L'\0');
+  length = GetEnvironmentVariableW(name.c_str(), value.data(), length);
+  value.resize(length);
+
+  return value;
+}
+
+/// <summary>
+/// Hashes this process's environment block.
+/// </summary>
+/// <remarks>
+/// Explorer rebuilds its environment when it receives the
+/// <c>WM_SETTINGCHANGE</c> "Environment" broadcast, so a change in this hash
+/// means variables may expand differently.
+/// </remarks>
+/// <returns>The hash.</returns>
+uint64_t HashEnvironmentBlock() {
+  LPWCH block = GetEnvironmentStringsW();
+
+  if (!block) return 0;
+
+  const wchar_t* end = block;
+
+  while (*end) end += wcslen(end) + 1;
+
+  uint64_t hash = HashBytes(block, (end - block) * sizeof(wchar_t));
+
+  FreeEnvironmentStringsW(block);
+
+  return hash;
+}
+
+/// <summary>
+/// Binds a context command to its CLSID slot.
+/// </summary>
+/// <remarks>
+/// The command is bound to the CLSID slot named by its <c>slot</c> property,
+/// which is either a slot index or a slot name. Without one, it is bound to
+/// the slot named after its type.
+/// </remarks>
+/// <param name="snapshot">The snapshot to bind the command in.</param>
+/// <param name="binding">The parsed context command.</param>
+extern void AddContextCommand(ConfigSnapshot& snapshot, ConfigBinding& binding) {
+  size_t slot = NoClsidSlot;
+
+  if (binding.slotIndex != SIZE_MAX) {
+    if (binding.slotIndex < ClsidSlotCount) slot = binding.slotIndex;
+  } else if (!binding.slotName.empty()) {
+    slot = FindClsidSlot(binding.slotName);
+  } else {
+    slot = FindClsidSlot(binding.type);
+  }
+
+  if (slot == NoClsidSlot) {
+    if (g_log.IsOpen()) {
+      g_log.Line() << L"ERROR: " << binding.type << L" is not bound to a CLSID slot";
+    }
+
+    return;
+  }
+
+  snapshot.entries[slot] = std::move(binding.entry);
+}
+
+/// <summary>
+/// Gets the current configuration.
+/// </summary>
+/// <returns>The current configuration, or <c>nullptr</c> if none has been
+/// loaded.</returns>
+extern std::shared_ptr<const ConfigSnapshot> GetConfigSnapshot() {
+  AcquireSRWLockShared(&g_configSnapshotLock);
+  std::shared_ptr<const ConfigSnapshot> snapshot = g_configSnapshot;
+  ReleaseSRWLockShared(&g_configSnapshotLock);
+
+  return snapshot;
+}
+
+/// <summary>
+/// Loads the configuration file and publishes it as the current
+/// configuration, recording the file's state in <see
+/// cref="g_configWriteTime"/> and <see cref="g_configSize"/>.
+/// </summary>
+/// <remarks>
+/// A file that cannot be read, such as one that is locked, empty, or
+/// written to while it is being parsed, leaves the current configuration
+/// in place. So does one that is not valid JSON, unless there is no current
+/// configuration.
+/// </remarks>
+/// <param name="configPath">The configuration file path.</param>
+/// <returns><c>S_OK</c> if the configuration was published, <c>S_FALSE</c>
+/// if the file was read but was not valid, or an <c>HRESULT</c> error code
+/// if it could not be read.</returns>
+HRESULT LoadConfigSnapshot(const std::wstring& configPath) {
+  Config config;
+  bool parsed = false;
+  FILETIME writeTime;
+  ULONGLONG size;
+
+  // Parsed straight from the mapping, which is released before anything
+  // else is done, since an editor cannot truncate a mapped file
+  {
+    MappedFile file;
+    HRESULT hr = file.Open(configPath);
+
+    if (SUCCEEDED(hr)) {
+      parsed = ParseConfig(file.Text(), config);
+
+      if (file.HasChanged()) hr = E_CHANGED_STATE;
+    }
+
+    if (FAILED(hr)) {
+      if (g_log.IsOpen()) {
+        wchar_t code[16];
+        swprintf(code, sizeof(code) / sizeof(code[0]), L"0x%08lX", static_cast<unsigned long>(hr));
+
+        g_log.Line() << L"Unable to read config file (" << code << L"), keeping the current config";
+      }
+
+      return hr;
+    }
+
+    writeTime = file.LastWriteTime();
+    size = file.Size();
+  }
+
+  if (!parsed && GetConfigSnapshot()) {
+    if (g_log.IsOpen()) {
+      for (const std::wstring& error : config.errors) {
+        g_log.Line() << L"ERROR: " << error;
+      }
+
+      g_log.Line() << L"Keeping the current config";
+    }
+
+    g_configWriteTime = writeTime;
+    g_configSize = size;
+
+    return S_FALSE;
+  }
+
+  // Each variable is looked up once, here, rather than on every right-click
+  EnvironmentExpander expander(LookUpEnvironmentVariable);
+
+  auto snapshot = std::make_shared<ConfigSnapshot>(ClsidSlotCount);
+  snapshot->logFile = expander.Expand(config.logFile);
+  snapshot->volumeTimeout = config.volumeTimeout;
+  snapshot->signatures = config.signatures;
+  snapshot->markers = config.markers;
+
+  SetBackgroundThreadpool(config.threadpool);
+
+  // The log follows logFile across reloads, so removing the property stops
+  // logging and changing it moves the log to the new file
+  if (snapshot->logFile != g_logFilePath) {
+    if (g_log.IsOpen()) {
+      if (snapshot->logFile.empty()) {
+        g_log.Line() << L"Closing log file";
+      } else {
+        g_log.Line() << L"Moving log file to " << snapshot->logFile;
+      }
+    }
+
+    // Closing the log first flushes it, and no line is written to the file
+    // once it is closed
+    g_log.Close();
+    g_logFile.close();
+    g_logFile.clear();
+    g_logFilePath.clear();
+
+    if (!snapshot->logFile.empty()) {
+      g_logFile.open(snapshot->logFile.c_str(), std::ofstream::out | std::ios_base::app);
+
+      // A file that cannot be opened is tried again on the next reload
+      if (g_logFile.is_open()) {
+        g_logFilePath = snapshot->logFile;
+        g_log.Open(&g_logFile);
+      }
+    }
+  }
+
+  if (g_log.IsOpen()) {
+    g_log.Line() << L"Loading config file";
+
+    for (const std::wstring& error : config.errors) {
+      g_log.Line() << L"ERROR: " << error;
+    }
+  }
+
+  // Icons are checked once per load, so a broken one is logged once rather
+  // than failing silently in Explorer on every right-click
+  IconResolver icons(g_log, config.iconCache ? configPath.substr(0, configPath.rfind(L'\\')) + L"\\IconCache" : L"");
+
+  for (ConfigBinding& binding : config.bindings) {
+    expander.Expand(binding.entry);
+    CompileCommandTemplates(binding.entry);
+    icons.Resolve(binding.entry);
+    AddContextCommand(*snapshot, binding);
+  }
+
+  std::shared_ptr<const ConfigSnapshot> previous;
+
+  AcquireSRWLockExclusive(&g_configSnapshotLock);
+  previous = std::exchange(g_configSnapshot, std::move(snapshot));
+  ReleaseSRWLockExclusive(&g_configSnapshotLock);
+
+  g_configWriteTime = writeTime;
+  g_configSize = size;
+
+  return S_OK;
+}
+
+/// <summary>
+/// Determines whether the environment has changed since it was last
+/// checked. Checks at most once every <see
+/// cref="EnvironmentCheckInterval"/>.
+/// </summary>
+/// <returns><c>true</c> if the environment has changed or <c>false</c>
+/// otherwise.</returns>
+bool HasEnvironmentChanged() {
+  ULONGLONG now = GetTickCount64();
+
+  if (g_environmentHash && now - g_environmentCheckTime < EnvironmentCheckInterval) return false;
+
+  g_environmentCheckTime = now;
+
+  uint64_t hash = HashEnvironmentBlock();
+  bool changed = hash != g_environmentHash;
+
+  g_environmentHash = hash;
+
+  return changed;
+}
+
+/// <summary>
+/// Reloads the configuration if the configuration file or the environment
+/// has changed since it was last loaded.
+/// </summary>
+/// <remarks>
+/// <para>This costs one file attribute query when nothing has changed, plus
+/// an environment check at most once a second, and never allocates with
+/// <c>new</c>.</para>
+/// <para>Callers do not wait for a reload already in progress on another
+/// thread; they use the current configuration instead, unless there is
+/// none yet.</para>
+/// </remarks>
+void RefreshConfigSnapshot() {
+  const std::wstring& configPath = GetConfigFilePath();
+  WIN32_FILE_ATTRIBUTE_DATA attributes;
+
+  if (configPath.empty() || !GetFileAttributesExW(configPath.c_str(), GetFileExInfoStandard, &attributes)) return;
+
+  ULONGLONG size = (static_cast<ULONGLONG>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+
+  if (!TryAcquireSRWLockExclusive(&g_configRefreshLock)) {
+    if (GetConfigSnapshot()) return;
+
+    AcquireSRWLockExclusive(&g_configRefreshLock);
+  }
+
+  bool environmentChanged = HasEnvironmentChanged();
+
+  if (!GetConfigSnapshot() || environmentChanged || CompareFileTime(&attributes.ftLastWriteTime, &g_configWriteTime) || size != g_configSize) {
+    if (environmentChanged && g_log.IsOpen()) {
+      g_log.Line() << L"Environment changed";
+    }
+
+    // Forget the file's state if it could not be read, such as while an
+    // editor is saving it, so the next refresh tries again
+    if (FAILED(LoadConfigSnapshot(configPath))) g_configWriteTime = {};
+  }
+
+  ReleaseSRWLockExclusive(&g_configRefreshLock);
+}
+
+/// <summary>
+/// Whether a log flush has been queued and has not started, so that a burst
+/// of class object requests queues one.
+/// </summary>
+LONG g_logFlushQueued = 0;
+
+void RunLogFlush(void* /*context*/, bool cancelled) {
+  InterlockedExchange(&g_logFlushQueued, 0);
+
+  // Unloading flushes the log itself
+  if (!cancelled) g_log.Flush();
+}
+
+/// <summary>
+/// Flushes the log as <see cref="WorkPriority::Housekeeping"/> background
+/// work, so that Explorer does not wait for the log file to be written.
+/// </summary>
+void QueueLogFlush() {
+  if (!g_log.IsOpen() || InterlockedExchange(&g_logFlushQueued, 1)) return;
+
+  if (!SubmitBackgroundWork(WorkPriority::Housekeeping, RunLogFlush, nullptr)) {
+    InterlockedExchange(&g_logFlushQueued, 0);
+    g_log.Flush();
+  }
+}
+
+template<size_t... Slots>
+std::array<ContextMenuCommandFactory, ClsidSlotCount> MakeContextMenuCommandFactories(std::index_sequence<Slots...>) {
+  return { ContextMenuCommandFactory(g_log, Slots)... };
+}
+
+/// <summary>
+/// The class objects, indexed by CLSID slot.
+/// </summary>
+std::array<ContextMenuCommandFactory, ClsidSlotCount> g_contextMenuCommandFactories = MakeContextMenuCommandFactories(std::make_index_sequence<ClsidSlotCount>());
+
+extern HRESULT GetContextMenuCommandFactory(CLSID clsid, REFIID riid, void** ppv) {
+  size_t slot = FindClsidSlot(clsid);
+
+  if (slot == NoClsidSlot) {
+    if (g_log.IsOpen()) {
+      g_log.Line() << L"ERROR: Unable to map CLSID to slot";
+    }
+
+    return CLASS_E_CLASSNOTAVAILABLE;
+  }
+
+  if (g_log.IsOpen()) {
+    g_log.Line() << L"CLSID refers to slot " << ClsidSlots[slot].name;
+  }
+
+  std::shared_ptr<const ConfigSnapshot> snapshot = GetConfigSnapshot();
+
+  if (!snapshot || !snapshot->Entry(slot)) {
+    if (g_log.IsOpen()) {
+      g_log.Line() << L"ERROR: Config file does not bind slot " << ClsidSlots[slot].name;
+    }
+
+    return CLASS_E_CLASSNOTAVAILABLE;
+  }
+
+  return g_contextMenuCommandFactories[slot].QueryInterface(riid, ppv);
+}
+
+_Check_return_
+/// <summary>
+/// Retrieves the class object from a DLL object handler or object application.
+/// </summary>
+/// <param name="rclsid">The <c>CLSID</c> that will associate the correct data
+/// and code.</param>
+/// <param name="riid">A reference to the identifier of the interface that the
+/// caller is to use to communicate with the class object. Usually, this is
+/// <c>IID_IClassFactory</c> (defined in the OLE headers as the interface
+/// identifier for <c>IClassFactory</c>).</param>
+/// <param name="ppv">The address of a pointer variable that receives the
+/// interface pointer requested in <paramref name="riid"/>. Upon successful
+/// return, <c>*</c><paramref name="ppv"/> contains the requested interface
+/// pointer. If an error occurs, the interface pointer is <c>NULL</c>.</param>
+/// <returns>This function can return the standard return values
+/// <c>E_INVALIDARG</c>, <c>E_OUTOFMEMORY</c>, and <c>E_UNEXPECTED</c>, as well
+/// as <c>S_OK</c> and <c>CLASS_E_CLASSNOTAVAILABLE</c>.</returns>
+extern "C" HRESULT __stdcall DllGetClassObject(_In_ REFCLSID rclsid, _In_ REFIID riid, _Outptr_ void** ppv) {
+  RefreshConfigSnapshot();
+
+  if (g_log.IsOpen()) {
+    std::time_t now = std::time(nullptr);
+    wchar_t timestamp[32] = L"";
+
+#pragma warning(suppress : 4996)
+    std::wcsftime(timestamp, sizeof(timestamp) / sizeof(timestamp[0]), L"%F %T", std::localtime(&now));
+
+    g_log.Line();
+    g_log.Line() << L"[" << timestamp << L"]";
+
+    LPOLESTR clsidString = nullptr;
+
+    if (!FAILED(StringFromCLSID(rclsid, &clsidString))) {
+      g_log.Line() << L"Initialized class object for CLSID " << clsidString;
+    }
+
+    CoTaskMemFree(clsidString);
+
+    g_log.Line() << L"Selection cache: " << ContextMenuCommand::CacheHits() << L" hits, " << ContextMenuCommand::CacheMisses() << L" misses";
+    g_log.Line() << L"Prefetch: " << ContextMenuCommand::PrefetchHits() << L" hits, " << ContextMenuCommand::PrefetchMisses() << L" misses";
+    g_log.Line() << L"Remote items inspected without recall: " << ContextMenuCommand::RecallsAvoided();
+    g_log.Line() << L"Directory markers: " << MarkerCacheHits() << L" hits, " << MarkerCacheMisses() << L" misses";
+  }
+
+  HRESULT hr = GetContextMenuCommandFactory(rclsid, riid, ppv);
+
+  QueueLogFlush();
+
+  return hr;
+}
+
+__control_entrypoint(DllExport)
+/// <summary>
+/// Determines whether the DLL that implements this function is in use. If not,
+/// the caller can unload the DLL from memory.
+/// </summary>
+/// <remarks>
+/// Once nothing else holds the DLL, background work keeps it loaded until
+/// none has been submitted for <see cref="BackgroundIdleLifetime"/> and none
+/// is running. Only then is the executor stopped, right before the DLL is
+/// unloaded.
+/// </remarks>
+/// <returns>If the function succeeds, the return value is <c>S_OK</c>.
+/// Otherwise, it is <c>S_FALSE</c>.</returns>
+extern "C" HRESULT __stdcall DllCanUnloadNow(void) {
+  if (g_cRefModule != 0) {
+    g_log.Flush();
+
+    return S_FALSE;
+  }
+
+  if (!StopBackgroundWork()) {
+    g_log.Flush();
+
+    return S_FALSE;
+  }
+
+  // Freed here rather than when the DLL is detached, which runs under the
+  // loader lock
+  ContextMenuCommand::DrainPool();
+  g_log.Flush();
+
+  return S_OK;
+}
+
+/// <summary>
+/// An optional entry point into a dynamic-link library (DLL). When the system
+/// starts or terminates a process or thread, it calls the entry-point function
+/// for each loaded DLL using the first thread of the process. The system also
+/// calls the entry-point function for a DLL when it is loaded or unloaded
+/// using the <c>LoadLibrary</c> and <c>FreeLibrary</c> functions.
+/// </summary>
+/// <param name="hinstDLL">A handle to the DLL module. The value is the base
+/// address of the DLL. The <c>HINSTANCE</c> of a DLL is the same as the
+/// <c>HMODULE</c> of the DLL, so <paramref name="hinstDLL"/> can be used in
+/// calls to functions that require a module handle.</param>
+/// <param name="fdwReason">The reason code that indicates why the DLL
+/// entry-point function is being called. This parameter can be one of the
+/// following values: <c>DLL_PROCESS_ATTACH</c>, <c>DLL_PROCESS_DETACH</c>,
+/// <c>DLL_THREAD_ATTACH</c>, and <c>DLL_THREAD_DETACH</c>.</param>
+/// <returns>The function returns <c>TRUE</c> if it succeeds or <c>FALSE</c>
+/// if initialization fails.</returns>
+extern "C" BOOL APIENTRY DllMain(HMODULE hinstDLL, DWORD fdwReason, LPVOID lpvReserved) {
+  if (fdwReason == DLL_PROCESS_ATTACH) DisableThreadLibraryCalls(hinstDLL);
+
+  // At process exit, other threads were terminated and may have held any
+  // lock, so nothing may be touched
+  if (fdwReason == DLL_PROCESS_DETACH && lpvReserved) return TRUE;
+
+  // Nothing is freed or flushed when the DLL is freed either, since that
+  // runs under the loader lock: DllCanUnloadNow has already drained the
+  // pool and flushed the log
+
+  return TRUE;
 }
\ No newline at end of file
@@ -1,3 +1,3 @@
-#include "guid.h"
-
+#include "guid.h"
+
 DEFINE_GUID(CLSID_GenericShellExHandler, 0x4f92cf35, 0x3c4c, 0x4b6e, 0xb6, 0x23, 0x41, 0xd1, 0x29, 0xc7, 0x2f, 0x08);
\ No newline at end of file
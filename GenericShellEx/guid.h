@@ -1,10 +1,7 @@
-#include "framework.h"
-
-#ifdef DEFINE_GUID
-
-DEFINE_GUID(CLSID_Null, 0x00000000L, 0x0000, 0x0000, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
-DEFINE_GUID(CLSID_StarContextMenuProvider, 0xff8b806eL, 0x83c6, 0x4df1, 0x9f, 0xb4, 0x69, 0x81, 0x33, 0x58, 0x08, 0x03);
-DEFINE_GUID(CLSID_DirectoryContextMenuProvider, 0xaeb1215cL, 0x84ff, 0x43cc, 0xae, 0xc7, 0xe0, 0x2c, 0x2b, 0x56, 0xe7, 0x4c);
-DEFINE_GUID(CLSID_DirectoryBackgroundContextMenuProvider, 0x92fd673fL, 0xd257, 0x4ac8, 0x87, 0x31, 0xc7, 0xcd, 0xe8, 0x2f, 0xa4, 0x9e);
-
+#include "framework.h"
+
+#ifdef DEFINE_GUID
+
+DEFINE_GUID(CLSID_Null, 0x00000000L, 0x0000, 0x0000, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include <chrono>
+#include <string>
+#include <benchmark/benchmark.h>
+
+#include "CommandTemplate.h"
+#include "Config.h"
+#include "Log.h"
+#include "MockShellItems.h"
+#include "SelectionPredicate.h"
+#include "Utf8.h"
+
+namespace {
+  constexpr auto NoDeadline = std::chrono::steady_clock::time_point::max();
+
+  /// <summary>
+  /// Generates a config with <paramref name="entries"/> entries whose
+  /// titles mix scripts, so that conversion takes every path.
+  /// </summary>
+  std::string MakeConfig(size_t entries) {
+    std::string text = "{\"types\":{";
+
+    for (size_t i = 0; i < entries; ++i) {
+      if (i) text += ',';
+
+      text += "\"*#" + std::to_string(i) + "\":{\"title\":\"Open \xC3\xA9\xE6\x97\xA5\xF0\x9F\x98\x80 " + std::to_string(i) + "\",";
+      text += "\"command\":\"\\\"C:\\\\Program Files\\\\App\\\\app.exe\\\" --profile default %*\",";
+      text += "\"when\":{\"extensions\":[\".c\",\".h\",\".cpp\"],\"paths\":[\"C:\\\\src\\\\**\"],\"maxCount\":64}}";
+    }
+
+    return text + "}}";
+  }
+
+  /// <summary>
+  /// Reads mock shell items of a shape, with paths.
+  /// </summary>
+  Selection ReadSelection(size_t count, PathShape shape) {
+    MockShellItems items(count, shape, 0);
+    Selection selection;
+
+    items.Read(selection, true, SIZE_MAX, NoDeadline);
+
+    return selection;
+  }
+
+  void ConvertUtf8(benchmark::State& state) {
+    std::string text = MakeConfig(static_cast<size_t>(state.range(0)));
+    std::wstring wide;
+
+    for (auto _ : state) {
+      ConvertUtf8ToWide(text, wide);
+      benchmark::DoNotOptimize(wide.data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+  }
+
+  void ParseConfigText(benchmark::State& state) {
+    std::string text = MakeConfig(static_cast<size_t>(state.range(0)));
+    Config config;
+
+    for (auto _ : state) {
+      ParseConfig(text, config);
+      benchmark::DoNotOptimize(config.bindings.data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+  }
+
+  /// <summary>
+  /// Expands a command of each shape, specialized when the second argument
+  /// is 1 and interpreted otherwise.
+  /// </summary>
+  void ExpandCommand(benchmark::State& state, const wchar_t* command) {
+    Selection selection = ReadSelection(static_cast<size_t>(state.range(0)), PathShape::Deep);
+    CommandTemplate compiled(command, state.range(1) != 0);
+    std::wstring result;
+
+    for (auto _ : state) {
+      compiled.Expand(selection, {}, result);
+      benchmark::DoNotOptimize(result.data());
+    }
+  }
+
+  void EvaluatePredicate(benchmark::State& state) {
+    Selection selection = ReadSelection(static_cast<size_t>(state.range(0)), PathShape::Deep);
+    SelectionPredicate predicate;
+
+    predicate.AddExtension(L".c");
+    predicate.AddExtension(L".h");
+    predicate.AddExtension(L".cpp");
+    predicate.AddPathGlob(L"C:\\src\\**\\impl\\**");
+
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(predicate.Evaluate(selection));
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * selection.Inspected()));
+  }
+
+  /// <summary>
+  /// Reads mock shell items one at a time when the second argument is 0 and
+  /// from their block of ID lists otherwise.
+  /// </summary>
+  void ReadShellItems(benchmark::State& state) {
+    MockShellItems items(static_cast<size_t>(state.range(0)), PathShape::Deep, 0);
+    Selection selection;
+
+    for (auto _ : state) {
+      if (state.range(1)) {
+        items.ReadIdList(selection, true);
+      } else {
+        items.ReadPerItem(selection, true);
+      }
+
+      benchmark::DoNotOptimize(selection.PathLength());
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * items.Count()));
+  }
+
+  void WriteLogLine(benchmark::State& state) {
+    Log log;
+    log.Open(nullptr);
+
+    for (auto _ : state) {
+      log.Line() << L"Expanded " << L"C:\\src\\project\\file.cpp" << L" in " << 1234 << L" us";
+    }
+  }
+}
+
+BENCHMARK(ConvertUtf8)->Arg(16)->Arg(1024);
+BENCHMARK(ParseConfigText)->Arg(16)->Arg(1024);
+BENCHMARK_CAPTURE(ExpandCommand, SingleItem, L"notepad.exe %1")->ArgsProduct({ { 1, 1000 }, { 0, 1 } });
+BENCHMARK_CAPTURE(ExpandCommand, RepeatAll, L"nvim -p %*")->ArgsProduct({ { 1, 1000 }, { 0, 1 } });
+BENCHMARK_CAPTURE(ExpandCommand, Mixed, L"tool %# %{--file %1}* %d")->ArgsProduct({ { 1, 1000 }, { 1 } });
+BENCHMARK(EvaluatePredicate)->Arg(16)->Arg(1024);
+BENCHMARK(ReadShellItems)->ArgsProduct({ { 16, 1024 }, { 0, 1 } });
+BENCHMARK(WriteLogLine);
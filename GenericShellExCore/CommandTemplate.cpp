@@ -0,0 +1,519 @@
+#include <algorithm>
+#include <cstring>
+
+#include "CommandTemplate.h"
+#include "ContextMenuEntry.h"
+#include "DirectoryMarkers.h"
+#include "SelectionPredicate.h"
+
+namespace {
+  void AppendQuoted(std::wstring& result, std::wstring_view argument) {
+    result.push_back(L'"');
+
+    // Paths almost never contain quotes, so only trailing backslashes need
+    // escaping and the rest is copied in one piece
+    if (argument.find(L'"') == std::wstring_view::npos) {
+      size_t end = argument.find_last_not_of(L'\\');
+      size_t trailing = end == std::wstring_view::npos ? argument.size() : argument.size() - end - 1;
+
+      result.append(argument);
+      result.append(trailing, L'\\');
+      result.push_back(L'"');
+
+      return;
+    }
+
+    size_t backslashes = 0;
+
+    for (wchar_t c : argument) {
+      if (c == L'\\') {
+        ++backslashes;
+      } else {
+        // Backslashes that precede a quote must be escaped along with it
+        if (c == L'"') result.append(backslashes + 1, L'\\');
+
+        backslashes = 0;
+      }
+
+      result.push_back(c);
+    }
+
+    result.append(backslashes, L'\\');
+    result.push_back(L'"');
+  }
+
+  std::wstring_view ItemPath(const SelectionItem& item) {
+    return std::wstring_view(item.path, item.length);
+  }
+
+  void AppendValue(std::wstring& result, std::wstring_view value) {
+    if (!value.empty()) AppendQuoted(result, value);
+  }
+
+  std::wstring_view FirstPath(const Selection& selection) {
+    for (size_t i = 0; i < selection.Inspected(); ++i) {
+      SelectionItem item = selection.Item(i);
+
+      if (item.length) return ItemPath(item);
+    }
+
+    return {};
+  }
+
+  std::wstring_view ItemName(std::wstring_view path) {
+    size_t separator = path.find_last_of(L"\\/");
+
+    return separator == std::wstring_view::npos ? path : path.substr(separator + 1);
+  }
+
+  /// <summary>
+  /// Gets the length of the prefix two strings share.
+  /// </summary>
+  size_t GetCommonPrefixLength(std::wstring_view a, std::wstring_view b) {
+    constexpr size_t Block = 16;
+
+    size_t length = std::min(a.size(), b.size());
+    size_t i = 0;
+
+    // A fixed-size comparison compiles to a few vector compares, and paths
+    // from one directory share dozens of characters
+    while (i + Block <= length && !std::memcmp(a.data() + i, b.data() + i, Block * sizeof(wchar_t))) i += Block;
+    while (i < length && a[i] == b[i]) ++i;
+
+    return i;
+  }
+
+  /// <summary>
+  /// Gets the offset of a name's extension, or its length if it has none.
+  /// A name that only starts with a dot, such as <c>.gitignore</c>, has
+  /// none.
+  /// </summary>
+  size_t ExtensionOffset(std::wstring_view name) {
+    size_t dot = name.rfind(L'.');
+
+    return dot == std::wstring_view::npos || dot == 0 ? name.size() : dot;
+  }
+
+  std::wstring_view RelativePath(std::wstring_view path, std::wstring_view directory) {
+    while (!directory.empty() && (directory.back() == L'\\' || directory.back() == L'/')) directory.remove_suffix(1);
+
+    if (directory.empty() || path.size() < directory.size()) return path;
+
+    // The directory is usually a prefix spelled the same way, so case is
+    // only folded from the first difference on
+    for (size_t i = GetCommonPrefixLength(path.substr(0, directory.size()), directory); i < directory.size(); ++i) {
+      if (SelectionPredicate::Fold(path[i]) != SelectionPredicate::Fold(directory[i])) return path;
+    }
+
+    if (path.size() == directory.size()) return L".";
+
+    if (path[directory.size()] != L'\\' && path[directory.size()] != L'/') return path;
+
+    return path.substr(directory.size() + 1);
+  }
+
+  /// <summary>
+  /// Appends an item's path, quoted, relative to <paramref
+  /// name="directory"/> if it is inside it.
+  /// </summary>
+  void AppendPath(std::wstring& result, std::wstring_view path, std::wstring_view directory) {
+    if (path.empty()) return;
+
+    std::wstring_view relative = directory.empty() ? path : RelativePath(path, directory);
+    size_t start = result.size();
+
+    AppendQuoted(result, relative);
+
+    // A relative path could be taken for an option
+    if (relative.size() != path.size() && (relative[0] == L'-' || relative[0] == L'/')) result.insert(start + 1, L".\\");
+  }
+
+  void AppendNumber(std::wstring& result, size_t number) {
+    wchar_t digits[20];
+    size_t length = 0;
+
+    do {
+      digits[length++] = static_cast<wchar_t>(L'0' + number % 10);
+      number /= 10;
+    } while (number);
+
+    while (length) result.push_back(digits[--length]);
+  }
+}
+
+std::wstring QuoteArgument(std::wstring_view argument) {
+  std::wstring result;
+  result.reserve(argument.size() + 2);
+
+  AppendQuoted(result, argument);
+
+  return result;
+}
+
+CommandTemplate::CommandTemplate() : expander(&ExpandShape<CommandTemplateShape::Literal>) {}
+
+CommandTemplate::CommandTemplate(std::wstring_view command, bool specialize) : CommandTemplate() {
+  text.reserve(command.size());
+  Parse(command, false);
+
+  // Only the parts outside fragments decide the shape
+  size_t placeholders = 0;
+  const Part* placeholder = nullptr;
+
+  for (size_t i = 0; i < parts.size(); ++i) {
+    if (parts[i].kind == PartKind::Literal) continue;
+
+    ++placeholders;
+    placeholder = &parts[i];
+
+    if (parts[i].kind == PartKind::Repeat) i += parts[i].length;
+  }
+
+  if (!placeholders) {
+    shape = CommandTemplateShape::Literal;
+  } else if (placeholders == 1 && placeholder->kind == PartKind::Item) {
+    shape = CommandTemplateShape::SingleItem;
+  } else if (placeholders == 1 && placeholder->kind == PartKind::All) {
+    shape = CommandTemplateShape::RepeatAll;
+  } else {
+    shape = CommandTemplateShape::Mixed;
+  }
+
+  // Literal text before the placeholder is always the first part
+  if (shape == CommandTemplateShape::SingleItem || shape == CommandTemplateShape::RepeatAll) {
+    split = parts[0].kind == PartKind::Literal ? parts[0].length : 0;
+  }
+
+  switch (specialize ? shape : CommandTemplateShape::Mixed) {
+  case CommandTemplateShape::Literal:
+    expander = &ExpandShape<CommandTemplateShape::Literal>;
+    break;
+  case CommandTemplateShape::SingleItem:
+    expander = &ExpandShape<CommandTemplateShape::SingleItem>;
+    break;
+  case CommandTemplateShape::RepeatAll:
+    expander = &ExpandShape<CommandTemplateShape::RepeatAll>;
+    break;
+  default:
+    expander = &ExpandShape<CommandTemplateShape::Mixed>;
+    break;
+  }
+}
+
+void CommandTemplate::AppendLiteral(std::wstring_view literal, size_t& literalPart) {
+  if (literal.empty()) return;
+
+  if (literalPart == SIZE_MAX) {
+    literalPart = parts.size();
+    parts.push_back({ PartKind::Literal, static_cast<uint32_t>(text.size()), 0 });
+  }
+
+  text.append(literal);
+  parts[literalPart].length += static_cast<uint32_t>(literal.size());
+}
+
+void CommandTemplate::Parse(std::wstring_view command, bool inFragment) {
+  // The literal part being extended, if the last part is one
+  size_t literalPart = SIZE_MAX;
+  size_t literalStart = 0;
+
+  for (size_t i = 0; i < command.size(); ++i) {
+    if (command[i] != L'%' || i + 1 == command.size()) continue;
+
+    std::wstring_view rest = command.substr(i);
+    PartKind kind = PartKind::Literal;
+    size_t length = 2;
+
+    if (rest.starts_with(RootPlaceholder)) {
+      kind = PartKind::Root;
+      length = RootPlaceholder.size();
+    } else if (rest[1] == L'{' && !inFragment) {
+      size_t end = rest.find(L"}*", 2);
+
+      if (end == std::wstring_view::npos) continue;
+
+      AppendLiteral(command.substr(literalStart, i - literalStart), literalPart);
+      literalPart = SIZE_MAX;
+
+      size_t repeat = parts.size();
+      parts.push_back({ PartKind::Repeat, 0, 0 });
+      Parse(rest.substr(2, end - 2), true);
+
+      size_t fragmentParts = parts.size() - repeat - 1;
+
+      // %{%1}* is %*
+      if (fragmentParts == 1 && parts[repeat + 1].kind == PartKind::Item) {
+        parts.pop_back();
+        parts[repeat].kind = PartKind::All;
+      } else if (!fragmentParts) {
+        parts.pop_back();
+      } else {
+        parts[repeat].length = static_cast<uint32_t>(fragmentParts);
+      }
+
+      i += end + 1;
+      literalStart = i + 1;
+
+      continue;
+    } else {
+      switch (rest[1]) {
+      case L'1': kind = PartKind::Item; break;
+      case L'*': kind = PartKind::All; break;
+      case L'd': kind = PartKind::Directory; break;
+      case L'n': kind = PartKind::Name; break;
+      case L'b': kind = PartKind::BaseName; break;
+      case L'x': kind = PartKind::Extension; break;
+      case L'r': kind = PartKind::Relative; break;
+      case L'#': kind = PartKind::Count; break;
+      }
+
+      if (kind == PartKind::Literal) continue;
+    }
+
+    AppendLiteral(command.substr(literalStart, i - literalStart), literalPart);
+
+    // A placeholder the user already quoted is quoted once, properly
+    bool quoted = kind != PartKind::Count && literalPart != SIZE_MAX && text.back() == L'"' && i + length < command.size() && command[i + length] == L'"';
+
+    if (quoted) {
+      text.pop_back();
+
+      if (!--parts[literalPart].length) parts.pop_back();
+
+      ++length;
+    }
+
+    parts.push_back({ kind, 0, 0 });
+    literalPart = SIZE_MAX;
+    usesRoot |= kind == PartKind::Root;
+
+    i += length - 1;
+    literalStart = i + 1;
+  }
+
+  AppendLiteral(command.substr(std::min(literalStart, command.size())), literalPart);
+}
+
+void CommandTemplate::AppendPart(const Part& part, std::wstring_view path, const Expansion& expansion, std::wstring& result) const {
+  switch (part.kind) {
+  case PartKind::Literal:
+    result.append(text, part.offset, part.length);
+    break;
+  case PartKind::Item:
+    AppendPath(result, path, expansion.context.relativePaths ? expansion.context.workingDirectory : std::wstring_view());
+    break;
+  case PartKind::All: {
+    std::wstring_view directory = expansion.context.relativePaths ? expansion.context.workingDirectory : std::wstring_view();
+    bool first = true;
+
+    for (size_t i = 0; i < expansion.selection.Inspected(); ++i) {
+      SelectionItem item = expansion.selection.Item(i);
+
+      if (!item.length) continue;
+
+      if (!first) result.push_back(L' ');
+
+      AppendPath(result, ItemPath(item), directory);
+      first = false;
+    }
+
+    break;
+  }
+  case PartKind::Directory:
+    AppendValue(result, path.substr(0, GetParentLength(path)));
+    break;
+  case PartKind::Name:
+    AppendValue(result, ItemName(path));
+    break;
+  case PartKind::BaseName: {
+    std::wstring_view name = ItemName(path);
+
+    AppendValue(result, name.substr(0, ExtensionOffset(name)));
+    break;
+  }
+  case PartKind::Extension: {
+    std::wstring_view name = ItemName(path);
+
+    AppendValue(result, name.substr(ExtensionOffset(name)));
+    break;
+  }
+  case PartKind::Relative:
+    AppendPath(result, path, expansion.context.workingDirectory);
+    break;
+  case PartKind::Count: {
+    size_t count = 0;
+
+    for (size_t i = 0; i < expansion.selection.Inspected(); ++i) {
+      if (expansion.selection.Item(i).length) ++count;
+    }
+
+    AppendNumber(result, count);
+    break;
+  }
+  case PartKind::Root:
+    AppendValue(result, expansion.context.root);
+    break;
+  default:
+    break;
+  }
+}
+
+void CommandTemplate::Interpret(const Expansion& expansion, std::wstring& result) const {
+  std::wstring_view firstPath = FirstPath(expansion.selection);
+
+  for (size_t i = 0; i < parts.size(); ++i) {
+    const Part& part = parts[i];
+
+    if (part.kind != PartKind::Repeat) {
+      AppendPart(part, firstPath, expansion, result);
+
+      continue;
+    }
+
+    bool first = true;
+
+    for (size_t j = 0; j < expansion.selection.Inspected(); ++j) {
+      SelectionItem item = expansion.selection.Item(j);
+
+      if (!item.length) continue;
+
+      if (!first) result.push_back(L' ');
+
+      for (size_t k = i + 1; k <= i + part.length; ++k) AppendPart(parts[k], ItemPath(item), expansion, result);
+
+      first = false;
+    }
+
+    i += part.length;
+  }
+}
+
+template <CommandTemplateShape Shape>
+void CommandTemplate::ExpandShape(const CommandTemplate& commandTemplate, const Expansion& expansion, std::wstring& result) {
+  const std::wstring& text = commandTemplate.text;
+
+  if constexpr (Shape == CommandTemplateShape::Literal) {
+    result.assign(text);
+  } else if constexpr (Shape == CommandTemplateShape::SingleItem) {
+    std::wstring_view path = FirstPath(expansion.selection);
+
+    result.clear();
+    result.reserve(text.size() + path.size() + 4);
+    result.append(text, 0, commandTemplate.split);
+    AppendPath(result, path, expansion.context.relativePaths ? expansion.context.workingDirectory : std::wstring_view());
+    result.append(text, commandTemplate.split);
+  } else if constexpr (Shape == CommandTemplateShape::RepeatAll) {
+    const Selection& selection = expansion.selection;
+    std::wstring_view directory = expansion.context.relativePaths ? expansion.context.workingDirectory : std::wstring_view();
+    size_t length = selection.PathLength();
+
+    // Relative paths drop the directory and its separator
+    if (!directory.empty()) length -= std::min(length, selection.Inspected() * (directory.size() + 1));
+
+    // Quotes and a separator per item; escapes are rare
+    result.clear();
+    result.reserve(text.size() + length + 3 * selection.Inspected());
+    result.append(text, 0, commandTemplate.split);
+
+    bool first = true;
+
+    for (size_t i = 0; i < selection.Inspected(); ++i) {
+      SelectionItem item = selection.Item(i);
+
+      if (!item.length) continue;
+
+      if (!first) result.push_back(L' ');
+
+      AppendPath(result, ItemPath(item), directory);
+      first = false;
+    }
+
+    result.append(text, commandTemplate.split);
+  } else {
+    result.clear();
+    commandTemplate.Interpret(expansion, result);
+  }
+}
+
+void CommandTemplate::Expand(const Selection& selection, const CommandContext& context, std::wstring& result) const {
+  expander(*this, Expansion{ selection, context }, result);
+}
+
+std::wstring CommandTemplate::Expand(const Selection& selection, const CommandContext& context) const {
+  std::wstring result;
+
+  Expand(selection, context, result);
+
+  return result;
+}
+
+void CompileCommandTemplates(ContextMenuEntry& entry) {
+  entry.commandTemplate = CommandTemplate(entry.command);
+  entry.forward.messageTemplate = CommandTemplate(entry.forward.message);
+
+  for (ContextMenuEntry& subCommand : entry.subCommands) {
+    CompileCommandTemplates(subCommand);
+  }
+}
+
+std::wstring GetDirectoryFromFirstItem(const Selection& selection) {
+  for (size_t i = 0; i < selection.Inspected(); ++i) {
+    std::wstring_view path = ItemPath(selection.Item(i));
+
+    if (path.empty()) continue;
+
+    return std::wstring(path.substr(0, GetParentLength(path)));
+  }
+
+  return L"";
+}
+
+std::wstring GetCommonParentDirectory(const Selection& selection) {
+  std::wstring_view first;
+  size_t common = 0;
+
+  for (size_t i = 0; i < selection.Inspected(); ++i) {
+    std::wstring_view path = ItemPath(selection.Item(i));
+
+    if (path.empty()) continue;
+
+    if (first.empty()) {
+      first = path;
+      common = path.size();
+
+      continue;
+    }
+
+    common = GetCommonPrefixLength(first.substr(0, common), path);
+
+    if (!common) return L"";
+  }
+
+  // The prefix may end partway through a name, as in C:\src\ab and
+  // C:\src\ac, so only what precedes its last separator is shared
+  size_t separator = first.substr(0, common).find_last_of(L"\\/");
+
+  if (separator == std::wstring_view::npos) return L"";
+
+  size_t root = GetRootLength(first);
+
+  if (!root || separator < root - 1) return L"";
+
+  return std::wstring(first.substr(0, std::max(separator, root)));
+}
+
+std::wstring GetCommandProgram(std::wstring_view command) {
+  size_t start = command.find_first_not_of(L" \t");
+
+  if (start == std::wstring_view::npos) return L"";
+
+  if (command[start] == L'"') {
+    size_t end = command.find(L'"', start + 1);
+
+    return std::wstring(command.substr(start + 1, end == std::wstring_view::npos ? std::wstring_view::npos : end - start - 1));
+  }
+
+  size_t end = command.find_first_of(L" \t", start);
+
+  return std::wstring(command.substr(start, end == std::wstring_view::npos ? std::wstring_view::npos : end - start));
+}
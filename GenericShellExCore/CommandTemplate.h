@@ -0,0 +1,260 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Selection.h"
+
+struct ContextMenuEntry;
+
+/// <summary>
+/// Quotes an argument so that <c>CommandLineToArgvW</c> and the C runtime
+/// parse it back unchanged.
+/// </summary>
+/// <remarks>
+/// Backslashes are only special before a double quote, so a trailing
+/// backslash, as in <c>C:\</c>, is doubled rather than allowed to escape
+/// the closing quote.
+/// </remarks>
+/// <param name="argument">The argument to quote.</param>
+/// <returns>The quoted argument.</returns>
+std::wstring QuoteArgument(std::wstring_view argument);
+
+/// <summary>
+/// The placeholder for the project directory of the first item.
+/// </summary>
+constexpr std::wstring_view RootPlaceholder = L"%root";
+
+/// <summary>
+/// The shapes of <see cref="CommandTemplate"/> that have an expander of
+/// their own.
+/// </summary>
+enum class CommandTemplateShape {
+  /// <summary>
+  /// No placeholders, so expanding copies the command.
+  /// </summary>
+  Literal,
+
+  /// <summary>
+  /// A single <c>%1</c> between literal text.
+  /// </summary>
+  SingleItem,
+
+  /// <summary>
+  /// A single <c>%*</c> between literal text.
+  /// </summary>
+  RepeatAll,
+
+  /// <summary>
+  /// Anything else, expanded by interpreting the template's parts.
+  /// </summary>
+  Mixed
+};
+
+/// <summary>
+/// What a <see cref="CommandTemplate"/> is expanded with besides the
+/// selection.
+/// </summary>
+struct CommandContext {
+  /// <summary>
+  /// The project directory, or an empty string to expand <c>%root</c> to
+  /// nothing.
+  /// </summary>
+  std::wstring_view root;
+
+  /// <summary>
+  /// The directory the command runs in, which <c>%r</c> is relative to, or
+  /// an empty string for full paths.
+  /// </summary>
+  std::wstring_view workingDirectory;
+
+  /// <summary>
+  /// Whether items are expanded relative to <see cref="workingDirectory"/>
+  /// too, which shortens <c>%1</c>, <c>%*</c> and fragments.
+  /// </summary>
+  bool relativePaths = false;
+};
+
+/// <summary>
+/// A command, or a forwarded message, compiled once so that invoking an
+/// entry only has to fill in its placeholders.
+/// </summary>
+/// <remarks>
+/// <para>These placeholders are expanded, quoted:</para>
+/// <list type="bullet">
+/// <item><c>%1</c>, the first item</item>
+/// <item><c>%*</c>, all items, separated by spaces</item>
+/// <item><c>%d</c>, the directory containing the first item</item>
+/// <item><c>%n</c>, the first item's name</item>
+/// <item><c>%b</c>, the first item's name without its extension</item>
+/// <item><c>%x</c>, the first item's extension, with its dot</item>
+/// <item><c>%r</c>, the first item's path relative to the working
+/// directory, or its full path if it is not inside it</item>
+/// <item><c>%root</c>, the project directory</item>
+/// </list>
+/// <para><c>%#</c> is expanded to the number of items, unquoted.
+/// <c>%{fragment}*</c> repeats the fragment for every item, separated by
+/// spaces, with <c>%1</c>, <c>%d</c>, <c>%n</c>, <c>%b</c>, <c>%x</c> and
+/// <c>%r</c> in it standing for that item. A placeholder already written in
+/// double quotes, as in <c>"%1"</c>, is quoted only once. Items without a
+/// path are skipped, and substituted values are never expanded again.</para>
+/// <para>With <see cref="CommandContext::relativePaths"/>, items inside the
+/// working directory are expanded as relative paths, like <c>%r</c>. A
+/// relative path that would start with <c>-</c> or <c>/</c> starts with
+/// <c>.\</c> instead, so it is not taken for an option.</para>
+/// <para>The common <see cref="CommandTemplateShape"/>s are expanded by
+/// their own instantiation of the expander, which copies the literal text
+/// around the placeholder in one piece and sizes the result up front.</para>
+/// </remarks>
+class CommandTemplate {
+  enum class PartKind : uint8_t {
+    Literal,
+    Item,
+    All,
+    Directory,
+    Name,
+    BaseName,
+    Extension,
+    Relative,
+    Count,
+    Root,
+
+    /// <summary>
+    /// The next <c>length</c> parts are repeated for every item.
+    /// </summary>
+    Repeat
+  };
+
+  struct Part {
+    PartKind kind;
+
+    /// <summary>
+    /// For a literal, the offset of its text in <see cref="text"/>.
+    /// </summary>
+    uint32_t offset;
+
+    /// <summary>
+    /// For a literal, the length of its text. For <see
+    /// cref="PartKind::Repeat"/>, the number of parts in the fragment.
+    /// </summary>
+    uint32_t length;
+  };
+
+  struct Expansion {
+    const Selection& selection;
+    const CommandContext& context;
+  };
+
+  using Expander = void (*)(const CommandTemplate& commandTemplate, const Expansion& expansion, std::wstring& result);
+
+  /// <summary>
+  /// The literal text, back to back.
+  /// </summary>
+  std::wstring text;
+
+  std::vector<Part> parts;
+
+  /// <summary>
+  /// For <see cref="CommandTemplateShape::SingleItem"/> and <see
+  /// cref="CommandTemplateShape::RepeatAll"/>, the offset in <see
+  /// cref="text"/> at which the placeholder goes.
+  /// </summary>
+  size_t split = 0;
+
+  CommandTemplateShape shape = CommandTemplateShape::Literal;
+  Expander expander;
+  bool usesRoot = false;
+
+  void Parse(std::wstring_view command, bool inFragment);
+  void AppendLiteral(std::wstring_view literal, size_t& literalPart);
+  void AppendPart(const Part& part, std::wstring_view path, const Expansion& expansion, std::wstring& result) const;
+  void Interpret(const Expansion& expansion, std::wstring& result) const;
+
+  template <CommandTemplateShape Shape>
+  static void ExpandShape(const CommandTemplate& commandTemplate, const Expansion& expansion, std::wstring& result);
+
+public:
+  /// <summary>
+  /// Initializes an empty <see cref="CommandTemplate"/>.
+  /// </summary>
+  CommandTemplate();
+
+  /// <summary>
+  /// Compiles a command.
+  /// </summary>
+  /// <param name="command">The command.</param>
+  /// <param name="specialize">Whether to pick the expander for the
+  /// command's shape, rather than interpret every shape as <see
+  /// cref="CommandTemplateShape::Mixed"/>, which is only useful for
+  /// measuring the difference.</param>
+  explicit CommandTemplate(std::wstring_view command, bool specialize = true);
+
+  /// <summary>
+  /// Expands the placeholders for a selection.
+  /// </summary>
+  /// <param name="selection">The selection, read with paths.</param>
+  /// <param name="context">The <see cref="CommandContext"/>.</param>
+  /// <param name="result">Receives the expanded command. Its capacity is
+  /// reused.</param>
+  void Expand(const Selection& selection, const CommandContext& context, std::wstring& result) const;
+
+  /// <summary>
+  /// Expands the placeholders for a selection.
+  /// </summary>
+  /// <param name="selection">The selection, read with paths.</param>
+  /// <param name="context">The <see cref="CommandContext"/>.</param>
+  /// <returns>The expanded command.</returns>
+  std::wstring Expand(const Selection& selection, const CommandContext& context = {}) const;
+
+  /// <summary>
+  /// The shape the command was compiled to.
+  /// </summary>
+  CommandTemplateShape Shape() const { return shape; }
+
+  /// <summary>
+  /// Whether the command has a <c>%root</c> placeholder, so that the
+  /// project directory must be found before expanding it.
+  /// </summary>
+  bool UsesRoot() const { return usesRoot; }
+};
+
+/// <summary>
+/// Compiles the command and forwarded message of an entry and all of its
+/// subcommands, once environment variables have been expanded in them.
+/// </summary>
+void CompileCommandTemplates(ContextMenuEntry& entry);
+
+/// <summary>
+/// Gets the directory containing the first item with a path.
+/// </summary>
+/// <param name="selection">The selection, read with paths.</param>
+/// <returns>A directory, or an empty string if there is none. A drive root
+/// keeps its separator.</returns>
+std::wstring GetDirectoryFromFirstItem(const Selection& selection);
+
+/// <summary>
+/// Gets the deepest directory that contains every item with a path.
+/// </summary>
+/// <remarks>
+/// The paths' common prefix is found a block of characters at a time, then
+/// cut back to the last separator in it. Paths are compared exactly, since
+/// items selected together share the spelling of their directory.
+/// </remarks>
+/// <param name="selection">The selection, read with paths.</param>
+/// <returns>A directory, or an empty string if the items are not on the
+/// same volume. A drive root keeps its separator.</returns>
+std::wstring GetCommonParentDirectory(const Selection& selection);
+
+/// <summary>
+/// Gets the program a command runs, which is its first argument.
+/// </summary>
+/// <remarks>
+/// The program ends at the closing quote if it is quoted and at the first
+/// space or tab otherwise, as <c>CreateProcessW</c> reads it.
+/// </remarks>
+/// <param name="command">The command.</param>
+/// <returns>The program, without quotes, or an empty string if there is
+/// none.</returns>
+std::wstring GetCommandProgram(std::wstring_view command);
@@ -0,0 +1,397 @@
+#include <algorithm>
+#include <utility>
+
+#include "Config.h"
+#include "Json.h"
+#include "Utf8.h"
+
+namespace {
+  /// <summary>
+  /// The title of an entry given as an array.
+  /// </summary>
+  constexpr const wchar_t* DefaultSubmenuTitle = L"Generic Shell Extensions";
+
+  /// <summary>
+  /// The attribute names accepted in a <c>when</c> clause's
+  /// <c>attributes</c> object.
+  /// </summary>
+  const std::pair<const char*, uint32_t> AttributeNames[] = {
+    { "readOnly", ItemAttributeReadOnly },
+    { "hidden", ItemAttributeHidden },
+    { "system", ItemAttributeSystem },
+    { "link", ItemAttributeLink },
+    { "compressed", ItemAttributeCompressed },
+    { "encrypted", ItemAttributeEncrypted },
+    { "slow", ItemAttributeSlow },
+    { "fileSystem", ItemAttributeFileSystem },
+    { "remote", ItemAttributeRemote }
+  };
+
+  /// <summary>
+  /// Converts a UTF-8 string from the config file to a <see
+  /// cref="std::wstring"/>.
+  /// </summary>
+  std::wstring ConvertToWString(std::string_view s) {
+    std::wstring wide;
+    ConvertUtf8ToWide(s, wide);
+
+    return wide;
+  }
+
+  /// <summary>
+  /// Reads the string property <paramref name="key"/> of <paramref
+  /// name="object"/> into <paramref name="value"/>, if it is a string.
+  /// </summary>
+  void ReadString(const JsonValue& object, const char* key, std::wstring& value) {
+    object[key].GetString(value);
+  }
+
+  /// <summary>
+  /// Compiles a <c>when</c> clause into a <see cref="SelectionPredicate"/>.
+  /// </summary>
+  /// <remarks>
+  /// Invalid conditions are reported and ignored.
+  /// </remarks>
+  SelectionPredicate CompileSelectionPredicate(const JsonValue& when, Config& config) {
+    SelectionPredicate predicate;
+    std::wstring value;
+
+    if (when["extensions"].IsArray()) {
+      for (JsonValue extension : when["extensions"]) {
+        if (!extension.GetString(value) || !predicate.AddExtension(value)) {
+          config.errors.push_back(L"Ignoring invalid extension");
+        }
+      }
+    }
+
+    if (when["paths"].IsArray()) {
+      for (JsonValue glob : when["paths"]) {
+        if (!glob.GetString(value) || !predicate.AddPathGlob(value)) {
+          config.errors.push_back(L"Ignoring invalid path glob");
+        }
+      }
+    }
+
+    if (when["minCount"].Exists() || when["maxCount"].Exists()) {
+      uint64_t minCount = 0;
+      uint64_t maxCount = SIZE_MAX;
+
+      when["minCount"].GetUnsigned(minCount);
+      when["maxCount"].GetUnsigned(maxCount);
+
+      predicate.SetCountBounds(static_cast<size_t>(minCount), static_cast<size_t>(std::min<uint64_t>(maxCount, SIZE_MAX)));
+    }
+
+    std::string itemType;
+
+    if (when["itemType"].GetString(itemType)) {
+      if (itemType == "file") {
+        predicate.SetItemType(PredicateItemType::File);
+      } else if (itemType == "directory") {
+        predicate.SetItemType(PredicateItemType::Directory);
+      } else if (itemType != "any") {
+        config.errors.push_back(L"Ignoring invalid item type " + ConvertToWString(itemType));
+      }
+    }
+
+    if (when["content"].IsArray()) {
+      uint64_t signatures = 0;
+      std::string signature;
+
+      for (JsonValue entry : when["content"]) {
+        uint64_t mask = entry.GetString(signature) ? config.signatures.Add(signature) : 0;
+
+        if (!mask) config.errors.push_back(L"Ignoring invalid content signature " + ConvertToWString(signature));
+
+        signatures |= mask;
+      }
+
+      if (signatures) predicate.SetContentSignatures(signatures);
+    }
+
+    if (when["markers"].IsArray()) {
+      uint64_t markers = 0;
+
+      for (JsonValue entry : when["markers"]) {
+        uint64_t mask = entry.GetString(value) ? config.markers.Add(value) : 0;
+
+        if (!mask) config.errors.push_back(L"Ignoring invalid directory marker");
+
+        markers |= mask;
+      }
+
+      if (markers) predicate.SetMarkers(markers);
+    }
+
+    JsonValue attributes = when["attributes"];
+
+    if (attributes.IsObject()) {
+      uint32_t required = ItemAttributeNone;
+      uint32_t forbidden = ItemAttributeNone;
+      std::string key;
+
+      for (JsonValue attribute : attributes) {
+        bool known = false;
+        bool set = false;
+
+        attribute.GetKey(key);
+
+        for (const auto& name : AttributeNames) {
+          if (key == name.first && attribute.GetBoolean(set)) {
+            (set ? required : forbidden) |= name.second;
+            known = true;
+          }
+        }
+
+        if (!known) {
+          config.errors.push_back(L"Ignoring invalid attribute " + ConvertToWString(key));
+        }
+      }
+
+      predicate.SetAttributes(required, forbidden);
+    }
+
+    uint64_t number = 0;
+
+    if (when["inspectLimit"].GetUnsigned(number)) {
+      predicate.SetInspectLimit(static_cast<size_t>(std::min<uint64_t>(number, SIZE_MAX)));
+    }
+
+    if (when["timeBudgetMs"].GetUnsigned(number)) {
+      predicate.SetTimeBudget(std::chrono::milliseconds(std::min<uint64_t>(number, UINT32_MAX)));
+    }
+
+    std::string fallback;
+
+    if (when["fallback"].GetString(fallback)) {
+      if (fallback == "enabled") {
+        predicate.SetFallback(VisibilityState::Enabled);
+      } else if (fallback == "disabled") {
+        predicate.SetFallback(VisibilityState::Disabled);
+      } else if (fallback == "hidden") {
+        predicate.SetFallback(VisibilityState::Hidden);
+      } else {
+        config.errors.push_back(L"Ignoring invalid fallback " + ConvertToWString(fallback));
+      }
+    }
+
+    std::string remoteItems;
+
+    if (when["remoteItems"].GetString(remoteItems)) {
+      if (remoteItems == "skip") {
+        predicate.SetRemoteItemPolicy(RemoteItemPolicy::Skip);
+      } else if (remoteItems == "fallback") {
+        predicate.SetRemoteItemPolicy(RemoteItemPolicy::Fallback);
+      } else {
+        config.errors.push_back(L"Ignoring invalid remote item policy " + ConvertToWString(remoteItems));
+      }
+    }
+
+    return predicate;
+  }
+
+  /// <summary>
+  /// Parses a <c>forward</c> block.
+  /// </summary>
+  /// <remarks>
+  /// A block without a pipe or window is reported and ignored.
+  /// </remarks>
+  ForwardTarget ParseForwardTarget(const JsonValue& forward, Config& config) {
+    ForwardTarget target;
+
+    if (forward["pipe"].GetString(target.endpoint)) {
+      target.kind = ForwardKind::Pipe;
+    } else if (forward["window"].GetString(target.endpoint)) {
+      target.kind = ForwardKind::Window;
+      ReadString(forward, "windowTitle", target.windowTitle);
+    } else {
+      config.errors.push_back(L"Ignoring forward without a pipe or window");
+
+      return ForwardTarget();
+    }
+
+    ReadString(forward, "message", target.message);
+
+    uint64_t number = 0;
+
+    if (forward["timeoutMs"].GetUnsigned(number)) {
+      target.timeout = std::chrono::milliseconds(std::min<uint64_t>(number, ForwardTarget::MaxTimeout.count()));
+    }
+
+    if (forward["copyDataId"].GetUnsigned(number)) {
+      target.copyDataId = static_cast<uint32_t>(std::min<uint64_t>(number, UINT32_MAX));
+    }
+
+    std::string encoding;
+
+    if (forward["encoding"].GetString(encoding)) {
+      if (encoding == "utf16") {
+        target.utf16 = true;
+      } else if (encoding != "utf8") {
+        config.errors.push_back(L"Ignoring invalid forward encoding " + ConvertToWString(encoding));
+      }
+    }
+
+    return target;
+  }
+
+  /// <summary>
+  /// Parses a <c>selection</c> block.
+  /// </summary>
+  /// <remarks>
+  /// An invalid sort key is reported and ignored.
+  /// </remarks>
+  SelectionOrder ParseSelectionOrder(const JsonValue& selection, Config& config) {
+    SelectionOrder order;
+
+    selection["unique"].GetBoolean(order.unique);
+    selection["descending"].GetBoolean(order.descending);
+
+    std::string sort;
+
+    if (selection["sort"].GetString(sort)) {
+      if (sort == "natural") {
+        order.sort = SelectionSortKey::Natural;
+      } else if (sort == "path") {
+        order.sort = SelectionSortKey::Path;
+      } else if (sort == "modified") {
+        order.sort = SelectionSortKey::Modified;
+      } else if (sort != "none") {
+        config.errors.push_back(L"Ignoring invalid sort " + ConvertToWString(sort));
+      }
+    }
+
+    uint64_t number = 0;
+
+    if (selection["limit"].GetUnsigned(number)) {
+      order.limit = static_cast<size_t>(std::min<uint64_t>(number, SIZE_MAX));
+    }
+
+    return order;
+  }
+
+  void ParseSubCommands(const JsonValue& subCommands, ContextMenuEntry& parent, Config& config);
+
+  /// <summary>
+  /// Parses a context command, including any subcommands.
+  /// </summary>
+  ContextMenuEntry ParseContextCommand(const JsonValue& entry, Config& config) {
+    ContextMenuEntry contextMenuEntry;
+
+    ReadString(entry, "title", contextMenuEntry.title);
+    ReadString(entry, "toolTip", contextMenuEntry.toolTip);
+    ReadString(entry, "icon", contextMenuEntry.icon);
+    ReadString(entry, "command", contextMenuEntry.command);
+    entry["prefetch"].GetBoolean(contextMenuEntry.prefetch);
+    entry["relativePaths"].GetBoolean(contextMenuEntry.relativePaths);
+
+    if (entry["forward"].IsObject()) {
+      contextMenuEntry.forward = ParseForwardTarget(entry["forward"], config);
+    }
+
+    if (entry["selection"].IsObject()) {
+      contextMenuEntry.order = ParseSelectionOrder(entry["selection"], config);
+    }
+
+    if (entry["when"].IsObject()) {
+      contextMenuEntry.when = CompileSelectionPredicate(entry["when"], config);
+    }
+
+    ParseSubCommands(entry["subCommands"], contextMenuEntry, config);
+
+    return contextMenuEntry;
+  }
+
+  /// <summary>
+  /// Parses an array of context commands into <paramref name="parent"/>'s
+  /// subcommands.
+  /// </summary>
+  void ParseSubCommands(const JsonValue& subCommands, ContextMenuEntry& parent, Config& config) {
+    if (!subCommands.IsArray()) return;
+
+    for (JsonValue subCommand : subCommands) {
+      if (subCommand.IsObject()) {
+        parent.subCommands.push_back(ParseContextCommand(subCommand, config));
+      }
+    }
+  }
+
+  /// <summary>
+  /// Parses a context command and the slot it asks to be bound to.
+  /// </summary>
+  void AddBinding(const JsonValue& entry, Config& config) {
+    ConfigBinding binding;
+    std::string type;
+
+    entry.GetKey(type);
+    binding.type = ConvertToWString(type);
+
+    if (entry.IsObject()) {
+      uint64_t slotIndex = 0;
+
+      if (entry["slot"].GetUnsigned(slotIndex)) {
+        binding.slotIndex = static_cast<size_t>(std::min<uint64_t>(slotIndex, SIZE_MAX));
+      } else {
+        ReadString(entry, "slot", binding.slotName);
+      }
+
+      binding.entry = ParseContextCommand(entry, config);
+    }
+
+    // MSIX only allows one top-level entry per type per CLSID, so an array
+    // is presented as subcommands of a single entry
+    else {
+      binding.entry.title = DefaultSubmenuTitle;
+
+      ParseSubCommands(entry, binding.entry, config);
+    }
+
+    config.bindings.push_back(std::move(binding));
+  }
+}
+
+bool ParseConfig(std::string_view text, Config& config) {
+  config = Config();
+
+  JsonDocument document;
+
+  if (!document.Parse(text)) {
+    config.errors.push_back(L"Config file is not valid JSON at byte " + std::to_wstring(document.ErrorOffset()));
+
+    return false;
+  }
+
+  JsonValue json = document.Root();
+
+  if (!json.IsObject()) {
+    config.errors.push_back(L"Config file is not a JSON object");
+
+    return false;
+  }
+
+  ReadString(json, "logFile", config.logFile);
+  json["iconCache"].GetBoolean(config.iconCache);
+  json["threadpool"].GetBoolean(config.threadpool);
+
+  uint64_t volumeTimeout = 0;
+
+  if (json["volumeTimeoutMs"].GetUnsigned(volumeTimeout)) {
+    config.volumeTimeout = std::chrono::milliseconds(std::min<uint64_t>(volumeTimeout, Config::MaxVolumeTimeout.count()));
+  }
+
+  JsonValue types = json["types"];
+
+  if (types.IsObject()) {
+    for (JsonValue entry : types) {
+      if (entry.IsObject() || entry.IsArray()) {
+        AddBinding(entry, config);
+      } else {
+        std::string type;
+        entry.GetKey(type);
+        config.errors.push_back(L"Ignoring type " + ConvertToWString(type) + L", which is neither an entry nor an array of entries");
+      }
+    }
+  }
+
+  return true;
+}
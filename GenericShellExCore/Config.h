@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ContentSignatures.h"
+#include "ContextMenuEntry.h"
+#include "DirectoryMarkers.h"
+
+/// <summary>
+/// A context menu entry and the CLSID slot it asks to be bound to.
+/// </summary>
+struct ConfigBinding {
+  /// <summary>
+  /// The key under <c>types</c>, such as <c>*</c> or <c>Directory</c>.
+  /// </summary>
+  std::wstring type;
+
+  /// <summary>
+  /// The slot name from the entry's <c>slot</c> property, or empty.
+  /// </summary>
+  std::wstring slotName;
+
+  /// <summary>
+  /// The slot index from the entry's <c>slot</c> property, or
+  /// <c>SIZE_MAX</c>.
+  /// </summary>
+  size_t slotIndex = SIZE_MAX;
+
+  ContextMenuEntry entry;
+};
+
+/// <summary>
+/// A parsed configuration file.
+/// </summary>
+struct Config {
+  /// <summary>
+  /// The longest volume timeout accepted, since waiting for a volume blocks
+  /// Explorer.
+  /// </summary>
+  static constexpr std::chrono::milliseconds MaxVolumeTimeout{ 5000 };
+
+  /// <summary>
+  /// The log file path, before environment variables are expanded, or
+  /// empty.
+  /// </summary>
+  std::wstring logFile;
+
+  /// <summary>
+  /// Whether icons taken from executables and DLLs should be extracted to
+  /// cached <c>.ico</c> files.
+  /// </summary>
+  bool iconCache = false;
+
+  /// <summary>
+  /// How long to wait for a network or removable volume to respond before
+  /// treating it as slow.
+  /// </summary>
+  std::chrono::milliseconds volumeTimeout{ 200 };
+
+  /// <summary>
+  /// Whether background work runs on a private Windows thread pool rather
+  /// than on the DLL's own threads.
+  /// </summary>
+  bool threadpool = false;
+
+  std::vector<ConfigBinding> bindings;
+
+  /// <summary>
+  /// The content signatures of every entry's conditions, which the entries'
+  /// predicates refer to by mask.
+  /// </summary>
+  ContentSignatures signatures;
+
+  /// <summary>
+  /// The directory markers of every entry's conditions, which the entries'
+  /// predicates refer to by mask.
+  /// </summary>
+  DirectoryMarkers markers;
+
+  /// <summary>
+  /// Problems found while parsing. Invalid values are ignored, so these are
+  /// only worth logging.
+  /// </summary>
+  std::vector<std::wstring> errors;
+};
+
+/// <summary>
+/// Parses a configuration file.
+/// </summary>
+/// <param name="text">The configuration file's contents.</param>
+/// <param name="config">Receives the configuration.</param>
+/// <returns><c>true</c> on success or <c>false</c> if <paramref
+/// name="text"/> is not a JSON object.</returns>
+bool ParseConfig(std::string_view text, Config& config);
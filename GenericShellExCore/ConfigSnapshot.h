@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+#include "ContentSignatures.h"
+#include "ContextMenuEntry.h"
+#include "DirectoryMarkers.h"
+
+/// <summary>
+/// A loaded configuration, with its context menu entries bound to CLSID
+/// slots.
+/// </summary>
+/// <remarks>
+/// Environment variables in the entries' strings are expanded when the
+/// snapshot is built. A snapshot is never modified once it is published. Commands keep a
+/// reference to the snapshot they were created from and present its entries
+/// without copying them, so a reload never disturbs a menu that is already
+/// open.
+/// </remarks>
+struct ConfigSnapshot {
+  /// <summary>
+  /// The log file path, with environment variables expanded, or empty.
+  /// </summary>
+  std::wstring logFile;
+
+  /// <summary>
+  /// How long to wait for a network or removable volume to respond.
+  /// </summary>
+  std::chrono::milliseconds volumeTimeout{ 200 };
+
+  /// <summary>
+  /// The context menu entries, indexed by CLSID slot. Slots the config file
+  /// does not bind are empty.
+  /// </summary>
+  std::vector<std::optional<ContextMenuEntry>> entries;
+
+  /// <summary>
+  /// The content signatures the entries' conditions refer to.
+  /// </summary>
+  ContentSignatures signatures;
+
+  /// <summary>
+  /// The directory markers the entries' conditions refer to.
+  /// </summary>
+  DirectoryMarkers markers;
+
+  /// <summary>
+  /// Initializes a <see cref="ConfigSnapshot"/>.
+  /// </summary>
+  /// <param name="slotCount">The number of CLSID slots.</param>
+  explicit ConfigSnapshot(size_t slotCount) : entries(slotCount) {}
+
+  /// <summary>
+  /// Gets the entry bound to a slot.
+  /// </summary>
+  /// <param name="slot">The slot index.</param>
+  /// <returns>The entry, or <c>nullptr</c> if <paramref name="slot"/> is not
+  /// bound.</returns>
+  const ContextMenuEntry* Entry(size_t slot) const {
+    return slot < entries.size() && entries[slot] ? &*entries[slot] : nullptr;
+  }
+};
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <numeric>
+
+#include "ContentSignatures.h"
+#include "Selection.h"
+
+namespace {
+  struct NamedSignature {
+    const char* name;
+    std::string_view patterns[3];
+  };
+
+  using namespace std::string_view_literals;
+
+  const NamedSignature NamedSignatures[] = {
+    { "pe", { "MZ"sv } },
+    { "elf", { "\x7F" "ELF"sv } },
+    { "pdf", { "%PDF-"sv } },
+    // Ordinary, empty and spanned archives
+    { "zip", { "PK\x03\x04"sv, "PK\x05\x06"sv, "PK\x07\x08"sv } },
+    { "shebang", { "#!"sv } }
+  };
+
+  int HexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+
+    return -1;
+  }
+
+  bool ParseHex(std::string_view hex, std::string& bytes) {
+    int high = -1;
+
+    for (char c : hex) {
+      if (c == ' ') {
+        // Spaces may only separate whole bytes
+        if (high >= 0) return false;
+
+        continue;
+      }
+
+      int digit = HexDigit(c);
+
+      if (digit < 0) return false;
+
+      if (high < 0) {
+        high = digit;
+      } else {
+        bytes.push_back(static_cast<char>(high << 4 | digit));
+        high = -1;
+      }
+    }
+
+    return high < 0 && !bytes.empty();
+  }
+}
+
+bool ContentSignatures::Parse(std::string_view signature, std::vector<std::string>& patterns) {
+  patterns.clear();
+
+  if (signature.starts_with("hex:")) {
+    std::string bytes;
+
+    if (!ParseHex(signature.substr(4), bytes)) return false;
+
+    patterns.push_back(std::move(bytes));
+  } else if (signature.starts_with("text:")) {
+    if (signature.size() == 5) return false;
+
+    patterns.emplace_back(signature.substr(5));
+  } else {
+    for (const NamedSignature& named : NamedSignatures) {
+      if (signature != named.name) continue;
+
+      for (std::string_view pattern : named.patterns) {
+        if (!pattern.empty()) patterns.emplace_back(pattern);
+      }
+    }
+
+    if (patterns.empty()) return false;
+  }
+
+  return std::all_of(patterns.begin(), patterns.end(), [](const std::string& pattern) { return pattern.size() <= MaxPatternLength; });
+}
+
+uint64_t ContentSignatures::Add(std::string_view signature) {
+  std::vector<std::string> parsed;
+
+  if (!Parse(signature, parsed)) return 0;
+
+  std::vector<std::string> added = patterns;
+  uint64_t mask = 0;
+
+  for (const std::string& pattern : parsed) {
+    auto existing = std::find(added.begin(), added.end(), pattern);
+
+    if (existing == added.end()) {
+      if (added.size() == MaxPatterns) return 0;
+
+      existing = added.insert(added.end(), pattern);
+    }
+
+    mask |= 1ull << (existing - added.begin());
+  }
+
+  patterns = std::move(added);
+  Rebuild();
+
+  return mask;
+}
+
+uint32_t ContentSignatures::Build(const std::vector<size_t>& order, size_t begin, size_t end, size_t depth) {
+  uint32_t index = static_cast<uint32_t>(nodes.size());
+
+  nodes.push_back({ 0, 0, 0 });
+
+  // Patterns that end here sort first
+  while (begin < end && patterns[order[begin]].size() == depth) {
+    nodes[index].accepts |= 1ull << order[begin];
+    ++begin;
+  }
+
+  // Reserve this node's edges together, then fill in their targets
+  uint32_t firstEdge = static_cast<uint32_t>(edges.size());
+
+  for (size_t i = begin; i < end; ++i) {
+    uint8_t byte = static_cast<uint8_t>(patterns[order[i]][depth]);
+
+    if (i == begin || static_cast<uint8_t>(patterns[order[i - 1]][depth]) != byte) edges.push_back({ byte, 0 });
+  }
+
+  nodes[index].firstEdge = firstEdge;
+  nodes[index].edgeCount = static_cast<uint32_t>(edges.size()) - firstEdge;
+
+  for (uint32_t edge = firstEdge; begin < end; ++edge) {
+    uint8_t byte = edges[edge].byte;
+    size_t groupEnd = begin;
+
+    while (groupEnd < end && static_cast<uint8_t>(patterns[order[groupEnd]][depth]) == byte) ++groupEnd;
+
+    uint32_t next = Build(order, begin, groupEnd, depth + 1);
+    edges[edge].next = next;
+    begin = groupEnd;
+  }
+
+  return index;
+}
+
+void ContentSignatures::Rebuild() {
+  std::vector<size_t> order(patterns.size());
+
+  std::iota(order.begin(), order.end(), size_t(0));
+  std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+    return std::lexicographical_compare(patterns[a].begin(), patterns[a].end(), patterns[b].begin(), patterns[b].end(), [](char x, char y) {
+      return static_cast<uint8_t>(x) < static_cast<uint8_t>(y);
+    });
+  });
+
+  nodes.clear();
+  edges.clear();
+  longest = 0;
+
+  for (const std::string& pattern : patterns) longest = std::max(longest, pattern.size());
+
+  Build(order, 0, order.size(), 0);
+}
+
+uint64_t ContentSignatures::Match(const void* data, size_t length) const {
+  if (nodes.empty()) return 0;
+
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  const Node* node = &nodes[0];
+  uint64_t mask = node->accepts;
+
+  for (size_t i = 0; i < length && node->edgeCount; ++i) {
+    const Edge* first = edges.data() + node->firstEdge;
+    const Edge* last = first + node->edgeCount;
+    const Edge* edge = std::lower_bound(first, last, bytes[i], [](const Edge& e, uint8_t byte) { return e.byte < byte; });
+
+    if (edge == last || edge->byte != bytes[i]) break;
+
+    node = &nodes[edge->next];
+    mask |= node->accepts;
+  }
+
+  return mask;
+}
+
+uint64_t ContentSignatures::Hash() const {
+  uint64_t hash = HashBytes(nullptr, 0);
+
+  for (const std::string& pattern : patterns) {
+    uint64_t size = pattern.size();
+
+    hash ^= HashBytes(&size, sizeof(size));
+    hash = hash * 0x100000001b3ull ^ HashBytes(pattern.data(), pattern.size());
+  }
+
+  return hash;
+}
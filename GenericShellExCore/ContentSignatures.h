@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// <summary>
+/// The byte patterns that files' contents are matched against, such as
+/// <c>MZ</c> at the start of a PE image, compiled into one anchored trie.
+/// </summary>
+/// <remarks>
+/// <para>Every pattern is anchored at the start of the file, so matching is
+/// a single walk down the trie over the first <see cref="Longest"/> bytes,
+/// which reports every pattern it passes through as one bit in a mask. A
+/// predicate matches a file if its own mask shares a bit with the
+/// file's.</para>
+/// <para>Matching never allocates.</para>
+/// </remarks>
+class ContentSignatures {
+public:
+  /// <summary>
+  /// The largest number of distinct patterns. The top bit of a mask is <see
+  /// cref="Unknown"/>.
+  /// </summary>
+  static constexpr size_t MaxPatterns = 63;
+
+  /// <summary>
+  /// The longest pattern accepted, in bytes.
+  /// </summary>
+  static constexpr size_t MaxPatternLength = 512;
+
+  /// <summary>
+  /// A mask bit meaning that a file's contents could not be read in time.
+  /// </summary>
+  static constexpr uint64_t Unknown = 1ull << 63;
+
+private:
+  struct Node {
+    uint32_t firstEdge;
+    uint32_t edgeCount;
+    uint64_t accepts;
+  };
+
+  struct Edge {
+    uint8_t byte;
+    uint32_t next;
+  };
+
+  std::vector<std::string> patterns;
+  std::vector<Node> nodes;
+  std::vector<Edge> edges;
+  size_t longest = 0;
+
+  uint32_t Build(const std::vector<size_t>& order, size_t begin, size_t end, size_t depth);
+  void Rebuild();
+
+public:
+  /// <summary>
+  /// Parses a signature into the patterns it stands for.
+  /// </summary>
+  /// <remarks>
+  /// A signature is one of the names <c>pe</c>, <c>elf</c>, <c>pdf</c>,
+  /// <c>zip</c>, and <c>shebang</c>, <c>hex:</c> followed by hexadecimal
+  /// bytes, which may be separated by spaces, or <c>text:</c> followed by
+  /// literal text.
+  /// </remarks>
+  /// <param name="signature">The signature.</param>
+  /// <param name="patterns">Receives the patterns.</param>
+  /// <returns><c>true</c> on success or <c>false</c> if <paramref
+  /// name="signature"/> is not valid.</returns>
+  static bool Parse(std::string_view signature, std::vector<std::string>& patterns);
+
+  /// <summary>
+  /// Adds a signature's patterns.
+  /// </summary>
+  /// <param name="signature">The signature, as accepted by <see
+  /// cref="Parse"/>.</param>
+  /// <returns>The mask of the signature's patterns, or zero if <paramref
+  /// name="signature"/> is not valid or there would be more than <see
+  /// cref="MaxPatterns"/> patterns.</returns>
+  uint64_t Add(std::string_view signature);
+
+  /// <summary>
+  /// Matches the start of a file's contents against every pattern.
+  /// </summary>
+  /// <param name="data">The first bytes of the file.</param>
+  /// <param name="length">The number of bytes, which may be fewer than <see
+  /// cref="Longest"/> for short files.</param>
+  /// <returns>The mask of the patterns that match.</returns>
+  uint64_t Match(const void* data, size_t length) const;
+
+  /// <summary>
+  /// Whether any pattern has been added.
+  /// </summary>
+  bool IsEmpty() const { return patterns.empty(); }
+
+  /// <summary>
+  /// The length of the longest pattern, which is how much of a file must be
+  /// read.
+  /// </summary>
+  size_t Longest() const { return longest; }
+
+  /// <summary>
+  /// Hashes the patterns, so that masks cached for one set of patterns are
+  /// not mistaken for another's.
+  /// </summary>
+  uint64_t Hash() const;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "CommandTemplate.h"
+#include "ForwardTarget.h"
+#include "SelectionOrder.h"
+#include "SelectionPredicate.h"
+
+/// <summary>
+/// A context menu entry.
+/// </summary>
+struct ContextMenuEntry {
+  std::wstring title;
+  std::wstring toolTip;
+  std::wstring icon;
+  std::wstring command;
+
+  /// <summary>
+  /// <see cref="command"/>, compiled once environment variables have been
+  /// expanded in it.
+  /// </summary>
+  CommandTemplate commandTemplate;
+
+  /// <summary>
+  /// Whether to start the command in the selection's common parent
+  /// directory and pass paths relative to it, which keeps long selections
+  /// within the command line limit.
+  /// </summary>
+  bool relativePaths = false;
+
+  /// <summary>
+  /// How the selection is deduplicated, sorted and capped before the
+  /// command is expanded.
+  /// </summary>
+  SelectionOrder order;
+
+  /// <summary>
+  /// Whether to prepare the launch in the background once the entry is
+  /// shown, ahead of it being invoked.
+  /// </summary>
+  bool prefetch = false;
+
+  /// <summary>
+  /// The running instance to try before starting a new process.
+  /// </summary>
+  ForwardTarget forward;
+
+  SelectionPredicate when;
+  std::vector<ContextMenuEntry> subCommands;
+};
\ No newline at end of file
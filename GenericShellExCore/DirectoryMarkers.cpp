@@ -0,0 +1,90 @@
+#include <algorithm>
+
+#include "DirectoryMarkers.h"
+#include "SelectionPredicate.h"
+
+namespace {
+  bool IsSeparator(wchar_t c) {
+    return c == L'\\' || c == L'/';
+  }
+
+  bool EqualsIgnoringCase(std::wstring_view a, std::wstring_view b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](wchar_t x, wchar_t y) {
+      return SelectionPredicate::Fold(x) == SelectionPredicate::Fold(y);
+    });
+  }
+}
+
+uint64_t DirectoryMarkers::Add(std::wstring_view name) {
+  if (name.empty() || name == L"." || name == L"..") return 0;
+
+  if (std::any_of(name.begin(), name.end(), [](wchar_t c) { return c < L' ' || std::wstring_view(L"\\/:*?\"<>|").find(c) != std::wstring_view::npos; })) {
+    return 0;
+  }
+
+  // Names on Windows are not case-sensitive
+  for (size_t i = 0; i < names.size(); ++i) {
+    if (EqualsIgnoringCase(names[i], name)) return 1ull << i;
+  }
+
+  if (names.size() == MaxMarkers) return 0;
+
+  names.emplace_back(name);
+
+  return 1ull << (names.size() - 1);
+}
+
+uint64_t DirectoryMarkers::Hash() const {
+  uint64_t hash = HashBytes(nullptr, 0);
+
+  for (const std::wstring& name : names) {
+    uint64_t size = name.size();
+
+    hash ^= HashBytes(&size, sizeof(size));
+    hash = hash * 0x100000001b3ull ^ HashBytes(name.data(), name.size() * sizeof(wchar_t));
+  }
+
+  return hash;
+}
+
+size_t GetRootLength(std::wstring_view path) {
+  if (path.size() >= 2 && path[1] == L':') return path.size() >= 3 && IsSeparator(path[2]) ? 3 : 2;
+
+  if (path.size() >= 2 && IsSeparator(path[0]) && IsSeparator(path[1])) {
+    size_t end = path.find_first_of(L"\\/", 2);
+
+    if (end == std::wstring_view::npos) return path.size();
+
+    // The share is part of the root
+    end = path.find_first_of(L"\\/", end + 1);
+
+    return end == std::wstring_view::npos ? path.size() : end;
+  }
+
+  return !path.empty() && IsSeparator(path[0]) ? 1 : 0;
+}
+
+size_t GetParentLength(std::wstring_view path) {
+  size_t root = GetRootLength(path);
+  size_t length = path.size();
+
+  while (length > root && IsSeparator(path[length - 1])) --length;
+
+  if (length <= root) return 0;
+
+  size_t separator = path.find_last_of(L"\\/", length - 1);
+
+  if (separator == std::wstring_view::npos || separator < root) return root;
+
+  while (separator > root && IsSeparator(path[separator - 1])) --separator;
+
+  return separator;
+}
+
+std::wstring_view GetMarkerDirectory(const SelectionItem& item) {
+  std::wstring_view path(item.path, item.length);
+
+  if ((item.attributes & ItemAttributeDirectory) && !(item.attributes & ItemAttributeRemote)) return path;
+
+  return path.substr(0, GetParentLength(path));
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Selection.h"
+
+/// <summary>
+/// The names of the files and directories, such as <c>.git</c> or
+/// <c>package.json</c>, whose presence marks a directory as the root of a
+/// project.
+/// </summary>
+/// <remarks>
+/// Each name is one bit in a mask. An item's mask holds the markers found
+/// in its directory or any ancestor, and a predicate matches the item if its
+/// own mask shares a bit with the item's.
+/// </remarks>
+class DirectoryMarkers {
+public:
+  /// <summary>
+  /// The largest number of distinct markers. The top bit of a mask is <see
+  /// cref="Unknown"/>.
+  /// </summary>
+  static constexpr size_t MaxMarkers = 63;
+
+  /// <summary>
+  /// A mask bit meaning that an item's ancestors could not be probed in
+  /// time.
+  /// </summary>
+  static constexpr uint64_t Unknown = 1ull << 63;
+
+private:
+  std::vector<std::wstring> names;
+
+public:
+  /// <summary>
+  /// Adds a marker.
+  /// </summary>
+  /// <param name="name">The name of the file or directory, without a
+  /// path.</param>
+  /// <returns>The marker's mask, or zero if <paramref name="name"/> is not a
+  /// valid name or there would be more than <see cref="MaxMarkers"/>
+  /// markers.</returns>
+  uint64_t Add(std::wstring_view name);
+
+  /// <summary>
+  /// Whether any marker has been added.
+  /// </summary>
+  bool IsEmpty() const { return names.empty(); }
+
+  /// <summary>
+  /// The number of markers.
+  /// </summary>
+  size_t Count() const { return names.size(); }
+
+  /// <summary>
+  /// Gets the name of the marker with mask bit <c>1 &lt;&lt; index</c>.
+  /// </summary>
+  const std::wstring& Name(size_t index) const { return names[index]; }
+
+  /// <summary>
+  /// Hashes the names, so that masks cached for one set of markers are not
+  /// mistaken for another's.
+  /// </summary>
+  uint64_t Hash() const;
+};
+
+/// <summary>
+/// Gets the length of a path's root, such as <c>C:\</c> or
+/// <c>\\server\share</c>.
+/// </summary>
+/// <param name="path">The path.</param>
+/// <returns>The length of the root, or zero for a relative path.</returns>
+size_t GetRootLength(std::wstring_view path);
+
+/// <summary>
+/// Gets the length of the directory containing a path.
+/// </summary>
+/// <remarks>
+/// The parent of <c>C:\src</c> is <c>C:\</c>, with its separator, and the
+/// parent of <c>\\server\share\src</c> is <c>\\server\share</c>. Roots have
+/// no parent.
+/// </remarks>
+/// <param name="path">The path, which may end in a separator.</param>
+/// <returns>The length of the parent directory's path within <paramref
+/// name="path"/>, or zero if it has none.</returns>
+size_t GetParentLength(std::wstring_view path);
+
+/// <summary>
+/// Gets the directory the markers for an item are looked for from first.
+/// </summary>
+/// <remarks>
+/// That is the item itself if it is a directory, so that a project folder
+/// and its background find the project, and the item's parent otherwise.
+/// Remote directories are not looked in, since that would populate
+/// them.
+/// </remarks>
+/// <param name="item">The item, read with its path.</param>
+/// <returns>The directory, which points into <paramref name="item"/>'s
+/// path, or an empty string if it has none.</returns>
+std::wstring_view GetMarkerDirectory(const SelectionItem& item);
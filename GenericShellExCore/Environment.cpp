@@ -0,0 +1,87 @@
+#include "Environment.h"
+
+namespace {
+  bool IsNameCharacter(wchar_t c) {
+    return (c >= L'A' && c <= L'Z') || (c >= L'a' && c <= L'z') || (c >= L'0' && c <= L'9') || c == L'_' || c == L'(' || c == L')';
+  }
+
+  /// <summary>
+  /// Gets the length of the variable name starting at <paramref
+  /// name="text"/>, or <c>0</c> if there is no valid name terminated by
+  /// <c>%</c>.
+  /// </summary>
+  size_t NameLength(std::wstring_view text) {
+    if (text.empty() || (text[0] >= L'0' && text[0] <= L'9')) return 0;
+
+    size_t length = 0;
+
+    while (length < text.size() && IsNameCharacter(text[length])) ++length;
+
+    return length < text.size() && text[length] == L'%' ? length : 0;
+  }
+}
+
+const std::optional<std::wstring>& EnvironmentExpander::Value(std::wstring_view name) {
+  std::wstring key(name);
+  auto value = values.find(key);
+
+  if (value == values.end()) value = values.emplace(key, lookup(key)).first;
+
+  return value->second;
+}
+
+std::wstring EnvironmentExpander::Expand(std::wstring_view text) {
+  std::wstring result;
+  result.reserve(text.size());
+
+  size_t i = 0;
+
+  while (i < text.size()) {
+    size_t percent = text.find(L'%', i);
+
+    if (percent == std::wstring_view::npos) {
+      result.append(text.substr(i));
+
+      break;
+    }
+
+    result.append(text.substr(i, percent - i));
+
+    size_t nameLength = NameLength(text.substr(percent + 1));
+
+    if (!nameLength) {
+      // Not a reference, such as %1 or a lone percent sign, so carry on
+      // after it in case a reference follows
+      result.push_back(L'%');
+      i = percent + 1;
+
+      continue;
+    }
+
+    const std::optional<std::wstring>& value = Value(text.substr(percent + 1, nameLength));
+
+    if (value) {
+      result.append(*value);
+    } else {
+      result.append(text.substr(percent, nameLength + 2));
+    }
+
+    i = percent + nameLength + 2;
+  }
+
+  return result;
+}
+
+void EnvironmentExpander::Expand(ContextMenuEntry& entry) {
+  entry.title = Expand(entry.title);
+  entry.toolTip = Expand(entry.toolTip);
+  entry.icon = Expand(entry.icon);
+  entry.command = Expand(entry.command);
+  entry.forward.endpoint = Expand(entry.forward.endpoint);
+  entry.forward.windowTitle = Expand(entry.forward.windowTitle);
+  entry.forward.message = Expand(entry.forward.message);
+
+  for (ContextMenuEntry& subCommand : entry.subCommands) {
+    Expand(subCommand);
+  }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include "ContextMenuEntry.h"
+
+/// <summary>
+/// Expands <c>%NAME%</c> environment variable references, remembering each
+/// variable it looks up.
+/// </summary>
+/// <remarks>
+/// <para>One expander is used to build one configuration snapshot, so each
+/// variable is looked up at most once per snapshot, and nothing is expanded
+/// when a menu is displayed.</para>
+/// <para>Only names made of letters, digits, <c>_</c>, <c>(</c> and
+/// <c>)</c> that do not start with a digit are expanded, which leaves
+/// command placeholders such as <c>%1</c> and <c>%*</c> alone. Unknown
+/// variables are left as written.</para>
+/// <para>Values are copied as they are, without expanding them again or
+/// escaping them. Commands are expanded before they are compiled, so a
+/// <c>%1</c> or <c>%*</c> inside a variable's value acts as a
+/// placeholder.</para>
+/// </remarks>
+class EnvironmentExpander {
+public:
+  /// <summary>
+  /// Looks up an environment variable.
+  /// </summary>
+  /// <returns>The variable's value, or <c>std::nullopt</c> if it is not
+  /// set.</returns>
+  using Lookup = std::function<std::optional<std::wstring>(const std::wstring& name)>;
+
+private:
+  Lookup lookup;
+
+  std::unordered_map<std::wstring, std::optional<std::wstring>> values;
+
+  const std::optional<std::wstring>& Value(std::wstring_view name);
+
+public:
+  /// <summary>
+  /// Initializes an <see cref="EnvironmentExpander"/>.
+  /// </summary>
+  /// <param name="lookup">Looks up environment variables.</param>
+  explicit EnvironmentExpander(Lookup lookup) : lookup(std::move(lookup)) {}
+
+  /// <summary>
+  /// Expands environment variable references in <paramref name="text"/>.
+  /// </summary>
+  /// <param name="text">The text to expand.</param>
+  /// <returns>The expanded text.</returns>
+  std::wstring Expand(std::wstring_view text);
+
+  /// <summary>
+  /// Expands environment variable references in every string of an entry
+  /// and its subcommands, in place.
+  /// </summary>
+  /// <param name="entry">The entry to expand.</param>
+  void Expand(ContextMenuEntry& entry);
+};
@@ -0,0 +1,181 @@
+#include <system_error>
+#include "Executor.h"
+
+namespace {
+  /// <summary>
+  /// The executor and worker the current thread belongs to, if any, so that
+  /// work submitted from running work stays on its worker.
+  /// </summary>
+  thread_local const StealingExecutor* currentExecutor = nullptr;
+  thread_local size_t currentWorker = 0;
+}
+
+StealingExecutor::StealingExecutor(size_t threads) {
+  workers.reserve(threads);
+
+  for (size_t i = 0; i < threads; ++i) {
+    workers.push_back(std::make_unique<Worker>());
+  }
+
+  // Every worker exists before any thread starts, since threads look at
+  // each other's queues
+  for (; this->threads < threads; ++this->threads) {
+    try {
+      workers[this->threads]->thread = std::thread(&StealingExecutor::Work, this, this->threads);
+    } catch (const std::system_error&) {
+      break;
+    }
+  }
+
+  if (!this->threads) workers.clear();
+}
+
+StealingExecutor::~StealingExecutor() {
+  Stop();
+
+  if (joined) return;
+
+  for (const std::unique_ptr<Worker>& worker : workers) {
+    if (worker->thread.joinable()) worker->thread.join();
+  }
+}
+
+bool StealingExecutor::Submit(WorkPriority priority, WorkItem item) {
+  if (workers.empty()) return false;
+
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+
+    if (stopping.load(std::memory_order_relaxed)) return false;
+
+    pending.fetch_add(1);
+  }
+
+  size_t index = currentExecutor == this ? currentWorker : next.fetch_add(1, std::memory_order_relaxed) % workers.size();
+  Worker& worker = *workers[index];
+
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+
+    worker.queues[static_cast<size_t>(priority)].push_back(item);
+  }
+
+  wake.notify_one();
+
+  return true;
+}
+
+bool StealingExecutor::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+
+    stopping.store(true);
+  }
+
+  wake.notify_all();
+  Cancel();
+
+  // Work taken before its queue was drained has been counted by now
+  if (running.load()) return false;
+
+  if (!joined) {
+    for (const std::unique_ptr<Worker>& worker : workers) {
+      if (worker->thread.joinable()) worker->thread.join();
+    }
+
+    joined = true;
+  }
+
+  return true;
+}
+
+void StealingExecutor::Work(size_t index) {
+  currentExecutor = this;
+  currentWorker = index;
+
+  for (;;) {
+    WorkItem item;
+
+    if (Take(index, item)) {
+      // Work queued while the executor was being stopped is cancelled too
+      bool cancel = stopping.load();
+
+      item.run(item.context, cancel);
+      (cancel ? cancelled : executed).fetch_add(1, std::memory_order_relaxed);
+      running.fetch_sub(1);
+
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleepMutex);
+
+    // An item counted but not yet queued is waited for by looking again
+    wake.wait(lock, [this] { return pending.load() || stopping.load(); });
+
+    if (stopping.load() && !pending.load()) return;
+  }
+}
+
+bool StealingExecutor::Take(size_t index, WorkItem& item) {
+  for (size_t priority = 0; priority < WorkPriorityCount; ++priority) {
+    {
+      Worker& own = *workers[index];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      std::deque<WorkItem>& queue = own.queues[priority];
+
+      if (!queue.empty()) {
+        item = queue.back();
+        queue.pop_back();
+        running.fetch_add(1);
+        pending.fetch_sub(1);
+
+        return true;
+      }
+    }
+
+    for (size_t i = 1; i < workers.size(); ++i) {
+      Worker& other = *workers[(index + i) % workers.size()];
+      std::lock_guard<std::mutex> lock(other.mutex);
+      std::deque<WorkItem>& queue = other.queues[priority];
+
+      if (!queue.empty()) {
+        item = queue.front();
+        queue.pop_front();
+        running.fetch_add(1);
+        pending.fetch_sub(1);
+        stolen.fetch_add(1, std::memory_order_relaxed);
+
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+void StealingExecutor::Cancel() {
+  for (const std::unique_ptr<Worker>& worker : workers) {
+    std::deque<WorkItem> drained[WorkPriorityCount];
+    size_t count = 0;
+
+    {
+      std::lock_guard<std::mutex> lock(worker->mutex);
+
+      for (size_t priority = 0; priority < WorkPriorityCount; ++priority) {
+        drained[priority].swap(worker->queues[priority]);
+        count += drained[priority].size();
+      }
+    }
+
+    // Uncounted at once, so idle workers do not look for them meanwhile
+    pending.fetch_sub(count);
+
+    // Cancelled work runs without the lock, since it may try to submit more
+    for (std::deque<WorkItem>& queue : drained) {
+      for (const WorkItem& item : queue) {
+        item.run(item.context, true);
+        cancelled.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  }
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// How urgent a piece of background work is. Lower values run first.
+/// </summary>
+enum class WorkPriority {
+  /// <summary>
+  /// Work that someone on Explorer's thread is waiting for.
+  /// </summary>
+  Interactive,
+
+  /// <summary>
+  /// Work that makes a later request faster, such as preparing a launch.
+  /// </summary>
+  Prefetch,
+
+  /// <summary>
+  /// Work that nobody waits for, such as flushing the log.
+  /// </summary>
+  Housekeeping
+};
+
+/// <summary>
+/// The number of <see cref="WorkPriority"/> values.
+/// </summary>
+constexpr size_t WorkPriorityCount = 3;
+
+/// <summary>
+/// A piece of background work.
+/// </summary>
+/// <remarks>
+/// Work is a function and a context rather than a closure, so submitting it
+/// allocates nothing beyond what the caller already has.
+/// </remarks>
+struct WorkItem {
+  /// <summary>
+  /// Runs the work. <c>cancelled</c> is <c>true</c> if the executor stopped
+  /// before the work started, in which case the function only releases
+  /// <c>context</c>.
+  /// </summary>
+  void (*run)(void* context, bool cancelled) = nullptr;
+
+  void* context = nullptr;
+};
+
+/// <summary>
+/// Runs background work on a small, fixed number of threads.
+/// </summary>
+/// <remarks>
+/// <para>An executor is stopped before the module that submitted work to it
+/// is unloaded. Stopping cancels work that has not started, and work that
+/// has started finishes on its own: long-running work polls <see
+/// cref="IsStopping"/>.</para>
+/// <para>Work that can block for long, such as touching a network volume,
+/// does not belong on an executor, since a few such items hold every one of
+/// its threads.</para>
+/// <para>All members other than <see cref="Stop"/> are safe to call from
+/// any thread, including from running work. <see cref="Stop"/> is called
+/// by the executor's owner, from one thread at a time, and never from
+/// running work.</para>
+/// </remarks>
+class Executor {
+public:
+  virtual ~Executor() = default;
+
+  /// <summary>
+  /// Queues work.
+  /// </summary>
+  /// <param name="priority">How urgent the work is.</param>
+  /// <param name="item">The work.</param>
+  /// <returns><c>true</c> if the work will run or be cancelled, or
+  /// <c>false</c> if it was not queued because the executor is stopping,
+  /// in which case the caller still owns its context.</returns>
+  virtual bool Submit(WorkPriority priority, WorkItem item) = 0;
+
+  /// <summary>
+  /// Stops the executor, cancelling work that has not started.
+  /// </summary>
+  /// <returns><c>true</c> if no work is running and the threads are gone,
+  /// or <c>false</c> if work is still running, in which case <see
+  /// cref="Stop"/> is called again later.</returns>
+  virtual bool Stop() = 0;
+
+  /// <summary>
+  /// Whether <see cref="Stop"/> has been called.
+  /// </summary>
+  virtual bool IsStopping() const = 0;
+};
+
+/// <summary>
+/// An <see cref="Executor"/> with its own threads, each with a queue per
+/// priority, that take work from each other when idle.
+/// </summary>
+/// <remarks>
+/// <para>Work submitted from a worker goes to that worker's queues, and
+/// other work to each worker in turn. A worker takes the most urgent work
+/// it can find: its own newest work of a priority first, then the oldest
+/// of that priority from another worker, before looking at the next
+/// priority.</para>
+/// <para>Queues are guarded by a lock each, rather than being lock-free,
+/// since background work in a shell extension is measured in tens of items
+/// rather than millions.</para>
+/// </remarks>
+class StealingExecutor : public Executor {
+  struct Worker {
+    std::mutex mutex;
+    std::deque<WorkItem> queues[WorkPriorityCount];
+    std::thread thread;
+  };
+
+  /// <summary>
+  /// The workers. Those whose threads could not be started keep their
+  /// queues, which the others take from.
+  /// </summary>
+  std::vector<std::unique_ptr<Worker>> workers;
+  size_t threads = 0;
+
+  /// <summary>
+  /// Guards sleeping and waking, and <see cref="stopping"/> being set.
+  /// </summary>
+  std::mutex sleepMutex;
+  std::condition_variable wake;
+
+  /// <summary>
+  /// The number of queued items, counted before an item is queued and after
+  /// it is taken, so a worker never sleeps while one is queued.
+  /// </summary>
+  std::atomic<size_t> pending = 0;
+
+  /// <summary>
+  /// The number of items taken and not finished, counted while the queue
+  /// they were taken from is locked.
+  /// </summary>
+  std::atomic<size_t> running = 0;
+
+  std::atomic<bool> stopping = false;
+  std::atomic<size_t> next = 0;
+  bool joined = false;
+
+  std::atomic<uint64_t> executed = 0;
+  std::atomic<uint64_t> stolen = 0;
+  std::atomic<uint64_t> cancelled = 0;
+
+  void Work(size_t index);
+  bool Take(size_t index, WorkItem& item);
+  void Cancel();
+
+public:
+  /// <summary>
+  /// Initializes a <see cref="StealingExecutor"/> and starts its threads.
+  /// </summary>
+  /// <param name="threads">The number of threads. Fewer are started if the
+  /// system refuses to create them.</param>
+  explicit StealingExecutor(size_t threads);
+
+  StealingExecutor(const StealingExecutor&) = delete;
+  StealingExecutor& operator=(const StealingExecutor&) = delete;
+
+  /// <summary>
+  /// Stops the executor, waiting for running work to finish.
+  /// </summary>
+  ~StealingExecutor() override;
+
+  bool Submit(WorkPriority priority, WorkItem item) override;
+  bool Stop() override;
+  bool IsStopping() const override { return stopping.load(std::memory_order_relaxed); }
+
+  /// <summary>
+  /// The number of threads.
+  /// </summary>
+  size_t Threads() const { return threads; }
+
+  /// <summary>
+  /// The number of items that ran.
+  /// </summary>
+  uint64_t Executed() const { return executed.load(); }
+
+  /// <summary>
+  /// The number of items that ran on a worker other than the one they were
+  /// queued on.
+  /// </summary>
+  uint64_t Stolen() const { return stolen.load(); }
+
+  /// <summary>
+  /// The number of items cancelled before they started.
+  /// </summary>
+  uint64_t Cancelled() const { return cancelled.load(); }
+};
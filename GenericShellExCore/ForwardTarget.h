@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "CommandTemplate.h"
+
+/// <summary>
+/// How a command is forwarded to a running instance.
+/// </summary>
+enum class ForwardKind {
+  /// <summary>
+  /// The command is not forwarded.
+  /// </summary>
+  None,
+
+  /// <summary>
+  /// The message is written to a named pipe.
+  /// </summary>
+  Pipe,
+
+  /// <summary>
+  /// The message is sent to a top-level window with <c>WM_COPYDATA</c>.
+  /// </summary>
+  Window
+};
+
+/// <summary>
+/// A running instance that a context menu entry's command is forwarded to
+/// before falling back to starting a new process, from the entry's
+/// <c>forward</c> block.
+/// </summary>
+struct ForwardTarget {
+  /// <summary>
+  /// The longest timeout accepted, since forwarding blocks Explorer.
+  /// </summary>
+  static constexpr std::chrono::milliseconds MaxTimeout{ 5000 };
+
+  ForwardKind kind = ForwardKind::None;
+
+  /// <summary>
+  /// The pipe name, such as <c>\\.\pipe\nvim</c>, or the window class.
+  /// </summary>
+  std::wstring endpoint;
+
+  /// <summary>
+  /// The window title, or empty to match any window of the class.
+  /// </summary>
+  std::wstring windowTitle;
+
+  /// <summary>
+  /// The message template, in which placeholders are expanded as in a
+  /// command.
+  /// </summary>
+  std::wstring message = L"%*";
+
+  /// <summary>
+  /// <see cref="message"/>, compiled once environment variables have been
+  /// expanded in it.
+  /// </summary>
+  CommandTemplate messageTemplate;
+
+  /// <summary>
+  /// The <c>dwData</c> value of the <c>COPYDATASTRUCT</c>.
+  /// </summary>
+  uint32_t copyDataId = 0;
+
+  /// <summary>
+  /// Whether the message is sent as UTF-16 rather than UTF-8.
+  /// </summary>
+  bool utf16 = false;
+
+  /// <summary>
+  /// How long to wait for the instance to accept the message.
+  /// </summary>
+  std::chrono::milliseconds timeout{ 250 };
+
+  bool IsConfigured() const { return kind != ForwardKind::None; }
+};
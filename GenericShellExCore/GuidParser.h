@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace GuidParserDetail {
+  constexpr int HexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+
+    return -1;
+  }
+
+  /// <summary>
+  /// Reads <paramref name="digits"/> hex digits starting at <paramref
+  /// name="offset"/>, or returns <c>false</c> if any is not a hex digit.
+  /// </summary>
+  constexpr bool ReadHex(const char* s, size_t offset, size_t digits, uint32_t& value) {
+    value = 0;
+
+    for (size_t i = 0; i < digits; ++i) {
+      int digit = HexDigit(s[offset + i]);
+
+      if (digit < 0) return false;
+
+      value = (value << 4) | static_cast<uint32_t>(digit);
+    }
+
+    return true;
+  }
+
+  /// <summary>
+  /// Parses a GUID in registry format, with or without braces, into any
+  /// structure laid out like <c>GUID</c>.
+  /// </summary>
+  /// <returns><c>true</c> on success or <c>false</c> if <paramref
+  /// name="s"/> is malformed.</returns>
+  template <typename Guid>
+  constexpr bool TryParseGuid(const char* s, size_t length, Guid& guid) {
+    if (length == 38) {
+      if (s[0] != '{' || s[37] != '}') return false;
+
+      ++s;
+      length -= 2;
+    }
+
+    if (length != 36) return false;
+    if (s[8] != '-' || s[13] != '-' || s[18] != '-' || s[23] != '-') return false;
+
+    uint32_t value = 0;
+
+    if (!ReadHex(s, 0, 8, value)) return false;
+    guid.Data1 = value;
+
+    if (!ReadHex(s, 9, 4, value)) return false;
+    guid.Data2 = static_cast<unsigned short>(value);
+
+    if (!ReadHex(s, 14, 4, value)) return false;
+    guid.Data3 = static_cast<unsigned short>(value);
+
+    // Data4 is the last four digits of the fourth group followed by the
+    // twelve digits of the fifth
+    constexpr size_t Data4Offsets[8] = { 19, 21, 24, 26, 28, 30, 32, 34 };
+
+    for (size_t i = 0; i < 8; ++i) {
+      if (!ReadHex(s, Data4Offsets[i], 2, value)) return false;
+      guid.Data4[i] = static_cast<unsigned char>(value);
+    }
+
+    return true;
+  }
+}
+
+/// <summary>
+/// Parses a GUID such as <c>ff8b806e-83c6-4df1-9fb4-698133580803</c> at
+/// compile time. Surrounding braces are optional.
+/// </summary>
+/// <remarks>
+/// A malformed GUID fails to compile. <typeparamref name="Guid"/> is
+/// <c>GUID</c> in the DLL; the parser only needs its members, so it is
+/// tested without Windows headers.
+/// </remarks>
+/// <typeparam name="Guid">The GUID structure.</typeparam>
+/// <param name="s">The GUID string.</param>
+/// <returns>The GUID.</returns>
+template <typename Guid, size_t N>
+consteval Guid ParseGuid(const char (&s)[N]) {
+  Guid guid = {};
+
+  if (!GuidParserDetail::TryParseGuid(s, N - 1, guid)) throw "Malformed GUID";
+
+  return guid;
+}
+
+/// <summary>
+/// Compares two GUIDs in a constant expression.
+/// </summary>
+template <typename Guid>
+constexpr bool GuidEquals(const Guid& a, const Guid& b) {
+  if (a.Data1 != b.Data1 || a.Data2 != b.Data2 || a.Data3 != b.Data3) return false;
+
+  for (size_t i = 0; i < 8; ++i) {
+    if (a.Data4[i] != b.Data4[i]) return false;
+  }
+
+  return true;
+}
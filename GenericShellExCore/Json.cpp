@@ -0,0 +1,467 @@
+#include "Json.h"
+#include "Utf8.h"
+
+namespace {
+  /// <summary>
+  /// The deepest nesting accepted, so that hostile input cannot exhaust the
+  /// stack of the process hosting the DLL.
+  /// </summary>
+  constexpr int MaxDepth = 64;
+
+  bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+  }
+
+  int HexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+
+    return -1;
+  }
+
+  /// <summary>
+  /// Reads the four hex digits of a <c>\u</c> escape.
+  /// </summary>
+  /// <returns>The code unit, or <c>-1</c> if the digits are invalid.</returns>
+  long ReadHex4(std::string_view text, size_t position) {
+    if (text.size() - position < 4) return -1;
+
+    long value = 0;
+
+    for (size_t i = 0; i < 4; ++i) {
+      int digit = HexDigit(text[position + i]);
+
+      if (digit < 0) return -1;
+
+      value = (value << 4) | digit;
+    }
+
+    return value;
+  }
+
+  void AppendUtf8(std::string& s, uint32_t c) {
+    if (c < 0x80) {
+      s.push_back(static_cast<char>(c));
+    } else if (c < 0x800) {
+      s.push_back(static_cast<char>(0xC0 | (c >> 6)));
+      s.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+    } else if (c < 0x10000) {
+      s.push_back(static_cast<char>(0xE0 | (c >> 12)));
+      s.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+      s.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+    } else {
+      s.push_back(static_cast<char>(0xF0 | (c >> 18)));
+      s.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
+      s.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+      s.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+    }
+  }
+
+  /// <summary>
+  /// Decodes the escape sequences in string contents that have already been
+  /// validated.
+  /// </summary>
+  void Unescape(std::string_view text, std::string& value) {
+    value.clear();
+    value.reserve(text.size());
+
+    for (size_t i = 0; i < text.size(); ++i) {
+      if (text[i] != '\\') {
+        value.push_back(text[i]);
+
+        continue;
+      }
+
+      switch (text[++i]) {
+      case 'b': value.push_back('\b'); break;
+      case 'f': value.push_back('\f'); break;
+      case 'n': value.push_back('\n'); break;
+      case 'r': value.push_back('\r'); break;
+      case 't': value.push_back('\t'); break;
+      case 'u': {
+        uint32_t c = static_cast<uint32_t>(ReadHex4(text, i + 1));
+        i += 4;
+
+        if (c >= 0xD800 && c <= 0xDBFF) {
+          c = 0x10000 + ((c - 0xD800) << 10) + (static_cast<uint32_t>(ReadHex4(text, i + 3)) - 0xDC00);
+          i += 6;
+        }
+
+        AppendUtf8(value, c);
+
+        break;
+      }
+      default: value.push_back(text[i]); break;
+      }
+    }
+  }
+
+  /// <summary>
+  /// A recursive descent parser that appends to a <see cref="JsonDocument"/>'s
+  /// nodes.
+  /// </summary>
+  class Parser {
+    std::string_view text;
+    size_t position = 0;
+    std::vector<JsonNode>& nodes;
+
+    void SkipWhitespace() {
+      while (position < text.size() && (text[position] == ' ' || text[position] == '\n' || text[position] == '\r' || text[position] == '\t')) ++position;
+    }
+
+    bool Consume(char c) {
+      if (position < text.size() && text[position] == c) {
+        ++position;
+
+        return true;
+      }
+
+      return false;
+    }
+
+    bool ConsumeLiteral(std::string_view literal) {
+      if (text.substr(position, literal.size()) != literal) return false;
+
+      position += literal.size();
+
+      return true;
+    }
+
+    /// <summary>
+    /// Reads a string, leaving <see cref="position"/> after the closing
+    /// quote.
+    /// </summary>
+    bool String(std::string_view& contents, bool& escaped) {
+      if (!Consume('"')) return false;
+
+      size_t start = position;
+      escaped = false;
+
+      while (position < text.size()) {
+        unsigned char c = static_cast<unsigned char>(text[position]);
+
+        if (c == '"') {
+          contents = text.substr(start, position - start);
+          ++position;
+
+          return true;
+        }
+
+        if (c < 0x20) return false;
+
+        if (c != '\\') {
+          ++position;
+
+          continue;
+        }
+
+        escaped = true;
+
+        if (++position == text.size()) return false;
+
+        switch (text[position]) {
+        case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+          ++position;
+
+          break;
+        case 'u': {
+          long unit = ReadHex4(text, position + 1);
+
+          if (unit < 0 || (unit >= 0xDC00 && unit <= 0xDFFF)) return false;
+
+          position += 5;
+
+          // A high surrogate must be followed by an escaped low surrogate
+          if (unit >= 0xD800 && unit <= 0xDBFF) {
+            if (!ConsumeLiteral("\\u")) return false;
+
+            long low = ReadHex4(text, position);
+
+            if (low < 0xDC00 || low > 0xDFFF) return false;
+
+            position += 4;
+          }
+
+          break;
+        }
+        default:
+          return false;
+        }
+      }
+
+      return false;
+    }
+
+    bool Number() {
+      size_t start = position;
+
+      Consume('-');
+
+      if (Consume('0')) {
+      } else if (position < text.size() && IsDigit(text[position])) {
+        while (position < text.size() && IsDigit(text[position])) ++position;
+      } else {
+        return false;
+      }
+
+      if (Consume('.')) {
+        if (position == text.size() || !IsDigit(text[position])) return false;
+
+        while (position < text.size() && IsDigit(text[position])) ++position;
+      }
+
+      if (Consume('e') || Consume('E')) {
+        if (!Consume('+')) Consume('-');
+
+        if (position == text.size() || !IsDigit(text[position])) return false;
+
+        while (position < text.size() && IsDigit(text[position])) ++position;
+      }
+
+      nodes.back().type = JsonType::Number;
+      nodes.back().text = text.substr(start, position - start);
+
+      return true;
+    }
+
+    bool Members(int depth) {
+      SkipWhitespace();
+
+      if (Consume('}')) return true;
+
+      do {
+        SkipWhitespace();
+
+        std::string_view key;
+        bool keyEscaped = false;
+
+        if (!String(key, keyEscaped)) return false;
+
+        SkipWhitespace();
+
+        if (!Consume(':')) return false;
+
+        size_t member = nodes.size();
+
+        if (!Value(depth)) return false;
+
+        nodes[member].key = key;
+        nodes[member].keyEscaped = keyEscaped;
+
+        SkipWhitespace();
+      } while (Consume(','));
+
+      return Consume('}');
+    }
+
+    bool Elements(int depth) {
+      SkipWhitespace();
+
+      if (Consume(']')) return true;
+
+      do {
+        if (!Value(depth)) return false;
+
+        SkipWhitespace();
+      } while (Consume(','));
+
+      return Consume(']');
+    }
+
+  public:
+    Parser(std::string_view text, std::vector<JsonNode>& nodes) : text(text), nodes(nodes) {}
+
+    size_t Position() const { return position; }
+
+    /// <summary>
+    /// Reads a value and its descendants, appending them to the nodes.
+    /// </summary>
+    bool Value(int depth) {
+      SkipWhitespace();
+
+      if (position == text.size()) return false;
+
+      size_t index = nodes.size();
+      nodes.emplace_back();
+
+      bool success = false;
+
+      switch (text[position]) {
+      case '{':
+      case '[': {
+        if (depth == MaxDepth) return false;
+
+        bool isObject = text[position++] == '{';
+        nodes[index].type = isObject ? JsonType::Object : JsonType::Array;
+        success = isObject ? Members(depth + 1) : Elements(depth + 1);
+
+        break;
+      }
+      case '"':
+        nodes[index].type = JsonType::String;
+        success = String(nodes[index].text, nodes[index].escaped);
+
+        break;
+      case 't':
+        nodes[index].type = JsonType::Boolean;
+        nodes[index].boolean = true;
+        success = ConsumeLiteral("true");
+
+        break;
+      case 'f':
+        nodes[index].type = JsonType::Boolean;
+        success = ConsumeLiteral("false");
+
+        break;
+      case 'n':
+        nodes[index].type = JsonType::Null;
+        success = ConsumeLiteral("null");
+
+        break;
+      default:
+        success = Number();
+
+        break;
+      }
+
+      nodes[index].end = nodes.size();
+
+      return success;
+    }
+
+    bool AtEnd() {
+      SkipWhitespace();
+
+      return position == text.size();
+    }
+  };
+}
+
+const JsonNode* JsonValue::Node() const {
+  return document && index < document->nodes.size() ? &document->nodes[index] : nullptr;
+}
+
+JsonValue::Iterator& JsonValue::Iterator::operator++() {
+  index = document->nodes[index].end;
+
+  return *this;
+}
+
+JsonType JsonValue::Type() const {
+  const JsonNode* node = Node();
+
+  return node ? node->type : JsonType::Missing;
+}
+
+JsonValue JsonValue::operator[](std::string_view key) const {
+  if (!IsObject()) return JsonValue();
+
+  JsonValue found;
+  std::string decoded;
+
+  for (JsonValue member : *this) {
+    const JsonNode* node = member.Node();
+
+    if (node->keyEscaped ? member.GetKey(decoded) && decoded == key : node->key == key) found = member;
+  }
+
+  return found;
+}
+
+bool JsonValue::GetKey(std::string& key) const {
+  const JsonNode* node = Node();
+
+  if (!node) return false;
+
+  if (node->keyEscaped) {
+    Unescape(node->key, key);
+  } else {
+    key.assign(node->key);
+  }
+
+  return true;
+}
+
+bool JsonValue::GetBoolean(bool& value) const {
+  if (Type() != JsonType::Boolean) return false;
+
+  value = Node()->boolean;
+
+  return true;
+}
+
+bool JsonValue::GetUnsigned(uint64_t& value) const {
+  if (Type() != JsonType::Number) return false;
+
+  uint64_t result = 0;
+
+  for (char c : Node()->text) {
+    if (!IsDigit(c)) return false;
+
+    uint64_t digit = static_cast<uint64_t>(c - '0');
+
+    if (result > (UINT64_MAX - digit) / 10) return false;
+
+    result = result * 10 + digit;
+  }
+
+  value = result;
+
+  return true;
+}
+
+bool JsonValue::GetString(std::string& value) const {
+  if (Type() != JsonType::String) return false;
+
+  if (Node()->escaped) {
+    Unescape(Node()->text, value);
+  } else {
+    value.assign(Node()->text);
+  }
+
+  return true;
+}
+
+bool JsonValue::GetString(std::wstring& value) const {
+  if (Type() != JsonType::String) return false;
+
+  if (Node()->escaped) {
+    std::string unescaped;
+    Unescape(Node()->text, unescaped);
+    ConvertUtf8ToWide(unescaped, value);
+  } else {
+    ConvertUtf8ToWide(Node()->text, value);
+  }
+
+  return true;
+}
+
+JsonValue::Iterator JsonValue::begin() const {
+  const JsonNode* node = Node();
+
+  if (!node) return Iterator(document, 0);
+
+  return Iterator(document, node->type == JsonType::Array || node->type == JsonType::Object ? index + 1 : node->end);
+}
+
+JsonValue::Iterator JsonValue::end() const {
+  const JsonNode* node = Node();
+
+  return Iterator(document, node ? node->end : 0);
+}
+
+bool JsonDocument::Parse(std::string_view text) {
+  nodes.clear();
+  errorOffset = 0;
+
+  size_t bom = text.substr(0, 3) == "\xEF\xBB\xBF" ? 3 : 0;
+  Parser parser(text.substr(bom), nodes);
+
+  if (parser.Value(0) && parser.AtEnd()) return true;
+
+  errorOffset = bom + parser.Position();
+  nodes.clear();
+
+  return false;
+}
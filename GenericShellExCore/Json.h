@@ -0,0 +1,215 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// <summary>
+/// The type of a <see cref="JsonValue"/>.
+/// </summary>
+enum class JsonType : uint8_t {
+  /// <summary>
+  /// The value does not exist, such as an object member that is not there.
+  /// </summary>
+  Missing,
+  Null,
+  Boolean,
+  Number,
+  String,
+  Array,
+  Object
+};
+
+/// <summary>
+/// A parsed value in a <see cref="JsonDocument"/>.
+/// </summary>
+struct JsonNode {
+  JsonType type = JsonType::Missing;
+
+  bool boolean = false;
+
+  /// <summary>
+  /// Whether <see cref="text"/> contains escape sequences.
+  /// </summary>
+  bool escaped = false;
+
+  /// <summary>
+  /// Whether <see cref="key"/> contains escape sequences.
+  /// </summary>
+  bool keyEscaped = false;
+
+  /// <summary>
+  /// The index just past this node's descendants, which is its next
+  /// sibling, if it has one.
+  /// </summary>
+  size_t end = 0;
+
+  /// <summary>
+  /// The member name, as written between the quotes, for object members.
+  /// </summary>
+  std::string_view key;
+
+  /// <summary>
+  /// A string's contents, as written between the quotes, or a number as
+  /// written.
+  /// </summary>
+  std::string_view text;
+};
+
+class JsonDocument;
+
+/// <summary>
+/// A value in a <see cref="JsonDocument"/>, or a missing value.
+/// </summary>
+/// <remarks>
+/// A value is a small handle into its document, which must outlive it, as
+/// must the text the document was parsed from. Looking up a member that is
+/// not there, or a member of something that is not an object, gives a
+/// missing value rather than failing, so lookups can be chained and checked
+/// once.
+/// </remarks>
+class JsonValue {
+  const JsonDocument* document = nullptr;
+  size_t index = 0;
+
+  JsonValue(const JsonDocument* document, size_t index) : document(document), index(index) {}
+
+  const JsonNode* Node() const;
+
+  friend class JsonDocument;
+
+public:
+  /// <summary>
+  /// Iterates over the elements of an array or the members of an object.
+  /// </summary>
+  class Iterator {
+    const JsonDocument* document;
+    size_t index;
+
+    friend class JsonValue;
+
+    Iterator(const JsonDocument* document, size_t index) : document(document), index(index) {}
+
+  public:
+    JsonValue operator*() const { return JsonValue(document, index); }
+
+    Iterator& operator++();
+
+    bool operator==(const Iterator& other) const { return index == other.index; }
+    bool operator!=(const Iterator& other) const { return index != other.index; }
+  };
+
+  /// <summary>
+  /// Initializes a missing <see cref="JsonValue"/>.
+  /// </summary>
+  JsonValue() = default;
+
+  JsonType Type() const;
+
+  bool Exists() const { return Type() != JsonType::Missing; }
+  bool IsArray() const { return Type() == JsonType::Array; }
+  bool IsObject() const { return Type() == JsonType::Object; }
+
+  /// <summary>
+  /// Gets an object member. If the name appears more than once, the last
+  /// one is used.
+  /// </summary>
+  /// <param name="key">The member name.</param>
+  /// <returns>The member, or a missing value.</returns>
+  JsonValue operator[](std::string_view key) const;
+
+  /// <summary>
+  /// Gets the name of an object member.
+  /// </summary>
+  /// <param name="key">Receives the name, with escape sequences decoded, or
+  /// an empty string if this is not an object member.</param>
+  /// <returns><c>true</c> on success or <c>false</c> if this is
+  /// missing.</returns>
+  bool GetKey(std::string& key) const;
+
+  /// <summary>
+  /// Gets a Boolean.
+  /// </summary>
+  /// <param name="value">Receives the value. Unchanged if this is not a
+  /// Boolean.</param>
+  /// <returns><c>true</c> if this is a Boolean or <c>false</c>
+  /// otherwise.</returns>
+  bool GetBoolean(bool& value) const;
+
+  /// <summary>
+  /// Gets a non-negative integer, written without a fraction or exponent.
+  /// </summary>
+  /// <param name="value">Receives the value. Unchanged on failure.</param>
+  /// <returns><c>true</c> if this is such a number and it fits or
+  /// <c>false</c> otherwise.</returns>
+  bool GetUnsigned(uint64_t& value) const;
+
+  /// <summary>
+  /// Gets a string as UTF-8.
+  /// </summary>
+  /// <param name="value">Receives the value, with escape sequences decoded.
+  /// Unchanged if this is not a string.</param>
+  /// <returns><c>true</c> if this is a string or <c>false</c>
+  /// otherwise.</returns>
+  bool GetString(std::string& value) const;
+
+  /// <summary>
+  /// Gets a string as a wide string.
+  /// </summary>
+  /// <remarks>
+  /// Strings without escape sequences are converted straight from the
+  /// document text.
+  /// </remarks>
+  /// <param name="value">Receives the value. Unchanged if this is not a
+  /// string.</param>
+  /// <returns><c>true</c> if this is a string or <c>false</c>
+  /// otherwise.</returns>
+  bool GetString(std::wstring& value) const;
+
+  Iterator begin() const;
+  Iterator end() const;
+};
+
+/// <summary>
+/// A parsed JSON document.
+/// </summary>
+/// <remarks>
+/// <para>Parsing never throws. The document is a flat array of <see
+/// cref="JsonNode"/> in document order, each recording where its
+/// descendants end, with strings and numbers left as views of the text, so
+/// parsing allocates only that array and decodes nothing that is not
+/// asked for.</para>
+/// <para>Text is validated against RFC 8259, except that the contents of
+/// strings are not checked to be UTF-8; invalid sequences are replaced when
+/// strings are converted. A leading UTF-8 byte order mark is skipped.</para>
+/// </remarks>
+class JsonDocument {
+  std::vector<JsonNode> nodes;
+
+  size_t errorOffset = 0;
+
+  friend class JsonValue;
+
+public:
+  /// <summary>
+  /// Parses JSON text, replacing anything previously parsed.
+  /// </summary>
+  /// <param name="text">The text, which must outlive the document.</param>
+  /// <returns><c>true</c> on success or <c>false</c> if <paramref
+  /// name="text"/> is not valid JSON.</returns>
+  bool Parse(std::string_view text);
+
+  /// <summary>
+  /// Gets the root value.
+  /// </summary>
+  /// <returns>The root value, or a missing value if parsing
+  /// failed.</returns>
+  JsonValue Root() const { return JsonValue(this, 0); }
+
+  /// <summary>
+  /// Gets the offset of the first invalid byte if parsing failed.
+  /// </summary>
+  size_t ErrorOffset() const { return errorOffset; }
+};
@@ -0,0 +1,179 @@
+#include <cstring>
+
+#include "Log.h"
+
+void LogLine::Append(const wchar_t* chars, size_t count) {
+  if (count > Capacity - length) count = Capacity - length;
+
+  std::memcpy(text + length, chars, count * sizeof(wchar_t));
+  length += count;
+}
+
+void LogLine::AppendUnsigned(uint64_t value, bool negative) {
+  wchar_t digits[21];
+  size_t i = sizeof(digits) / sizeof(digits[0]);
+
+  do {
+    digits[--i] = static_cast<wchar_t>(L'0' + value % 10);
+    value /= 10;
+  } while (value);
+
+  if (negative) digits[--i] = L'-';
+
+  Append(digits + i, sizeof(digits) / sizeof(digits[0]) - i);
+}
+
+LogLine::~LogLine() {
+  if (!log) return;
+
+  if (length == Capacity) --length;
+  text[length++] = L'\n';
+
+  log->Commit(text, length);
+}
+
+LogLine& LogLine::operator<<(std::wstring_view s) {
+  if (log) Append(s.data(), s.size());
+
+  return *this;
+}
+
+LogLine& LogLine::operator<<(const wchar_t* s) {
+  return *this << std::wstring_view(s ? s : L"(null)");
+}
+
+LogLine& LogLine::operator<<(wchar_t c) {
+  if (log) Append(&c, 1);
+
+  return *this;
+}
+
+LogLine& LogLine::operator<<(int value) {
+  return *this << static_cast<long long>(value);
+}
+
+LogLine& LogLine::operator<<(long value) {
+  return *this << static_cast<long long>(value);
+}
+
+LogLine& LogLine::operator<<(long long value) {
+  if (log) {
+    // Negate in unsigned arithmetic so that the smallest value survives
+    AppendUnsigned(value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value), value < 0);
+  }
+
+  return *this;
+}
+
+LogLine& LogLine::operator<<(unsigned int value) {
+  return *this << static_cast<unsigned long long>(value);
+}
+
+LogLine& LogLine::operator<<(unsigned long value) {
+  return *this << static_cast<unsigned long long>(value);
+}
+
+LogLine& LogLine::operator<<(unsigned long long value) {
+  if (log) AppendUnsigned(value, false);
+
+  return *this;
+}
+
+void Log::Open(std::wostream* sink, size_t capacity) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  FlushLocked();
+
+  this->sink = sink;
+  ring.assign(capacity ? capacity : DefaultCapacity, L'\0');
+  start = 0;
+  size = 0;
+
+  open.store(true, std::memory_order_relaxed);
+}
+
+void Log::Close() {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  FlushLocked();
+  open.store(false, std::memory_order_relaxed);
+
+  sink = nullptr;
+  ring.clear();
+  ring.shrink_to_fit();
+  start = 0;
+  size = 0;
+}
+
+void Log::DiscardLocked(size_t count) {
+  // Drop whole lines so that the ring never starts mid-line
+  while (size && (count || ring[(start + ring.size() - 1) % ring.size()] != L'\n')) {
+    start = (start + 1) % ring.size();
+    --size;
+
+    if (count) --count;
+  }
+}
+
+void Log::FlushLocked() {
+  if (!sink || !size) return;
+
+  size_t first = ring.size() - start;
+
+  if (first > size) first = size;
+
+  sink->write(ring.data() + start, static_cast<std::streamsize>(first));
+  sink->write(ring.data(), static_cast<std::streamsize>(size - first));
+  sink->flush();
+
+  start = 0;
+  size = 0;
+}
+
+void Log::Commit(const wchar_t* text, size_t length) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (ring.empty()) return;
+
+  bool truncated = length > ring.size();
+
+  if (truncated) length = ring.size();
+
+  if (size + length > ring.size()) {
+    FlushLocked();
+
+    // Without a sink, make room by dropping the oldest text
+    if (size + length > ring.size()) DiscardLocked(size + length - ring.size());
+  }
+
+  size_t end = (start + size) % ring.size();
+  size_t first = ring.size() - end;
+
+  if (first > length) first = length;
+
+  std::memcpy(ring.data() + end, text, first * sizeof(wchar_t));
+  std::memcpy(ring.data(), text + first, (length - first) * sizeof(wchar_t));
+  size += length;
+
+  if (truncated) ring[(end + length - 1) % ring.size()] = L'\n';
+}
+
+void Log::Flush() {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  FlushLocked();
+}
+
+std::wstring Log::Snapshot() {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  std::wstring text;
+
+  if (ring.empty()) return text;
+
+  text.reserve(size);
+
+  for (size_t i = 0; i < size; ++i) text.push_back(ring[(start + i) % ring.size()]);
+
+  return text;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Log;
+
+/// <summary>
+/// A single log line, built in place and committed to its <see cref="Log"/>
+/// when it goes out of scope.
+/// </summary>
+/// <remarks>
+/// Lines longer than <see cref="Capacity"/> characters are truncated.
+/// Building a line never allocates.
+/// </remarks>
+class LogLine {
+public:
+  /// <summary>
+  /// The largest number of characters in a line.
+  /// </summary>
+  static constexpr size_t Capacity = 512;
+
+private:
+  Log* log;
+  wchar_t text[Capacity];
+  size_t length = 0;
+
+  void Append(const wchar_t* chars, size_t count);
+  void AppendUnsigned(uint64_t value, bool negative);
+
+public:
+  /// <summary>
+  /// Initializes a <see cref="LogLine"/>.
+  /// </summary>
+  /// <param name="log">The log to commit to, or <c>nullptr</c> to discard
+  /// the line.</param>
+  explicit LogLine(Log* log) : log(log) {}
+
+  LogLine(const LogLine&) = delete;
+  LogLine& operator=(const LogLine&) = delete;
+
+  /// <summary>
+  /// Commits the line.
+  /// </summary>
+  ~LogLine();
+
+  LogLine& operator<<(std::wstring_view s);
+  LogLine& operator<<(const wchar_t* s);
+  LogLine& operator<<(wchar_t c);
+  LogLine& operator<<(int value);
+  LogLine& operator<<(long value);
+  LogLine& operator<<(long long value);
+  LogLine& operator<<(unsigned int value);
+  LogLine& operator<<(unsigned long value);
+  LogLine& operator<<(unsigned long long value);
+};
+
+/// <summary>
+/// A log that keeps recent lines in a fixed-size ring and writes them to a
+/// sink in batches.
+/// </summary>
+/// <remarks>
+/// <para>Lines are written to the sink when the ring fills up and whenever
+/// <see cref="Flush"/> is called, so logging does not cost a write per
+/// line. Without a sink, the oldest lines are overwritten.</para>
+/// <para>All members are safe to call from any thread.</para>
+/// </remarks>
+class Log {
+  friend class LogLine;
+
+  std::mutex mutex;
+
+  std::vector<wchar_t> ring;
+  size_t start = 0;
+  size_t size = 0;
+
+  std::wostream* sink = nullptr;
+
+  std::atomic<bool> open = false;
+
+  void Commit(const wchar_t* text, size_t length);
+  void FlushLocked();
+  void DiscardLocked(size_t count);
+
+public:
+  /// <summary>
+  /// The default ring size, in characters.
+  /// </summary>
+  static constexpr size_t DefaultCapacity = 64 * 1024;
+
+  /// <summary>
+  /// Enables the log.
+  /// </summary>
+  /// <param name="sink">The stream lines are written to, or <c>nullptr</c>
+  /// to only keep them in the ring.</param>
+  /// <param name="capacity">The ring size, in characters.</param>
+  void Open(std::wostream* sink, size_t capacity = DefaultCapacity);
+
+  /// <summary>
+  /// Flushes and disables the log.
+  /// </summary>
+  void Close();
+
+  /// <summary>
+  /// Whether the log is enabled. Callers check this before building a
+  /// line, so a disabled log costs a single test.
+  /// </summary>
+  bool IsOpen() const { return open.load(std::memory_order_relaxed); }
+
+  /// <summary>
+  /// Starts a line.
+  /// </summary>
+  /// <returns>A <see cref="LogLine"/> that is committed when it goes out of
+  /// scope.</returns>
+  LogLine Line() { return LogLine(IsOpen() ? this : nullptr); }
+
+  /// <summary>
+  /// Writes buffered lines to the sink.
+  /// </summary>
+  void Flush();
+
+  /// <summary>
+  /// Copies the buffered lines, oldest first.
+  /// </summary>
+  /// <returns>The buffered text.</returns>
+  std::wstring Snapshot();
+};
@@ -0,0 +1,155 @@
+#include "MarkerCache.h"
+#include "SelectionPredicate.h"
+
+size_t MarkerCache::KeyHash::operator()(const KeyView& key) const {
+  uint64_t hash = key.markers;
+
+  for (wchar_t c : key.directory) {
+    hash ^= static_cast<uint16_t>(SelectionPredicate::Fold(c));
+    hash *= 0x100000001b3ull;
+  }
+
+  return static_cast<size_t>(hash);
+}
+
+bool MarkerCache::KeyEqual::operator()(const KeyView& a, const KeyView& b) const {
+  if (a.markers != b.markers || a.directory.size() != b.directory.size()) return false;
+
+  for (size_t i = 0; i < a.directory.size(); ++i) {
+    if (SelectionPredicate::Fold(a.directory[i]) != SelectionPredicate::Fold(b.directory[i])) return false;
+  }
+
+  return true;
+}
+
+MarkerCache::~MarkerCache() {
+  for (const Entry& entry : entries) {
+    if (entry.watch) probe.Unwatch(entry.watch);
+  }
+}
+
+uint64_t MarkerCache::Find(std::wstring_view directory, const DirectoryMarkers& markers) {
+  if (markers.IsEmpty() || directory.empty()) return 0;
+
+  KeyView view{ directory, markers.Hash() };
+  auto now = probe.Now();
+  bool reserveWatch = false;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto found = index.find(view);
+
+    if (found != index.end()) {
+      Entry& entry = *found->second;
+
+      // A change may have added or removed a marker, or only touched an
+      // unrelated entry, so it is probed again either way
+      if (!(entry.watch && probe.HasChanged(entry.watch)) && now < entry.expires) {
+        entries.splice(entries.begin(), entries, found->second);
+        ++hits;
+
+        return entry.mask;
+      }
+
+      reserveWatch = !entry.watch && watches < MaxWatches;
+    } else {
+      reserveWatch = watches < MaxWatches;
+    }
+
+    if (reserveWatch) ++watches;
+    ++misses;
+  }
+
+  std::wstring path(directory);
+
+  // Watching first means a marker created while the directory is probed is
+  // noticed on the next lookup
+  uintptr_t watch = reserveWatch ? probe.Watch(path) : 0;
+  uint64_t mask = 0;
+
+  if (path.back() != L'\\' && path.back() != L'/') path.push_back(L'\\');
+
+  size_t length = path.size();
+
+  for (size_t i = 0; i < markers.Count(); ++i) {
+    path.resize(length);
+    path.append(markers.Name(i));
+
+    if (probe.Exists(path)) mask |= 1ull << i;
+  }
+
+  now = probe.Now();
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (reserveWatch && !watch) --watches;
+
+  auto found = index.find(view);
+
+  if (found != index.end()) {
+    Entry& entry = *found->second;
+
+    entry.mask = mask;
+    entry.expires = now + (mask ? presentLifetime : absentLifetime);
+
+    // Another thread may have started watching the directory meanwhile
+    if (watch && entry.watch) {
+      probe.Unwatch(watch);
+      --watches;
+    } else if (watch) {
+      entry.watch = watch;
+    }
+
+    entries.splice(entries.begin(), entries, found->second);
+
+    return mask;
+  }
+
+  if (entries.size() >= capacity && !entries.empty()) {
+    Entry& evicted = entries.back();
+
+    if (evicted.watch) {
+      probe.Unwatch(evicted.watch);
+      --watches;
+    }
+
+    index.erase(evicted.key);
+    entries.pop_back();
+  }
+
+  entries.push_front({ Key{ std::wstring(directory), view.markers }, mask, now + (mask ? presentLifetime : absentLifetime), watch });
+  index.emplace(entries.front().key, entries.begin());
+
+  return mask;
+}
+
+uint64_t MarkerCache::FindInAncestors(std::wstring_view directory, const DirectoryMarkers& markers) {
+  uint64_t mask = 0;
+
+  for (size_t length = directory.size(); length; length = GetParentLength(directory.substr(0, length))) {
+    mask |= Find(directory.substr(0, length), markers);
+  }
+
+  return mask;
+}
+
+size_t MarkerCache::FindNearest(std::wstring_view directory, const DirectoryMarkers& markers, uint64_t mask) {
+  for (size_t length = directory.size(); length; length = GetParentLength(directory.substr(0, length))) {
+    if (Find(directory.substr(0, length), markers) & mask) return length;
+  }
+
+  return 0;
+}
+
+uint64_t MarkerCache::Hits() {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  return hits;
+}
+
+uint64_t MarkerCache::Misses() {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  return misses;
+}
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "DirectoryMarkers.h"
+
+/// <summary>
+/// The file system operations and the clock a <see cref="MarkerCache"/>
+/// needs.
+/// </summary>
+class MarkerProbe {
+public:
+  virtual ~MarkerProbe() = default;
+
+  /// <summary>
+  /// Whether a file or directory exists.
+  /// </summary>
+  virtual bool Exists(const std::wstring& path) = 0;
+
+  /// <summary>
+  /// Starts watching a directory for entries being created, deleted or
+  /// renamed.
+  /// </summary>
+  /// <returns>A watch, or zero if watching the directory would not be
+  /// cheap.</returns>
+  virtual uintptr_t Watch(const std::wstring& directory) = 0;
+
+  /// <summary>
+  /// Whether a watched directory's entries have changed since it was
+  /// watched or last reported changed.
+  /// </summary>
+  virtual bool HasChanged(uintptr_t watch) = 0;
+
+  /// <summary>
+  /// Stops watching a directory.
+  /// </summary>
+  virtual void Unwatch(uintptr_t watch) = 0;
+
+  /// <summary>
+  /// Gets the current time, which cached directories expire by.
+  /// </summary>
+  virtual std::chrono::steady_clock::time_point Now() { return std::chrono::steady_clock::now(); }
+};
+
+/// <summary>
+/// A least recently used cache of the <see cref="DirectoryMarkers"/> each
+/// directory contains, so that walking up from a selection does not probe
+/// the file system every time a menu is opened.
+/// </summary>
+/// <remarks>
+/// <para>A directory with markers is remembered for longer than one
+/// without, since projects are created more often than they are removed.
+/// Up to <see cref="MaxWatches"/> directories are also watched, so that a
+/// marker created or deleted in them is noticed at once.</para>
+/// <para>The cache is safe to use from several threads. The file system is
+/// never probed while the cache is locked.</para>
+/// </remarks>
+class MarkerCache {
+public:
+  /// <summary>
+  /// The largest number of directories watched at once.
+  /// </summary>
+  static constexpr size_t MaxWatches = 64;
+
+private:
+  struct Key {
+    std::wstring directory;
+    uint64_t markers;
+  };
+
+  struct KeyView {
+    std::wstring_view directory;
+    uint64_t markers;
+  };
+
+  /// <summary>
+  /// Hashes and compares directories without regard to case, and without
+  /// copying them to look them up.
+  /// </summary>
+  struct KeyHash {
+    using is_transparent = void;
+
+    size_t operator()(const KeyView& key) const;
+    size_t operator()(const Key& key) const { return (*this)(KeyView{ key.directory, key.markers }); }
+  };
+
+  struct KeyEqual {
+    using is_transparent = void;
+
+    bool operator()(const KeyView& a, const KeyView& b) const;
+    bool operator()(const Key& a, const Key& b) const { return (*this)(KeyView{ a.directory, a.markers }, KeyView{ b.directory, b.markers }); }
+    bool operator()(const KeyView& a, const Key& b) const { return (*this)(a, KeyView{ b.directory, b.markers }); }
+    bool operator()(const Key& a, const KeyView& b) const { return (*this)(KeyView{ a.directory, a.markers }, b); }
+  };
+
+  struct Entry {
+    Key key;
+    uint64_t mask;
+    std::chrono::steady_clock::time_point expires;
+    uintptr_t watch;
+  };
+
+  MarkerProbe& probe;
+  size_t capacity;
+  std::chrono::milliseconds presentLifetime;
+  std::chrono::milliseconds absentLifetime;
+
+  std::mutex mutex;
+  size_t watches = 0;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+
+  /// <summary>
+  /// Entries, most recently used first.
+  /// </summary>
+  std::list<Entry> entries;
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash, KeyEqual> index;
+
+public:
+  /// <summary>
+  /// Initializes a <see cref="MarkerCache"/>.
+  /// </summary>
+  /// <param name="probe">The file system operations.</param>
+  /// <param name="capacity">The largest number of directories
+  /// remembered.</param>
+  /// <param name="presentLifetime">How long a directory with markers is
+  /// remembered.</param>
+  /// <param name="absentLifetime">How long a directory without markers is
+  /// remembered.</param>
+  MarkerCache(MarkerProbe& probe, size_t capacity, std::chrono::milliseconds presentLifetime, std::chrono::milliseconds absentLifetime)
+    : probe(probe), capacity(capacity), presentLifetime(presentLifetime), absentLifetime(absentLifetime) {}
+
+  MarkerCache(const MarkerCache&) = delete;
+  MarkerCache& operator=(const MarkerCache&) = delete;
+
+  /// <summary>
+  /// Stops watching every directory.
+  /// </summary>
+  ~MarkerCache();
+
+  /// <summary>
+  /// Finds the markers a directory contains, probing it only if it is not
+  /// cached, its entry has expired or it has changed.
+  /// </summary>
+  /// <param name="directory">The directory.</param>
+  /// <param name="markers">The markers.</param>
+  /// <returns>The mask of the markers in <paramref
+  /// name="directory"/>.</returns>
+  uint64_t Find(std::wstring_view directory, const DirectoryMarkers& markers);
+
+  /// <summary>
+  /// Finds the markers a directory or any of its ancestors contains.
+  /// </summary>
+  /// <param name="directory">The directory.</param>
+  /// <param name="markers">The markers.</param>
+  /// <returns>The mask of the markers found.</returns>
+  uint64_t FindInAncestors(std::wstring_view directory, const DirectoryMarkers& markers);
+
+  /// <summary>
+  /// Finds the nearest of a directory and its ancestors that contains any of
+  /// a set of markers.
+  /// </summary>
+  /// <param name="directory">The directory.</param>
+  /// <param name="markers">The markers.</param>
+  /// <param name="mask">The mask of the markers to look for.</param>
+  /// <returns>The length of the directory found within <paramref
+  /// name="directory"/>, or zero if there is none.</returns>
+  size_t FindNearest(std::wstring_view directory, const DirectoryMarkers& markers, uint64_t mask);
+
+  /// <summary>
+  /// The number of lookups answered without probing.
+  /// </summary>
+  uint64_t Hits();
+
+  /// <summary>
+  /// The number of lookups that probed the file system.
+  /// </summary>
+  uint64_t Misses();
+};
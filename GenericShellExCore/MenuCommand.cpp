@@ -0,0 +1,357 @@
+#include <utility>
+#include "CommandTemplate.h"
+#include "MenuCommand.h"
+
+namespace {
+  /// <summary>
+  /// Accumulates what reading a selection must provide for <paramref
+  /// name="entry"/> and all of its subcommands.
+  /// </summary>
+  void AccumulateRequirements(const ContextMenuEntry& entry, bool& needsPaths, bool& needsContent, bool& needsMarkers, size_t& limit) {
+    if (entry.when.IsConfigured() && entry.when.NeedsItems()) {
+      needsPaths |= entry.when.NeedsPaths();
+      needsContent |= entry.when.NeedsContent();
+      needsMarkers |= entry.when.NeedsMarkers();
+      if (entry.when.InspectLimit() > limit) limit = entry.when.InspectLimit();
+    }
+
+    for (const ContextMenuEntry& subCommand : entry.subCommands) {
+      AccumulateRequirements(subCommand, needsPaths, needsContent, needsMarkers, limit);
+    }
+  }
+}
+
+std::atomic<uint64_t> MenuCommand::cacheHits = 0;
+std::atomic<uint64_t> MenuCommand::cacheMisses = 0;
+std::atomic<uint64_t> MenuCommand::prefetchHits = 0;
+std::atomic<uint64_t> MenuCommand::prefetchMisses = 0;
+std::atomic<uint64_t> MenuCommand::recallsAvoided = 0;
+
+MenuCommand* MenuCommandPool::Take(Log& log) {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (pooled) return commands[--pooled];
+  }
+
+  return Allocate(log);
+}
+
+void MenuCommandPool::Return(MenuCommand* command) {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (pooled < Capacity) {
+      commands[pooled++] = command;
+
+      return;
+    }
+  }
+
+  delete command;
+}
+
+void MenuCommandPool::Drain() {
+  std::lock_guard<std::mutex> guard(lock);
+
+  while (pooled) delete commands[--pooled];
+}
+
+MenuCommand::MenuCommand(MenuCommandPool& pool, MenuCommandPlatform& platform, Log& log) : pool(pool), platform(platform), log(log) {}
+
+MenuCommand::~MenuCommand() {
+  for (MenuCommand* subCommand : subCommands) {
+    if (subCommand) subCommand->Release();
+  }
+}
+
+MenuCommand* MenuCommand::Create(MenuCommandPool& pool, Log& log, std::shared_ptr<const ConfigSnapshot> snapshot, const ContextMenuEntry& entry) {
+  MenuCommand* command = pool.Take(log);
+
+  if (!command) return nullptr;
+
+  command->Initialize(std::move(snapshot), entry, nullptr);
+  command->Initialized(nullptr, 0);
+
+  return command;
+}
+
+void MenuCommand::Initialize(std::shared_ptr<const ConfigSnapshot> snapshot, const ContextMenuEntry& entry, const std::shared_ptr<SelectionAnalysis>& analysis) {
+  if (analysis) {
+    this->analysis = analysis;
+  } else {
+    if (!ownAnalysis) ownAnalysis = std::make_shared<SelectionAnalysis>();
+
+    ownAnalysis->valid = false;
+    this->analysis = ownAnalysis;
+  }
+
+  this->snapshot = std::move(snapshot);
+  this->entry = &entry;
+
+  refCount = 1;
+  hasCachedState = false;
+  hasPreparation = false;
+
+  // Keeps its capacity from earlier use
+  subCommands.assign(entry.subCommands.size(), nullptr);
+
+  analysisNeedsPaths = false;
+  analysisNeedsContent = false;
+  analysisNeedsMarkers = false;
+  analysisLimit = 0;
+  AccumulateRequirements(entry, analysisNeedsPaths, analysisNeedsContent, analysisNeedsMarkers, analysisLimit);
+
+  if (log.IsOpen()) {
+    log.Line() << L"Initializing context menu command";
+  }
+}
+
+void MenuCommand::Recycle() {
+  for (MenuCommand*& subCommand : subCommands) {
+    if (subCommand) subCommand->Release();
+    subCommand = nullptr;
+  }
+
+  analysis.reset();
+
+  // A subcommand that outlives us still reads this analysis
+  if (ownAnalysis.use_count() > 1) ownAnalysis.reset();
+
+  snapshot.reset();
+  entry = nullptr;
+
+  Recycled();
+
+  pool.Return(this);
+}
+
+unsigned long MenuCommand::AddRef() {
+  return ++refCount;
+}
+
+unsigned long MenuCommand::Release() {
+  unsigned long count = --refCount;
+
+  if (!count) Recycle();
+
+  return count;
+}
+
+MenuCommand* MenuCommand::GetSubCommand(size_t index) {
+  if (index >= subCommands.size()) return nullptr;
+
+  // Two enumerators may reach the same subcommand at once
+  std::lock_guard<std::shared_mutex> guard(lock);
+
+  if (!subCommands[index]) {
+    MenuCommand* subCommand = pool.Take(log);
+
+    if (!subCommand) return nullptr;
+
+    subCommand->Initialize(snapshot, entry->subCommands[index], analysis);
+    subCommand->Initialized(this, index);
+    subCommands[index] = subCommand;
+  }
+
+  return subCommands[index];
+}
+
+bool MenuCommand::Analyze(SelectionSource& source, const SelectionFingerprint& fingerprint) {
+  // A parent reads enough for all of its subcommands, so they normally find
+  // the selection already read
+  if (analysis->valid && analysis->fingerprint == fingerprint && (analysis->hasPaths || !analysisNeedsPaths) && (analysis->hasContent || !analysisNeedsContent) && (analysis->hasMarkers || !analysisNeedsMarkers) && analysis->limit >= analysisLimit) {
+    return true;
+  }
+
+  auto deadline = std::chrono::steady_clock::now() + entry->when.TimeBudget();
+
+  analysis->valid = false;
+
+  if (!source.Read(analysis->selection, analysisNeedsPaths, analysisLimit, deadline, snapshot->volumeTimeout)) return false;
+
+  analysis->fingerprint = fingerprint;
+  analysis->valid = true;
+  analysis->hasPaths = analysisNeedsPaths;
+  analysis->hasContent = analysisNeedsContent;
+  analysis->hasMarkers = analysisNeedsMarkers;
+  analysis->limit = analysisLimit;
+
+  // Shares the budget reading the selection started
+  if (analysisNeedsMarkers) platform.FindMarkers(analysis->selection, snapshot->markers, deadline, snapshot->volumeTimeout);
+  if (analysisNeedsContent) platform.MatchContent(analysis->selection, snapshot->signatures, deadline);
+
+  recallsAvoided += analysis->selection.RemoteCount();
+
+  return true;
+}
+
+VisibilityState MenuCommand::GetState(SelectionSource& source) {
+  bool prefetch = entry->prefetch && subCommands.empty();
+
+  if (!entry->when.IsConfigured() && !prefetch) return VisibilityState::Enabled;
+
+  SelectionFingerprint fingerprint;
+  bool fingerprinted = source.Fingerprint(fingerprint);
+  VisibilityState state = VisibilityState::Enabled;
+
+  if (entry->when.IsConfigured()) state = EvaluateState(source, fingerprint, fingerprinted);
+
+  // Only a command that is shown can be invoked, and Explorer asks for the
+  // state several times per menu, so prepare once per selection
+  if (prefetch && fingerprinted && state == VisibilityState::Enabled) {
+    std::lock_guard<std::shared_mutex> guard(lock);
+
+    if (!(hasPreparation && preparation->IsFor(fingerprint))) {
+      platform.PrepareLaunch(preparation, fingerprint, entry->command);
+      hasPreparation = preparation != nullptr;
+    }
+  }
+
+  return state;
+}
+
+VisibilityState MenuCommand::EvaluateState(SelectionSource& source, const SelectionFingerprint& fingerprint, bool fingerprinted) {
+  const SelectionPredicate& when = entry->when;
+  VisibilityState state = VisibilityState::Enabled;
+
+  // Explorer asks for the state repeatedly for the same selection, so only
+  // the first call pays for reading it
+  if (fingerprinted) {
+    std::shared_lock<std::shared_mutex> shared(lock);
+
+    if (hasCachedState && stateFingerprint == fingerprint) {
+      state = cachedState;
+      shared.unlock();
+
+      ++cacheHits;
+
+      return state;
+    }
+  }
+
+  ++cacheMisses;
+
+  bool cacheable = false;
+
+  {
+    std::lock_guard<std::mutex> analysisGuard(analysis->lock);
+
+    // Without a fingerprint, a selection read now could not be recognized
+    // later
+    if (!fingerprinted) analysis->valid = false;
+
+    if (!Analyze(source, fingerprint)) {
+      if (log.IsOpen()) {
+        log.Line() << L"ERROR: Unable to read selection, using fallback state";
+      }
+
+      state = when.Fallback();
+    } else {
+      const Selection& selection = analysis->selection;
+
+      switch (when.Evaluate(selection)) {
+      case PredicateResult::Match:
+        state = VisibilityState::Enabled;
+        break;
+      case PredicateResult::NoMatch:
+        state = VisibilityState::Hidden;
+        break;
+      case PredicateResult::Inconclusive:
+        if (log.IsOpen()) {
+          log.Line() << L"Inspected " << selection.Inspected() << L" of " << selection.Count() << L" items, using fallback state";
+        }
+
+        state = when.Fallback();
+        break;
+      }
+
+      if (!fingerprinted) {
+        analysis->valid = false;
+      } else {
+        cacheable = analysis->valid;
+      }
+    }
+  }
+
+  std::lock_guard<std::shared_mutex> guard(lock);
+
+  hasCachedState = cacheable;
+
+  if (cacheable) {
+    stateFingerprint = fingerprint;
+    cachedState = state;
+  }
+
+  return state;
+}
+
+bool MenuCommand::Invoke(SelectionSource& source) {
+  if (!subCommands.empty()) return false;
+
+  if (entry->prefetch) {
+    SelectionFingerprint fingerprint;
+    bool prepared = false;
+
+    // The preparation stays with the command, which restarts it for the
+    // next selection rather than allocating another
+    if (source.Fingerprint(fingerprint)) {
+      std::shared_lock<std::shared_mutex> shared(lock);
+      prepared = hasPreparation && preparation->IsReadyFor(fingerprint);
+    }
+
+    ++(prepared ? prefetchHits : prefetchMisses);
+  }
+
+  Selection selection;
+
+  // The command needs every path, which the source holds wherever the
+  // items are, and nothing that would mean touching their volumes
+  if (!source.ReadPaths(selection)) return false;
+
+  const SelectionOrder& order = entry->order;
+
+  if (!order.IsEmpty()) {
+    std::vector<SelectionFileInfo> files;
+    size_t inspected = selection.Inspected();
+
+    if (order.NeedsFileInfo()) platform.ReadFiles(selection, snapshot->volumeTimeout, files);
+
+    ArrangeSelection(selection, order, files);
+
+    if (log.IsOpen() && selection.Inspected() != inspected) log.Line() << L"Passing " << selection.Inspected() << L" of " << inspected << L" items";
+  }
+
+  const ForwardTarget& forward = entry->forward;
+  const CommandTemplate& commandTemplate = entry->commandTemplate;
+
+  std::wstring root;
+
+  if (commandTemplate.UsesRoot() || (forward.IsConfigured() && forward.messageTemplate.UsesRoot())) {
+    root = platform.FindRoot(selection, snapshot->markers, entry->when.Markers(), snapshot->volumeTimeout);
+  }
+
+  std::wstring currentDirectory;
+
+  // Items on different drives share no directory
+  if (entry->relativePaths) currentDirectory = GetCommonParentDirectory(selection);
+  if (currentDirectory.empty()) currentDirectory = GetDirectoryFromFirstItem(selection);
+
+  // The running instance has its own working directory, so it is always
+  // sent full paths
+  if (forward.IsConfigured() && platform.Forward(forward, forward.messageTemplate.Expand(selection, CommandContext{ root, currentDirectory }), log)) return true;
+
+  // Starting a process in a directory on a volume that does not respond
+  // would block until the redirector gives up
+  if (!currentDirectory.empty() && !platform.IsVolumeResponsive(currentDirectory, snapshot->volumeTimeout)) {
+    if (log.IsOpen()) log.Line() << L"Volume of " << currentDirectory << L" is not responding, starting without a working directory";
+
+    currentDirectory.clear();
+  }
+
+  // Paths relative to a working directory the process does not get would
+  // be wrong, so they fall back to full paths then
+  std::wstring command = commandTemplate.Expand(selection, CommandContext{ root, currentDirectory, entry->relativePaths && !currentDirectory.empty() });
+
+  return platform.Launch(currentDirectory, std::move(command), log);
+}
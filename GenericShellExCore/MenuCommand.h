@@ -0,0 +1,427 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ConfigSnapshot.h"
+#include "ContextMenuEntry.h"
+#include "Log.h"
+#include "Selection.h"
+#include "SelectionAnalysis.h"
+#include "SelectionOrder.h"
+
+/// <summary>
+/// The items a <see cref="MenuCommand"/> is asked about, such as the shell's
+/// <c>IShellItemArray</c>.
+/// </summary>
+class SelectionSource {
+public:
+  virtual ~SelectionSource() = default;
+
+  /// <summary>
+  /// Computes the items' fingerprint. Explorer asks for a command's state
+  /// several times per menu, and this is done every time, so it should not
+  /// allocate once the source has seen the items.
+  /// </summary>
+  /// <returns><c>true</c> on success or <c>false</c> if the items could
+  /// not be fingerprinted.</returns>
+  virtual bool Fingerprint(SelectionFingerprint& fingerprint) = 0;
+
+  /// <summary>
+  /// Reads the items into a <see cref="Selection"/>, stopping after
+  /// <paramref name="limit"/> items or at <paramref name="deadline"/>.
+  /// </summary>
+  /// <param name="selection">Receives the items.</param>
+  /// <param name="readPaths">Whether to read item paths.</param>
+  /// <param name="limit">The largest number of items to inspect.</param>
+  /// <param name="deadline">The time after which to stop inspecting.</param>
+  /// <param name="volumeTimeout">How long to wait for a network or
+  /// removable volume to respond.</param>
+  /// <returns><c>true</c> on success or <c>false</c> if the items could
+  /// not be read.</returns>
+  virtual bool Read(Selection& selection, bool readPaths, size_t limit, std::chrono::steady_clock::time_point deadline, std::chrono::milliseconds volumeTimeout) = 0;
+
+  /// <summary>
+  /// Reads every item's path and nothing else, for invoking a command.
+  /// </summary>
+  /// <param name="selection">Receives the items.</param>
+  /// <returns><c>true</c> on success or <c>false</c> if the items could
+  /// not be read.</returns>
+  virtual bool ReadPaths(Selection& selection) = 0;
+};
+
+/// <summary>
+/// Work done between a command being shown and being invoked, so that
+/// invoking it is faster. It is tied to one selection.
+/// </summary>
+class PreparedLaunch {
+public:
+  virtual ~PreparedLaunch() = default;
+
+  /// <summary>
+  /// Determines whether the preparation was started for a selection and
+  /// has not expired, whether or not it has finished.
+  /// </summary>
+  virtual bool IsFor(const SelectionFingerprint& fingerprint) const = 0;
+
+  /// <summary>
+  /// Determines whether the preparation is for a selection and has
+  /// finished in time to be used. Never waits.
+  /// </summary>
+  virtual bool IsReadyFor(const SelectionFingerprint& fingerprint) const = 0;
+};
+
+/// <summary>
+/// The file system and process operations a <see cref="MenuCommand"/>
+/// needs.
+/// </summary>
+class MenuCommandPlatform {
+public:
+  virtual ~MenuCommandPlatform() = default;
+
+  /// <summary>
+  /// Looks for directory markers in the ancestors of each inspected item,
+  /// recording the masks in the selection.
+  /// </summary>
+  virtual void FindMarkers(Selection& selection, const DirectoryMarkers& markers, std::chrono::steady_clock::time_point deadline, std::chrono::milliseconds volumeTimeout) = 0;
+
+  /// <summary>
+  /// Matches the start of each inspected file against content signatures,
+  /// recording the masks in the selection.
+  /// </summary>
+  virtual void MatchContent(Selection& selection, const ContentSignatures& signatures, std::chrono::steady_clock::time_point deadline) = 0;
+
+  /// <summary>
+  /// Starts preparing to launch a command for a selection.
+  /// </summary>
+  /// <param name="preparation">The command's previous preparation, or
+  /// <c>nullptr</c>. Reused if nothing else still uses it, so that preparing
+  /// again does not allocate. Receives the new preparation, or
+  /// <c>nullptr</c> if it could not be started.</param>
+  /// <param name="fingerprint">The fingerprint of the selection the command
+  /// was shown for.</param>
+  /// <param name="command">The command.</param>
+  virtual void PrepareLaunch(std::shared_ptr<PreparedLaunch>& preparation, const SelectionFingerprint& fingerprint, const std::wstring& command) = 0;
+
+  /// <summary>
+  /// Reads the volume serial number, file ID and last write time of each
+  /// inspected item, for <see cref="ArrangeSelection"/>.
+  /// </summary>
+  virtual void ReadFiles(const Selection& selection, std::chrono::milliseconds volumeTimeout, std::vector<SelectionFileInfo>& files) = 0;
+
+  /// <summary>
+  /// Finds the nearest common ancestor of a selection's items that holds
+  /// any of the markers in <paramref name="mask"/>.
+  /// </summary>
+  /// <returns>The root, or an empty string if there is none.</returns>
+  virtual std::wstring FindRoot(const Selection& selection, const DirectoryMarkers& markers, uint64_t mask, std::chrono::milliseconds volumeTimeout) = 0;
+
+  /// <summary>
+  /// Forwards a command to a running instance.
+  /// </summary>
+  /// <returns><c>true</c> if the message was delivered or <c>false</c>
+  /// otherwise.</returns>
+  virtual bool Forward(const ForwardTarget& target, std::wstring_view message, Log& log) = 0;
+
+  /// <summary>
+  /// Determines whether the volume a path is on responds within <paramref
+  /// name="timeout"/>.
+  /// </summary>
+  virtual bool IsVolumeResponsive(std::wstring_view path, std::chrono::milliseconds timeout) = 0;
+
+  /// <summary>
+  /// Starts a process.
+  /// </summary>
+  /// <param name="currentDirectory">The process's working directory, or an
+  /// empty string to inherit ours.</param>
+  /// <param name="command">The command line.</param>
+  /// <param name="log">A <see cref="Log"/>.</param>
+  /// <returns><c>true</c> if the process was started or <c>false</c>
+  /// otherwise.</returns>
+  virtual bool Launch(const std::wstring& currentDirectory, std::wstring command, Log& log) = 0;
+};
+
+class MenuCommand;
+
+/// <summary>
+/// Recycles <see cref="MenuCommand"/>s, since Explorer creates a command
+/// and its subcommands every time a menu is opened.
+/// </summary>
+/// <remarks>
+/// Pooled commands keep the capacity of their storage, so reusing one
+/// allocates nothing. Commands are only freed by <see cref="Drain"/>, or
+/// when the pool is full.
+/// </remarks>
+class MenuCommandPool {
+public:
+  /// <summary>
+  /// The largest number of commands kept for reuse.
+  /// </summary>
+  static constexpr size_t Capacity = 32;
+
+private:
+  std::mutex lock;
+  MenuCommand* commands[Capacity] = {};
+  size_t pooled = 0;
+
+protected:
+  /// <summary>
+  /// Allocates a command when none is pooled.
+  /// </summary>
+  /// <returns>The command, or <c>nullptr</c> if out of memory.</returns>
+  virtual MenuCommand* Allocate(Log& log) = 0;
+
+public:
+  virtual ~MenuCommandPool() = default;
+
+  /// <summary>
+  /// Takes a pooled command, or allocates one.
+  /// </summary>
+  /// <returns>The command, not yet initialized, or <c>nullptr</c> if out of
+  /// memory.</returns>
+  MenuCommand* Take(Log& log);
+
+  /// <summary>
+  /// Pools a released command, or frees it if the pool is full.
+  /// </summary>
+  void Return(MenuCommand* command);
+
+  /// <summary>
+  /// Frees every pooled command.
+  /// </summary>
+  void Drain();
+};
+
+/// <summary>
+/// A <see cref="MenuCommandPool"/> of one kind of command, such as the
+/// DLL's COM commands.
+/// </summary>
+/// <typeparam name="Command">The command type, which is constructed from
+/// the pool, a <see cref="MenuCommandPlatform"/> and a <see
+/// cref="Log"/>.</typeparam>
+template <typename Command>
+class TypedMenuCommandPool : public MenuCommandPool {
+  MenuCommandPlatform& platform;
+
+protected:
+  MenuCommand* Allocate(Log& log) override {
+    return new (std::nothrow) Command(*this, platform, log);
+  }
+
+public:
+  explicit TypedMenuCommandPool(MenuCommandPlatform& platform) : platform(platform) {}
+};
+
+/// <summary>
+/// A context menu entry presented as a command, with its state, its
+/// subcommands and invoking it, independent of COM and the shell.
+/// </summary>
+/// <remarks>
+/// <para>A command and its subcommands read a selection once, with
+/// everything any of them needs, and share it. Each remembers its state for
+/// the last selection it was asked about, so Explorer asking again is only
+/// a fingerprint and a lookup.</para>
+/// <para>Commands are reference counted and free-threaded. The last <see
+/// cref="Release"/> returns a command to its pool.</para>
+/// </remarks>
+class MenuCommand {
+  std::atomic<unsigned long> refCount = 1;
+
+  MenuCommandPool& pool;
+  MenuCommandPlatform& platform;
+  Log& log;
+
+  /// <summary>
+  /// Guards <see cref="subCommands"/>, the cached state and <see
+  /// cref="preparation"/>.
+  /// </summary>
+  std::shared_mutex lock;
+
+  /// <summary>
+  /// The snapshot <see cref="entry"/> belongs to, which is kept alive for
+  /// as long as the command is.
+  /// </summary>
+  std::shared_ptr<const ConfigSnapshot> snapshot;
+
+  const ContextMenuEntry* entry = nullptr;
+
+  /// <summary>
+  /// The selection, shared with the parent command and subcommands.
+  /// </summary>
+  std::shared_ptr<SelectionAnalysis> analysis;
+
+  /// <summary>
+  /// The analysis this command shares when it is the top-level command,
+  /// kept while pooled so that it is not allocated again.
+  /// </summary>
+  std::shared_ptr<SelectionAnalysis> ownAnalysis;
+
+  /// <summary>
+  /// What reading the selection must provide for this command and all of
+  /// its subcommands.
+  /// </summary>
+  bool analysisNeedsPaths = false;
+  bool analysisNeedsContent = false;
+  bool analysisNeedsMarkers = false;
+  size_t analysisLimit = 0;
+
+  /// <summary>
+  /// The subcommands, created when first asked for.
+  /// </summary>
+  std::vector<MenuCommand*> subCommands;
+
+  /// <summary>
+  /// The fingerprint of the selection <see cref="cachedState"/> was
+  /// evaluated for.
+  /// </summary>
+  SelectionFingerprint stateFingerprint;
+
+  bool hasCachedState = false;
+
+  VisibilityState cachedState = VisibilityState::Enabled;
+
+  /// <summary>
+  /// Whether <see cref="preparation"/> was started since the command was
+  /// initialized.
+  /// </summary>
+  bool hasPreparation = false;
+
+  /// <summary>
+  /// The launch prepared for the last selection the command was shown for.
+  /// Kept while the command is pooled, so that its next use restarts it
+  /// rather than allocating another.
+  /// </summary>
+  std::shared_ptr<PreparedLaunch> preparation;
+
+  static std::atomic<uint64_t> cacheHits;
+  static std::atomic<uint64_t> cacheMisses;
+  static std::atomic<uint64_t> prefetchHits;
+  static std::atomic<uint64_t> prefetchMisses;
+  static std::atomic<uint64_t> recallsAvoided;
+
+  void Initialize(std::shared_ptr<const ConfigSnapshot> snapshot, const ContextMenuEntry& entry, const std::shared_ptr<SelectionAnalysis>& analysis);
+
+  void Recycle();
+
+  /// <summary>
+  /// Reads the selection into the shared analysis, unless it already holds
+  /// everything this command needs. Called with the analysis locked.
+  /// </summary>
+  bool Analyze(SelectionSource& source, const SelectionFingerprint& fingerprint);
+
+  VisibilityState EvaluateState(SelectionSource& source, const SelectionFingerprint& fingerprint, bool fingerprinted);
+
+protected:
+  /// <summary>
+  /// Called when the command has been initialized, before it is handed out.
+  /// </summary>
+  /// <param name="parent">The command this is a subcommand of, or
+  /// <c>nullptr</c>.</param>
+  /// <param name="index">The index of this subcommand in <paramref
+  /// name="parent"/>.</param>
+  virtual void Initialized(const MenuCommand*, size_t) {}
+
+  /// <summary>
+  /// Called when the command has been released for the last time, before
+  /// it is pooled.
+  /// </summary>
+  virtual void Recycled() {}
+
+public:
+  /// <summary>
+  /// Initializes a <see cref="MenuCommand"/>. Use <see cref="Create"/>
+  /// instead, which takes commands from the pool.
+  /// </summary>
+  MenuCommand(MenuCommandPool& pool, MenuCommandPlatform& platform, Log& log);
+
+  MenuCommand(const MenuCommand&) = delete;
+  MenuCommand& operator=(const MenuCommand&) = delete;
+
+  virtual ~MenuCommand();
+
+  /// <summary>
+  /// Creates a command for a context menu entry.
+  /// </summary>
+  /// <param name="pool">The pool to take the command from.</param>
+  /// <param name="log">A <see cref="Log"/>.</param>
+  /// <param name="snapshot">The snapshot <paramref name="entry"/> belongs
+  /// to.</param>
+  /// <param name="entry">The entry.</param>
+  /// <returns>The command, with one reference, or <c>nullptr</c> if out of
+  /// memory.</returns>
+  static MenuCommand* Create(MenuCommandPool& pool, Log& log, std::shared_ptr<const ConfigSnapshot> snapshot, const ContextMenuEntry& entry);
+
+  /// <summary>
+  /// The number of <see cref="GetState"/> calls answered from the cache,
+  /// across all commands.
+  /// </summary>
+  static uint64_t CacheHits() { return cacheHits; }
+
+  /// <summary>
+  /// The number of <see cref="GetState"/> calls that had to evaluate the
+  /// selection, across all commands.
+  /// </summary>
+  static uint64_t CacheMisses() { return cacheMisses; }
+
+  /// <summary>
+  /// The number of <see cref="Invoke"/> calls whose launch had been
+  /// prepared, across all commands.
+  /// </summary>
+  static uint64_t PrefetchHits() { return prefetchHits; }
+
+  /// <summary>
+  /// The number of <see cref="Invoke"/> calls on prefetching commands that
+  /// found no launch prepared in time, across all commands.
+  /// </summary>
+  static uint64_t PrefetchMisses() { return prefetchMisses; }
+
+  /// <summary>
+  /// The number of remote items, such as cloud files available online only,
+  /// inspected without being recalled, across all commands.
+  /// </summary>
+  static uint64_t RecallsAvoided() { return recallsAvoided; }
+
+  unsigned long AddRef();
+
+  /// <summary>
+  /// Releases a reference, recycling the command when it was the last.
+  /// </summary>
+  unsigned long Release();
+
+  const ContextMenuEntry& Entry() const { return *entry; }
+
+  size_t SubCommandCount() const { return subCommands.size(); }
+
+  /// <summary>
+  /// Gets a subcommand, creating it if need be. It shares this command's
+  /// analysis.
+  /// </summary>
+  /// <returns>The subcommand, which this command holds a reference to, or
+  /// <c>nullptr</c> if <paramref name="index"/> is out of range or out of
+  /// memory.</returns>
+  MenuCommand* GetSubCommand(size_t index);
+
+  /// <summary>
+  /// Gets the command's state for a selection, evaluating its condition
+  /// only if the selection differs from the last one, and starts preparing
+  /// the launch of a command that is shown and asks for it.
+  /// </summary>
+  VisibilityState GetState(SelectionSource& source);
+
+  /// <summary>
+  /// Runs the command, or forwards it to a running instance, for a
+  /// selection.
+  /// </summary>
+  /// <returns><c>true</c> on success or <c>false</c> if the command has
+  /// subcommands, the selection could not be read, or the process could not
+  /// be started.</returns>
+  bool Invoke(SelectionSource& source);
+};
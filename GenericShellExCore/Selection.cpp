@@ -0,0 +1,61 @@
+#include "Selection.h"
+
+uint64_t HashBytes(const void* data, size_t length) {
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  uint64_t hash = 0xcbf29ce484222325ull;
+
+  for (size_t i = 0; i < length; ++i) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+  }
+
+  return hash;
+}
+
+void Selection::Reset(size_t count) {
+  this->count = count;
+  remoteCount = 0;
+  pathLength = 0;
+  truncated = false;
+
+  paths.clear();
+  records.clear();
+}
+
+void Selection::Add(const wchar_t* path, size_t length, uint32_t attributes) {
+  if (attributes & ItemAttributeRemote) ++remoteCount;
+
+  records.push_back({ paths.size(), length, attributes, 0, 0 });
+  paths.insert(paths.end(), path, path + length);
+  pathLength += length;
+}
+
+void Selection::Truncate() {
+  truncated = true;
+}
+
+void Selection::Arrange(const std::vector<size_t>& indices) {
+  std::vector<Record> arranged;
+  arranged.reserve(indices.size());
+
+  // Paths stay where they are; only the records that point at them move
+  remoteCount = 0;
+  pathLength = 0;
+
+  for (size_t index : indices) {
+    const Record& record = records[index];
+
+    if (record.attributes & ItemAttributeRemote) ++remoteCount;
+
+    pathLength += record.length;
+    arranged.push_back(record);
+  }
+
+  count -= records.size() - arranged.size();
+  records.swap(arranged);
+}
+
+SelectionItem Selection::Item(size_t index) const {
+  const Record& record = records[index];
+
+  return { paths.data() + record.offset, record.length, record.attributes, record.signatures, record.markers };
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// Attributes of a selected item.
+/// </summary>
+/// <remarks>
+/// These are deliberately independent of the shell's <c>SFGAO</c> flags so
+/// that predicates can be evaluated without COM.
+/// </remarks>
+enum SelectionItemAttributes : uint32_t {
+  ItemAttributeNone = 0x0000,
+  ItemAttributeDirectory = 0x0001,
+  ItemAttributeReadOnly = 0x0002,
+  ItemAttributeHidden = 0x0004,
+  ItemAttributeSystem = 0x0008,
+  ItemAttributeLink = 0x0010,
+  ItemAttributeCompressed = 0x0020,
+  ItemAttributeEncrypted = 0x0040,
+  ItemAttributeSlow = 0x0080,
+  ItemAttributeFileSystem = 0x0100,
+
+  // Not stored locally, such as a cloud file that has not been downloaded.
+  // Opening it would recall it.
+  ItemAttributeRemote = 0x0200
+};
+
+/// <summary>
+/// A view of a single selected item.
+/// </summary>
+/// <remarks>
+/// <c>path</c> points into the owning <see cref="Selection"/> and is not
+/// null-terminated. It is valid until the selection is next reset.
+/// </remarks>
+struct SelectionItem {
+  const wchar_t* path = nullptr;
+  size_t length = 0;
+  uint32_t attributes = ItemAttributeNone;
+
+  /// <summary>
+  /// The <see cref="ContentSignatures"/> mask of the item's contents, or
+  /// zero if they were not read.
+  /// </summary>
+  uint64_t signatures = 0;
+
+  /// <summary>
+  /// The <see cref="DirectoryMarkers"/> mask of the markers in the item's
+  /// directory or its ancestors, or zero if they were not probed. A
+  /// directory's own markers count.
+  /// </summary>
+  uint64_t markers = 0;
+};
+
+/// <summary>
+/// A cheap identity for a selection: its item count and hashes of its first
+/// and last items.
+/// </summary>
+/// <remarks>
+/// Two selections with the same count, first item and last item are treated
+/// as the same selection.
+/// </remarks>
+struct SelectionFingerprint {
+  size_t count = 0;
+  uint64_t first = 0;
+  uint64_t last = 0;
+
+  bool operator==(const SelectionFingerprint& other) const {
+    return count == other.count && first == other.first && last == other.last;
+  }
+
+  bool operator!=(const SelectionFingerprint& other) const {
+    return !(*this == other);
+  }
+};
+
+/// <summary>
+/// Hashes bytes with 64-bit FNV-1a.
+/// </summary>
+/// <param name="data">The bytes to hash.</param>
+/// <param name="length">The number of bytes.</param>
+/// <returns>The hash.</returns>
+uint64_t HashBytes(const void* data, size_t length);
+
+/// <summary>
+/// The items of a shell selection, flattened into reusable storage.
+/// </summary>
+/// <remarks>
+/// Paths are stored back to back in a single buffer. Resetting a selection
+/// keeps its capacity, so reading a selection of a similar size again does
+/// not allocate.
+/// </remarks>
+class Selection {
+  struct Record {
+    size_t offset;
+    size_t length;
+    uint32_t attributes;
+    uint64_t signatures;
+    uint64_t markers;
+  };
+
+  std::vector<wchar_t> paths;
+  std::vector<Record> records;
+
+  size_t count = 0;
+  size_t remoteCount = 0;
+  size_t pathLength = 0;
+  bool truncated = false;
+
+public:
+  /// <summary>
+  /// Clears the selection in preparation for reading <paramref
+  /// name="count"/> items.
+  /// </summary>
+  /// <param name="count">The total number of items in the selection.</param>
+  void Reset(size_t count);
+
+  /// <summary>
+  /// Appends an inspected item.
+  /// </summary>
+  /// <param name="path">The item's path. Need not be null-terminated.</param>
+  /// <param name="length">The length of <paramref name="path"/>, in
+  /// characters.</param>
+  /// <param name="attributes">The item's <see
+  /// cref="SelectionItemAttributes"/>.</param>
+  void Add(const wchar_t* path, size_t length, uint32_t attributes);
+
+  /// <summary>
+  /// Marks the selection as not fully inspected, either because it was too
+  /// large or because reading it took too long.
+  /// </summary>
+  void Truncate();
+
+  /// <summary>
+  /// Keeps only some of the inspected items, in a new order.
+  /// </summary>
+  /// <remarks>
+  /// Items that are dropped no longer count towards <see cref="Count"/>.
+  /// </remarks>
+  /// <param name="indices">The indices of the items to keep, each less
+  /// than <see cref="Inspected"/> and listed at most once, in their new
+  /// order.</param>
+  void Arrange(const std::vector<size_t>& indices);
+
+  /// <summary>
+  /// Records the <see cref="ContentSignatures"/> mask of an inspected item's
+  /// contents.
+  /// </summary>
+  /// <param name="index">The item index, which must be less than <see
+  /// cref="Inspected"/>.</param>
+  /// <param name="signatures">The mask.</param>
+  void SetSignatures(size_t index, uint64_t signatures) { records[index].signatures = signatures; }
+
+  /// <summary>
+  /// Records the <see cref="DirectoryMarkers"/> mask of the markers in an
+  /// inspected item's directory or its ancestors.
+  /// </summary>
+  /// <param name="index">The item index, which must be less than <see
+  /// cref="Inspected"/>.</param>
+  /// <param name="markers">The mask.</param>
+  void SetMarkers(size_t index, uint64_t markers) { records[index].markers = markers; }
+
+  /// <summary>
+  /// The total number of items in the selection.
+  /// </summary>
+  size_t Count() const { return count; }
+
+  /// <summary>
+  /// The number of items that have been inspected.
+  /// </summary>
+  size_t Inspected() const { return records.size(); }
+
+  /// <summary>
+  /// The total length of the inspected items' paths, in characters.
+  /// </summary>
+  size_t PathLength() const { return pathLength; }
+
+  /// <summary>
+  /// The number of inspected items with <see cref="ItemAttributeRemote"/>.
+  /// </summary>
+  size_t RemoteCount() const { return remoteCount; }
+
+  /// <summary>
+  /// Whether the selection was not fully inspected.
+  /// </summary>
+  bool IsTruncated() const { return truncated; }
+
+  /// <summary>
+  /// Gets an inspected item.
+  /// </summary>
+  /// <param name="index">The item index, which must be less than <see
+  /// cref="Inspected"/>.</param>
+  /// <returns>A view of the item.</returns>
+  SelectionItem Item(size_t index) const;
+};
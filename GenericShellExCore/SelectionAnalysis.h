@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include "Selection.h"
+
+/// <summary>
+/// A selection read once and shared between a <see cref="MenuCommand"/> and
+/// its subcommands.
+/// </summary>
+struct SelectionAnalysis {
+  /// <summary>
+  /// Held while the selection is read and evaluated, since a command and
+  /// its subcommands can be asked for their state on different threads at
+  /// once.
+  /// </summary>
+  std::mutex lock;
+
+  /// <summary>
+  /// The fingerprint of the selection that was read.
+  /// </summary>
+  SelectionFingerprint fingerprint;
+
+  /// <summary>
+  /// Whether <see cref="selection"/> has been read.
+  /// </summary>
+  bool valid = false;
+
+  /// <summary>
+  /// The selection.
+  /// </summary>
+  Selection selection;
+
+  /// <summary>
+  /// Whether <see cref="selection"/> includes item paths.
+  /// </summary>
+  bool hasPaths = false;
+
+  /// <summary>
+  /// Whether the contents of <see cref="selection"/>'s files have been
+  /// matched against the snapshot's content signatures.
+  /// </summary>
+  bool hasContent = false;
+
+  /// <summary>
+  /// Whether the ancestors of <see cref="selection"/>'s items have been
+  /// probed for the snapshot's directory markers.
+  /// </summary>
+  bool hasMarkers = false;
+
+  /// <summary>
+  /// The inspection limit <see cref="selection"/> was read with.
+  /// </summary>
+  size_t limit = 0;
+};
@@ -0,0 +1,172 @@
+#include <algorithm>
+
+#include "SelectionOrder.h"
+#include "SelectionPredicate.h"
+
+namespace {
+  bool IsSeparator(wchar_t c) {
+    return c == L'\\' || c == L'/';
+  }
+
+  bool IsDigit(wchar_t c) {
+    return c >= L'0' && c <= L'9';
+  }
+
+  /// <summary>
+  /// Folds a character for sorting. Separators come first, so that a
+  /// directory's contents sort together, before names that merely start
+  /// with the directory's name.
+  /// </summary>
+  wchar_t SortKey(wchar_t c) {
+    return IsSeparator(c) ? L'\0' : SelectionPredicate::Fold(c);
+  }
+
+  int ComparePaths(std::wstring_view a, std::wstring_view b) {
+    size_t length = std::min(a.size(), b.size());
+
+    for (size_t i = 0; i < length; ++i) {
+      wchar_t x = SortKey(a[i]);
+      wchar_t y = SortKey(b[i]);
+
+      if (x != y) return x < y ? -1 : 1;
+    }
+
+    return a.size() == b.size() ? 0 : a.size() < b.size() ? -1 : 1;
+  }
+
+  std::wstring_view ItemPath(const Selection& selection, size_t index) {
+    SelectionItem item = selection.Item(index);
+
+    return std::wstring_view(item.path, item.length);
+  }
+
+  /// <summary>
+  /// Compares the identities of two items: their volume and file ID if
+  /// both are known, and otherwise their paths.
+  /// </summary>
+  int CompareIdentity(const Selection& selection, const SelectionFileInfo* files, size_t a, size_t b) {
+    bool knownA = files && files[a].known;
+    bool knownB = files && files[b].known;
+
+    if (knownA != knownB) return knownA ? -1 : 1;
+
+    if (!knownA) return ComparePaths(ItemPath(selection, a), ItemPath(selection, b));
+
+    if (files[a].volume != files[b].volume) return files[a].volume < files[b].volume ? -1 : 1;
+    if (files[a].fileId != files[b].fileId) return files[a].fileId < files[b].fileId ? -1 : 1;
+
+    return 0;
+  }
+}
+
+int CompareNatural(std::wstring_view a, std::wstring_view b) {
+  size_t i = 0;
+  size_t j = 0;
+
+  while (i < a.size() && j < b.size()) {
+    if (IsDigit(a[i]) && IsDigit(b[j])) {
+      // Leading zeros do not change a number's value
+      while (i < a.size() && a[i] == L'0') ++i;
+      while (j < b.size() && b[j] == L'0') ++j;
+
+      size_t endA = i;
+      size_t endB = j;
+
+      while (endA < a.size() && IsDigit(a[endA])) ++endA;
+      while (endB < b.size() && IsDigit(b[endB])) ++endB;
+
+      // Without leading zeros, a longer number is a larger one
+      if (endA - i != endB - j) return endA - i < endB - j ? -1 : 1;
+
+      for (; i < endA; ++i, ++j) {
+        if (a[i] != b[j]) return a[i] < b[j] ? -1 : 1;
+      }
+
+      continue;
+    }
+
+    wchar_t x = SortKey(a[i++]);
+    wchar_t y = SortKey(b[j++]);
+
+    if (x != y) return x < y ? -1 : 1;
+  }
+
+  size_t restA = a.size() - i;
+  size_t restB = b.size() - j;
+
+  return restA == restB ? 0 : restA < restB ? -1 : 1;
+}
+
+void ArrangeSelection(Selection& selection, const SelectionOrder& order, const std::vector<SelectionFileInfo>& files) {
+  if (order.IsEmpty()) return;
+
+  size_t inspected = selection.Inspected();
+  const SelectionFileInfo* info = files.size() == inspected ? files.data() : nullptr;
+  std::vector<size_t> indices(inspected);
+
+  for (size_t i = 0; i < inspected; ++i) indices[i] = i;
+
+  if (order.unique) {
+    std::vector<size_t> byIdentity;
+    std::vector<bool> duplicate(inspected);
+
+    // Items without paths cannot be told apart, so they are all kept
+    for (size_t i = 0; i < inspected; ++i) {
+      if (selection.Item(i).length) byIdentity.push_back(i);
+    }
+
+    // Sorting by identity puts copies of a file next to each other, with
+    // the first in Explorer's order leading
+    std::sort(byIdentity.begin(), byIdentity.end(), [&](size_t a, size_t b) {
+      int comparison = CompareIdentity(selection, info, a, b);
+
+      return comparison ? comparison < 0 : a < b;
+    });
+
+    for (size_t i = 1; i < byIdentity.size(); ++i) {
+      if (!CompareIdentity(selection, info, byIdentity[i - 1], byIdentity[i])) duplicate[byIdentity[i]] = true;
+    }
+
+    indices.erase(std::remove_if(indices.begin(), indices.end(), [&](size_t i) { return duplicate[i]; }), indices.end());
+  }
+
+  if (order.sort != SelectionSortKey::None) {
+    // Breaking ties by index makes the sort stable, and lets a partial sort
+    // pick the same items a full one would
+    auto before = [&](size_t a, size_t b) {
+      int comparison = 0;
+
+      switch (order.sort) {
+      case SelectionSortKey::Natural:
+        comparison = CompareNatural(ItemPath(selection, a), ItemPath(selection, b));
+        break;
+      case SelectionSortKey::Path:
+        comparison = ComparePaths(ItemPath(selection, a), ItemPath(selection, b));
+        break;
+      case SelectionSortKey::Modified: {
+        uint64_t x = info ? info[a].lastWriteTime : 0;
+        uint64_t y = info ? info[b].lastWriteTime : 0;
+
+        comparison = x == y ? 0 : x < y ? -1 : 1;
+        break;
+      }
+      default:
+        break;
+      }
+
+      if (order.descending) comparison = -comparison;
+
+      return comparison ? comparison < 0 : a < b;
+    };
+
+    if (order.limit < indices.size()) {
+      std::partial_sort(indices.begin(), indices.begin() + static_cast<ptrdiff_t>(order.limit), indices.end(), before);
+    } else {
+      std::sort(indices.begin(), indices.end(), before);
+    }
+  }
+
+  if (indices.size() > order.limit) indices.resize(order.limit);
+
+  if (indices.size() < inspected || order.sort != SelectionSortKey::None) selection.Arrange(indices);
+}
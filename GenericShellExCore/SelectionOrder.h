@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "Selection.h"
+
+/// <summary>
+/// What a selection is sorted by before a command is expanded.
+/// </summary>
+enum class SelectionSortKey {
+  /// <summary>
+  /// The items are left in the order Explorer gave them.
+  /// </summary>
+  None,
+
+  /// <summary>
+  /// Paths, ignoring case, with runs of digits compared by value, so that
+  /// <c>file2</c> comes before <c>file10</c>.
+  /// </summary>
+  Natural,
+
+  /// <summary>
+  /// Paths, ignoring case.
+  /// </summary>
+  Path,
+
+  /// <summary>
+  /// Last write times, oldest first.
+  /// </summary>
+  Modified
+};
+
+/// <summary>
+/// The identity and last write time of a selected item, read from the file
+/// system.
+/// </summary>
+struct SelectionFileInfo {
+  uint64_t volume = 0;
+  uint64_t fileId = 0;
+  uint64_t lastWriteTime = 0;
+
+  /// <summary>
+  /// Whether the item could be read. Items that could not are told apart
+  /// by their paths and sort as the oldest.
+  /// </summary>
+  bool known = false;
+};
+
+/// <summary>
+/// How a context menu entry's selection is deduplicated, sorted and capped
+/// before its command is expanded, from the entry's <c>selection</c>
+/// block.
+/// </summary>
+struct SelectionOrder {
+  /// <summary>
+  /// Whether items that are the same file are passed once. Files are
+  /// compared by volume and file ID, so the same file reached through a
+  /// library and through its folder, or through two hard links, is one
+  /// item.
+  /// </summary>
+  bool unique = false;
+
+  SelectionSortKey sort = SelectionSortKey::None;
+
+  /// <summary>
+  /// Whether the sort order is reversed.
+  /// </summary>
+  bool descending = false;
+
+  /// <summary>
+  /// The largest number of items passed, counted after sorting.
+  /// </summary>
+  size_t limit = SIZE_MAX;
+
+  /// <summary>
+  /// Whether the selection is left as it is.
+  /// </summary>
+  bool IsEmpty() const { return !unique && sort == SelectionSortKey::None && limit == SIZE_MAX; }
+
+  /// <summary>
+  /// Whether applying the order needs each item's <see
+  /// cref="SelectionFileInfo"/>.
+  /// </summary>
+  bool NeedsFileInfo() const { return unique || sort == SelectionSortKey::Modified; }
+};
+
+/// <summary>
+/// Compares two paths in natural order: ignoring case, with runs of digits
+/// compared by value and separators before any other character.
+/// </summary>
+/// <returns>A negative number if <paramref name="a"/> comes first, a
+/// positive number if <paramref name="b"/> does, or zero if they are
+/// equal.</returns>
+int CompareNatural(std::wstring_view a, std::wstring_view b);
+
+/// <summary>
+/// Deduplicates, sorts and caps the inspected items of a selection.
+/// </summary>
+/// <remarks>
+/// <para>Sorting is stable: items that compare equal keep Explorer's order.
+/// When only the first <see cref="SelectionOrder::limit"/> items are kept,
+/// only those are sorted, so capping a huge selection costs little more
+/// than reading it.</para>
+/// <para>Of items that are the same file, the first in Explorer's order is
+/// kept. Items without file information are the same only if their paths
+/// are.</para>
+/// </remarks>
+/// <param name="selection">The selection, read with paths.</param>
+/// <param name="order">The order.</param>
+/// <param name="files">The file information of each inspected item, or an
+/// empty vector if none was read.</param>
+void ArrangeSelection(Selection& selection, const SelectionOrder& order, const std::vector<SelectionFileInfo>& files);
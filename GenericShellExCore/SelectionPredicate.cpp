@@ -0,0 +1,347 @@
+#include <cwctype>
+
+#include "ContentSignatures.h"
+#include "DirectoryMarkers.h"
+#include "SelectionPredicate.h"
+
+namespace {
+  constexpr uint32_t FnvOffsetBasis = 0x811c9dc5u;
+  constexpr uint32_t FnvPrime = 0x01000193u;
+
+  constexpr size_t StateWords = SelectionPredicate::MaxGlobStates / 64;
+
+  bool IsSeparator(wchar_t c) {
+    return c == L'\\' || c == L'/';
+  }
+
+  uint32_t HashStep(uint32_t hash, wchar_t c) {
+    return (hash ^ static_cast<uint32_t>(c)) * FnvPrime;
+  }
+
+  /// <summary>
+  /// Gets the offset of the first character of the name in <paramref
+  /// name="item"/>'s path.
+  /// </summary>
+  size_t NameOffset(const SelectionItem& item) {
+    for (size_t i = item.length; i > 0; --i) {
+      if (IsSeparator(item.path[i - 1])) return i;
+    }
+
+    return 0;
+  }
+
+  void SetState(uint64_t* states, size_t state) {
+    states[state / 64] |= uint64_t(1) << (state % 64);
+  }
+
+  bool HasState(const uint64_t* states, size_t state) {
+    return (states[state / 64] >> (state % 64)) & 1;
+  }
+}
+
+wchar_t SelectionPredicate::Fold(wchar_t c) {
+  if (c >= L'A' && c <= L'Z') return static_cast<wchar_t>(c + (L'a' - L'A'));
+  if (c < 0x80) return c;
+
+  return static_cast<wchar_t>(std::towlower(static_cast<std::wint_t>(c)));
+}
+
+void SelectionPredicate::InsertExtension(const ExtensionSlot& slot) {
+  size_t mask = extensionTable.size() - 1;
+
+  for (size_t i = slot.hash & mask; ; i = (i + 1) & mask) {
+    if (!extensionTable[i].length) {
+      extensionTable[i] = slot;
+
+      return;
+    }
+  }
+}
+
+bool SelectionPredicate::AddExtension(const std::wstring& extension) {
+  size_t start = (!extension.empty() && extension[0] == L'.') ? 1 : 0;
+
+  if (start >= extension.size()) return false;
+
+  ExtensionSlot slot = { FnvOffsetBasis, static_cast<uint32_t>(extensionChars.size()), static_cast<uint32_t>(extension.size() - start) };
+
+  for (size_t i = start; i < extension.size(); ++i) {
+    wchar_t c = Fold(extension[i]);
+
+    extensionChars.push_back(c);
+    slot.hash = HashStep(slot.hash, c);
+  }
+
+  configured = true;
+
+  if (FindExtension(extensionChars.data() + slot.offset, slot.length, slot.hash)) {
+    extensionChars.resize(slot.offset);
+
+    return true;
+  }
+
+  // Keep the table at most half full so probe sequences stay short
+  if ((extensionCount + 1) * 2 > extensionTable.size()) {
+    std::vector<ExtensionSlot> old(std::move(extensionTable));
+    extensionTable.assign(old.empty() ? 8 : old.size() * 2, ExtensionSlot{ 0, 0, 0 });
+
+    for (const ExtensionSlot& existing : old) {
+      if (existing.length) InsertExtension(existing);
+    }
+  }
+
+  InsertExtension(slot);
+  ++extensionCount;
+
+  return true;
+}
+
+bool SelectionPredicate::FindExtension(const wchar_t* extension, size_t length, uint32_t hash) const {
+  if (!extensionCount) return false;
+
+  size_t mask = extensionTable.size() - 1;
+
+  for (size_t i = hash & mask; extensionTable[i].length; i = (i + 1) & mask) {
+    const ExtensionSlot& slot = extensionTable[i];
+
+    if (slot.hash != hash || slot.length != length) continue;
+
+    const wchar_t* chars = extensionChars.data() + slot.offset;
+    size_t j = 0;
+
+    while (j < length && chars[j] == Fold(extension[j])) ++j;
+
+    if (j == length) return true;
+  }
+
+  return false;
+}
+
+bool SelectionPredicate::MatchExtension(const SelectionItem& item) const {
+  size_t nameOffset = NameOffset(item);
+  size_t start = 0;
+
+  for (size_t i = item.length; i > nameOffset; --i) {
+    if (item.path[i - 1] == L'.') {
+      start = i;
+      break;
+    }
+  }
+
+  if (!start || start == item.length) return false;
+
+  uint32_t hash = FnvOffsetBasis;
+
+  for (size_t i = start; i < item.length; ++i) hash = HashStep(hash, Fold(item.path[i]));
+
+  return FindExtension(item.path + start, item.length - start, hash);
+}
+
+bool SelectionPredicate::AddPathGlob(const std::wstring& glob) {
+  if (glob.empty()) return false;
+
+  Glob compiled = { globOps.size(), 0, true };
+
+  for (size_t i = 0; i < glob.size(); ++i) {
+    wchar_t c = glob[i];
+
+    if (c == L'*') {
+      if (i + 1 < glob.size() && glob[i + 1] == L'*') {
+        ++i;
+
+        if (i + 1 < glob.size() && IsSeparator(glob[i + 1])) {
+          ++i;
+          globOps.push_back({ GlobOpKind::GlobStarDirectory, 0 });
+          compiled.matchName = false;
+        } else {
+          globOps.push_back({ GlobOpKind::GlobStar, 0 });
+        }
+      } else {
+        globOps.push_back({ GlobOpKind::Star, 0 });
+      }
+    } else if (c == L'?') {
+      globOps.push_back({ GlobOpKind::AnyChar, 0 });
+    } else if (IsSeparator(c)) {
+      globOps.push_back({ GlobOpKind::Separator, 0 });
+      compiled.matchName = false;
+    } else {
+      globOps.push_back({ GlobOpKind::Literal, Fold(c) });
+    }
+  }
+
+  compiled.length = globOps.size() - compiled.offset;
+
+  // One state per op plus the accepting state
+  if (compiled.length + 1 > MaxGlobStates) {
+    globOps.resize(compiled.offset);
+
+    return false;
+  }
+
+  globs.push_back(compiled);
+  configured = true;
+
+  return true;
+}
+
+bool SelectionPredicate::MatchGlob(const Glob& glob, const SelectionItem& item) const {
+  const GlobOp* ops = globOps.data() + glob.offset;
+  size_t accept = glob.length;
+
+  uint64_t current[StateWords] = {};
+  uint64_t next[StateWords] = {};
+
+  // Star-like ops may match nothing, so a state at a star also implies the
+  // state after it. States only ever move forward, so one ascending pass
+  // computes the closure.
+  auto closure = [&](uint64_t* states) {
+    for (size_t i = 0; i < accept; ++i) {
+      if (ops[i].kind >= GlobOpKind::Star && HasState(states, i)) SetState(states, i + 1);
+    }
+  };
+
+  SetState(current, 0);
+  closure(current);
+
+  for (size_t p = glob.matchName ? NameOffset(item) : 0; p < item.length; ++p) {
+    wchar_t c = item.path[p];
+    wchar_t folded = Fold(c);
+    bool separator = IsSeparator(c);
+    bool any = false;
+
+    for (uint64_t& word : next) word = 0;
+
+    for (size_t i = 0; i < accept; ++i) {
+      if (!HasState(current, i)) continue;
+
+      switch (ops[i].kind) {
+      case GlobOpKind::Literal:
+        if (folded == ops[i].c) SetState(next, i + 1);
+        break;
+      case GlobOpKind::Separator:
+        if (separator) SetState(next, i + 1);
+        break;
+      case GlobOpKind::AnyChar:
+        if (!separator) SetState(next, i + 1);
+        break;
+      case GlobOpKind::Star:
+        if (!separator) SetState(next, i);
+        break;
+      case GlobOpKind::GlobStar:
+        SetState(next, i);
+        break;
+      case GlobOpKind::GlobStarDirectory:
+        SetState(next, i);
+        if (separator) SetState(next, i + 1);
+        break;
+      }
+    }
+
+    closure(next);
+
+    for (size_t w = 0; w < StateWords; ++w) {
+      current[w] = next[w];
+      any |= next[w] != 0;
+    }
+
+    if (!any) return false;
+  }
+
+  return HasState(current, accept);
+}
+
+bool SelectionPredicate::MatchItem(const SelectionItem& item) const {
+  bool isDirectory = (item.attributes & ItemAttributeDirectory) != 0;
+
+  if (itemType == PredicateItemType::File && isDirectory) return false;
+  if (itemType == PredicateItemType::Directory && !isDirectory) return false;
+
+  if ((item.attributes & requiredAttributes) != requiredAttributes) return false;
+  if (item.attributes & forbiddenAttributes) return false;
+
+  if (extensionCount && !MatchExtension(item)) return false;
+
+  // Contents or ancestors that could not be read in time do not rule the
+  // item out, but leave the result inconclusive
+  if (contentSignatures && !(item.signatures & (contentSignatures | ContentSignatures::Unknown))) return false;
+  if (markers && !(item.markers & (markers | DirectoryMarkers::Unknown))) return false;
+
+  if (!globs.empty()) {
+    for (const Glob& glob : globs) {
+      if (MatchGlob(glob, item)) return true;
+    }
+
+    return false;
+  }
+
+  return true;
+}
+
+void SelectionPredicate::SetCountBounds(size_t min, size_t max) {
+  minCount = min;
+  maxCount = max;
+  configured = true;
+}
+
+void SelectionPredicate::SetItemType(PredicateItemType type) {
+  itemType = type;
+  configured = true;
+}
+
+void SelectionPredicate::SetAttributes(uint32_t required, uint32_t forbidden) {
+  requiredAttributes = required;
+  forbiddenAttributes = forbidden;
+  configured = true;
+}
+
+void SelectionPredicate::SetContentSignatures(uint64_t mask) {
+  contentSignatures = mask;
+  configured = true;
+}
+
+void SelectionPredicate::SetMarkers(uint64_t mask) {
+  markers = mask;
+  configured = true;
+}
+
+void SelectionPredicate::SetInspectLimit(size_t limit) {
+  inspectLimit = limit;
+}
+
+void SelectionPredicate::SetTimeBudget(std::chrono::milliseconds budget) {
+  timeBudget = budget;
+}
+
+void SelectionPredicate::SetFallback(VisibilityState state) {
+  fallback = state;
+}
+
+void SelectionPredicate::SetRemoteItemPolicy(RemoteItemPolicy policy) {
+  remoteItems = policy;
+  configured = true;
+}
+
+PredicateResult SelectionPredicate::Evaluate(const Selection& selection) const {
+  if (selection.Count() < minCount || selection.Count() > maxCount) return PredicateResult::NoMatch;
+
+  if (!NeedsItems()) return PredicateResult::Match;
+
+  bool unknown = false;
+
+  // Any inspected item that fails is conclusive, even for a truncated
+  // selection
+  for (size_t i = 0; i < selection.Inspected(); ++i) {
+    SelectionItem item = selection.Item(i);
+
+    if (!MatchItem(item)) return PredicateResult::NoMatch;
+
+    if (contentSignatures && (item.signatures & ContentSignatures::Unknown)) unknown = true;
+    if (markers && (item.markers & DirectoryMarkers::Unknown)) unknown = true;
+  }
+
+  if (unknown) return PredicateResult::Inconclusive;
+
+  if (remoteItems == RemoteItemPolicy::Fallback && selection.RemoteCount()) return PredicateResult::Inconclusive;
+
+  return selection.IsTruncated() ? PredicateResult::Inconclusive : PredicateResult::Match;
+}
@@ -0,0 +1,257 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Selection.h"
+
+/// <summary>
+/// The state in which a context menu entry is presented.
+/// </summary>
+enum class VisibilityState {
+  Enabled,
+  Disabled,
+  Hidden
+};
+
+/// <summary>
+/// The item types a predicate accepts.
+/// </summary>
+enum class PredicateItemType {
+  Any,
+  File,
+  Directory
+};
+
+/// <summary>
+/// How a predicate treats items with <see cref="ItemAttributeRemote"/>.
+/// </summary>
+enum class RemoteItemPolicy {
+  /// <summary>
+  /// Remote items are judged by their paths and attributes, and conditions
+  /// that would have to open them do not match them.
+  /// </summary>
+  Skip,
+
+  /// <summary>
+  /// A selection with remote items is treated as not fully inspected.
+  /// </summary>
+  Fallback
+};
+
+/// <summary>
+/// The outcome of evaluating a <see cref="SelectionPredicate"/>.
+/// </summary>
+enum class PredicateResult {
+  Match,
+  NoMatch,
+
+  /// <summary>
+  /// The selection could not be fully inspected.
+  /// </summary>
+  Inconclusive
+};
+
+/// <summary>
+/// A compiled <c>when</c> clause that decides whether a context menu entry
+/// applies to a selection.
+/// </summary>
+/// <remarks>
+/// <para>Every inspected item must satisfy every configured condition. Item
+/// count bounds apply to the selection as a whole.</para>
+/// <para>Extensions are kept in an open-addressed hash table and globs are
+/// compiled into small NFAs that are simulated with a fixed-size state set,
+/// so evaluation never allocates.</para>
+/// </remarks>
+class SelectionPredicate {
+public:
+  /// <summary>
+  /// The largest number of NFA states a single glob may compile to.
+  /// </summary>
+  static constexpr size_t MaxGlobStates = 256;
+
+private:
+  struct ExtensionSlot {
+    uint32_t hash;
+    uint32_t offset;
+    uint32_t length;
+  };
+
+  enum class GlobOpKind : uint8_t {
+    Literal,
+    Separator,
+    AnyChar,
+    Star,
+    GlobStar,
+    GlobStarDirectory
+  };
+
+  struct GlobOp {
+    GlobOpKind kind;
+    wchar_t c;
+  };
+
+  struct Glob {
+    size_t offset;
+    size_t length;
+    bool matchName;
+  };
+
+  std::wstring extensionChars;
+  std::vector<ExtensionSlot> extensionTable;
+  size_t extensionCount = 0;
+
+  std::vector<GlobOp> globOps;
+  std::vector<Glob> globs;
+
+  size_t minCount = 0;
+  size_t maxCount = SIZE_MAX;
+
+  PredicateItemType itemType = PredicateItemType::Any;
+
+  uint32_t requiredAttributes = ItemAttributeNone;
+  uint32_t forbiddenAttributes = ItemAttributeNone;
+
+  uint64_t contentSignatures = 0;
+  uint64_t markers = 0;
+
+  size_t inspectLimit = 1024;
+  std::chrono::milliseconds timeBudget = std::chrono::milliseconds(50);
+  VisibilityState fallback = VisibilityState::Enabled;
+  RemoteItemPolicy remoteItems = RemoteItemPolicy::Skip;
+
+  bool configured = false;
+
+  void InsertExtension(const ExtensionSlot& slot);
+  bool FindExtension(const wchar_t* extension, size_t length, uint32_t hash) const;
+  bool MatchExtension(const SelectionItem& item) const;
+  bool MatchGlob(const Glob& glob, const SelectionItem& item) const;
+  bool MatchItem(const SelectionItem& item) const;
+
+public:
+  /// <summary>
+  /// Folds a character for case-insensitive comparison.
+  /// </summary>
+  /// <param name="c">The character to fold.</param>
+  /// <returns>The folded character.</returns>
+  static wchar_t Fold(wchar_t c);
+
+  /// <summary>
+  /// Adds an extension to the set of accepted extensions. A leading
+  /// <c>.</c> is optional.
+  /// </summary>
+  /// <param name="extension">The extension.</param>
+  /// <returns><c>true</c> on success or <c>false</c> if <paramref
+  /// name="extension"/> is empty.</returns>
+  bool AddExtension(const std::wstring& extension);
+
+  /// <summary>
+  /// Adds a glob to the set of accepted path globs.
+  /// </summary>
+  /// <remarks>
+  /// <c>?</c> matches any character except a separator, <c>*</c> matches any
+  /// run of characters except separators and <c>**</c> matches any run of
+  /// characters. Globs without a separator are matched against the item's
+  /// name only. Both <c>\</c> and <c>/</c> are separators.
+  /// </remarks>
+  /// <param name="glob">The glob.</param>
+  /// <returns><c>true</c> on success or <c>false</c> if <paramref
+  /// name="glob"/> is empty or compiles to more than <see
+  /// cref="MaxGlobStates"/> states.</returns>
+  bool AddPathGlob(const std::wstring& glob);
+
+  /// <summary>
+  /// Sets the inclusive bounds on the number of selected items.
+  /// </summary>
+  void SetCountBounds(size_t min, size_t max);
+
+  /// <summary>
+  /// Sets the item types that are accepted.
+  /// </summary>
+  void SetItemType(PredicateItemType type);
+
+  /// <summary>
+  /// Sets the <see cref="SelectionItemAttributes"/> items must have and
+  /// must not have.
+  /// </summary>
+  void SetAttributes(uint32_t required, uint32_t forbidden);
+
+  /// <summary>
+  /// Sets the <see cref="ContentSignatures"/> mask of the patterns a file's
+  /// contents must start with, one of which must match. Directories never
+  /// match.
+  /// </summary>
+  void SetContentSignatures(uint64_t mask);
+
+  /// <summary>
+  /// Sets the <see cref="DirectoryMarkers"/> mask of the markers one of
+  /// which an item's directory or one of its ancestors must contain. A
+  /// directory is its own first candidate.
+  /// </summary>
+  void SetMarkers(uint64_t mask);
+
+  /// <summary>
+  /// Sets the largest number of items that will be inspected.
+  /// </summary>
+  void SetInspectLimit(size_t limit);
+
+  /// <summary>
+  /// Sets the time allowed for reading the selection.
+  /// </summary>
+  void SetTimeBudget(std::chrono::milliseconds budget);
+
+  /// <summary>
+  /// Sets the state presented when the selection cannot be fully
+  /// inspected.
+  /// </summary>
+  void SetFallback(VisibilityState state);
+
+  /// <summary>
+  /// Sets how items that are not stored locally are treated.
+  /// </summary>
+  void SetRemoteItemPolicy(RemoteItemPolicy policy);
+
+  /// <summary>
+  /// Whether any condition has been configured.
+  /// </summary>
+  bool IsConfigured() const { return configured; }
+
+  /// <summary>
+  /// Whether evaluation needs item paths.
+  /// </summary>
+  bool NeedsPaths() const { return extensionCount || !globs.empty() || NeedsContent() || NeedsMarkers(); }
+
+  /// <summary>
+  /// Whether evaluation needs the items' contents to have been matched
+  /// against <see cref="ContentSignatures"/>.
+  /// </summary>
+  bool NeedsContent() const { return contentSignatures != 0; }
+
+  /// <summary>
+  /// Whether evaluation needs the items' ancestors to have been probed for
+  /// <see cref="DirectoryMarkers"/>.
+  /// </summary>
+  bool NeedsMarkers() const { return markers != 0; }
+
+  /// <summary>
+  /// Whether evaluation needs to inspect individual items at all.
+  /// </summary>
+  bool NeedsItems() const {
+    return NeedsPaths() || itemType != PredicateItemType::Any || requiredAttributes || forbiddenAttributes || remoteItems != RemoteItemPolicy::Skip;
+  }
+
+  size_t InspectLimit() const { return inspectLimit; }
+  std::chrono::milliseconds TimeBudget() const { return timeBudget; }
+  VisibilityState Fallback() const { return fallback; }
+  RemoteItemPolicy RemoteItems() const { return remoteItems; }
+  uint64_t Markers() const { return markers; }
+
+  /// <summary>
+  /// Evaluates the predicate against a selection.
+  /// </summary>
+  /// <param name="selection">The selection.</param>
+  /// <returns>A <see cref="PredicateResult"/>.</returns>
+  PredicateResult Evaluate(const Selection& selection) const;
+};
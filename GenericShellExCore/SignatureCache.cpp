@@ -0,0 +1,40 @@
+#include "Selection.h"
+#include "SignatureCache.h"
+
+size_t SignatureCache::KeyHash::operator()(const FileVersionKey& key) const {
+  return static_cast<size_t>(HashBytes(&key, sizeof(key)));
+}
+
+bool SignatureCache::Find(const FileVersionKey& key, uint64_t& mask) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  auto found = index.find(key);
+
+  if (found == index.end()) return false;
+
+  entries.splice(entries.begin(), entries, found->second);
+  mask = found->second->mask;
+
+  return true;
+}
+
+void SignatureCache::Insert(const FileVersionKey& key, uint64_t mask) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  auto found = index.find(key);
+
+  if (found != index.end()) {
+    found->second->mask = mask;
+    entries.splice(entries.begin(), entries, found->second);
+
+    return;
+  }
+
+  if (entries.size() >= capacity && !entries.empty()) {
+    index.erase(entries.back().key);
+    entries.pop_back();
+  }
+
+  entries.push_front({ key, mask });
+  index.emplace(key, entries.begin());
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+/// <summary>
+/// Identifies a version of a file's contents without reading them.
+/// </summary>
+struct FileVersionKey {
+  uint64_t volume = 0;
+  uint64_t fileId = 0;
+  uint64_t size = 0;
+  uint64_t lastWriteTime = 0;
+
+  /// <summary>
+  /// The <see cref="ContentSignatures::Hash"/> of the patterns the file was
+  /// matched against.
+  /// </summary>
+  uint64_t signatures = 0;
+
+  bool operator==(const FileVersionKey& other) const = default;
+};
+
+/// <summary>
+/// A least recently used cache of the <see cref="ContentSignatures"/> masks
+/// of files, so that right-clicking the same files again never reads them.
+/// </summary>
+/// <remarks>
+/// A file that is written gets a new last write time and so a new key; its
+/// old entry ages out. The cache is safe to use from several threads.
+/// </remarks>
+class SignatureCache {
+  struct KeyHash {
+    size_t operator()(const FileVersionKey& key) const;
+  };
+
+  struct Entry {
+    FileVersionKey key;
+    uint64_t mask;
+  };
+
+  std::mutex mutex;
+  size_t capacity;
+
+  /// <summary>
+  /// Entries, most recently used first.
+  /// </summary>
+  std::list<Entry> entries;
+  std::unordered_map<FileVersionKey, std::list<Entry>::iterator, KeyHash> index;
+
+public:
+  /// <summary>
+  /// Initializes a <see cref="SignatureCache"/>.
+  /// </summary>
+  /// <param name="capacity">The largest number of files remembered.</param>
+  explicit SignatureCache(size_t capacity) : capacity(capacity) {}
+
+  /// <summary>
+  /// Looks up a file.
+  /// </summary>
+  /// <param name="key">The file version.</param>
+  /// <param name="mask">Receives the file's mask.</param>
+  /// <returns><c>true</c> if the file is cached; otherwise,
+  /// <c>false</c>.</returns>
+  bool Find(const FileVersionKey& key, uint64_t& mask);
+
+  /// <summary>
+  /// Remembers a file's mask, forgetting the least recently used file if the
+  /// cache is full.
+  /// </summary>
+  void Insert(const FileVersionKey& key, uint64_t mask);
+};
@@ -0,0 +1,219 @@
+#include <bit>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "Utf8.h"
+
+namespace {
+  /// <summary>
+  /// Marks an invalid sequence in <see cref="DecodeSequence"/>.
+  /// </summary>
+  constexpr char32_t InvalidSequence = 0xFFFFFFFF;
+
+  constexpr char32_t ReplacementCharacter = 0xFFFD;
+
+  /// <summary>
+  /// Decodes the non-ASCII sequence at the start of <paramref name="s"/>.
+  /// </summary>
+  /// <remarks>
+  /// An invalid sequence consumes its longest valid prefix, or one byte if
+  /// there is none, so that each maximal invalid subpart becomes one
+  /// U+FFFD.
+  /// </remarks>
+  /// <param name="s">The text.</param>
+  /// <param name="remaining">The number of bytes at <paramref
+  /// name="s"/>.</param>
+  /// <param name="codePoint">Receives the code point, or <see
+  /// cref="InvalidSequence"/>.</param>
+  /// <returns>The number of bytes consumed.</returns>
+  size_t DecodeSequence(const unsigned char* s, size_t remaining, char32_t& codePoint) {
+    unsigned char lead = s[0];
+    unsigned char lower = 0x80;
+    unsigned char upper = 0xBF;
+    size_t length;
+    char32_t value;
+
+    if (lead >= 0xC2 && lead <= 0xDF) {
+      length = 2;
+      value = lead & 0x1F;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+      length = 3;
+      value = lead & 0x0F;
+
+      // Excludes overlong forms and surrogates
+      if (lead == 0xE0) lower = 0xA0;
+      if (lead == 0xED) upper = 0x9F;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+      length = 4;
+      value = lead & 0x07;
+
+      // Excludes overlong forms and code points above U+10FFFF
+      if (lead == 0xF0) lower = 0x90;
+      if (lead == 0xF4) upper = 0x8F;
+    } else {
+      codePoint = InvalidSequence;
+
+      return 1;
+    }
+
+    for (size_t i = 1; i < length; ++i) {
+      if (i >= remaining || s[i] < lower || s[i] > upper) {
+        codePoint = InvalidSequence;
+
+        return i;
+      }
+
+      value = (value << 6) | (s[i] & 0x3F);
+      lower = 0x80;
+      upper = 0xBF;
+    }
+
+    codePoint = value;
+
+    return length;
+  }
+
+  /// <summary>
+  /// Gets the number of leading ASCII bytes in <paramref name="s"/>.
+  /// </summary>
+  size_t CountAscii(const unsigned char* s, size_t length) {
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    for (; i + 32 <= length; i += 32) {
+      uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i))));
+
+      if (mask) return i + std::countr_zero(mask);
+    }
+#elif defined(_M_X64) || defined(__SSE2__)
+    for (; i + 16 <= length; i += 16) {
+      uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i))));
+
+      if (mask) return i + std::countr_zero(mask);
+    }
+#endif
+
+    while (i < length && s[i] < 0x80) ++i;
+
+    return i;
+  }
+
+  /// <summary>
+  /// Widens the leading ASCII bytes of <paramref name="s"/> into <paramref
+  /// name="out"/>.
+  /// </summary>
+  /// <returns>The number of bytes widened.</returns>
+  size_t WidenAscii(const unsigned char* s, size_t length, wchar_t* out) {
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    for (; i + 32 <= length; i += 32) {
+      __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+
+      if (_mm256_movemask_epi8(bytes)) break;
+
+      __m128i low = _mm256_castsi256_si128(bytes);
+      __m128i high = _mm256_extracti128_si256(bytes, 1);
+
+      if constexpr (sizeof(wchar_t) == 2) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_cvtepu8_epi16(low));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 16), _mm256_cvtepu8_epi16(high));
+      } else {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_cvtepu8_epi32(low));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 8), _mm256_cvtepu8_epi32(_mm_srli_si128(low, 8)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 16), _mm256_cvtepu8_epi32(high));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 24), _mm256_cvtepu8_epi32(_mm_srli_si128(high, 8)));
+      }
+    }
+#elif defined(_M_X64) || defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 16 <= length; i += 16) {
+      __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+
+      if (_mm_movemask_epi8(bytes)) break;
+
+      __m128i low = _mm_unpacklo_epi8(bytes, zero);
+      __m128i high = _mm_unpackhi_epi8(bytes, zero);
+
+      if constexpr (sizeof(wchar_t) == 2) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), low);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), high);
+      } else {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi16(low, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 4), _mm_unpackhi_epi16(low, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), _mm_unpacklo_epi16(high, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 12), _mm_unpackhi_epi16(high, zero));
+      }
+    }
+#endif
+
+    for (; i < length && s[i] < 0x80; ++i) out[i] = static_cast<wchar_t>(s[i]);
+
+    return i;
+  }
+}
+
+size_t GetWideLength(std::string_view utf8) {
+  const unsigned char* s = reinterpret_cast<const unsigned char*>(utf8.data());
+  size_t length = utf8.size();
+  size_t wideLength = 0;
+  size_t i = 0;
+
+  while (i < length) {
+    size_t ascii = CountAscii(s + i, length - i);
+
+    i += ascii;
+    wideLength += ascii;
+
+    if (i == length) break;
+
+    char32_t codePoint;
+    i += DecodeSequence(s + i, length - i, codePoint);
+
+    wideLength += sizeof(wchar_t) == 2 && codePoint != InvalidSequence && codePoint > 0xFFFF ? 2 : 1;
+  }
+
+  return wideLength;
+}
+
+bool ConvertUtf8ToWide(std::string_view utf8, std::wstring& wide) {
+  const unsigned char* s = reinterpret_cast<const unsigned char*>(utf8.data());
+  size_t length = utf8.size();
+  bool valid = true;
+
+  wide.resize(GetWideLength(utf8));
+
+  wchar_t* out = wide.data();
+  size_t i = 0;
+
+  while (i < length) {
+    size_t ascii = WidenAscii(s + i, length - i, out);
+
+    i += ascii;
+    out += ascii;
+
+    if (i == length) break;
+
+    char32_t codePoint;
+    i += DecodeSequence(s + i, length - i, codePoint);
+
+    if (codePoint == InvalidSequence) {
+      valid = false;
+      *out++ = static_cast<wchar_t>(ReplacementCharacter);
+    } else if (sizeof(wchar_t) == 2 && codePoint > 0xFFFF) {
+      codePoint -= 0x10000;
+      *out++ = static_cast<wchar_t>(0xD800 + (codePoint >> 10));
+      *out++ = static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF));
+    } else {
+      *out++ = static_cast<wchar_t>(codePoint);
+    }
+  }
+
+  return valid;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/// <summary>
+/// Gets the number of <c>wchar_t</c> that UTF-8 text converts to.
+/// </summary>
+/// <remarks>
+/// Where <c>wchar_t</c> is 16 bits, code points above U+FFFF count as two
+/// (a surrogate pair). Each invalid sequence counts as one U+FFFD.
+/// </remarks>
+/// <param name="utf8">The UTF-8 text.</param>
+/// <returns>The converted length, in characters.</returns>
+size_t GetWideLength(std::string_view utf8);
+
+/// <summary>
+/// Converts UTF-8 text to a wide string.
+/// </summary>
+/// <remarks>
+/// <para>The result is UTF-16 where <c>wchar_t</c> is 16 bits, as on
+/// Windows, and UTF-32 otherwise. Invalid sequences (overlong forms,
+/// surrogates, code points above U+10FFFF, and truncated or stray bytes) are
+/// each replaced with U+FFFD.</para>
+/// <para><paramref name="wide"/> is sized exactly once, using <see
+/// cref="GetWideLength"/>, and written in place. Runs of ASCII are widened
+/// 16 or 32 bytes at a time with SSE2 or AVX2 where the target has
+/// them.</para>
+/// </remarks>
+/// <param name="utf8">The UTF-8 text.</param>
+/// <param name="wide">Receives the converted text.</param>
+/// <returns><c>true</c> if <paramref name="utf8"/> was valid UTF-8 or
+/// <c>false</c> if anything was replaced.</returns>
+bool ConvertUtf8ToWide(std::string_view utf8, std::wstring& wide);
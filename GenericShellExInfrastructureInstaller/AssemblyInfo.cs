@@ -1,32 +1,32 @@
-﻿using System.Reflection;
-using System.Runtime.InteropServices;
-
-// General Information about an assembly is controlled through the following
-// set of attributes. Change these attribute values to modify the information
-// associated with an assembly.
-[assembly: AssemblyTitle(GenericShellExInfrastructureInstaller.Installer.DisplayName)]
-[assembly: AssemblyDescription("")]
-[assembly: AssemblyConfiguration("")]
-[assembly: AssemblyCompany("")]
-[assembly: AssemblyProduct(GenericShellExInfrastructureInstaller.Installer.ShortName)]
-[assembly: AssemblyCopyright(GenericShellExInfrastructureInstaller.Installer.Publisher)]
-[assembly: AssemblyTrademark("")]
-[assembly: AssemblyCulture("")]
-
-// Setting ComVisible to false makes the types in this assembly not visible
-// to COM components.  If you need to access a type in this assembly from
-// COM, set the ComVisible attribute to true on that type.
-[assembly: ComVisible(false)]
-
-// The following GUID is for the ID of the typelib if this project is exposed to COM
-[assembly: Guid("41c09894-79d8-448f-96e4-9eb59a8ed4d8")]
-
-// Version information for an assembly consists of the following four values:
-//
-//      Major Version
-//      Minor Version
-//      Build Number
-//      Revision
-//
-[assembly: AssemblyVersion(GenericShellExInfrastructureInstaller.Installer.Version)]
-[assembly: AssemblyFileVersion(GenericShellExInfrastructureInstaller.Installer.Version)]
+﻿using System.Reflection;
+using System.Runtime.InteropServices;
+
+// General Information about an assembly is controlled through the following
+// set of attributes. Change these attribute values to modify the information
+// associated with an assembly.
+[assembly: AssemblyTitle(GenericShellExInfrastructureInstaller.Installer.DisplayName)]
+[assembly: AssemblyDescription("")]
+[assembly: AssemblyConfiguration("")]
+[assembly: AssemblyCompany("")]
+[assembly: AssemblyProduct(GenericShellExInfrastructureInstaller.Installer.ShortName)]
+[assembly: AssemblyCopyright(GenericShellExInfrastructureInstaller.Installer.Publisher)]
+[assembly: AssemblyTrademark("")]
+[assembly: AssemblyCulture("")]
+
+// Setting ComVisible to false makes the types in this assembly not visible
+// to COM components.  If you need to access a type in this assembly from
+// COM, set the ComVisible attribute to true on that type.
+[assembly: ComVisible(false)]
+
+// The following GUID is for the ID of the typelib if this project is exposed to COM
+[assembly: Guid("41c09894-79d8-448f-96e4-9eb59a8ed4d8")]
+
+// Version information for an assembly consists of the following four values:
+//
+//      Major Version
+//      Minor Version
+//      Build Number
+//      Revision
+//
+[assembly: AssemblyVersion(GenericShellExInfrastructureInstaller.Installer.Version)]
+[assembly: AssemblyFileVersion(GenericShellExInfrastructureInstaller.Installer.Version)]
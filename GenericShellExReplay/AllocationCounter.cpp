@@ -0,0 +1,78 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "AllocationCounter.h"
+
+namespace {
+  std::atomic<uint64_t> allocations = 0;
+  std::atomic<uint64_t> bytes = 0;
+
+  // Constant-initialized, so counting never needs the thread's storage to
+  // be set up by code that could itself allocate
+  thread_local uint64_t threadAllocations = 0;
+
+  void* Allocate(std::size_t size) noexcept {
+    ++threadAllocations;
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(size, std::memory_order_relaxed);
+
+    return std::malloc(size ? size : 1);
+  }
+}
+
+uint64_t AllocationCounter::Allocations() {
+  return allocations.load(std::memory_order_relaxed);
+}
+
+uint64_t AllocationCounter::Bytes() {
+  return bytes.load(std::memory_order_relaxed);
+}
+
+uint64_t AllocationCounter::ThreadAllocations() {
+  return threadAllocations;
+}
+
+void* operator new(std::size_t size) {
+  if (void* p = Allocate(size)) return p;
+
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+  if (void* p = Allocate(size)) return p;
+
+  throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return Allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return Allocate(size);
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+  std::free(p);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+/// <summary>
+/// Counts heap allocations made through the global <c>operator new</c>,
+/// which the replay harness replaces.
+/// </summary>
+namespace AllocationCounter {
+  /// <summary>
+  /// The number of allocations made so far, on all threads.
+  /// </summary>
+  uint64_t Allocations();
+
+  /// <summary>
+  /// The number of bytes allocated so far, on all threads.
+  /// </summary>
+  uint64_t Bytes();
+
+  /// <summary>
+  /// The number of allocations made so far on the calling thread, which
+  /// measuring a call uses so that other threads' allocations are not
+  /// charged to it.
+  /// </summary>
+  uint64_t ThreadAllocations();
+}
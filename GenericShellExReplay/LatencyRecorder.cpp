@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <iomanip>
+
+#include "AllocationCounter.h"
+#include "LatencyRecorder.h"
+
+namespace {
+  /// <summary>
+  /// Gets the nearest-rank percentile of sorted samples.
+  /// </summary>
+  uint64_t Percentile(const std::vector<uint64_t>& sorted, double percentile) {
+    if (sorted.empty()) return 0;
+
+    size_t rank = static_cast<size_t>(percentile / 100.0 * static_cast<double>(sorted.size()) + 0.5);
+
+    if (rank < 1) rank = 1;
+    if (rank > sorted.size()) rank = sorted.size();
+
+    return sorted[rank - 1];
+  }
+}
+
+size_t LatencyRecorder::SeriesIndex(const std::string& name) {
+  for (size_t i = 0; i < series.size(); ++i) {
+    if (series[i].name == name) return i;
+  }
+
+  series.push_back({ name, {}, 0 });
+
+  return series.size() - 1;
+}
+
+void LatencyRecorder::Reserve(size_t samplesPerSeries) {
+  for (Series& s : series) s.nanoseconds.reserve(samplesPerSeries);
+}
+
+void LatencyRecorder::Clear() {
+  for (Series& s : series) {
+    s.nanoseconds.clear();
+    s.allocations = 0;
+  }
+}
+
+void LatencyRecorder::Merge(const LatencyRecorder& other) {
+  for (const Series& s : other.series) {
+    Series& merged = series[SeriesIndex(s.name)];
+
+    merged.nanoseconds.insert(merged.nanoseconds.end(), s.nanoseconds.begin(), s.nanoseconds.end());
+    merged.allocations += s.allocations;
+  }
+}
+
+void LatencyRecorder::Record(size_t index, std::chrono::nanoseconds duration, uint64_t allocations) {
+  series[index].nanoseconds.push_back(static_cast<uint64_t>(duration.count()));
+  series[index].allocations += allocations;
+}
+
+void LatencyRecorder::Report(std::ostream& out) {
+  out << std::left << std::setw(16) << "call" << std::right
+    << std::setw(10) << "count"
+    << std::setw(12) << "p50 ns"
+    << std::setw(12) << "p90 ns"
+    << std::setw(12) << "p99 ns"
+    << std::setw(12) << "max ns"
+    << std::setw(14) << "allocs/call" << '\n';
+
+  for (Series& s : series) {
+    if (s.nanoseconds.empty()) continue;
+
+    std::sort(s.nanoseconds.begin(), s.nanoseconds.end());
+
+    out << std::left << std::setw(16) << s.name << std::right
+      << std::setw(10) << s.nanoseconds.size()
+      << std::setw(12) << Percentile(s.nanoseconds, 50)
+      << std::setw(12) << Percentile(s.nanoseconds, 90)
+      << std::setw(12) << Percentile(s.nanoseconds, 99)
+      << std::setw(12) << s.nanoseconds.back()
+      << std::setw(14) << std::fixed << std::setprecision(2) << static_cast<double>(s.allocations) / static_cast<double>(s.nanoseconds.size()) << '\n';
+  }
+}
+
+ScopedSample::ScopedSample(LatencyRecorder& recorder, size_t index) : recorder(recorder), index(index), allocations(AllocationCounter::ThreadAllocations()), start(std::chrono::steady_clock::now()) {}
+
+ScopedSample::~ScopedSample() {
+  auto duration = std::chrono::steady_clock::now() - start;
+  uint64_t made = AllocationCounter::ThreadAllocations() - allocations;
+
+  recorder.Record(index, std::chrono::duration_cast<std::chrono::nanoseconds>(duration), made);
+}
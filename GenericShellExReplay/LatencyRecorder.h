@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Collects latency and allocation samples for named calls and reports
+/// percentiles.
+/// </summary>
+class LatencyRecorder {
+  struct Series {
+    std::string name;
+    std::vector<uint64_t> nanoseconds;
+    uint64_t allocations = 0;
+  };
+
+  std::vector<Series> series;
+
+public:
+  /// <summary>
+  /// Gets the index of the series for a call, creating it if needed.
+  /// </summary>
+  /// <param name="name">The call name.</param>
+  /// <returns>A series index for <see cref="Record"/>.</returns>
+  size_t SeriesIndex(const std::string& name);
+
+  /// <summary>
+  /// Reserves room for samples so that recording does not allocate.
+  /// </summary>
+  void Reserve(size_t samplesPerSeries);
+
+  /// <summary>
+  /// Records one call.
+  /// </summary>
+  /// <param name="index">The series index.</param>
+  /// <param name="duration">How long the call took.</param>
+  /// <param name="allocations">How many allocations the call made.</param>
+  void Record(size_t index, std::chrono::nanoseconds duration, uint64_t allocations);
+
+  /// <summary>
+  /// Adds another recorder's samples to the series of the same name.
+  /// </summary>
+  void Merge(const LatencyRecorder& other);
+
+  /// <summary>
+  /// Discards all samples, keeping the reserved room.
+  /// </summary>
+  void Clear();
+
+  /// <summary>
+  /// Gets the total allocations recorded for a series.
+  /// </summary>
+  /// <param name="index">The series index.</param>
+  uint64_t Allocations(size_t index) const { return series[index].allocations; }
+
+  /// <summary>
+  /// Writes a table of percentiles, one row per series.
+  /// </summary>
+  void Report(std::ostream& out);
+};
+
+/// <summary>
+/// Measures a call from construction to destruction and records it.
+/// </summary>
+class ScopedSample {
+  LatencyRecorder& recorder;
+  size_t index;
+  uint64_t allocations;
+  std::chrono::steady_clock::time_point start;
+
+public:
+  ScopedSample(LatencyRecorder& recorder, size_t index);
+  ~ScopedSample();
+};
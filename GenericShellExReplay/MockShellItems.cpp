@@ -0,0 +1,164 @@
+#include <cwchar>
+#include <iterator>
+#include <memory>
+#include <string_view>
+#include "MockShellItems.h"
+
+namespace {
+  const wchar_t* const MixedExtensions[] = { L".txt", L".cpp", L".h", L".png", L".PDF", L".tar.gz", L"" };
+
+  std::wstring Number(uint32_t value) {
+    return std::to_wstring(value);
+  }
+}
+
+bool ParsePathShape(const std::string& name, PathShape& shape) {
+  if (name == "flat") {
+    shape = PathShape::Flat;
+  } else if (name == "deep") {
+    shape = PathShape::Deep;
+  } else if (name == "mixed") {
+    shape = PathShape::Mixed;
+  } else if (name == "unc") {
+    shape = PathShape::Unc;
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+MockShellItems::MockShellItems(size_t count, PathShape shape, uint32_t seed) {
+  items.reserve(count);
+
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t n = static_cast<uint32_t>(i) + seed;
+
+    switch (shape) {
+    case PathShape::Flat:
+      items.push_back({ L"C:\\Users\\user\\Documents\\file" + Number(n) + L".txt", ItemAttributeFileSystem });
+      break;
+    case PathShape::Deep:
+      items.push_back({ L"C:\\src\\project\\module" + Number(n % 8) + L"\\include\\detail\\impl\\v2\\file" + Number(n) + L".cpp", ItemAttributeFileSystem });
+      break;
+    case PathShape::Mixed:
+      if (n % 5 == 0) {
+        items.push_back({ L"D:\\Data\\Folder " + Number(n), ItemAttributeFileSystem | ItemAttributeDirectory });
+      } else {
+        items.push_back({ L"D:\\Data\\R\u00e9sum\u00e9 " + Number(n) + MixedExtensions[n % 7], ItemAttributeFileSystem | (n % 3 ? ItemAttributeNone : ItemAttributeReadOnly) | (n % 4 ? ItemAttributeNone : ItemAttributeRemote) });
+      }
+      break;
+    case PathShape::Unc:
+      items.push_back({ L"\\\\server\\share\\folder\\file" + Number(n) + L".dat", ItemAttributeFileSystem | ItemAttributeSlow });
+      break;
+    }
+  }
+
+  if (items.empty()) return;
+
+  std::wstring_view parent = items.front().path;
+
+  for (const Item& item : items) {
+    size_t common = 0;
+
+    while (common < parent.size() && common < item.path.size() && parent[common] == item.path[common]) ++common;
+
+    parent = parent.substr(0, common);
+  }
+
+  parent = parent.substr(0, parent.rfind(L'\\') + 1);
+  parentLength = parent.size();
+  idList.assign(parent.begin(), parent.end());
+  idListOffsets.reserve(items.size());
+
+  for (const Item& item : items) {
+    idListOffsets.push_back(idList.size());
+    idList.insert(idList.end(), item.path.begin() + parentLength, item.path.end());
+    idList.push_back(L'\0');
+  }
+}
+
+void MockShellItems::Read(Selection& selection, bool readPaths, size_t limit, std::chrono::steady_clock::time_point deadline) const {
+  selection.Reset(items.size());
+
+  for (size_t i = 0; i < items.size(); ++i) {
+    if (i >= limit || std::chrono::steady_clock::now() > deadline) {
+      selection.Truncate();
+
+      break;
+    }
+
+    if (readPaths) {
+      selection.Add(items[i].path.data(), items[i].path.size(), items[i].attributes);
+    } else {
+      selection.Add(L"", 0, items[i].attributes);
+    }
+  }
+}
+
+void MockShellItems::ReadPerItem(Selection& selection, bool readPaths) const {
+  selection.Reset(items.size());
+
+  for (const Item& item : items) {
+    auto shellItem = std::make_unique<Item>(item);
+
+    if (readPaths) {
+      std::wstring displayName = shellItem->path;
+
+      selection.Add(displayName.data(), displayName.size(), shellItem->attributes);
+    } else {
+      selection.Add(L"", 0, shellItem->attributes);
+    }
+  }
+}
+
+void MockShellItems::ReadIdList(Selection& selection, bool readPaths) const {
+  std::vector<wchar_t> block = idList;
+  wchar_t path[260];
+
+  wmemcpy(path, block.data(), parentLength);
+  selection.Reset(items.size());
+
+  for (size_t i = 0; i < items.size(); ++i) {
+    if (readPaths) {
+      const wchar_t* child = block.data() + idListOffsets[i];
+      size_t length = parentLength + wcslen(child);
+
+      if (length < std::size(path)) {
+        wmemcpy(path + parentLength, child, length - parentLength);
+        selection.Add(path, length, items[i].attributes);
+      } else {
+        selection.Add(items[i].path.data(), items[i].path.size(), items[i].attributes);
+      }
+    } else {
+      selection.Add(L"", 0, items[i].attributes);
+    }
+  }
+}
+
+bool MockShellItems::Read(Selection& selection, bool readPaths, size_t limit, std::chrono::steady_clock::time_point deadline, std::chrono::milliseconds) {
+  Read(selection, readPaths, limit, deadline);
+
+  return true;
+}
+
+bool MockShellItems::ReadPaths(Selection& selection) {
+  Read(selection, true, SIZE_MAX, std::chrono::steady_clock::time_point::max());
+
+  return true;
+}
+
+bool MockShellItems::Fingerprint(SelectionFingerprint& fingerprint) {
+  fingerprint = SelectionFingerprint();
+
+  if (items.empty()) return true;
+
+  const std::wstring& first = items.front().path;
+  const std::wstring& last = items.back().path;
+
+  fingerprint.count = items.size();
+  fingerprint.first = HashBytes(first.data(), first.size() * sizeof(wchar_t));
+  fingerprint.last = HashBytes(last.data(), last.size() * sizeof(wchar_t));
+
+  return true;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MenuCommand.h"
+#include "Selection.h"
+
+/// <summary>
+/// The kinds of paths a <see cref="MockShellItems"/> generates.
+/// </summary>
+enum class PathShape {
+  /// <summary>
+  /// Files in one directory, such as <c>C:\Users\user\Documents\file1.txt</c>.
+  /// </summary>
+  Flat,
+
+  /// <summary>
+  /// Files spread over a deep source tree.
+  /// </summary>
+  Deep,
+
+  /// <summary>
+  /// A mix of files with assorted extensions, some of them remote, and
+  /// directories.
+  /// </summary>
+  Mixed,
+
+  /// <summary>
+  /// Files on a UNC share.
+  /// </summary>
+  Unc
+};
+
+/// <summary>
+/// Parses a <see cref="PathShape"/> name.
+/// </summary>
+/// <param name="name"><c>flat</c>, <c>deep</c>, <c>mixed</c>, or
+/// <c>unc</c>.</param>
+/// <param name="shape">Receives the shape.</param>
+/// <returns><c>true</c> on success or <c>false</c> if <paramref
+/// name="name"/> is unknown.</returns>
+bool ParsePathShape(const std::string& name, PathShape& shape);
+
+/// <summary>
+/// A stand-in for the shell's <c>IShellItemArray</c>, as the <see
+/// cref="SelectionSource"/> a <see cref="MenuCommand"/> reads.
+/// </summary>
+/// <remarks>
+/// Reading and fingerprinting follow <c>ReadShellSelection</c> and
+/// <c>GetShellSelectionFingerprint</c>, with paths in place of ID lists. Mock
+/// items are on no volume, so none is ever slow to respond. The
+/// items are also kept as one block of paths relative to their common parent,
+/// in place of the array's <c>CFSTR_SHELLIDLIST</c> data.
+/// </remarks>
+class MockShellItems : public SelectionSource {
+  struct Item {
+    std::wstring path;
+    uint32_t attributes;
+  };
+
+  std::vector<Item> items;
+
+  /// <summary>
+  /// The length of the items' common parent at the start of <see
+  /// cref="idList"/>, followed by each item's null-terminated path relative
+  /// to it.
+  /// </summary>
+  size_t parentLength = 0;
+  std::vector<wchar_t> idList;
+  std::vector<size_t> idListOffsets;
+
+public:
+  /// <summary>
+  /// Initializes a <see cref="MockShellItems"/>.
+  /// </summary>
+  /// <param name="count">The number of items.</param>
+  /// <param name="shape">The kind of paths to generate.</param>
+  /// <param name="seed">Varies the generated paths between
+  /// selections.</param>
+  MockShellItems(size_t count, PathShape shape, uint32_t seed);
+
+  size_t Count() const { return items.size(); }
+
+  /// <summary>
+  /// Reads the items into a <see cref="Selection"/>.
+  /// </summary>
+  /// <param name="selection">Receives the items.</param>
+  /// <param name="readPaths">Whether to read item paths.</param>
+  /// <param name="limit">The largest number of items to inspect.</param>
+  /// <param name="deadline">The time after which to stop
+  /// inspecting.</param>
+  void Read(Selection& selection, bool readPaths, size_t limit, std::chrono::steady_clock::time_point deadline) const;
+
+  bool Read(Selection& selection, bool readPaths, size_t limit, std::chrono::steady_clock::time_point deadline, std::chrono::milliseconds volumeTimeout) override;
+
+  bool ReadPaths(Selection& selection) override;
+
+  /// <summary>
+  /// Reads the items the way an array is enumerated one shell item at a
+  /// time, copying each item and its display name.
+  /// </summary>
+  void ReadPerItem(Selection& selection, bool readPaths) const;
+
+  /// <summary>
+  /// Reads the items the way an array's ID list is, copying the block of
+  /// relative paths once and joining each one to the parent in a stack
+  /// buffer.
+  /// </summary>
+  void ReadIdList(Selection& selection, bool readPaths) const;
+
+  /// <summary>
+  /// Computes the items' fingerprint, hashing the first and last paths in
+  /// place.
+  /// </summary>
+  bool Fingerprint(SelectionFingerprint& fingerprint) override;
+};
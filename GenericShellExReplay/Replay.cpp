@@ -0,0 +1,1131 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cwchar>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "AllocationCounter.h"
+#include "CommandTemplate.h"
+#include "Config.h"
+#include "ConfigSnapshot.h"
+#include "Environment.h"
+#include "Executor.h"
+#include "LatencyRecorder.h"
+#include "Log.h"
+#include "MenuCommand.h"
+#include "MockShellItems.h"
+#include "Utf8.h"
+
+namespace {
+  const char* const DefaultConfig = R"({
+  "types": {
+    "*": {
+      "title": "Edit with Notepad",
+      "icon": "C:\\Windows\\System32\\notepad.exe,0",
+      "command": "notepad.exe %*",
+      "prefetch": true,
+      "when": { "extensions": [".txt", ".cpp", ".h"], "maxCount": 64 }
+    },
+    "Directory": [
+      { "title": "Open in Terminal", "command": "wt.exe -d %1" },
+      { "title": "Search here", "command": "search.exe %1", "when": { "itemType": "directory" } }
+    ]
+  }
+})";
+
+  struct Options {
+    std::string configPath;
+    std::string scriptPath;
+    std::wstring slot = L"*";
+    size_t sessions = 1000;
+    size_t items = 16;
+    PathShape shape = PathShape::Flat;
+    size_t queries = 3;
+    size_t invokeEvery = 0;
+    bool checkAllocations = false;
+    size_t transcodeMegabytes = 0;
+    size_t resolveItems = 0;
+    size_t expandItems = 0;
+    size_t threads = 0;
+    size_t stressItems = 0;
+    bool log = false;
+    bool verbose = false;
+  };
+
+  /// <summary>
+  /// The number of distinct selections sessions cycle through when checking
+  /// allocations.
+  /// </summary>
+  constexpr size_t CheckSelections = 8;
+
+  bool ReadFile(const std::filesystem::path& path, std::string& text) {
+    std::ifstream stream(path, std::ios::binary);
+
+    if (!stream.is_open()) return false;
+
+    text.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+
+    return true;
+  }
+
+  /// <summary>
+  /// Looks up an environment variable. Names are ASCII, as <see
+  /// cref="EnvironmentExpander"/> only expands those.
+  /// </summary>
+  std::optional<std::wstring> LookUpEnvironmentVariable(const std::wstring& name) {
+    std::string narrowName(name.begin(), name.end());
+    const char* value = std::getenv(narrowName.c_str());
+
+    if (!value) return std::nullopt;
+
+    std::wstring wideValue;
+    ConvertUtf8ToWide(value, wideValue);
+
+    return wideValue;
+  }
+
+  /// <summary>
+  /// A launch prepared for a selection, which is ready at once.
+  /// </summary>
+  class FakePreparation : public PreparedLaunch {
+  public:
+    SelectionFingerprint fingerprint;
+
+    bool IsFor(const SelectionFingerprint& fingerprint) const override { return this->fingerprint == fingerprint; }
+
+    bool IsReadyFor(const SelectionFingerprint& fingerprint) const override { return IsFor(fingerprint); }
+  };
+
+  /// <summary>
+  /// Stands in for the file system and <c>CreateProcessW</c>. Mock items
+  /// have no files, so nothing is found in them, and launches are only
+  /// counted.
+  /// </summary>
+  class FakePlatform : public MenuCommandPlatform {
+  public:
+    size_t launches = 0;
+    bool verbose = false;
+
+    void FindMarkers(Selection&, const DirectoryMarkers&, std::chrono::steady_clock::time_point, std::chrono::milliseconds) override {}
+
+    void MatchContent(Selection&, const ContentSignatures&, std::chrono::steady_clock::time_point) override {}
+
+    // Restarts the last preparation in place, as the DLL's does once its
+    // work has finished
+    void PrepareLaunch(std::shared_ptr<PreparedLaunch>& preparation, const SelectionFingerprint& fingerprint, const std::wstring&) override {
+      if (!preparation) preparation = std::make_shared<FakePreparation>();
+
+      static_cast<FakePreparation&>(*preparation).fingerprint = fingerprint;
+    }
+
+    // Duplicates are found by path
+    void ReadFiles(const Selection&, std::chrono::milliseconds, std::vector<SelectionFileInfo>&) override {}
+
+    std::wstring FindRoot(const Selection&, const DirectoryMarkers&, uint64_t, std::chrono::milliseconds) override { return L""; }
+
+    bool Forward(const ForwardTarget&, std::wstring_view, Log&) override { return false; }
+
+    bool IsVolumeResponsive(std::wstring_view, std::chrono::milliseconds) override { return true; }
+
+    bool Launch(const std::wstring& currentDirectory, std::wstring command, Log&) override {
+      ++launches;
+
+      if (verbose) std::wcout << L"Launch in " << currentDirectory << L": " << command << std::endl;
+
+      return true;
+    }
+  };
+
+  /// <summary>
+  /// Copies an out-string the way <c>ContextMenuCommand</c> does, with
+  /// <c>malloc</c> standing in for <c>CoTaskMemAlloc</c>. The caller frees
+  /// it.
+  /// </summary>
+  wchar_t* DuplicateOutString(const std::wstring& s) {
+    auto* copy = static_cast<wchar_t*>(std::malloc((s.size() + 1) * sizeof(wchar_t)));
+
+    if (copy) std::wmemcpy(copy, s.c_str(), s.size() + 1);
+
+    return copy;
+  }
+
+  /// <summary>
+  /// Stands in for COM and <c>DllGetClassObject</c>: the config is loaded
+  /// into a snapshot once and reloaded only when the config file changes, as
+  /// the DLL does.
+  /// </summary>
+  class FakeHost {
+    std::filesystem::path configPath;
+    std::filesystem::file_time_type configWriteTime;
+    std::string defaultConfigText;
+
+    /// <summary>
+    /// Guards reloading and <see cref="snapshot"/>, as the DLL's snapshot
+    /// lock does.
+    /// </summary>
+    std::mutex lock;
+
+    std::shared_ptr<const ConfigSnapshot> snapshot;
+
+    /// <summary>
+    /// Slot names, in the order bindings first name them. A slot's index is
+    /// its position.
+    /// </summary>
+    std::vector<std::wstring> slotNames;
+
+    MenuCommandPool& pool;
+    Log& log;
+
+    void Load(const std::string& text) {
+      Config config;
+      ParseConfig(text, config);
+
+      if (log.IsOpen()) {
+        for (const std::wstring& error : config.errors) log.Line() << L"ERROR: " << error;
+      }
+
+      for (const ConfigBinding& binding : config.bindings) {
+        const std::wstring& name = binding.slotName.empty() ? binding.type : binding.slotName;
+
+        if (std::find(slotNames.begin(), slotNames.end(), name) == slotNames.end()) slotNames.push_back(name);
+      }
+
+      EnvironmentExpander expander(LookUpEnvironmentVariable);
+
+      auto loaded = std::make_shared<ConfigSnapshot>(slotNames.size());
+      loaded->logFile = expander.Expand(config.logFile);
+      loaded->signatures = config.signatures;
+      loaded->markers = config.markers;
+
+      for (ConfigBinding& binding : config.bindings) {
+        const std::wstring& name = binding.slotName.empty() ? binding.type : binding.slotName;
+
+        expander.Expand(binding.entry);
+        CompileCommandTemplates(binding.entry);
+
+        loaded->entries[std::find(slotNames.begin(), slotNames.end(), name) - slotNames.begin()] = std::move(binding.entry);
+      }
+
+      snapshot = std::move(loaded);
+    }
+
+    void Refresh() {
+      if (configPath.empty()) {
+        if (!snapshot) Load(defaultConfigText);
+
+        return;
+      }
+
+      std::error_code error;
+      std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(configPath, error);
+
+      if (error || (snapshot && writeTime == configWriteTime)) return;
+
+      std::string text;
+
+      if (!ReadFile(configPath, text)) return;
+
+      Load(text);
+      configWriteTime = writeTime;
+    }
+
+  public:
+    FakeHost(const std::string& configPath, std::string defaultConfigText, MenuCommandPool& pool, Log& log) : configPath(configPath), defaultConfigText(std::move(defaultConfigText)), pool(pool), log(log) {}
+
+    /// <summary>
+    /// Looks up a slot by name.
+    /// </summary>
+    /// <returns>The slot index, or <c>SIZE_MAX</c> if the config does not
+    /// bind <paramref name="slot"/>.</returns>
+    size_t GetClassObject(const std::wstring& slot) {
+      std::lock_guard<std::mutex> guard(lock);
+
+      Refresh();
+
+      for (size_t i = 0; i < slotNames.size(); ++i) {
+        if (slotNames[i] == slot) return snapshot && snapshot->Entry(i) ? i : SIZE_MAX;
+      }
+
+      return SIZE_MAX;
+    }
+
+    MenuCommand* CreateInstance(Log& log, size_t slot) {
+      std::shared_ptr<const ConfigSnapshot> current;
+
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        current = snapshot;
+      }
+
+      const ContextMenuEntry& entry = *current->Entry(slot);
+
+      return MenuCommand::Create(pool, log, std::move(current), entry);
+    }
+  };
+
+  /// <summary>
+  /// Series indexes for each call.
+  /// </summary>
+  struct Calls {
+    size_t session, getClassObject, createInstance, getTitle, getIcon, getToolTip, getState, getFlags, enumSubCommands, invoke;
+
+    explicit Calls(LatencyRecorder& recorder) :
+      session(recorder.SeriesIndex("session")),
+      getClassObject(recorder.SeriesIndex("GetClassObject")),
+      createInstance(recorder.SeriesIndex("CreateInstance")),
+      getTitle(recorder.SeriesIndex("GetTitle")),
+      getIcon(recorder.SeriesIndex("GetIcon")),
+      getToolTip(recorder.SeriesIndex("GetToolTip")),
+      getState(recorder.SeriesIndex("GetState")),
+      getFlags(recorder.SeriesIndex("GetFlags")),
+      enumSubCommands(recorder.SeriesIndex("EnumSubCommands")),
+      invoke(recorder.SeriesIndex("Invoke")) {}
+  };
+
+  /// <summary>
+  /// Holds an apartment for the length of one call, standing in for COM
+  /// marshalling the call to a single-threaded apartment's thread.
+  /// </summary>
+  class ApartmentCall {
+    std::mutex* apartment;
+
+  public:
+    /// <summary>
+    /// Enters the apartment.
+    /// </summary>
+    /// <param name="apartment">The apartment, or <c>nullptr</c> if calls
+    /// are made directly, as with a free-threaded handler.</param>
+    explicit ApartmentCall(std::mutex* apartment) : apartment(apartment) {
+      if (apartment) apartment->lock();
+    }
+
+    ApartmentCall(const ApartmentCall&) = delete;
+    ApartmentCall& operator=(const ApartmentCall&) = delete;
+
+    ~ApartmentCall() {
+      if (apartment) apartment->unlock();
+    }
+  };
+
+  /// <summary>
+  /// Replays one menu query of a command and its subcommands: flags, title,
+  /// icon and state, as Explorer asks for them.
+  /// </summary>
+  /// <param name="apartment">The apartment each call enters, or
+  /// <c>nullptr</c> to call directly.</param>
+  void QueryCommand(MenuCommand& command, MockShellItems& items, LatencyRecorder& recorder, const Calls& calls, std::mutex* apartment = nullptr) {
+    {
+      ScopedSample sample(recorder, calls.getFlags);
+      ApartmentCall call(apartment);
+      (void)command.SubCommandCount();
+    }
+
+    {
+      ScopedSample sample(recorder, calls.getTitle);
+      ApartmentCall call(apartment);
+      std::free(DuplicateOutString(command.Entry().title));
+    }
+
+    {
+      ScopedSample sample(recorder, calls.getIcon);
+      ApartmentCall call(apartment);
+      if (!command.Entry().icon.empty()) std::free(DuplicateOutString(command.Entry().icon));
+    }
+
+    {
+      ScopedSample sample(recorder, calls.getState);
+      ApartmentCall call(apartment);
+      (void)command.GetState(items);
+    }
+
+    for (size_t i = 0; i < command.SubCommandCount(); ++i) {
+      MenuCommand* subCommand = nullptr;
+
+      {
+        ScopedSample sample(recorder, calls.enumSubCommands);
+        ApartmentCall call(apartment);
+        subCommand = command.GetSubCommand(i);
+      }
+
+      QueryCommand(*subCommand, items, recorder, calls, apartment);
+    }
+  }
+
+  /// <summary>
+  /// Opens a menu: gets the class object and creates the command.
+  /// </summary>
+  /// <returns>The command, or <c>nullptr</c> if the config does not bind the
+  /// requested slot.</returns>
+  MenuCommand* OpenMenu(const Options& options, FakeHost& host, Log& log, LatencyRecorder& recorder, const Calls& calls) {
+    size_t slot = SIZE_MAX;
+
+    {
+      ScopedSample sample(recorder, calls.getClassObject);
+      slot = host.GetClassObject(options.slot);
+    }
+
+    if (slot == SIZE_MAX) {
+      std::cerr << "The config does not bind the requested slot." << std::endl;
+
+      return nullptr;
+    }
+
+    ScopedSample sample(recorder, calls.createInstance);
+
+    return host.CreateInstance(log, slot);
+  }
+
+  /// <summary>
+  /// Replays synthetic sessions.
+  /// </summary>
+  /// <remarks>
+  /// When checking allocations, sessions cycle through <see
+  /// cref="CheckSelections"/> selections, and the first pass through them
+  /// only warms up pooled storage.
+  /// </remarks>
+  int ReplaySynthetic(const Options& options, FakeHost& host, Log& log, LatencyRecorder& recorder, const Calls& calls) {
+    for (size_t i = 0; i < options.sessions; ++i) {
+      uint32_t seed = static_cast<uint32_t>(options.checkAllocations ? i % CheckSelections : i);
+
+      if (options.checkAllocations && i == CheckSelections) recorder.Clear();
+
+      MockShellItems items(options.items, options.shape, seed);
+
+      ScopedSample session(recorder, calls.session);
+
+      MenuCommand* command = OpenMenu(options, host, log, recorder, calls);
+
+      if (!command) return 1;
+
+      for (size_t q = 0; q < options.queries; ++q) QueryCommand(*command, items, recorder, calls);
+
+      if (options.invokeEvery && i % options.invokeEvery == 0) {
+        MenuCommand* target = command;
+
+        if (target->SubCommandCount()) target = target->GetSubCommand(0);
+
+        ScopedSample sample(recorder, calls.invoke);
+        target->Invoke(items);
+      }
+
+      command->Release();
+    }
+
+    return 0;
+  }
+
+  /// <summary>
+  /// Replays a recorded session script.
+  /// </summary>
+  /// <remarks>
+  /// Each line is one of <c>session &lt;items&gt; &lt;shape&gt;</c>, which
+  /// starts a session, or a call: <c>title</c>, <c>icon</c>,
+  /// <c>tooltip</c>, <c>state</c>, <c>flags</c>, <c>subcommands</c>, or
+  /// <c>invoke</c>. Lines starting with <c>#</c> are ignored.
+  /// </remarks>
+  int ReplayScript(const Options& options, FakeHost& host, Log& log, LatencyRecorder& recorder, const Calls& calls) {
+    std::string script;
+
+    if (!ReadFile(options.scriptPath, script)) {
+      std::cerr << "Unable to read " << options.scriptPath << std::endl;
+
+      return 1;
+    }
+
+    std::istringstream lines(script);
+    std::string line;
+    size_t lineNumber = 0;
+    uint32_t seed = 0;
+    int result = 0;
+
+    std::unique_ptr<MockShellItems> items;
+    MenuCommand* command = nullptr;
+
+    while (!result && std::getline(lines, line)) {
+      ++lineNumber;
+
+      std::istringstream words(line);
+      std::string call;
+
+      if (!(words >> call) || call[0] == '#') continue;
+
+      if (call == "session") {
+        size_t count = options.items;
+        std::string shapeName;
+        PathShape shape = options.shape;
+
+        words >> count >> shapeName;
+
+        if (!shapeName.empty() && !ParsePathShape(shapeName, shape)) {
+          std::cerr << "Line " << lineNumber << ": unknown shape " << shapeName << std::endl;
+          result = 1;
+
+          continue;
+        }
+
+        if (command) command->Release();
+
+        items = std::make_unique<MockShellItems>(count, shape, seed++);
+
+        ScopedSample session(recorder, calls.session);
+        command = OpenMenu(options, host, log, recorder, calls);
+
+        if (!command) result = 1;
+
+        continue;
+      }
+
+      if (!command) {
+        std::cerr << "Line " << lineNumber << ": call before the first session" << std::endl;
+        result = 1;
+      } else if (call == "title") {
+        ScopedSample sample(recorder, calls.getTitle);
+        std::free(DuplicateOutString(command->Entry().title));
+      } else if (call == "icon") {
+        ScopedSample sample(recorder, calls.getIcon);
+        if (!command->Entry().icon.empty()) std::free(DuplicateOutString(command->Entry().icon));
+      } else if (call == "tooltip") {
+        ScopedSample sample(recorder, calls.getToolTip);
+        std::free(DuplicateOutString(command->Entry().toolTip));
+      } else if (call == "state") {
+        ScopedSample sample(recorder, calls.getState);
+        (void)command->GetState(*items);
+      } else if (call == "flags") {
+        ScopedSample sample(recorder, calls.getFlags);
+        (void)command->SubCommandCount();
+      } else if (call == "subcommands") {
+        QueryCommand(*command, *items, recorder, calls);
+      } else if (call == "invoke") {
+        ScopedSample sample(recorder, calls.invoke);
+        command->Invoke(*items);
+      } else {
+        std::cerr << "Line " << lineNumber << ": unknown call " << call << std::endl;
+        result = 1;
+      }
+    }
+
+    if (command) command->Release();
+
+    return result;
+  }
+
+  /// <summary>
+  /// Replays synthetic sessions on several threads that all query one
+  /// command, as Explorer's worker threads do with a free-threaded handler,
+  /// and again with every call serialized through one apartment.
+  /// </summary>
+  /// <remarks>
+  /// The serialized run only models waiting for the apartment's thread, not
+  /// the cost of marshalling each call to it, so it understates what a
+  /// single-threaded handler costs. Each call is charged only the
+  /// allocations made on its own thread.
+  /// </remarks>
+  int ReplayConcurrent(const Options& options, FakeHost& host, Log& log) {
+    size_t slot = host.GetClassObject(options.slot);
+
+    if (slot == SIZE_MAX) {
+      std::cerr << "The config does not bind the requested slot." << std::endl;
+
+      return 1;
+    }
+
+    for (bool serialized : { false, true }) {
+      std::mutex apartment;
+      std::vector<LatencyRecorder> recorders(options.threads);
+      std::vector<std::thread> threads;
+      MenuCommand* command = host.CreateInstance(log, slot);
+      auto start = std::chrono::steady_clock::now();
+
+      for (LatencyRecorder& recorder : recorders) {
+        threads.emplace_back([&options, &recorder, &apartment, command, serialized] {
+          Calls calls(recorder);
+
+          recorder.Reserve(options.sessions * options.queries * 4);
+
+          // Threads walk through the same selections, so they mostly ask
+          // about the one the command has cached
+          for (size_t i = 0; i < options.sessions; ++i) {
+            MockShellItems items(options.items, options.shape, static_cast<uint32_t>(i));
+
+            for (size_t q = 0; q < options.queries; ++q) QueryCommand(*command, items, recorder, calls, serialized ? &apartment : nullptr);
+          }
+        });
+      }
+
+      for (std::thread& thread : threads) thread.join();
+
+      auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+      command->Release();
+
+      for (size_t i = 1; i < recorders.size(); ++i) recorders[0].Merge(recorders[i]);
+
+      std::cout << (serialized ? "Serialized" : "Free-threaded") << ", " << options.threads << " threads, " << elapsed.count() << " ms:\n";
+      recorders[0].Report(std::cout);
+      std::cout << '\n';
+    }
+
+    std::cout << std::flush;
+
+    return 0;
+  }
+
+  /// <summary>
+  /// Totals the allocations made while displaying menus, which should be
+  /// none once pooled storage has warmed up.
+  /// </summary>
+  uint64_t MenuDisplayAllocations(const LatencyRecorder& recorder, const Calls& calls) {
+    const size_t menuDisplayCalls[] = { calls.getClassObject, calls.createInstance, calls.getTitle, calls.getIcon, calls.getToolTip, calls.getState, calls.getFlags, calls.enumSubCommands };
+    uint64_t allocations = 0;
+
+    for (size_t call : menuDisplayCalls) allocations += recorder.Allocations(call);
+
+    return allocations;
+  }
+
+  /// <summary>
+  /// Measures UTF-8 conversion and config parsing throughput on a large
+  /// config with titles in several scripts.
+  /// </summary>
+  int BenchmarkTranscode(size_t megabytes) {
+    const char* const titles[] = {
+      "Open with Editor",
+      "Ouvrir avec l\xE2\x80\x99\xC3\xA9" "diteur",
+      "Im Editor \xC3\xB6" "ffnen",
+      "\xD0\x9E\xD1\x82\xD0\xBA\xD1\x80\xD1\x8B\xD1\x82\xD1\x8C \xD0\xB2 \xD1\x80\xD0\xB5\xD0\xB4\xD0\xB0\xD0\xBA\xD1\x82\xD0\xBE\xD1\x80\xD0\xB5",
+      "\xE3\x82\xA8\xE3\x83\x87\xE3\x82\xA3\xE3\x82\xBF\xE3\x83\xBC\xE3\x81\xA7\xE9\x96\x8B\xE3\x81\x8F",
+      "\xE7\x94\xA8\xE7\xBC\x96\xE8\xBE\x91\xE5\x99\xA8\xE6\x89\x93\xE5\xBC\x80",
+      "\xE1\xBA\x92\xC3\xAA\xCC\x81 \xF0\x9F\x93\x9D Notes"
+    };
+
+    std::string text = "{ \"types\": { ";
+
+    for (size_t i = 0; text.size() < (megabytes << 20); ++i) {
+      if (i) text += ", ";
+
+      text += "\"type" + std::to_string(i) + "\": { \"title\": \"";
+      text += titles[i % (sizeof(titles) / sizeof(titles[0]))];
+      text += "\", \"command\": \"C:\\\\Program Files\\\\Editor\\\\editor.exe --new-window %*\" }";
+    }
+
+    text += " } }";
+
+    std::wstring wide;
+    auto best = std::chrono::nanoseconds::max();
+
+    for (int i = 0; i < 5; ++i) {
+      auto start = std::chrono::steady_clock::now();
+      ConvertUtf8ToWide(text, wide);
+      best = std::min(best, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start));
+    }
+
+    Config config;
+    auto start = std::chrono::steady_clock::now();
+    ParseConfig(text, config);
+    auto parse = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+    double size = static_cast<double>(text.size()) / (1 << 20);
+
+    std::cout << "config: " << size << " MiB, " << config.bindings.size() << " entries\n"
+      << "ConvertUtf8ToWide: " << size / (static_cast<double>(best.count()) / 1e9) << " MiB/s\n"
+      << "ParseConfig: " << size / (static_cast<double>(parse.count()) / 1e9) << " MiB/s" << std::endl;
+
+    return 0;
+  }
+
+  /// <summary>
+  /// Compares reading a selection one shell item at a time with reading it
+  /// from its ID list, for each path shape.
+  /// </summary>
+  int BenchmarkResolve(size_t count) {
+    const std::pair<const char*, PathShape> shapes[] = { { "flat", PathShape::Flat }, { "deep", PathShape::Deep }, { "mixed", PathShape::Mixed }, { "unc", PathShape::Unc } };
+    Selection selection;
+
+    for (const auto& [name, shape] : shapes) {
+      MockShellItems items(count, shape, 0);
+
+      for (bool idList : { false, true }) {
+        auto best = std::chrono::nanoseconds::max();
+        uint64_t allocations = 0;
+
+        for (int i = 0; i < 20; ++i) {
+          uint64_t before = AllocationCounter::ThreadAllocations();
+          auto start = std::chrono::steady_clock::now();
+
+          if (idList) {
+            items.ReadIdList(selection, true);
+          } else {
+            items.ReadPerItem(selection, true);
+          }
+
+          best = std::min(best, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start));
+          allocations = AllocationCounter::ThreadAllocations() - before;
+        }
+
+        std::cout << name << (idList ? " ID list: " : " per item: ")
+          << static_cast<double>(best.count()) / static_cast<double>(count) << " ns/item, "
+          << static_cast<double>(allocations) / static_cast<double>(count) << " allocations/item\n";
+      }
+    }
+
+    std::cout << std::flush;
+
+    return 0;
+  }
+
+  /// <summary>
+  /// Compares each command template shape's own expander with interpreting
+  /// the same template, and full paths with paths relative to the
+  /// selection's common parent directory.
+  /// </summary>
+  int BenchmarkExpand(size_t count) {
+    const std::tuple<const char*, const wchar_t*, bool> templates[] = {
+      { "literal", L"C:\\Program Files\\Editor\\editor.exe --new-window", false },
+      { "single item", L"C:\\Program Files\\Editor\\editor.exe --goto %1", false },
+      { "repeat all", L"C:\\Program Files\\Editor\\editor.exe --new-window %*", false },
+      { "repeat all relative", L"C:\\Program Files\\Editor\\editor.exe --new-window %*", true },
+      { "mixed", L"C:\\Program Files\\Editor\\editor.exe --count %# %{--file \"%1\"}* --cwd %d", false }
+    };
+
+    MockShellItems items(count, PathShape::Mixed, 0);
+    Selection selection;
+    std::wstring result;
+
+    items.Read(selection, true, SIZE_MAX, std::chrono::steady_clock::time_point::max());
+
+    std::wstring commonParent = GetCommonParentDirectory(selection);
+
+    for (const auto& [name, command, relative] : templates) {
+      CommandContext context{ {}, relative ? std::wstring_view(commonParent) : std::wstring_view(L"C:\\"), relative };
+
+      for (bool specialize : { true, false }) {
+        CommandTemplate commandTemplate(command, specialize);
+        auto best = std::chrono::nanoseconds::max();
+        uint64_t allocations = 0;
+
+        for (int i = 0; i < 1000; ++i) {
+          uint64_t before = AllocationCounter::ThreadAllocations();
+          auto start = std::chrono::steady_clock::now();
+
+          commandTemplate.Expand(selection, context, result);
+
+          best = std::min(best, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start));
+          allocations = AllocationCounter::ThreadAllocations() - before;
+        }
+
+        std::cout << name << (specialize ? " specialized: " : " interpreted: ")
+          << best.count() << " ns, " << result.size() << " characters, "
+          << allocations << " allocations\n";
+      }
+    }
+
+    std::cout << std::flush;
+
+    return 0;
+  }
+
+  /// <summary>
+  /// One piece of work submitted while stressing an executor, recording how
+  /// it ended so that none is lost or run twice.
+  /// </summary>
+  struct StressWork {
+    enum Outcome { None, Ran, Cancelled, Refused };
+
+    StealingExecutor* executor = nullptr;
+    WorkPriority priority = WorkPriority::Housekeeping;
+
+    /// <summary>
+    /// Work submitted from this work when it runs, or <c>nullptr</c>.
+    /// </summary>
+    StressWork* child = nullptr;
+
+    std::atomic<int> outcome = None;
+    std::atomic<size_t>* duplicates = nullptr;
+
+    void End(Outcome ending) {
+      if (outcome.exchange(ending) != None) duplicates->fetch_add(1);
+    }
+
+    static void Run(void* context, bool cancelled) {
+      auto* work = static_cast<StressWork*>(context);
+
+      work->End(cancelled ? Cancelled : Ran);
+
+      // Submitted from a worker, so it goes to that worker's queues
+      if (!cancelled && work->child && !work->executor->Submit(work->child->priority, { Run, work->child })) work->child->End(Refused);
+    }
+  };
+
+  /// <summary>
+  /// Checks that a single worker runs queued work most urgent first.
+  /// </summary>
+  bool CheckExecutorPriorities() {
+    StealingExecutor executor(1);
+    std::mutex mutex;
+    std::vector<WorkPriority> order;
+
+    struct Gate {
+      std::atomic<bool> started = false;
+      std::atomic<bool> released = false;
+    } gate;
+
+    struct Context {
+      std::mutex* mutex;
+      std::vector<WorkPriority>* order;
+      WorkPriority priority;
+    };
+
+    // Holds the worker until everything else is queued
+    auto block = [](void* context, bool) {
+      auto* held = static_cast<Gate*>(context);
+
+      held->started = true;
+
+      while (!held->released) std::this_thread::yield();
+    };
+
+    auto record = [](void* context, bool cancelled) {
+      auto* recorded = static_cast<Context*>(context);
+      std::lock_guard<std::mutex> lock(*recorded->mutex);
+
+      if (!cancelled) recorded->order->push_back(recorded->priority);
+    };
+
+    Context contexts[] = {
+      { &mutex, &order, WorkPriority::Housekeeping },
+      { &mutex, &order, WorkPriority::Prefetch },
+      { &mutex, &order, WorkPriority::Interactive },
+      { &mutex, &order, WorkPriority::Housekeeping },
+      { &mutex, &order, WorkPriority::Interactive }
+    };
+
+    executor.Submit(WorkPriority::Housekeeping, { block, &gate });
+
+    while (!gate.started) std::this_thread::yield();
+
+    for (Context& context : contexts) executor.Submit(context.priority, { record, &context });
+
+    gate.released = true;
+
+    while (executor.Executed() < 1 + std::size(contexts)) std::this_thread::yield();
+
+    executor.Stop();
+
+    return std::is_sorted(order.begin(), order.end());
+  }
+
+  /// <summary>
+  /// Checks that work blocked on every worker, as probes of shares whose
+  /// servers are gone would be, holds up the work queued behind it but not
+  /// stopping the executor, which cancels that work without waiting.
+  /// </summary>
+  bool CheckBlockedWorkers(size_t count) {
+    StealingExecutor executor(2);
+    std::atomic<size_t> duplicates = 0;
+    std::vector<StressWork> work(count);
+
+    struct Gate {
+      std::atomic<size_t> started = 0;
+      std::atomic<bool> released = false;
+    } gate;
+
+    auto block = [](void* context, bool cancelled) {
+      auto* held = static_cast<Gate*>(context);
+
+      if (cancelled) return;
+
+      ++held->started;
+
+      while (!held->released) std::this_thread::yield();
+    };
+
+    for (size_t i = 0; i < executor.Threads(); ++i) executor.Submit(WorkPriority::Interactive, { block, &gate });
+
+    while (gate.started < executor.Threads()) std::this_thread::yield();
+
+    for (size_t i = 0; i < work.size(); ++i) {
+      work[i].executor = &executor;
+      work[i].priority = static_cast<WorkPriority>(i % WorkPriorityCount);
+      work[i].duplicates = &duplicates;
+
+      if (!executor.Submit(work[i].priority, { StressWork::Run, &work[i] })) work[i].End(StressWork::Refused);
+    }
+
+    // Stopping would never return if it waited for the blocked work
+    bool held = !executor.Stop();
+
+    gate.released = true;
+
+    while (!executor.Stop()) std::this_thread::yield();
+
+    bool cancelled = std::all_of(work.begin(), work.end(), [](const StressWork& item) { return item.outcome == StressWork::Cancelled; });
+
+    return held && cancelled && !duplicates;
+  }
+
+  /// <summary>
+  /// Submits work of every priority to executors from several threads at
+  /// once, some of which submits more work as it runs, and stops every other
+  /// executor while work is still being submitted, after checking
+  /// priorities and blocked workers.
+  /// </summary>
+  /// <remarks>
+  /// Every piece of work must end exactly once: by running, by being
+  /// cancelled, or by being refused because its executor was stopping.
+  /// </remarks>
+  int StressExecutor(size_t count) {
+    constexpr size_t Rounds = 20;
+    constexpr size_t Submitters = 4;
+    size_t failures = 0;
+    uint64_t ran = 0;
+    uint64_t stolen = 0;
+    uint64_t cancelled = 0;
+    uint64_t refused = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    if (!CheckExecutorPriorities()) {
+      std::cerr << "error: a worker did not run the most urgent work first" << std::endl;
+      ++failures;
+    }
+
+    if (!CheckBlockedWorkers(count)) {
+      std::cerr << "error: blocked workers held up stopping, or work queued behind them ran or was lost" << std::endl;
+      ++failures;
+    }
+
+    for (size_t round = 0; round < Rounds; ++round) {
+      StealingExecutor executor(2);
+      std::atomic<size_t> duplicates = 0;
+
+      // Every eighth piece of work has a child, stored after the rest
+      size_t children = (count + 7) / 8;
+      std::vector<StressWork> work(count + children);
+
+      for (size_t i = 0; i < work.size(); ++i) {
+        work[i].executor = &executor;
+        work[i].priority = static_cast<WorkPriority>(i % WorkPriorityCount);
+        work[i].duplicates = &duplicates;
+
+        if (i < count && i % 8 == 0) work[i].child = &work[count + i / 8];
+      }
+
+      std::vector<std::thread> threads;
+
+      for (size_t t = 0; t < Submitters; ++t) {
+        threads.emplace_back([&work, &executor, count, t] {
+          for (size_t i = t; i < count; i += Submitters) {
+            if (!executor.Submit(work[i].priority, { StressWork::Run, &work[i] })) work[i].End(StressWork::Refused);
+          }
+        });
+      }
+
+      bool stopEarly = round % 2;
+
+      if (stopEarly) {
+        while (executor.Executed() < count / 4) std::this_thread::yield();
+
+        executor.Stop();
+      }
+
+      for (std::thread& thread : threads) thread.join();
+
+      if (!stopEarly) {
+        while (executor.Executed() < work.size()) std::this_thread::yield();
+      }
+
+      while (!executor.Stop()) std::this_thread::yield();
+
+      // Children of work that never ran were never submitted
+      for (size_t i = 0; i < count; ++i) {
+        if (work[i].child && work[i].outcome != StressWork::Ran && work[i].child->outcome == StressWork::None) work[i].child->End(StressWork::Refused);
+      }
+
+      size_t lost = 0;
+      uint64_t roundRefused = 0;
+
+      for (StressWork& item : work) {
+        if (item.outcome == StressWork::None) ++lost;
+        if (item.outcome == StressWork::Refused) ++roundRefused;
+      }
+
+      if (lost || duplicates) {
+        std::cerr << "error: round " << round << " lost " << lost << " and ended " << duplicates.load() << " more than once" << std::endl;
+        ++failures;
+      }
+
+      ran += executor.Executed();
+      stolen += executor.Stolen();
+      cancelled += executor.Cancelled();
+      refused += roundRefused;
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    std::cout << Rounds << " rounds of " << count << " items, " << elapsed.count() << " ms: "
+      << ran << " ran (" << stolen << " stolen), " << cancelled << " cancelled, " << refused << " refused" << std::endl;
+
+    if (failures) return 4;
+
+    std::cout << "Every item ended exactly once, most urgent first, and blocked workers did not hold up stopping." << std::endl;
+
+    return 0;
+  }
+
+  void PrintUsage() {
+    std::cerr <<
+      "Usage: GenericShellExReplay [options]\n"
+      "  --config <file>        Config file (default: a built-in sample)\n"
+      "  --script <file>        Replay a recorded session script\n"
+      "  --slot <name>          Slot to request (default: *)\n"
+      "  --sessions <n>         Synthetic sessions (default: 1000)\n"
+      "  --items <n>            Selected items per session (default: 16)\n"
+      "  --shape <shape>        flat, deep, mixed, or unc (default: flat)\n"
+      "  --queries <n>          Menu queries per session (default: 3)\n"
+      "  --invoke-every <n>     Invoke every nth session (default: never)\n"
+      "  --check-allocations    Fail if displaying a menu allocates once warmed up\n"
+      "  --transcode <MiB>      Measure UTF-8 conversion and config parsing instead\n"
+      "  --resolve <n>          Measure reading n selected items instead\n"
+      "  --expand <n>           Measure expanding commands for n items instead\n"
+      "  --threads <n>          Query one command from n threads at once instead\n"
+      "  --stress-executor <n>  Submit n items to the background executor instead\n"
+      "  --log                  Log to an in-memory ring\n"
+      "  --verbose              Print launched commands\n";
+  }
+
+  bool ParseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+      std::string arg = argv[i];
+      bool hasValue = i + 1 < argc;
+
+      if (arg == "--log") {
+        options.log = true;
+      } else if (arg == "--verbose") {
+        options.verbose = true;
+      } else if (arg == "--check-allocations") {
+        options.checkAllocations = true;
+      } else if (!hasValue) {
+        return false;
+      } else if (arg == "--config") {
+        options.configPath = argv[++i];
+      } else if (arg == "--script") {
+        options.scriptPath = argv[++i];
+      } else if (arg == "--slot") {
+        std::string slot = argv[++i];
+        options.slot.assign(slot.begin(), slot.end());
+      } else if (arg == "--sessions") {
+        options.sessions = std::strtoull(argv[++i], nullptr, 10);
+      } else if (arg == "--items") {
+        options.items = std::strtoull(argv[++i], nullptr, 10);
+      } else if (arg == "--shape") {
+        if (!ParsePathShape(argv[++i], options.shape)) return false;
+      } else if (arg == "--queries") {
+        options.queries = std::strtoull(argv[++i], nullptr, 10);
+      } else if (arg == "--transcode") {
+        options.transcodeMegabytes = std::strtoull(argv[++i], nullptr, 10);
+      } else if (arg == "--resolve") {
+        options.resolveItems = std::strtoull(argv[++i], nullptr, 10);
+      } else if (arg == "--expand") {
+        options.expandItems = std::strtoull(argv[++i], nullptr, 10);
+      } else if (arg == "--threads") {
+        options.threads = std::strtoull(argv[++i], nullptr, 10);
+      } else if (arg == "--stress-executor") {
+        options.stressItems = std::strtoull(argv[++i], nullptr, 10);
+      } else if (arg == "--invoke-every") {
+        options.invokeEvery = std::strtoull(argv[++i], nullptr, 10);
+      } else {
+        return false;
+      }
+    }
+
+    return true;
+  }
+}
+
+int main(int argc, char** argv) {
+  Options options;
+
+  if (!ParseOptions(argc, argv, options)) {
+    PrintUsage();
+
+    return 2;
+  }
+
+  if (options.transcodeMegabytes) return BenchmarkTranscode(options.transcodeMegabytes);
+  if (options.resolveItems) return BenchmarkResolve(options.resolveItems);
+  if (options.expandItems) return BenchmarkExpand(options.expandItems);
+  if (options.stressItems) return StressExecutor(options.stressItems);
+
+  if (!options.configPath.empty() && !std::filesystem::exists(options.configPath)) {
+    std::cerr << "Unable to read " << options.configPath << std::endl;
+
+    return 1;
+  }
+
+  Log log;
+
+  if (options.log) log.Open(nullptr);
+
+  FakePlatform platform;
+  platform.verbose = options.verbose;
+
+  TypedMenuCommandPool<MenuCommand> pool(platform);
+  FakeHost host(options.configPath, DefaultConfig, pool, log);
+
+  if (options.threads) {
+    int concurrentResult = ReplayConcurrent(options, host, log);
+
+    pool.Drain();
+
+    return concurrentResult;
+  }
+
+  LatencyRecorder recorder;
+  Calls calls(recorder);
+
+  recorder.Reserve(options.sessions * options.queries * 4);
+
+  uint64_t allocations = AllocationCounter::Allocations();
+  uint64_t bytes = AllocationCounter::Bytes();
+
+  int result = options.scriptPath.empty()
+    ? ReplaySynthetic(options, host, log, recorder, calls)
+    : ReplayScript(options, host, log, recorder, calls);
+
+  pool.Drain();
+
+  if (result) return result;
+
+  allocations = AllocationCounter::Allocations() - allocations;
+  bytes = AllocationCounter::Bytes() - bytes;
+
+  recorder.Report(std::cout);
+
+  std::cout << '\n' << "allocations: " << allocations << " (" << bytes << " bytes), launches: " << platform.launches << " (" << MenuCommand::PrefetchHits() << " prepared)" << std::endl;
+
+  if (options.checkAllocations) {
+    uint64_t menuDisplayAllocations = MenuDisplayAllocations(recorder, calls);
+
+    if (menuDisplayAllocations) {
+      std::cerr << "error: displaying menus allocated " << menuDisplayAllocations << " times after warming up" << std::endl;
+
+      return 3;
+    }
+
+    std::cout << "Displaying menus made no allocations after warming up." << std::endl;
+  }
+
+  return 0;
+}
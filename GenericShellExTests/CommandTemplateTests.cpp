@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include "CommandTemplate.h"
+#include "ContextMenuEntry.h"
+#include "TestSelection.h"
+
+TEST(QuoteArgument, QuotesEveryArgument) {
+  EXPECT_EQ(QuoteArgument(L"C:\\My Files\\a.txt"), L"\"C:\\My Files\\a.txt\"");
+  EXPECT_EQ(QuoteArgument(L"a.txt"), L"\"a.txt\"");
+  EXPECT_EQ(QuoteArgument(L""), L"\"\"");
+}
+
+TEST(QuoteArgument, DoublesBackslashesBeforeQuotes) {
+  EXPECT_EQ(QuoteArgument(L"C:\\"), L"\"C:\\\\\"");
+  EXPECT_EQ(QuoteArgument(L"say \"hi\""), L"\"say \\\"hi\\\"\"");
+}
+
+TEST(CommandTemplate, PicksShapes) {
+  EXPECT_EQ(CommandTemplate(L"notepad").Shape(), CommandTemplateShape::Literal);
+  EXPECT_EQ(CommandTemplate(L"notepad %1").Shape(), CommandTemplateShape::SingleItem);
+  EXPECT_EQ(CommandTemplate(L"nvim %* --").Shape(), CommandTemplateShape::RepeatAll);
+  EXPECT_EQ(CommandTemplate(L"diff %1 %*").Shape(), CommandTemplateShape::Mixed);
+  EXPECT_TRUE(CommandTemplate(L"code %root").UsesRoot());
+  EXPECT_FALSE(CommandTemplate(L"code %1").UsesRoot());
+}
+
+TEST(CommandTemplate, ExpandsItems) {
+  Selection selection = MakeSelection({ L"C:\\src\\a.txt", L"C:\\src\\my b.txt" });
+
+  EXPECT_EQ(CommandTemplate(L"nvim %*").Expand(selection), L"nvim \"C:\\src\\a.txt\" \"C:\\src\\my b.txt\"");
+  EXPECT_EQ(CommandTemplate(L"nvim %1").Expand(selection), L"nvim \"C:\\src\\a.txt\"");
+  EXPECT_EQ(CommandTemplate(L"count %#").Expand(selection), L"count 2");
+}
+
+TEST(CommandTemplate, ExpandsNameParts) {
+  Selection selection = MakeSelection({ L"C:\\src\\archive.tar.gz" });
+
+  EXPECT_EQ(CommandTemplate(L"%d %n %b %x").Expand(selection), L"\"C:\\src\" \"archive.tar.gz\" \"archive.tar\" \".gz\"");
+
+  Selection dotFile = MakeSelection({ L"C:\\src\\.gitignore" });
+
+  EXPECT_EQ(CommandTemplate(L"%b|%x").Expand(dotFile), L"\".gitignore\"|");
+}
+
+TEST(CommandTemplate, QuotesPlaceholdersWrittenInQuotesOnce) {
+  Selection selection = MakeSelection({ L"C:\\My Files\\a.txt" });
+
+  EXPECT_EQ(CommandTemplate(L"open \"%1\"").Expand(selection), L"open \"C:\\My Files\\a.txt\"");
+}
+
+TEST(CommandTemplate, RepeatsFragments) {
+  Selection selection = MakeSelection({ L"C:\\a.txt", L"C:\\b.txt" });
+
+  EXPECT_EQ(CommandTemplate(L"tool %{--file %1}*").Expand(selection), L"tool --file \"C:\\a.txt\" --file \"C:\\b.txt\"");
+}
+
+TEST(CommandTemplate, ExpandsRelativePaths) {
+  Selection selection = MakeSelection({ L"C:\\src\\a.txt", L"C:\\src\\-b.txt", L"D:\\other.txt" });
+  CommandContext context{ {}, L"C:\\src", true };
+
+  EXPECT_EQ(CommandTemplate(L"nvim %*").Expand(selection, context), L"nvim \"a.txt\" \".\\-b.txt\" \"D:\\other.txt\"");
+}
+
+TEST(CommandTemplate, SpecializedAndInterpretedExpansionsAgree) {
+  Selection selection = MakeSelection({ L"C:\\src\\a.txt", L"C:\\src\\my b.txt", L"C:\\src\\c" });
+
+  for (const wchar_t* command : { L"notepad", L"notepad %1 --wait", L"nvim -p %*" }) {
+    EXPECT_EQ(CommandTemplate(command).Expand(selection), CommandTemplate(command, false).Expand(selection)) << command;
+  }
+}
+
+TEST(CommandTemplate, DoesNotExpandSubstitutedValues) {
+  Selection selection = MakeSelection({ L"C:\\100%1 sure.txt" });
+
+  EXPECT_EQ(CommandTemplate(L"x %1").Expand(selection), L"x \"C:\\100%1 sure.txt\"");
+}
+
+TEST(CommandTemplate, FindsDirectories) {
+  Selection selection = MakeSelection({ L"C:\\src\\app\\main.cpp", L"C:\\src\\lib\\util.cpp" });
+
+  EXPECT_EQ(GetDirectoryFromFirstItem(selection), L"C:\\src\\app");
+  EXPECT_EQ(GetCommonParentDirectory(selection), L"C:\\src");
+
+  Selection root = MakeSelection({ L"C:\\a.txt" });
+
+  EXPECT_EQ(GetDirectoryFromFirstItem(root), L"C:\\");
+
+  Selection volumes = MakeSelection({ L"C:\\a.txt", L"D:\\b.txt" });
+
+  EXPECT_EQ(GetCommonParentDirectory(volumes), L"");
+}
+
+TEST(CommandTemplate, FindsTheProgram) {
+  EXPECT_EQ(GetCommandProgram(L"\"C:\\Program Files\\app.exe\" %1"), L"C:\\Program Files\\app.exe");
+  EXPECT_EQ(GetCommandProgram(L"notepad.exe\t%1"), L"notepad.exe");
+  EXPECT_EQ(GetCommandProgram(L""), L"");
+}
+
+TEST(CommandTemplate, CompilesSubcommands) {
+  ContextMenuEntry entry;
+  entry.command = L"nvim %1";
+  entry.subCommands.emplace_back();
+  entry.subCommands.back().command = L"code %*";
+
+  CompileCommandTemplates(entry);
+
+  EXPECT_EQ(entry.commandTemplate.Shape(), CommandTemplateShape::SingleItem);
+  EXPECT_EQ(entry.subCommands.back().commandTemplate.Shape(), CommandTemplateShape::RepeatAll);
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include "Config.h"
+#include "TestSelection.h"
+
+TEST(ParseConfig, ParsesEntries) {
+  Config config;
+
+  ASSERT_TRUE(ParseConfig(R"({
+    "logFile": "C:\\log.txt",
+    "types": {
+      "*": { "title": "Open in Neovim", "icon": "nvim.exe,0", "command": "nvim %*" },
+      "Directory#1": { "title": "Open Here", "command": "wt -d %1", "slot": 1 }
+    }
+  })", config));
+
+  EXPECT_EQ(config.logFile, L"C:\\log.txt");
+  ASSERT_EQ(config.bindings.size(), 2u);
+  EXPECT_EQ(config.bindings[0].type, L"*");
+  EXPECT_EQ(config.bindings[0].entry.title, L"Open in Neovim");
+  EXPECT_EQ(config.bindings[0].entry.icon, L"nvim.exe,0");
+  EXPECT_EQ(config.bindings[0].entry.command, L"nvim %*");
+  EXPECT_EQ(config.bindings[1].type, L"Directory#1");
+  EXPECT_EQ(config.bindings[1].slotIndex, 1u);
+  EXPECT_TRUE(config.errors.empty());
+}
+
+TEST(ParseConfig, ReadsUtf8) {
+  Config config;
+
+  ASSERT_TRUE(ParseConfig("{\"types\":{\"*\":{\"title\":\"\xC3\x96" "ffnen \xE2\x9C\x93\"}}}", config));
+  ASSERT_EQ(config.bindings.size(), 1u);
+  EXPECT_EQ(config.bindings[0].entry.title, L"\u00D6ffnen \u2713");
+}
+
+TEST(ParseConfig, PresentsArraysAsSubcommands) {
+  Config config;
+
+  ASSERT_TRUE(ParseConfig(R"({"types": {"*": [
+    { "title": "Edit with Notepad", "command": "notepad %*" },
+    { "title": "Open in Neovim", "command": "nvim %*" }
+  ]}})", config));
+
+  ASSERT_EQ(config.bindings.size(), 1u);
+  EXPECT_EQ(config.bindings[0].entry.title, L"Generic Shell Extensions");
+  ASSERT_EQ(config.bindings[0].entry.subCommands.size(), 2u);
+  EXPECT_EQ(config.bindings[0].entry.subCommands[1].title, L"Open in Neovim");
+}
+
+TEST(ParseConfig, ReportsTypesThatAreNotEntries) {
+  Config config;
+
+  ASSERT_TRUE(ParseConfig(R"({"types": {
+    "*": [{ "title": "Edit with Notepad", "command": "notepad %*" }],
+    "*Title": "Editors"
+  }})", config));
+
+  ASSERT_EQ(config.bindings.size(), 1u);
+  EXPECT_EQ(config.bindings[0].entry.title, L"Generic Shell Extensions");
+  ASSERT_EQ(config.errors.size(), 1u);
+  EXPECT_NE(config.errors[0].find(L"*Title"), std::wstring::npos);
+}
+
+TEST(ParseConfig, TitlesSubcommandObjectsFromTheirOwnTitle) {
+  Config config;
+
+  ASSERT_TRUE(ParseConfig(R"({"types": {"*": {
+    "title": "Editors",
+    "subCommands": [{ "title": "Edit with Notepad", "command": "notepad %*" }]
+  }}})", config));
+
+  ASSERT_EQ(config.bindings.size(), 1u);
+  EXPECT_EQ(config.bindings[0].entry.title, L"Editors");
+  EXPECT_EQ(config.bindings[0].entry.subCommands.size(), 1u);
+}
+
+TEST(ParseConfig, ReadsTopLevelSettings) {
+  Config config;
+
+  ASSERT_TRUE(ParseConfig(R"({"iconCache": true, "threadpool": true, "volumeTimeoutMs": 60000})", config));
+
+  EXPECT_TRUE(config.iconCache);
+  EXPECT_TRUE(config.threadpool);
+  EXPECT_EQ(config.volumeTimeout, Config::MaxVolumeTimeout);
+}
+
+TEST(ParseConfig, RejectsInvalidDocuments) {
+  Config config;
+
+  EXPECT_FALSE(ParseConfig("{\"types\": ", config));
+  EXPECT_FALSE(config.errors.empty());
+
+  EXPECT_FALSE(ParseConfig("[]", config));
+  EXPECT_FALSE(config.errors.empty());
+}
+
+TEST(ParseConfig, ReportsAndIgnoresInvalidValues) {
+  Config config;
+
+  ASSERT_TRUE(ParseConfig(R"({"types": {"*": {
+    "command": "nvim %1",
+    "when": { "itemType": "socket", "extensions": [".c"] },
+    "selection": { "sort": "sideways", "limit": 2 }
+  }}})", config));
+
+  ASSERT_EQ(config.bindings.size(), 1u);
+  EXPECT_EQ(config.errors.size(), 2u);
+
+  const ContextMenuEntry& entry = config.bindings[0].entry;
+
+  EXPECT_EQ(entry.order.sort, SelectionSortKey::None);
+  EXPECT_EQ(entry.order.limit, 2u);
+  EXPECT_EQ(entry.when.Evaluate(MakeSelection({ L"C:\\src\\main.c" })), PredicateResult::Match);
+  EXPECT_EQ(entry.when.Evaluate(MakeSelection({ L"C:\\src\\main.cpp" })), PredicateResult::NoMatch);
+}
+
+TEST(ParseConfig, ParsesSelectionOrder) {
+  Config config;
+
+  ASSERT_TRUE(ParseConfig(R"({"types": {"*": {
+    "selection": { "unique": true, "sort": "natural", "descending": true }
+  }}})", config));
+
+  const SelectionOrder& order = config.bindings[0].entry.order;
+
+  EXPECT_TRUE(order.unique);
+  EXPECT_EQ(order.sort, SelectionSortKey::Natural);
+  EXPECT_TRUE(order.descending);
+  EXPECT_EQ(order.limit, SIZE_MAX);
+}
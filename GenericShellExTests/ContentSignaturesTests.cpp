@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ContentSignatures.h"
+
+namespace {
+  uint64_t MatchText(const ContentSignatures& signatures, std::string_view text) {
+    return signatures.Match(text.data(), text.size());
+  }
+}
+
+TEST(ContentSignatures, ParsesNamedSignatures) {
+  std::vector<std::string> patterns;
+
+  ASSERT_TRUE(ContentSignatures::Parse("pe", patterns));
+  EXPECT_EQ(patterns, std::vector<std::string>{ "MZ" });
+
+  ASSERT_TRUE(ContentSignatures::Parse("zip", patterns));
+  EXPECT_EQ(patterns, (std::vector<std::string>{ "PK\x03\x04", "PK\x05\x06", "PK\x07\x08" }));
+
+  ASSERT_TRUE(ContentSignatures::Parse("elf", patterns));
+  EXPECT_EQ(patterns, std::vector<std::string>{ "\x7F" "ELF" });
+}
+
+TEST(ContentSignatures, ParsesHexAndText) {
+  std::vector<std::string> patterns;
+
+  ASSERT_TRUE(ContentSignatures::Parse("hex:7F 45 4c 46", patterns));
+  EXPECT_EQ(patterns, std::vector<std::string>{ "\x7F" "ELF" });
+
+  ASSERT_TRUE(ContentSignatures::Parse("hex:00FF", patterns));
+  EXPECT_EQ(patterns, std::vector<std::string>{ std::string("\0\xFF", 2) });
+
+  ASSERT_TRUE(ContentSignatures::Parse("text:#!/bin/sh", patterns));
+  EXPECT_EQ(patterns, std::vector<std::string>{ "#!/bin/sh" });
+}
+
+TEST(ContentSignatures, RejectsInvalidSignatures) {
+  std::vector<std::string> patterns;
+
+  EXPECT_FALSE(ContentSignatures::Parse("", patterns));
+  EXPECT_FALSE(ContentSignatures::Parse("exe", patterns));
+  EXPECT_FALSE(ContentSignatures::Parse("PE", patterns));
+  EXPECT_FALSE(ContentSignatures::Parse("hex:", patterns));
+  EXPECT_FALSE(ContentSignatures::Parse("hex:4", patterns));
+  EXPECT_FALSE(ContentSignatures::Parse("hex:4 D", patterns));
+  EXPECT_FALSE(ContentSignatures::Parse("hex:4G", patterns));
+  EXPECT_FALSE(ContentSignatures::Parse("text:", patterns));
+  EXPECT_FALSE(ContentSignatures::Parse("text:" + std::string(ContentSignatures::MaxPatternLength + 1, 'a'), patterns));
+  EXPECT_TRUE(ContentSignatures::Parse("text:" + std::string(ContentSignatures::MaxPatternLength, 'a'), patterns));
+
+  ContentSignatures signatures;
+
+  EXPECT_EQ(signatures.Add("hex:4"), 0u);
+  EXPECT_TRUE(signatures.IsEmpty());
+}
+
+TEST(ContentSignatures, MatchesAnchoredPrefixes) {
+  ContentSignatures signatures;
+  uint64_t pe = signatures.Add("pe");
+  uint64_t pdf = signatures.Add("pdf");
+
+  ASSERT_NE(pe, 0u);
+  ASSERT_NE(pdf, 0u);
+  EXPECT_EQ(pe & pdf, 0u);
+  EXPECT_EQ(signatures.Longest(), 5u);
+
+  EXPECT_EQ(MatchText(signatures, "MZ\x90\x00"), pe);
+  EXPECT_EQ(MatchText(signatures, "%PDF-1.7"), pdf);
+  EXPECT_EQ(MatchText(signatures, "xMZ"), 0u);
+  EXPECT_EQ(MatchText(signatures, "%PDF"), 0u);
+  EXPECT_EQ(MatchText(signatures, "M"), 0u);
+  EXPECT_EQ(MatchText(signatures, ""), 0u);
+}
+
+TEST(ContentSignatures, MatchesOverlappingPrefixes) {
+  ContentSignatures signatures;
+  uint64_t longer = signatures.Add("text:MZ\x90");
+  uint64_t pe = signatures.Add("pe");
+  uint64_t sibling = signatures.Add("text:MA");
+
+  ASSERT_NE(longer, 0u);
+  ASSERT_NE(pe, 0u);
+  EXPECT_NE(longer, pe);
+
+  // Both the shorter pattern and the longer one that starts with it match
+  EXPECT_EQ(MatchText(signatures, "MZ\x90\x00"), pe | longer);
+  EXPECT_EQ(MatchText(signatures, "MZ\x91"), pe);
+  EXPECT_EQ(MatchText(signatures, "MZ"), pe);
+  EXPECT_EQ(MatchText(signatures, "MA"), sibling);
+}
+
+TEST(ContentSignatures, SharesRepeatedPatterns) {
+  ContentSignatures signatures;
+  uint64_t pe = signatures.Add("pe");
+
+  EXPECT_EQ(signatures.Add("text:MZ"), pe);
+  EXPECT_EQ(signatures.Add("hex:4D5A"), pe);
+}
+
+TEST(ContentSignatures, LimitsThePatternCount) {
+  ContentSignatures signatures;
+  uint64_t all = 0;
+
+  for (size_t i = 0; i < ContentSignatures::MaxPatterns; ++i) {
+    uint64_t mask = signatures.Add("text:" + std::to_string(i));
+
+    ASSERT_NE(mask, 0u);
+    EXPECT_EQ(mask & all, 0u);
+    all |= mask;
+  }
+
+  EXPECT_EQ(all & ContentSignatures::Unknown, 0u);
+
+  uint64_t hash = signatures.Hash();
+
+  // Another pattern does not fit, and leaves the others as they were
+  EXPECT_EQ(signatures.Add("text:x"), 0u);
+  EXPECT_EQ(signatures.Add("zip"), 0u);
+  EXPECT_EQ(signatures.Hash(), hash);
+  EXPECT_NE(MatchText(signatures, "62"), 0u);
+  EXPECT_EQ(MatchText(signatures, "x"), 0u);
+
+  // A pattern that is already there still does
+  EXPECT_NE(signatures.Add("text:0"), 0u);
+}
+
+TEST(ContentSignatures, HashesPatterns) {
+  ContentSignatures empty;
+  ContentSignatures a;
+  ContentSignatures b;
+  ContentSignatures c;
+
+  a.Add("pe");
+  b.Add("pe");
+  c.Add("text:MZ\x90");
+
+  EXPECT_EQ(a.Hash(), b.Hash());
+  EXPECT_NE(a.Hash(), c.Hash());
+  EXPECT_NE(a.Hash(), empty.Hash());
+
+  b.Add("pdf");
+
+  EXPECT_NE(a.Hash(), b.Hash());
+}
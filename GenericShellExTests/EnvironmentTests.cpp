@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <initializer_list>
+#include <map>
+#include <utility>
+
+#include "Environment.h"
+
+namespace {
+  /// <summary>
+  /// A fixed environment that counts how often each variable is looked up.
+  /// </summary>
+  struct FakeEnvironment {
+    std::map<std::wstring, std::wstring> variables;
+    std::map<std::wstring, int> lookups;
+
+    FakeEnvironment(std::initializer_list<std::pair<const std::wstring, std::wstring>> variables = {}) : variables(variables) {}
+
+    EnvironmentExpander Expander() {
+      return EnvironmentExpander([this](const std::wstring& name) -> std::optional<std::wstring> {
+        ++lookups[name];
+
+        auto variable = variables.find(name);
+
+        if (variable == variables.end()) return std::nullopt;
+
+        return variable->second;
+      });
+    }
+  };
+}
+
+TEST(EnvironmentExpander, ExpandsReferences) {
+  FakeEnvironment environment({ { L"PROGRAMFILES", L"C:\\Program Files" }, { L"ProgramFiles(x86)", L"C:\\Program Files (x86)" } });
+  EnvironmentExpander expander = environment.Expander();
+
+  EXPECT_EQ(expander.Expand(L"%PROGRAMFILES%\\Editor\\editor.exe"), L"C:\\Program Files\\Editor\\editor.exe");
+  EXPECT_EQ(expander.Expand(L"%ProgramFiles(x86)%\\a;%PROGRAMFILES%\\b"), L"C:\\Program Files (x86)\\a;C:\\Program Files\\b");
+}
+
+TEST(EnvironmentExpander, LeavesPlaceholdersAlone) {
+  FakeEnvironment environment({ { L"EDITOR", L"nvim" } });
+  EnvironmentExpander expander = environment.Expander();
+
+  EXPECT_EQ(expander.Expand(L"%EDITOR% %1"), L"nvim %1");
+  EXPECT_EQ(expander.Expand(L"%EDITOR% %*"), L"nvim %*");
+  EXPECT_EQ(expander.Expand(L"%EDITOR% %{--file %1}* --cwd %d"), L"nvim %{--file %1}* --cwd %d");
+  EXPECT_EQ(expander.Expand(L"%EDITOR% %1%EDITOR%"), L"nvim %1nvim");
+  EXPECT_EQ(expander.Expand(L"100% %EDITOR%"), L"100% nvim");
+  EXPECT_EQ(expander.Expand(L"%"), L"%");
+}
+
+TEST(EnvironmentExpander, KeepsUnsetVariables) {
+  FakeEnvironment environment;
+  EnvironmentExpander expander = environment.Expander();
+
+  EXPECT_EQ(expander.Expand(L"%MISSING%\\tool.exe %1"), L"%MISSING%\\tool.exe %1");
+  EXPECT_EQ(expander.Expand(L"%NOT A NAME%"), L"%NOT A NAME%");
+}
+
+TEST(EnvironmentExpander, LooksUpEachVariableOnce) {
+  FakeEnvironment environment({ { L"EDITOR", L"nvim" } });
+  EnvironmentExpander expander = environment.Expander();
+
+  expander.Expand(L"%EDITOR% %EDITOR% %MISSING%");
+  expander.Expand(L"%EDITOR% %MISSING%");
+
+  ContextMenuEntry entry;
+  entry.title = L"Open in %EDITOR%";
+  entry.command = L"%EDITOR% %*";
+  entry.subCommands.emplace_back().command = L"%EDITOR% %1";
+  expander.Expand(entry);
+
+  EXPECT_EQ(entry.title, L"Open in nvim");
+  EXPECT_EQ(entry.subCommands[0].command, L"nvim %1");
+  EXPECT_EQ(environment.lookups[L"EDITOR"], 1);
+  EXPECT_EQ(environment.lookups[L"MISSING"], 1);
+}
+
+TEST(EnvironmentExpander, DoesNotExpandValuesAgain) {
+  FakeEnvironment environment({ { L"A", L"%B%" }, { L"B", L"b" } });
+  EnvironmentExpander expander = environment.Expander();
+
+  EXPECT_EQ(expander.Expand(L"%A%"), L"%B%");
+  EXPECT_EQ(environment.lookups.count(L"B"), 0u);
+}
+
+TEST(EnvironmentExpander, CopiesPercentSignsInValues) {
+  // Values are substituted as written, so a % in one becomes part of the
+  // command template compiled afterwards
+  FakeEnvironment environment({ { L"TOOL", L"C:\\100%1\\tool.exe" } });
+  EnvironmentExpander expander = environment.Expander();
+
+  EXPECT_EQ(expander.Expand(L"%TOOL% %*"), L"C:\\100%1\\tool.exe %*");
+}
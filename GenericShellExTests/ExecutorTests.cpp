@@ -0,0 +1,299 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Executor.h"
+
+namespace {
+  struct Counter {
+    std::atomic<int> ran = 0;
+    std::atomic<int> cancelled = 0;
+
+    static void Run(void* context, bool cancelled) {
+      auto* counter = static_cast<Counter*>(context);
+
+      if (cancelled) {
+        ++counter->cancelled;
+      } else {
+        ++counter->ran;
+      }
+    }
+  };
+
+  /// <summary>
+  /// Holds every worker that runs it until released.
+  /// </summary>
+  struct Blocker {
+    std::atomic<size_t> started = 0;
+    std::atomic<bool> released = false;
+
+    static void Run(void* context, bool cancelled) {
+      auto* blocker = static_cast<Blocker*>(context);
+
+      if (cancelled) return;
+
+      ++blocker->started;
+
+      while (!blocker->released) std::this_thread::yield();
+    }
+
+    /// <summary>
+    /// Blocks every worker of <paramref name="executor"/>, returning once
+    /// they all are.
+    /// </summary>
+    void BlockAll(StealingExecutor& executor) {
+      for (size_t i = 0; i < executor.Threads(); ++i) {
+        ASSERT_TRUE(executor.Submit(WorkPriority::Interactive, { Run, this }));
+      }
+
+      while (started < executor.Threads()) std::this_thread::yield();
+    }
+  };
+
+  /// <summary>
+  /// One piece of work submitted while stressing an executor, recording how
+  /// it ended so that none is lost or run twice.
+  /// </summary>
+  struct StressWork {
+    enum Outcome { None, Ran, Cancelled, Refused };
+
+    StealingExecutor* executor = nullptr;
+    WorkPriority priority = WorkPriority::Housekeeping;
+
+    /// <summary>
+    /// Work submitted from this work when it runs, or <c>nullptr</c>.
+    /// </summary>
+    StressWork* child = nullptr;
+
+    std::atomic<int> outcome = None;
+    std::atomic<size_t>* duplicates = nullptr;
+
+    void End(Outcome ending) {
+      if (outcome.exchange(ending) != None) duplicates->fetch_add(1);
+    }
+
+    static void Run(void* context, bool cancelled) {
+      auto* work = static_cast<StressWork*>(context);
+
+      work->End(cancelled ? Cancelled : Ran);
+
+      // Submitted from a worker, so it goes to that worker's queues
+      if (!cancelled && work->child && !work->executor->Submit(work->child->priority, { Run, work->child })) work->child->End(Refused);
+    }
+  };
+}
+
+TEST(StealingExecutor, RunsSubmittedWork) {
+  Counter counter;
+
+  {
+    StealingExecutor executor(2);
+
+    ASSERT_EQ(executor.Threads(), 2u);
+
+    for (int i = 0; i < 100; ++i) {
+      ASSERT_TRUE(executor.Submit(static_cast<WorkPriority>(i % WorkPriorityCount), { &Counter::Run, &counter }));
+    }
+  }
+
+  // Destroying the executor stops it, so each item ran or was cancelled
+  EXPECT_EQ(counter.ran + counter.cancelled, 100);
+}
+
+TEST(StealingExecutor, RefusesWorkOnceStopping) {
+  Counter counter;
+  StealingExecutor executor(1);
+
+  EXPECT_TRUE(executor.Stop());
+  EXPECT_TRUE(executor.IsStopping());
+  EXPECT_FALSE(executor.Submit(WorkPriority::Interactive, { &Counter::Run, &counter }));
+  EXPECT_EQ(counter.ran + counter.cancelled, 0);
+}
+
+TEST(StealingExecutor, FinishesWorkBeforeStopping) {
+  struct Gate {
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool started = false;
+    bool open = false;
+
+    static void Run(void* context, bool cancelled) {
+      if (cancelled) return;
+
+      auto* gate = static_cast<Gate*>(context);
+      std::unique_lock lock(gate->mutex);
+
+      gate->started = true;
+      gate->changed.notify_all();
+      gate->changed.wait(lock, [gate] { return gate->open; });
+    }
+  };
+
+  Gate gate;
+  StealingExecutor executor(1);
+
+  ASSERT_TRUE(executor.Submit(WorkPriority::Interactive, { &Gate::Run, &gate }));
+
+  {
+    std::unique_lock lock(gate.mutex);
+    gate.changed.wait(lock, [&gate] { return gate.started; });
+  }
+
+  EXPECT_FALSE(executor.Stop());
+
+  {
+    std::lock_guard lock(gate.mutex);
+    gate.open = true;
+  }
+
+  gate.changed.notify_all();
+
+  while (!executor.Stop()) std::this_thread::yield();
+
+  EXPECT_EQ(executor.Executed(), 1u);
+}
+
+TEST(StealingExecutor, RunsQueuedWorkMostUrgentFirst) {
+  struct Record {
+    std::mutex* mutex;
+    std::vector<WorkPriority>* order;
+    WorkPriority priority;
+
+    static void Run(void* context, bool cancelled) {
+      auto* record = static_cast<Record*>(context);
+      std::lock_guard lock(*record->mutex);
+
+      if (!cancelled) record->order->push_back(record->priority);
+    }
+  };
+
+  StealingExecutor executor(1);
+  Blocker blocker;
+  std::mutex mutex;
+  std::vector<WorkPriority> order;
+
+  Record records[] = {
+    { &mutex, &order, WorkPriority::Housekeeping },
+    { &mutex, &order, WorkPriority::Prefetch },
+    { &mutex, &order, WorkPriority::Interactive },
+    { &mutex, &order, WorkPriority::Housekeeping },
+    { &mutex, &order, WorkPriority::Interactive }
+  };
+
+  // Everything is queued behind the blocked worker before any of it runs
+  blocker.BlockAll(executor);
+
+  for (Record& record : records) {
+    ASSERT_TRUE(executor.Submit(record.priority, { &Record::Run, &record }));
+  }
+
+  blocker.released = true;
+
+  while (executor.Executed() < 1 + std::size(records)) std::this_thread::yield();
+
+  EXPECT_TRUE(executor.Stop());
+  EXPECT_EQ(order.size(), std::size(records));
+  EXPECT_TRUE(std::is_sorted(order.begin(), order.end()));
+}
+
+TEST(StealingExecutor, CancelsWorkBehindBlockedWorkersWithoutWaiting) {
+  StealingExecutor executor(2);
+  Blocker blocker;
+  std::atomic<size_t> duplicates = 0;
+  std::vector<StressWork> work(1000);
+
+  // As probes of shares whose servers are gone would block them
+  blocker.BlockAll(executor);
+
+  for (size_t i = 0; i < work.size(); ++i) {
+    work[i].executor = &executor;
+    work[i].priority = static_cast<WorkPriority>(i % WorkPriorityCount);
+    work[i].duplicates = &duplicates;
+
+    ASSERT_TRUE(executor.Submit(work[i].priority, { StressWork::Run, &work[i] }));
+  }
+
+  // Stopping would never return if it waited for the blocked work
+  EXPECT_FALSE(executor.Stop());
+  EXPECT_FALSE(executor.Submit(WorkPriority::Interactive, { StressWork::Run, &work[0] }));
+
+  blocker.released = true;
+
+  while (!executor.Stop()) std::this_thread::yield();
+
+  EXPECT_EQ(executor.Cancelled(), work.size());
+  EXPECT_TRUE(std::all_of(work.begin(), work.end(), [](const StressWork& item) { return item.outcome == StressWork::Cancelled; }));
+  EXPECT_EQ(duplicates, 0u);
+}
+
+class StealingExecutorStress : public ::testing::TestWithParam<bool> {};
+
+TEST_P(StealingExecutorStress, EndsEveryItemExactlyOnce) {
+  constexpr size_t Rounds = 10;
+  constexpr size_t Submitters = 4;
+  constexpr size_t Count = 4000;
+  bool stopEarly = GetParam();
+
+  for (size_t round = 0; round < Rounds; ++round) {
+    StealingExecutor executor(2);
+    std::atomic<size_t> duplicates = 0;
+
+    // Every eighth piece of work has a child, stored after the rest
+    std::vector<StressWork> work(Count + Count / 8);
+
+    for (size_t i = 0; i < work.size(); ++i) {
+      work[i].executor = &executor;
+      work[i].priority = static_cast<WorkPriority>(i % WorkPriorityCount);
+      work[i].duplicates = &duplicates;
+
+      if (i < Count && i % 8 == 0) work[i].child = &work[Count + i / 8];
+    }
+
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < Submitters; ++t) {
+      threads.emplace_back([&work, &executor, t] {
+        for (size_t i = t; i < Count; i += Submitters) {
+          if (!executor.Submit(work[i].priority, { StressWork::Run, &work[i] })) work[i].End(StressWork::Refused);
+        }
+      });
+    }
+
+    // Stopping while work is still being submitted races refusing work
+    // with cancelling it
+    if (stopEarly) {
+      while (executor.Executed() < Count / 4) std::this_thread::yield();
+
+      executor.Stop();
+    }
+
+    for (std::thread& thread : threads) thread.join();
+
+    if (!stopEarly) {
+      while (executor.Executed() < work.size()) std::this_thread::yield();
+    }
+
+    while (!executor.Stop()) std::this_thread::yield();
+
+    // Children of work that never ran were never submitted
+    for (size_t i = 0; i < Count; ++i) {
+      if (work[i].child && work[i].outcome != StressWork::Ran && work[i].child->outcome == StressWork::None) work[i].child->End(StressWork::Refused);
+    }
+
+    size_t lost = std::count_if(work.begin(), work.end(), [](const StressWork& item) { return item.outcome == StressWork::None; });
+
+    ASSERT_EQ(lost, 0u) << "round " << round;
+    ASSERT_EQ(duplicates, 0u) << "round " << round;
+
+    if (!stopEarly) {
+      EXPECT_EQ(executor.Executed(), work.size());
+      EXPECT_EQ(executor.Cancelled(), 0u);
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(StopEarly, StealingExecutorStress, ::testing::Bool());
@@ -0,0 +1,100 @@
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <gtest/gtest.h>
+
+#include "GuidParser.h"
+
+namespace {
+  /// <summary>
+  /// A structure laid out like the Windows <c>GUID</c>.
+  /// </summary>
+  struct TestGuid {
+    uint32_t Data1;
+    unsigned short Data2;
+    unsigned short Data3;
+    unsigned char Data4[8];
+  };
+
+  bool TryParse(const char* s, TestGuid& guid) {
+    return GuidParserDetail::TryParseGuid(s, std::strlen(s), guid);
+  }
+
+  bool IsValid(const char* s) {
+    TestGuid guid = {};
+
+    return TryParse(s, guid);
+  }
+}
+
+static_assert(GuidEquals(ParseGuid<TestGuid>("00000000-0000-0000-0000-000000000000"), TestGuid{}), "ParseGuid mishandles the null GUID");
+static_assert(GuidEquals(ParseGuid<TestGuid>("{FF8B806E-83C6-4DF1-9FB4-698133580803}"), TestGuid{ 0xff8b806e, 0x83c6, 0x4df1, { 0x9f, 0xb4, 0x69, 0x81, 0x33, 0x58, 0x08, 0x03 } }), "ParseGuid mishandles braces or upper case");
+static_assert(GuidEquals(ParseGuid<TestGuid>("aeb1215c-84ff-43cc-aec7-e02c2b56e74c"), TestGuid{ 0xaeb1215c, 0x84ff, 0x43cc, { 0xae, 0xc7, 0xe0, 0x2c, 0x2b, 0x56, 0xe7, 0x4c } }), "ParseGuid mishandles lower case");
+static_assert(!GuidEquals(ParseGuid<TestGuid>("aeb1215c-84ff-43cc-aec7-e02c2b56e74c"), ParseGuid<TestGuid>("aeb1215c-84ff-43cc-aec7-e02c2b56e74d")), "GuidEquals ignores Data4");
+
+TEST(GuidParser, ParsesWithAndWithoutBraces) {
+  TestGuid bare = {};
+  TestGuid braced = {};
+
+  ASSERT_TRUE(TryParse("92fd673f-d257-4ac8-8731-c7cde82fa49e", bare));
+  ASSERT_TRUE(TryParse("{92FD673F-D257-4AC8-8731-C7CDE82FA49E}", braced));
+
+  EXPECT_TRUE(GuidEquals(bare, braced));
+  EXPECT_EQ(bare.Data1, 0x92fd673fu);
+  EXPECT_EQ(bare.Data2, 0xd257u);
+  EXPECT_EQ(bare.Data3, 0x4ac8u);
+  EXPECT_EQ(bare.Data4[0], 0x87u);
+  EXPECT_EQ(bare.Data4[1], 0x31u);
+  EXPECT_EQ(bare.Data4[7], 0x9eu);
+}
+
+TEST(GuidParser, RejectsMalformedGuids) {
+  EXPECT_FALSE(IsValid(""));
+  EXPECT_FALSE(IsValid("92fd673f-d257-4ac8-8731-c7cde82fa49"));
+  EXPECT_FALSE(IsValid("92fd673f-d257-4ac8-8731-c7cde82fa49e0"));
+  EXPECT_FALSE(IsValid("{92fd673f-d257-4ac8-8731-c7cde82fa49e"));
+  EXPECT_FALSE(IsValid("92fd673f-d257-4ac8-8731-c7cde82fa49e}"));
+  EXPECT_FALSE(IsValid("(92fd673f-d257-4ac8-8731-c7cde82fa49e)"));
+  EXPECT_FALSE(IsValid("92fd673fd257-4ac8-8731-c7cde82fa49e-"));
+  EXPECT_FALSE(IsValid("92fd673f_d257_4ac8_8731_c7cde82fa49e"));
+  EXPECT_FALSE(IsValid("92fd673f-d257-4ac8-8731-c7cde82fa49g"));
+  EXPECT_FALSE(IsValid("0x2fd673-d257-4ac8-8731-c7cde82fa49e"));
+  EXPECT_FALSE(IsValid(" 2fd673f-d257-4ac8-8731-c7cde82fa49e"));
+}
+
+TEST(GuidParser, RejectsANonHexDigitAnywhere) {
+  const char valid[] = "92fd673f-d257-4ac8-8731-c7cde82fa49e";
+
+  for (size_t i = 0; i < sizeof(valid) - 1; ++i) {
+    if (valid[i] == '-') continue;
+
+    char s[sizeof(valid)];
+    std::memcpy(s, valid, sizeof(valid));
+    s[i] = 'x';
+
+    EXPECT_FALSE(IsValid(s)) << s;
+  }
+}
+
+TEST(GuidParser, RoundTripsFormattedGuids) {
+  std::mt19937 random(42);
+
+  for (int i = 0; i < 1000; ++i) {
+    TestGuid expected = { static_cast<uint32_t>(random()), static_cast<unsigned short>(random()), static_cast<unsigned short>(random()), {} };
+
+    for (unsigned char& byte : expected.Data4) {
+      byte = static_cast<unsigned char>(random());
+    }
+
+    char s[40];
+    std::snprintf(s, sizeof(s), i % 2 ? "{%08X-%04X-%04X-%02X%02X-%02X%02X%02X%02X%02X%02X}" : "%08x-%04x-%04x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+      static_cast<unsigned>(expected.Data1), expected.Data2, expected.Data3,
+      expected.Data4[0], expected.Data4[1], expected.Data4[2], expected.Data4[3],
+      expected.Data4[4], expected.Data4[5], expected.Data4[6], expected.Data4[7]);
+
+    TestGuid parsed = {};
+
+    ASSERT_TRUE(TryParse(s, parsed)) << s;
+    EXPECT_TRUE(GuidEquals(expected, parsed)) << s;
+  }
+}
@@ -0,0 +1,98 @@
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Json.h"
+
+TEST(Json, ParsesNestedValues) {
+  JsonDocument document;
+
+  ASSERT_TRUE(document.Parse(R"({"a": [1, 2, 3], "b": {"c": true}, "d": "text"})"));
+
+  JsonValue root = document.Root();
+
+  ASSERT_TRUE(root.IsObject());
+  ASSERT_TRUE(root["a"].IsArray());
+
+  std::vector<uint64_t> numbers;
+
+  for (JsonValue element : root["a"]) {
+    uint64_t number = 0;
+
+    ASSERT_TRUE(element.GetUnsigned(number));
+    numbers.push_back(number);
+  }
+
+  EXPECT_EQ(numbers, (std::vector<uint64_t>{ 1, 2, 3 }));
+
+  bool flag = false;
+
+  EXPECT_TRUE(root["b"]["c"].GetBoolean(flag));
+  EXPECT_TRUE(flag);
+
+  std::string text;
+
+  EXPECT_TRUE(root["d"].GetString(text));
+  EXPECT_EQ(text, "text");
+}
+
+TEST(Json, ReportsMissingAndMistypedValues) {
+  JsonDocument document;
+
+  ASSERT_TRUE(document.Parse(R"({"n": -1, "s": 5})"));
+
+  JsonValue root = document.Root();
+  uint64_t number = 0;
+  std::string text;
+
+  EXPECT_FALSE(root["missing"].Exists());
+  EXPECT_FALSE(root["missing"]["deeper"].Exists());
+  EXPECT_FALSE(root["n"].GetUnsigned(number));
+  EXPECT_FALSE(root["s"].GetString(text));
+}
+
+TEST(Json, IteratesKeysInOrder) {
+  JsonDocument document;
+
+  ASSERT_TRUE(document.Parse(R"({"*": 1, "Directory": 2, "Directory\\Background": 3})"));
+
+  std::vector<std::string> keys;
+
+  for (JsonValue value : document.Root()) {
+    std::string key;
+
+    ASSERT_TRUE(value.GetKey(key));
+    keys.push_back(key);
+  }
+
+  EXPECT_EQ(keys, (std::vector<std::string>{ "*", "Directory", "Directory\\Background" }));
+}
+
+TEST(Json, UnescapesStrings) {
+  JsonDocument document;
+
+  ASSERT_TRUE(document.Parse(R"(["a\"b\\c\/d\n", "\u00e9\ud83d\ude00"])"));
+
+  std::vector<std::wstring> strings;
+
+  for (JsonValue value : document.Root()) {
+    std::wstring text;
+
+    ASSERT_TRUE(value.GetString(text));
+    strings.push_back(text);
+  }
+
+  ASSERT_EQ(strings.size(), 2u);
+  EXPECT_EQ(strings[0], L"a\"b\\c/d\n");
+  EXPECT_EQ(strings[1], std::wstring(L"\u00e9") + static_cast<wchar_t>(0x1F600));
+}
+
+TEST(Json, ReportsWhereParsingFailed) {
+  JsonDocument document;
+
+  EXPECT_FALSE(document.Parse(R"({"a": [1, 2,, 3]})"));
+  EXPECT_EQ(document.ErrorOffset(), 12u);
+
+  EXPECT_FALSE(document.Parse(R"({"a": 1} x)"));
+  EXPECT_FALSE(document.Parse(""));
+}
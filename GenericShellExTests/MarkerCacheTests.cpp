@@ -0,0 +1,243 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "MarkerCache.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+  /// <summary>
+  /// A file system of paths that exist, with directories whose changes are
+  /// reported by hand, and a clock that only moves when told to.
+  /// </summary>
+  class FakeProbe : public MarkerProbe {
+  public:
+    std::set<std::wstring> paths;
+    std::vector<std::wstring> probed;
+    std::set<std::wstring> unwatchable;
+
+    /// <summary>
+    /// The directory of each watch that has not been unwatched.
+    /// </summary>
+    std::map<uintptr_t, std::wstring> watched;
+    std::set<uintptr_t> changed;
+    uintptr_t nextWatch = 1;
+
+    std::chrono::steady_clock::time_point now;
+
+    bool Exists(const std::wstring& path) override {
+      probed.push_back(path);
+
+      return paths.contains(path);
+    }
+
+    uintptr_t Watch(const std::wstring& directory) override {
+      if (unwatchable.contains(directory)) return 0;
+
+      watched.emplace(nextWatch, directory);
+
+      return nextWatch++;
+    }
+
+    bool HasChanged(uintptr_t watch) override {
+      return changed.erase(watch) != 0;
+    }
+
+    void Unwatch(uintptr_t watch) override {
+      EXPECT_EQ(watched.erase(watch), 1u);
+    }
+
+    std::chrono::steady_clock::time_point Now() override { return now; }
+
+    /// <summary>
+    /// Reports a change to every watch on a directory.
+    /// </summary>
+    void Change(const std::wstring& directory) {
+      for (const auto& [watch, path] : watched) {
+        if (path == directory) changed.insert(watch);
+      }
+    }
+
+    bool IsWatched(const std::wstring& directory) const {
+      for (const auto& [watch, path] : watched) {
+        if (path == directory) return true;
+      }
+
+      return false;
+    }
+  };
+
+  struct MarkerCacheTest : testing::Test {
+    FakeProbe probe;
+    DirectoryMarkers markers;
+    uint64_t git = markers.Add(L".git");
+    uint64_t package = markers.Add(L"package.json");
+  };
+}
+
+TEST_F(MarkerCacheTest, FindsMarkers) {
+  probe.paths = { L"C:\\src\\app\\.git", L"C:\\src\\app\\package.json" };
+  MarkerCache cache(probe, 16, 60s, 10s);
+
+  EXPECT_EQ(cache.Find(L"C:\\src\\app", markers), git | package);
+  EXPECT_EQ(cache.Find(L"C:\\src", markers), 0u);
+  EXPECT_EQ(probe.probed, (std::vector<std::wstring>{ L"C:\\src\\app\\.git", L"C:\\src\\app\\package.json", L"C:\\src\\.git", L"C:\\src\\package.json" }));
+
+  // Cached directories are compared without regard to case
+  EXPECT_EQ(cache.Find(L"c:\\SRC\\App", markers), git | package);
+  EXPECT_EQ(probe.probed.size(), 4u);
+  EXPECT_EQ(cache.Hits(), 1u);
+  EXPECT_EQ(cache.Misses(), 2u);
+}
+
+TEST_F(MarkerCacheTest, KeepsDirectoriesWithMarkersLonger) {
+  probe.paths = { L"C:\\project\\.git" };
+  MarkerCache cache(probe, 16, 60s, 10s);
+
+  cache.Find(L"C:\\project", markers);
+  cache.Find(L"C:\\other", markers);
+  probe.probed.clear();
+
+  probe.now += 9s;
+  cache.Find(L"C:\\project", markers);
+  cache.Find(L"C:\\other", markers);
+
+  EXPECT_TRUE(probe.probed.empty());
+
+  // The directory without markers expires first
+  probe.now += 2s;
+  probe.paths.insert(L"C:\\other\\.git");
+
+  EXPECT_EQ(cache.Find(L"C:\\other", markers), git);
+  EXPECT_EQ(cache.Find(L"C:\\project", markers), git);
+  EXPECT_EQ(probe.probed, (std::vector<std::wstring>{ L"C:\\other\\.git", L"C:\\other\\package.json" }));
+
+  // Probing again starts a new lifetime
+  probe.probed.clear();
+  probe.now += 50s;
+  probe.paths.clear();
+
+  EXPECT_EQ(cache.Find(L"C:\\project", markers), 0u);
+  EXPECT_EQ(cache.Find(L"C:\\other", markers), git);
+  EXPECT_EQ(probe.probed.size(), 2u);
+}
+
+TEST_F(MarkerCacheTest, ProbesChangedDirectoriesAgain) {
+  MarkerCache cache(probe, 16, 60s, 60s);
+
+  EXPECT_EQ(cache.Find(L"C:\\project", markers), 0u);
+  ASSERT_TRUE(probe.IsWatched(L"C:\\project"));
+
+  probe.paths.insert(L"C:\\project\\package.json");
+
+  // Without a change notification the cached result stands
+  EXPECT_EQ(cache.Find(L"C:\\project", markers), 0u);
+
+  probe.Change(L"C:\\project");
+
+  EXPECT_EQ(cache.Find(L"C:\\project", markers), package);
+  EXPECT_EQ(cache.Find(L"C:\\project", markers), package);
+  EXPECT_EQ(cache.Misses(), 2u);
+
+  // Watches are kept across probes
+  EXPECT_EQ(probe.watched.size(), 1u);
+}
+
+TEST_F(MarkerCacheTest, LimitsWatches) {
+  MarkerCache cache(probe, 1024, 60s, 60s);
+
+  for (int i = 0; i < 80; ++i) cache.Find(L"C:\\d" + std::to_wstring(i), markers);
+
+  EXPECT_EQ(probe.watched.size(), MarkerCache::MaxWatches);
+  EXPECT_TRUE(probe.IsWatched(L"C:\\d0"));
+  EXPECT_FALSE(probe.IsWatched(L"C:\\d79"));
+
+  // Unwatched directories are still cached, until they expire
+  probe.probed.clear();
+  cache.Find(L"C:\\d79", markers);
+
+  EXPECT_TRUE(probe.probed.empty());
+}
+
+TEST_F(MarkerCacheTest, ReturnsUnusedWatches) {
+  probe.unwatchable = { L"\\\\server\\share" };
+  MarkerCache cache(probe, 1024, 60s, 60s);
+
+  // A directory that cannot be watched does not use up a watch
+  cache.Find(L"\\\\server\\share", markers);
+
+  for (int i = 0; i < 64; ++i) cache.Find(L"C:\\d" + std::to_wstring(i), markers);
+
+  EXPECT_EQ(probe.watched.size(), MarkerCache::MaxWatches);
+  EXPECT_TRUE(probe.IsWatched(L"C:\\d63"));
+}
+
+TEST_F(MarkerCacheTest, UnwatchesEvictedDirectories) {
+  {
+    MarkerCache cache(probe, 2, 60s, 60s);
+
+    cache.Find(L"C:\\a", markers);
+    cache.Find(L"C:\\b", markers);
+    cache.Find(L"C:\\a", markers);
+    cache.Find(L"C:\\c", markers);
+
+    // The least recently used directory is forgotten and unwatched
+    EXPECT_FALSE(probe.IsWatched(L"C:\\b"));
+    EXPECT_TRUE(probe.IsWatched(L"C:\\a"));
+    EXPECT_TRUE(probe.IsWatched(L"C:\\c"));
+
+    probe.probed.clear();
+    cache.Find(L"C:\\b", markers);
+
+    EXPECT_EQ(probe.probed.size(), 2u);
+    EXPECT_TRUE(probe.IsWatched(L"C:\\b"));
+    EXPECT_EQ(probe.watched.size(), 2u);
+  }
+
+  // Destroying the cache unwatches the rest
+  EXPECT_TRUE(probe.watched.empty());
+}
+
+TEST_F(MarkerCacheTest, FindsNearestDirectoryUpToTheRoot) {
+  probe.paths = { L"C:\\src\\.git", L"C:\\src\\app\\package.json", L"D:\\.git" };
+  MarkerCache cache(probe, 16, 60s, 60s);
+
+  EXPECT_EQ(cache.FindNearest(L"C:\\src\\app\\lib", markers, git), std::wstring_view(L"C:\\src").size());
+  EXPECT_EQ(cache.FindNearest(L"C:\\src\\app\\lib", markers, package), std::wstring_view(L"C:\\src\\app").size());
+  EXPECT_EQ(cache.FindNearest(L"D:\\work\\app", markers, git), std::wstring_view(L"D:\\").size());
+
+  probe.probed.clear();
+
+  // The walk stops at the drive root rather than crossing to another drive
+  EXPECT_EQ(cache.FindNearest(L"E:\\work", markers, git), 0u);
+  EXPECT_EQ(probe.probed, (std::vector<std::wstring>{ L"E:\\work\\.git", L"E:\\work\\package.json", L"E:\\.git", L"E:\\package.json" }));
+}
+
+TEST_F(MarkerCacheTest, FindsNearestDirectoryUpToTheShare) {
+  probe.paths = { L"\\\\server\\share\\.git" };
+  MarkerCache cache(probe, 16, 60s, 60s);
+
+  EXPECT_EQ(cache.FindNearest(L"\\\\server\\share\\app", markers, git), std::wstring_view(L"\\\\server\\share").size());
+
+  probe.probed.clear();
+
+  EXPECT_EQ(cache.FindNearest(L"\\\\server\\other\\app", markers, git), 0u);
+  EXPECT_EQ(probe.probed, (std::vector<std::wstring>{ L"\\\\server\\other\\app\\.git", L"\\\\server\\other\\app\\package.json", L"\\\\server\\other\\.git", L"\\\\server\\other\\package.json" }));
+}
+
+TEST_F(MarkerCacheTest, FindsMarkersInAncestors) {
+  probe.paths = { L"C:\\.git", L"C:\\src\\app\\package.json", L"D:\\package.json" };
+  MarkerCache cache(probe, 16, 60s, 60s);
+
+  EXPECT_EQ(cache.FindInAncestors(L"C:\\src\\app\\lib", markers), git | package);
+  EXPECT_EQ(cache.FindInAncestors(L"C:\\src", markers), git);
+  EXPECT_EQ(cache.FindInAncestors(L"D:\\src", markers), package);
+
+  // Shared ancestors were only probed once
+  EXPECT_EQ(cache.Misses(), 6u);
+}
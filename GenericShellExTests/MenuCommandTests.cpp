@@ -0,0 +1,266 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "CommandTemplate.h"
+#include "Config.h"
+#include "MenuCommand.h"
+
+namespace {
+  /// <summary>
+  /// A selection of paths, which counts how often it is read.
+  /// </summary>
+  class FakeSource : public SelectionSource {
+  public:
+    std::vector<std::wstring> paths;
+    size_t reads = 0;
+    bool fails = false;
+
+    explicit FakeSource(std::vector<std::wstring> paths) : paths(std::move(paths)) {}
+
+    bool Fingerprint(SelectionFingerprint& fingerprint) override {
+      fingerprint = SelectionFingerprint();
+
+      if (paths.empty()) return true;
+
+      fingerprint.count = paths.size();
+      fingerprint.first = HashBytes(paths.front().data(), paths.front().size() * sizeof(wchar_t));
+      fingerprint.last = HashBytes(paths.back().data(), paths.back().size() * sizeof(wchar_t));
+
+      return true;
+    }
+
+    bool Read(Selection& selection, bool readPaths, size_t limit, std::chrono::steady_clock::time_point, std::chrono::milliseconds) override {
+      ++reads;
+
+      if (fails) return false;
+
+      selection.Reset(paths.size());
+
+      for (size_t i = 0; i < paths.size(); ++i) {
+        if (i >= limit) {
+          selection.Truncate();
+
+          break;
+        }
+
+        selection.Add(readPaths ? paths[i].data() : L"", readPaths ? paths[i].size() : 0, ItemAttributeFileSystem);
+      }
+
+      return true;
+    }
+
+    bool ReadPaths(Selection& selection) override {
+      return Read(selection, true, SIZE_MAX, std::chrono::steady_clock::time_point::max(), {});
+    }
+  };
+
+  class FakePreparation : public PreparedLaunch {
+  public:
+    SelectionFingerprint fingerprint;
+    bool ready = true;
+
+    bool IsFor(const SelectionFingerprint& fingerprint) const override { return this->fingerprint == fingerprint; }
+
+    bool IsReadyFor(const SelectionFingerprint& fingerprint) const override { return IsFor(fingerprint) && ready; }
+  };
+
+  /// <summary>
+  /// A platform that records launches and preparations and touches
+  /// nothing.
+  /// </summary>
+  class FakePlatform : public MenuCommandPlatform {
+  public:
+    size_t preparations = 0;
+    std::vector<std::pair<std::wstring, std::wstring>> launches;
+
+    void FindMarkers(Selection&, const DirectoryMarkers&, std::chrono::steady_clock::time_point, std::chrono::milliseconds) override {}
+
+    void MatchContent(Selection&, const ContentSignatures&, std::chrono::steady_clock::time_point) override {}
+
+    void PrepareLaunch(std::shared_ptr<PreparedLaunch>& preparation, const SelectionFingerprint& fingerprint, const std::wstring&) override {
+      ++preparations;
+
+      auto prepared = std::make_shared<FakePreparation>();
+      prepared->fingerprint = fingerprint;
+      preparation = std::move(prepared);
+    }
+
+    void ReadFiles(const Selection&, std::chrono::milliseconds, std::vector<SelectionFileInfo>&) override {}
+
+    std::wstring FindRoot(const Selection&, const DirectoryMarkers&, uint64_t, std::chrono::milliseconds) override { return L""; }
+
+    bool Forward(const ForwardTarget&, std::wstring_view, Log&) override { return false; }
+
+    bool IsVolumeResponsive(std::wstring_view, std::chrono::milliseconds) override { return true; }
+
+    bool Launch(const std::wstring& currentDirectory, std::wstring command, Log&) override {
+      launches.emplace_back(currentDirectory, std::move(command));
+
+      return true;
+    }
+  };
+
+  class MenuCommandTest : public testing::Test {
+  protected:
+    FakePlatform platform;
+    TypedMenuCommandPool<MenuCommand> pool{ platform };
+    Log log;
+    std::shared_ptr<const ConfigSnapshot> snapshot;
+
+    ~MenuCommandTest() override {
+      pool.Drain();
+    }
+
+    /// <summary>
+    /// Loads a config and creates a command for its first entry.
+    /// </summary>
+    MenuCommand* Create(const char* text) {
+      Config config;
+
+      EXPECT_TRUE(ParseConfig(text, config));
+      EXPECT_EQ(config.bindings.size(), 1u);
+
+      auto loaded = std::make_shared<ConfigSnapshot>(1);
+
+      CompileCommandTemplates(config.bindings[0].entry);
+      loaded->entries[0] = std::move(config.bindings[0].entry);
+      snapshot = loaded;
+
+      return MenuCommand::Create(pool, log, snapshot, *snapshot->Entry(0));
+    }
+  };
+}
+
+TEST_F(MenuCommandTest, CachesStateForTheSameSelection) {
+  MenuCommand* command = Create(R"({"types": {"*": { "title": "Edit", "command": "edit %1", "when": { "extensions": [".txt"] } }}})");
+  FakeSource text({ L"C:\\a.txt" });
+  FakeSource image({ L"C:\\a.png" });
+
+  EXPECT_EQ(command->GetState(text), VisibilityState::Enabled);
+  EXPECT_EQ(command->GetState(text), VisibilityState::Enabled);
+  EXPECT_EQ(text.reads, 1u);
+
+  EXPECT_EQ(command->GetState(image), VisibilityState::Hidden);
+  EXPECT_EQ(image.reads, 1u);
+
+  command->Release();
+}
+
+TEST_F(MenuCommandTest, SubcommandsShareOneRead) {
+  MenuCommand* command = Create(R"({"types": {"*": [
+    { "title": "Text", "command": "text %1", "when": { "extensions": [".txt"] } },
+    { "title": "Image", "command": "image %1", "when": { "extensions": [".png"] } }
+  ]}})");
+  FakeSource source({ L"C:\\a.txt" });
+
+  ASSERT_EQ(command->SubCommandCount(), 2u);
+
+  MenuCommand* text = command->GetSubCommand(0);
+  MenuCommand* image = command->GetSubCommand(1);
+
+  ASSERT_NE(text, nullptr);
+  ASSERT_NE(image, nullptr);
+  EXPECT_EQ(command->GetSubCommand(0), text);
+  EXPECT_EQ(command->GetSubCommand(2), nullptr);
+
+  EXPECT_EQ(text->GetState(source), VisibilityState::Enabled);
+  EXPECT_EQ(image->GetState(source), VisibilityState::Hidden);
+  EXPECT_EQ(source.reads, 1u);
+
+  command->Release();
+}
+
+TEST_F(MenuCommandTest, UsesFallbackWhenSelectionCannotBeRead) {
+  MenuCommand* command = Create(R"({"types": {"*": { "title": "Edit", "command": "edit %1", "when": { "extensions": [".txt"], "fallback": "disabled" } }}})");
+  FakeSource source({ L"C:\\a.txt" });
+
+  source.fails = true;
+
+  EXPECT_EQ(command->GetState(source), VisibilityState::Disabled);
+
+  // A failed read is not cached
+  source.fails = false;
+
+  EXPECT_EQ(command->GetState(source), VisibilityState::Enabled);
+  EXPECT_EQ(source.reads, 2u);
+
+  command->Release();
+}
+
+TEST_F(MenuCommandTest, ReusesReleasedCommands) {
+  MenuCommand* first = Create(R"({"types": {"*": { "title": "Edit", "command": "edit %1" }}})");
+
+  first->Release();
+
+  MenuCommand* second = MenuCommand::Create(pool, log, snapshot, *snapshot->Entry(0));
+
+  EXPECT_EQ(second, first);
+  EXPECT_EQ(&second->Entry(), snapshot->Entry(0));
+
+  second->Release();
+}
+
+TEST_F(MenuCommandTest, PreparesLaunchOncePerSelection) {
+  MenuCommand* command = Create(R"({"types": {"*": { "title": "Edit", "command": "edit %1", "prefetch": true }}})");
+  FakeSource first({ L"C:\\a.txt" });
+  FakeSource second({ L"C:\\b.txt" });
+  uint64_t hits = MenuCommand::PrefetchHits();
+
+  EXPECT_EQ(command->GetState(first), VisibilityState::Enabled);
+  EXPECT_EQ(command->GetState(first), VisibilityState::Enabled);
+  EXPECT_EQ(platform.preparations, 1u);
+
+  EXPECT_TRUE(command->Invoke(first));
+  EXPECT_EQ(MenuCommand::PrefetchHits(), hits + 1);
+
+  EXPECT_EQ(command->GetState(second), VisibilityState::Enabled);
+  EXPECT_EQ(platform.preparations, 2u);
+
+  command->Release();
+}
+
+TEST_F(MenuCommandTest, PreparesLaunchAgainAfterReuse) {
+  MenuCommand* command = Create(R"({"types": {"*": { "title": "Edit", "command": "edit %1", "prefetch": true }}})");
+  FakeSource source({ L"C:\\a.txt" });
+
+  EXPECT_EQ(command->GetState(source), VisibilityState::Enabled);
+  command->Release();
+
+  // A pooled command keeps its preparation to restart, but the next entry
+  // it is used for may run another program
+  command = MenuCommand::Create(pool, log, snapshot, *snapshot->Entry(0));
+
+  EXPECT_EQ(command->GetState(source), VisibilityState::Enabled);
+  EXPECT_EQ(platform.preparations, 2u);
+
+  command->Release();
+}
+
+TEST_F(MenuCommandTest, InvokesInTheFirstItemsDirectory) {
+  MenuCommand* command = Create(R"({"types": {"*": { "title": "Edit", "command": "edit %*" }}})");
+  FakeSource source({ L"C:\\dir\\a.txt", L"C:\\dir\\b.txt" });
+
+  EXPECT_TRUE(command->Invoke(source));
+  ASSERT_EQ(platform.launches.size(), 1u);
+  EXPECT_EQ(platform.launches[0].first, L"C:\\dir");
+  EXPECT_EQ(platform.launches[0].second, L"edit \"C:\\dir\\a.txt\" \"C:\\dir\\b.txt\"");
+
+  command->Release();
+}
+
+TEST_F(MenuCommandTest, DoesNotInvokeCommandsWithSubcommands) {
+  MenuCommand* command = Create(R"({"types": {"*": [
+    { "title": "Text", "command": "text %1" }
+  ]}})");
+  FakeSource source({ L"C:\\a.txt" });
+
+  EXPECT_FALSE(command->Invoke(source));
+  EXPECT_TRUE(platform.launches.empty());
+
+  command->Release();
+}
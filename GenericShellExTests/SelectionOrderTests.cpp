@@ -0,0 +1,85 @@
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "SelectionOrder.h"
+#include "TestSelection.h"
+
+namespace {
+  std::vector<std::wstring> Paths(const Selection& selection) {
+    std::vector<std::wstring> paths;
+
+    for (size_t i = 0; i < selection.Inspected(); ++i) {
+      SelectionItem item = selection.Item(i);
+      paths.emplace_back(item.path, item.length);
+    }
+
+    return paths;
+  }
+}
+
+TEST(CompareNatural, ComparesDigitsByValue) {
+  EXPECT_LT(CompareNatural(L"file2", L"file10"), 0);
+  EXPECT_GT(CompareNatural(L"file10", L"file2"), 0);
+  EXPECT_EQ(CompareNatural(L"File2", L"file2"), 0);
+  EXPECT_LT(CompareNatural(L"a\\z", L"a-b"), 0);
+}
+
+TEST(ArrangeSelection, SortsNaturally) {
+  Selection selection = MakeSelection({ L"C:\\file10", L"C:\\file2", L"C:\\File1" });
+  SelectionOrder order;
+  order.sort = SelectionSortKey::Natural;
+
+  ArrangeSelection(selection, order, {});
+
+  EXPECT_EQ(Paths(selection), (std::vector<std::wstring>{ L"C:\\File1", L"C:\\file2", L"C:\\file10" }));
+}
+
+TEST(ArrangeSelection, SortsDescendingAndCaps) {
+  Selection selection = MakeSelection({ L"C:\\b", L"C:\\d", L"C:\\a", L"C:\\c" });
+  SelectionOrder order;
+  order.sort = SelectionSortKey::Path;
+  order.descending = true;
+  order.limit = 2;
+
+  ArrangeSelection(selection, order, {});
+
+  EXPECT_EQ(Paths(selection), (std::vector<std::wstring>{ L"C:\\d", L"C:\\c" }));
+  EXPECT_EQ(selection.Count(), 2u);
+}
+
+TEST(ArrangeSelection, KeepsTheFirstOfEachFile) {
+  Selection selection = MakeSelection({ L"C:\\Libraries\\a.txt", L"C:\\b.txt", L"C:\\Users\\a.txt", L"C:\\b.txt" });
+  SelectionOrder order;
+  order.unique = true;
+
+  // The third item is the first reached through another path, and the
+  // fourth could not be read, so it is compared by path
+  std::vector<SelectionFileInfo> files = {
+    { 1, 100, 0, true },
+    { 1, 200, 0, true },
+    { 1, 100, 0, true },
+    { 0, 0, 0, false }
+  };
+
+  ArrangeSelection(selection, order, files);
+
+  EXPECT_EQ(Paths(selection), (std::vector<std::wstring>{ L"C:\\Libraries\\a.txt", L"C:\\b.txt", L"C:\\b.txt" }));
+}
+
+TEST(ArrangeSelection, SortsByModifiedTimeStably) {
+  Selection selection = MakeSelection({ L"C:\\new", L"C:\\old", L"C:\\unknown", L"C:\\same" });
+  SelectionOrder order;
+  order.sort = SelectionSortKey::Modified;
+
+  std::vector<SelectionFileInfo> files = {
+    { 1, 1, 300, true },
+    { 1, 2, 100, true },
+    { 0, 0, 0, false },
+    { 1, 3, 300, true }
+  };
+
+  ArrangeSelection(selection, order, files);
+
+  EXPECT_EQ(Paths(selection), (std::vector<std::wstring>{ L"C:\\unknown", L"C:\\old", L"C:\\new", L"C:\\same" }));
+}
@@ -0,0 +1,117 @@
+#include <chrono>
+#include <gtest/gtest.h>
+
+#include "MockShellItems.h"
+#include "SelectionPredicate.h"
+#include "TestSelection.h"
+
+TEST(SelectionPredicate, MatchesEverythingWhenEmpty) {
+  SelectionPredicate predicate;
+
+  EXPECT_FALSE(predicate.IsConfigured());
+  EXPECT_EQ(predicate.Evaluate(MakeSelection({ L"C:\\a.txt" })), PredicateResult::Match);
+}
+
+TEST(SelectionPredicate, MatchesExtensionsIgnoringCase) {
+  SelectionPredicate predicate;
+
+  ASSERT_TRUE(predicate.AddExtension(L".c"));
+  ASSERT_TRUE(predicate.AddExtension(L"H"));
+  EXPECT_FALSE(predicate.AddExtension(L""));
+
+  EXPECT_EQ(predicate.Evaluate(MakeSelection({ L"C:\\src\\main.C", L"C:\\src\\main.h" })), PredicateResult::Match);
+  EXPECT_EQ(predicate.Evaluate(MakeSelection({ L"C:\\src\\main.c", L"C:\\src\\main.cpp" })), PredicateResult::NoMatch);
+}
+
+TEST(SelectionPredicate, MatchesGlobs) {
+  SelectionPredicate predicate;
+
+  ASSERT_TRUE(predicate.AddPathGlob(L"C:\\src\\**"));
+  ASSERT_TRUE(predicate.AddPathGlob(L"*.md"));
+
+  EXPECT_EQ(predicate.Evaluate(MakeSelection({ L"C:\\src\\a\\b\\c.cpp" })), PredicateResult::Match);
+  EXPECT_EQ(predicate.Evaluate(MakeSelection({ L"D:\\docs\\README.md" })), PredicateResult::Match);
+  EXPECT_EQ(predicate.Evaluate(MakeSelection({ L"D:\\docs\\README.txt" })), PredicateResult::NoMatch);
+
+  SelectionPredicate single;
+
+  ASSERT_TRUE(single.AddPathGlob(L"C:/src/*/?.h"));
+
+  EXPECT_EQ(single.Evaluate(MakeSelection({ L"C:\\src\\lib\\a.h" })), PredicateResult::Match);
+  EXPECT_EQ(single.Evaluate(MakeSelection({ L"C:\\src\\lib\\deeper\\a.h" })), PredicateResult::NoMatch);
+}
+
+TEST(SelectionPredicate, BoundsCountsAndTypes) {
+  SelectionPredicate predicate;
+  predicate.SetCountBounds(1, 2);
+  predicate.SetItemType(PredicateItemType::Directory);
+
+  EXPECT_EQ(predicate.Evaluate(MakeSelection({ L"C:\\a" }, ItemAttributeDirectory)), PredicateResult::Match);
+  EXPECT_EQ(predicate.Evaluate(MakeSelection({ L"C:\\a.txt" })), PredicateResult::NoMatch);
+  EXPECT_EQ(predicate.Evaluate(MakeSelection({ L"C:\\a", L"C:\\b", L"C:\\c" }, ItemAttributeDirectory)), PredicateResult::NoMatch);
+}
+
+TEST(SelectionPredicate, ChecksAttributes) {
+  SelectionPredicate predicate;
+  predicate.SetAttributes(ItemAttributeReadOnly, ItemAttributeHidden);
+
+  EXPECT_EQ(predicate.Evaluate(MakeSelection({ L"C:\\a" }, ItemAttributeReadOnly)), PredicateResult::Match);
+  EXPECT_EQ(predicate.Evaluate(MakeSelection({ L"C:\\a" }, ItemAttributeReadOnly | ItemAttributeHidden)), PredicateResult::NoMatch);
+  EXPECT_EQ(predicate.Evaluate(MakeSelection({ L"C:\\a" })), PredicateResult::NoMatch);
+}
+
+TEST(SelectionPredicate, IsInconclusiveForTruncatedSelections) {
+  SelectionPredicate predicate;
+
+  ASSERT_TRUE(predicate.AddExtension(L".txt"));
+
+  MockShellItems items(100, PathShape::Flat, 0);
+  Selection selection;
+
+  items.Read(selection, true, 10, std::chrono::steady_clock::time_point::max());
+
+  EXPECT_EQ(predicate.Evaluate(selection), PredicateResult::Inconclusive);
+
+  items.Read(selection, true, 100, std::chrono::steady_clock::time_point::max());
+
+  EXPECT_EQ(predicate.Evaluate(selection), PredicateResult::Match);
+}
+
+TEST(SelectionPredicate, FailsOnAnyInspectedMismatch) {
+  SelectionPredicate predicate;
+
+  ASSERT_TRUE(predicate.AddExtension(L".txt"));
+
+  // Every fifth mixed item is a directory, which has no extension
+  MockShellItems items(20, PathShape::Mixed, 0);
+  Selection selection;
+
+  items.Read(selection, true, 20, std::chrono::steady_clock::time_point::max());
+
+  EXPECT_EQ(predicate.Evaluate(selection), PredicateResult::NoMatch);
+}
+
+TEST(SelectionPredicate, ReadsTheSameSelectionEveryWay) {
+  for (PathShape shape : { PathShape::Flat, PathShape::Deep, PathShape::Mixed, PathShape::Unc }) {
+    MockShellItems items(50, shape, 7);
+    Selection direct;
+    Selection perItem;
+    Selection idList;
+
+    items.Read(direct, true, SIZE_MAX, std::chrono::steady_clock::time_point::max());
+    items.ReadPerItem(perItem, true);
+    items.ReadIdList(idList, true);
+
+    ASSERT_EQ(direct.Inspected(), 50u);
+    ASSERT_EQ(perItem.Inspected(), 50u);
+    ASSERT_EQ(idList.Inspected(), 50u);
+
+    for (size_t i = 0; i < 50; ++i) {
+      std::wstring_view path(direct.Item(i).path, direct.Item(i).length);
+
+      EXPECT_EQ(path, std::wstring_view(perItem.Item(i).path, perItem.Item(i).length));
+      EXPECT_EQ(path, std::wstring_view(idList.Item(i).path, idList.Item(i).length));
+      EXPECT_EQ(direct.Item(i).attributes, idList.Item(i).attributes);
+    }
+  }
+}
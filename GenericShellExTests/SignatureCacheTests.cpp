@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include "SignatureCache.h"
+
+namespace {
+  FileVersionKey MakeKey(uint64_t fileId, uint64_t lastWriteTime = 1) {
+    FileVersionKey key;
+    key.volume = 7;
+    key.fileId = fileId;
+    key.size = 100;
+    key.lastWriteTime = lastWriteTime;
+    key.signatures = 42;
+
+    return key;
+  }
+}
+
+TEST(SignatureCache, FindsInsertedFiles) {
+  SignatureCache cache(4);
+  uint64_t mask = 0;
+
+  EXPECT_FALSE(cache.Find(MakeKey(1), mask));
+
+  cache.Insert(MakeKey(1), 5);
+
+  ASSERT_TRUE(cache.Find(MakeKey(1), mask));
+  EXPECT_EQ(mask, 5u);
+
+  cache.Insert(MakeKey(1), 6);
+
+  ASSERT_TRUE(cache.Find(MakeKey(1), mask));
+  EXPECT_EQ(mask, 6u);
+}
+
+TEST(SignatureCache, KeysOnEveryField) {
+  SignatureCache cache(4);
+  uint64_t mask = 0;
+
+  cache.Insert(MakeKey(1), 5);
+
+  FileVersionKey written = MakeKey(1, 2);
+  FileVersionKey resized = MakeKey(1);
+  resized.size = 101;
+  FileVersionKey otherSignatures = MakeKey(1);
+  otherSignatures.signatures = 43;
+  FileVersionKey otherVolume = MakeKey(1);
+  otherVolume.volume = 8;
+
+  EXPECT_FALSE(cache.Find(written, mask));
+  EXPECT_FALSE(cache.Find(resized, mask));
+  EXPECT_FALSE(cache.Find(otherSignatures, mask));
+  EXPECT_FALSE(cache.Find(otherVolume, mask));
+}
+
+TEST(SignatureCache, EvictsTheLeastRecentlyUsedFile) {
+  SignatureCache cache(3);
+  uint64_t mask = 0;
+
+  cache.Insert(MakeKey(1), 1);
+  cache.Insert(MakeKey(2), 2);
+  cache.Insert(MakeKey(3), 3);
+
+  // Finding the oldest file makes the second the least recently used
+  ASSERT_TRUE(cache.Find(MakeKey(1), mask));
+
+  cache.Insert(MakeKey(4), 4);
+
+  EXPECT_FALSE(cache.Find(MakeKey(2), mask));
+  EXPECT_TRUE(cache.Find(MakeKey(1), mask));
+  EXPECT_TRUE(cache.Find(MakeKey(3), mask));
+  EXPECT_TRUE(cache.Find(MakeKey(4), mask));
+
+  // Updating a file also counts as using it
+  cache.Insert(MakeKey(1), 10);
+  cache.Insert(MakeKey(5), 5);
+
+  EXPECT_FALSE(cache.Find(MakeKey(3), mask));
+  ASSERT_TRUE(cache.Find(MakeKey(1), mask));
+  EXPECT_EQ(mask, 10u);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <initializer_list>
+#include <string_view>
+#include "Selection.h"
+
+/// <summary>
+/// Builds a fully inspected <see cref="Selection"/> from paths, all with
+/// the same attributes.
+/// </summary>
+inline Selection MakeSelection(std::initializer_list<std::wstring_view> paths, uint32_t attributes = ItemAttributeFileSystem) {
+  Selection selection;
+
+  selection.Reset(paths.size());
+
+  for (std::wstring_view path : paths) {
+    selection.Add(path.data(), path.size(), attributes);
+  }
+
+  return selection;
+}
@@ -0,0 +1,356 @@
+#include <random>
+#include <string>
+#include <gtest/gtest.h>
+
+#include "Utf8.h"
+
+namespace {
+  constexpr char32_t Replacement = 0xFFFD;
+
+  /// <summary>
+  /// Decodes UTF-8 the way the WHATWG Encoding Standard does, one byte at a
+  /// time, replacing each maximal invalid subpart with U+FFFD.
+  /// </summary>
+  std::u32string ReferenceDecode(std::string_view utf8, bool& valid) {
+    std::u32string decoded;
+    char32_t codePoint = 0;
+    int needed = 0;
+    int seen = 0;
+    unsigned char lower = 0x80;
+    unsigned char upper = 0xBF;
+
+    valid = true;
+
+    for (size_t i = 0; i < utf8.size(); ++i) {
+      unsigned char byte = static_cast<unsigned char>(utf8[i]);
+
+      if (!needed) {
+        if (byte <= 0x7F) {
+          decoded += byte;
+        } else if (byte >= 0xC2 && byte <= 0xDF) {
+          needed = 1;
+          codePoint = byte & 0x1F;
+        } else if (byte >= 0xE0 && byte <= 0xEF) {
+          if (byte == 0xE0) lower = 0xA0;
+          if (byte == 0xED) upper = 0x9F;
+
+          needed = 2;
+          codePoint = byte & 0x0F;
+        } else if (byte >= 0xF0 && byte <= 0xF4) {
+          if (byte == 0xF0) lower = 0x90;
+          if (byte == 0xF4) upper = 0x8F;
+
+          needed = 3;
+          codePoint = byte & 0x07;
+        } else {
+          decoded += Replacement;
+          valid = false;
+        }
+
+        continue;
+      }
+
+      if (byte < lower || byte > upper) {
+        // The byte that ended the subpart starts the next one
+        codePoint = 0;
+        needed = 0;
+        seen = 0;
+        lower = 0x80;
+        upper = 0xBF;
+        decoded += Replacement;
+        valid = false;
+        --i;
+
+        continue;
+      }
+
+      lower = 0x80;
+      upper = 0xBF;
+      codePoint = (codePoint << 6) | (byte & 0x3F);
+
+      if (++seen == needed) {
+        decoded += codePoint;
+        codePoint = 0;
+        needed = 0;
+        seen = 0;
+      }
+    }
+
+    if (needed) {
+      decoded += Replacement;
+      valid = false;
+    }
+
+    return decoded;
+  }
+
+  /// <summary>
+  /// Encodes code points as a wide string: UTF-16 where <c>wchar_t</c> is
+  /// 16 bits and UTF-32 otherwise.
+  /// </summary>
+  std::wstring ToWide(std::u32string_view codePoints) {
+    std::wstring wide;
+
+    for (char32_t codePoint : codePoints) {
+      if (sizeof(wchar_t) == 2 && codePoint > 0xFFFF) {
+        codePoint -= 0x10000;
+        wide += static_cast<wchar_t>(0xD800 + (codePoint >> 10));
+        wide += static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF));
+      } else {
+        wide += static_cast<wchar_t>(codePoint);
+      }
+    }
+
+    return wide;
+  }
+
+  /// <summary>
+  /// Encodes a code point as UTF-8, without checking that it is a scalar
+  /// value.
+  /// </summary>
+  std::string Encode(char32_t codePoint) {
+    std::string utf8;
+
+    if (codePoint < 0x80) {
+      utf8 += static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+      utf8 += static_cast<char>(0xC0 | (codePoint >> 6));
+      utf8 += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+      utf8 += static_cast<char>(0xE0 | (codePoint >> 12));
+      utf8 += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+      utf8 += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+      utf8 += static_cast<char>(0xF0 | (codePoint >> 18));
+      utf8 += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+      utf8 += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+      utf8 += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+
+    return utf8;
+  }
+
+  /// <summary>
+  /// Converts <paramref name="utf8"/> and checks the result, the length and
+  /// the validity against the reference decoder.
+  /// </summary>
+  ::testing::AssertionResult MatchesReference(std::string_view utf8) {
+    bool expectedValid = false;
+    std::wstring expected = ToWide(ReferenceDecode(utf8, expectedValid));
+    std::wstring wide;
+    bool valid = ConvertUtf8ToWide(utf8, wide);
+
+    if (wide != expected || valid != expectedValid || GetWideLength(utf8) != expected.size()) {
+      std::string bytes;
+
+      for (unsigned char byte : utf8) {
+        bytes += "0123456789ABCDEF"[byte >> 4];
+        bytes += "0123456789ABCDEF"[byte & 15];
+        bytes += ' ';
+      }
+
+      return ::testing::AssertionFailure() << "converting " << bytes;
+    }
+
+    return ::testing::AssertionSuccess();
+  }
+
+  /// <summary>
+  /// Converts text that is expected to be invalid and returns the result.
+  /// </summary>
+  std::wstring ConvertInvalid(std::string_view utf8) {
+    std::wstring wide;
+
+    EXPECT_FALSE(ConvertUtf8ToWide(utf8, wide));
+    EXPECT_EQ(GetWideLength(utf8), wide.size());
+
+    return wide;
+  }
+}
+
+TEST(Utf8, ConvertsAscii) {
+  std::wstring wide;
+
+  EXPECT_TRUE(ConvertUtf8ToWide("nvim %*", wide));
+  EXPECT_EQ(wide, L"nvim %*");
+  EXPECT_EQ(GetWideLength("nvim %*"), 7u);
+}
+
+TEST(Utf8, ConvertsMultibyteSequences) {
+  std::wstring wide;
+
+  EXPECT_TRUE(ConvertUtf8ToWide("R\xC3\xA9sum\xC3\xA9 \xE2\x9C\x93", wide));
+  EXPECT_EQ(wide, L"R\u00e9sum\u00e9 \u2713");
+}
+
+TEST(Utf8, ConvertsEmptyStrings) {
+  std::wstring wide = L"stale";
+
+  EXPECT_TRUE(ConvertUtf8ToWide("", wide));
+  EXPECT_TRUE(wide.empty());
+  EXPECT_EQ(GetWideLength(""), 0u);
+}
+
+TEST(Utf8, ConvertsBoundaryCodePoints) {
+  for (char32_t codePoint : { 0x7Fu, 0x80u, 0x7FFu, 0x800u, 0xD7FFu, 0xE000u, 0xFFFDu, 0xFFFFu, 0x10000u, 0x1F600u, 0x10FFFFu }) {
+    std::wstring wide;
+
+    EXPECT_TRUE(ConvertUtf8ToWide(Encode(codePoint), wide)) << std::hex << static_cast<uint32_t>(codePoint);
+    EXPECT_EQ(wide, ToWide(std::u32string(1, codePoint))) << std::hex << static_cast<uint32_t>(codePoint);
+  }
+}
+
+TEST(Utf8, ConvertsSupplementaryCodePointsToSurrogatePairsOnlyWhereWideIs16Bits) {
+  std::wstring wide;
+
+  EXPECT_TRUE(ConvertUtf8ToWide("\xF0\x9F\x98\x80", wide));
+  EXPECT_EQ(wide.size(), sizeof(wchar_t) == 2 ? 2u : 1u);
+}
+
+TEST(Utf8, ReplacesStrayAndInvalidBytes) {
+  EXPECT_EQ(ConvertInvalid("\x80"), L"\uFFFD");
+  EXPECT_EQ(ConvertInvalid("a\xBF" "b"), L"a\uFFFDb");
+  EXPECT_EQ(ConvertInvalid("\xFE\xFF"), L"\uFFFD\uFFFD");
+
+  for (int lead = 0xF5; lead <= 0xFF; ++lead) {
+    EXPECT_EQ(ConvertInvalid(std::string(1, static_cast<char>(lead)) + "\x80"), L"\uFFFD\uFFFD") << lead;
+  }
+}
+
+TEST(Utf8, ReplacesTruncatedSequencesOnce) {
+  EXPECT_EQ(ConvertInvalid("\xC3"), L"\uFFFD");
+  EXPECT_EQ(ConvertInvalid("\xE2\x9C"), L"\uFFFD");
+  EXPECT_EQ(ConvertInvalid("\xF0\x9F\x98"), L"\uFFFD");
+  EXPECT_EQ(ConvertInvalid("\xF0\x9F\x98" "a"), L"\uFFFDa");
+  EXPECT_EQ(ConvertInvalid("\xE2\x9C\xE2\x9C\x93"), L"\uFFFD\u2713");
+}
+
+TEST(Utf8, ReplacesSurrogates) {
+  // Each byte of an encoded surrogate is a maximal invalid subpart
+  EXPECT_EQ(ConvertInvalid("\xED\xA0\x80"), L"\uFFFD\uFFFD\uFFFD");
+  EXPECT_EQ(ConvertInvalid("\xED\xBF\xBF"), L"\uFFFD\uFFFD\uFFFD");
+  EXPECT_EQ(ConvertInvalid("\xED\xA0\xBD\xED\xB8\x80"), std::wstring(6, L'\uFFFD'));
+}
+
+TEST(Utf8, ReplacesOverlongForms) {
+  EXPECT_EQ(ConvertInvalid("\xC0\xAF"), L"\uFFFD\uFFFD");
+  EXPECT_EQ(ConvertInvalid("\xC1\xBF"), L"\uFFFD\uFFFD");
+  EXPECT_EQ(ConvertInvalid("\xE0\x80\xAF"), L"\uFFFD\uFFFD\uFFFD");
+  EXPECT_EQ(ConvertInvalid("\xE0\x9F\xBF"), L"\uFFFD\uFFFD\uFFFD");
+  EXPECT_EQ(ConvertInvalid("\xF0\x80\x80\xAF"), L"\uFFFD\uFFFD\uFFFD\uFFFD");
+  EXPECT_EQ(ConvertInvalid("\xF0\x8F\xBF\xBF"), L"\uFFFD\uFFFD\uFFFD\uFFFD");
+}
+
+TEST(Utf8, ReplacesCodePointsAboveTheLast) {
+  EXPECT_EQ(ConvertInvalid("\xF4\x90\x80\x80"), L"\uFFFD\uFFFD\uFFFD\uFFFD");
+  EXPECT_EQ(ConvertInvalid("\xF7\xBF\xBF\xBF"), L"\uFFFD\uFFFD\uFFFD\uFFFD");
+}
+
+TEST(Utf8, MatchesTheReferenceForEveryTwoByteString) {
+  for (int first = 0; first < 256; ++first) {
+    for (int second = 0; second < 256; ++second) {
+      const char utf8[] = { static_cast<char>(first), static_cast<char>(second) };
+
+      ASSERT_TRUE(MatchesReference(std::string_view(utf8, 2)));
+    }
+  }
+}
+
+TEST(Utf8, MatchesTheReferenceForEveryThreeByteStringWithALeadByte) {
+  for (int first = 0xC0; first < 256; ++first) {
+    for (int second = 0; second < 256; ++second) {
+      for (int third = 0; third < 256; ++third) {
+        const char utf8[] = { static_cast<char>(first), static_cast<char>(second), static_cast<char>(third) };
+
+        ASSERT_TRUE(MatchesReference(std::string_view(utf8, 3)));
+      }
+    }
+  }
+}
+
+TEST(Utf8, MatchesTheReferenceForFourByteLeadsAtContinuationBoundaries) {
+  const int boundaries[] = { 0x00, 0x7F, 0x80, 0x8F, 0x90, 0x9F, 0xA0, 0xBF, 0xC0, 0xFF };
+
+  for (int first = 0xF0; first < 256; ++first) {
+    for (int second : boundaries) {
+      for (int third : boundaries) {
+        for (int fourth : boundaries) {
+          const char utf8[] = { static_cast<char>(first), static_cast<char>(second), static_cast<char>(third), static_cast<char>(fourth) };
+
+          ASSERT_TRUE(MatchesReference(std::string_view(utf8, 4)));
+        }
+      }
+    }
+  }
+}
+
+TEST(Utf8, MatchesTheReferenceAcrossVectorChunkBoundaries) {
+  // Sequences are placed at every offset in ASCII text long enough for two
+  // 32-byte chunks, so each one starts, ends and straddles a 16- and 32-byte
+  // boundary, and the ASCII runs either side end at every offset too
+  const char* const sequences[] = { "\xC3\xA9", "\xE2\x9C\x93", "\xF0\x9F\x98\x80", "\x80", "\xE2\x9C", "\xED\xA0\x80", "\xC0\xAF", "\xF4\x90\x80\x80" };
+
+  for (const char* sequence : sequences) {
+    for (size_t length = 0; length <= 80; ++length) {
+      for (size_t offset = 0; offset <= length; ++offset) {
+        std::string utf8(length, 'x');
+        utf8.insert(offset, sequence);
+
+        ASSERT_TRUE(MatchesReference(utf8)) << "at " << offset << " of " << length;
+      }
+    }
+  }
+}
+
+TEST(Utf8, MatchesTheReferenceForRandomText) {
+  std::mt19937 random(1234);
+
+  // Mostly ASCII, as config files are, with bytes from every class
+  const unsigned char classes[] = { 'a', ' ', '\\', 0x80, 0xBF, 0xC2, 0xC3, 0xDF, 0xE0, 0xE2, 0xED, 0xEF, 0xF0, 0xF4, 0xF5, 0xFF };
+
+  for (int i = 0; i < 20000; ++i) {
+    std::string utf8(random() % 100, '\0');
+
+    for (char& c : utf8) {
+      unsigned pick = random() % 64;
+
+      if (pick < 32) {
+        c = static_cast<char>(0x20 + random() % 0x5F);
+      } else if (pick < 48) {
+        c = static_cast<char>(classes[random() % std::size(classes)]);
+      } else {
+        c = static_cast<char>(0x80 + random() % 0x40);
+      }
+    }
+
+    ASSERT_TRUE(MatchesReference(utf8));
+  }
+}
+
+TEST(Utf8, MatchesTheReferenceForValidMultilingualText) {
+  std::mt19937 random(5678);
+
+  for (int i = 0; i < 2000; ++i) {
+    std::u32string codePoints;
+    std::string utf8;
+
+    for (size_t j = random() % 200; j; --j) {
+      char32_t codePoint;
+
+      switch (random() % 4) {
+      case 0: codePoint = 0x20 + random() % 0x5F; break;
+      case 1: codePoint = 0x80 + random() % 0x780; break;
+      case 2: codePoint = 0x800 + random() % 0xD000; break;
+      default: codePoint = 0x10000 + random() % 0x100000; break;
+      }
+
+      codePoints += codePoint;
+      utf8 += Encode(codePoint);
+    }
+
+    std::wstring wide;
+
+    ASSERT_TRUE(ConvertUtf8ToWide(utf8, wide));
+    ASSERT_EQ(wide, ToWide(codePoints));
+  }
+}
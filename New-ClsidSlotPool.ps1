@@ -0,0 +1,305 @@
+param (
+  [int]$SlotsPerType = 8
+)
+
+# Generates the pool of CLSID slots that context menu entries are bound to.
+#
+# Existing slots keep their CLSIDs and indexes; missing slots are appended
+# with new CLSIDs. The pool is written to GenericShellEx\ClsidSlots.h, to
+# Package.appxmanifest, and to Register-GenericShellEx.ps1.
+
+$Types = @("*", "Directory", "Directory\Background")
+
+$Root = $PSScriptRoot
+$Header = Join-Path -Path $Root -ChildPath "GenericShellEx\ClsidSlots.h"
+$Manifest = Join-Path -Path $Root -ChildPath "GenericShellExPackage\Package.appxmanifest"
+$RegisterScript = Join-Path -Path $Root -ChildPath "Register-GenericShellEx.ps1"
+
+$Generated = "Generated by New-ClsidSlotPool.ps1. Do not edit."
+
+$UInt32Mask = [uint64]4294967295
+
+function Update-GeneratedFile {
+  param (
+    [string]$Path,
+    [string]$Value,
+    [Text.Encoding]$Encoding = [Text.UTF8Encoding]::new($false)
+  )
+
+  # Only touch files that change so that an unchanged pool doesn't force a
+  # rebuild
+  if ((Test-Path -Path $Path) -And ([IO.File]::ReadAllText($Path) -ceq $Value)) {
+    return
+  }
+
+  [IO.File]::WriteAllText($Path, $Value, $Encoding)
+}
+
+function Get-Data1 {
+  param (
+    [string]$Clsid
+  )
+
+  return [uint64][Convert]::ToUInt32($Clsid.Split("-")[0], 16)
+}
+
+function Get-ExistingSlots {
+  $script = Get-Content -Path $RegisterScript -Raw
+  $pattern = '@\{\s*(?:Name = "([^"]*)"\s*)?Type = "([^"]*)"\s*(?:Verb = "([^"]*)"\s*)?Clsid = "\{([0-9a-fA-F-]+)\}"\s*\}'
+
+  foreach ($match in [regex]::Matches($script, $pattern)) {
+    $name = $match.Groups[1].Value
+
+    if (-Not $name) {
+      $name = $match.Groups[2].Value
+    }
+
+    [pscustomobject]@{
+      Name = $name
+      Type = $match.Groups[2].Value
+      Clsid = $match.Groups[4].Value.ToLowerInvariant()
+    }
+  }
+}
+
+function Get-Verb {
+  param (
+    [string]$Name
+  )
+
+  if ($Name.Contains("#")) {
+    return "GenericShellEx{0}" -f $Name.Split("#")[1]
+  }
+
+  return "GenericShellEx"
+}
+
+function Get-PerfectHash {
+  param (
+    [object[]]$Slots
+  )
+
+  $bits = 1
+
+  while ((1 -shl $bits) -lt 2 * $Slots.Count) {
+    $bits++
+  }
+
+  $k = 0
+
+  while ($true) {
+    $multiplier = ([uint64]2654435761 + 2 * $k) -band $UInt32Mask
+    $seen = @{}
+    $collision = $false
+
+    foreach ($slot in $Slots) {
+      $hash = (((Get-Data1 -Clsid $slot.Clsid) * $multiplier) -band $UInt32Mask) -shr (32 - $bits)
+
+      if ($seen.ContainsKey($hash)) {
+        $collision = $true
+        break
+      }
+
+      $seen[$hash] = $true
+    }
+
+    if (-Not $collision) {
+      return [pscustomobject]@{
+        Multiplier = $multiplier
+        Bits = $bits
+      }
+    }
+
+    $k++
+  }
+}
+
+function Write-Header {
+  param (
+    [object[]]$Slots,
+    [object]$Hash
+  )
+
+  $size = 1 -shl $Hash.Bits
+  $table = @(0xff) * $size
+
+  for ($i = 0; $i -lt $Slots.Count; $i++) {
+    $h = (((Get-Data1 -Clsid $Slots[$i].Clsid) * $Hash.Multiplier) -band $UInt32Mask) -shr (32 - $Hash.Bits)
+    $table[$h] = $i
+  }
+
+  $lines = @(
+    "#pragma once",
+    "",
+    "// $Generated",
+    "",
+    "#include <cstddef>",
+    "#include <cstdint>",
+    "#include `"framework.h`"",
+    "#include `"GuidParser.h`"",
+    "",
+    "/// <summary>",
+    "/// A CLSID registered for a shell type, to which a context menu entry can be",
+    "/// bound.",
+    "/// </summary>",
+    "struct ClsidSlot {",
+    "  GUID clsid;",
+    "  const wchar_t* type;",
+    "  const wchar_t* name;",
+    "};",
+    "",
+    "/// <summary>",
+    "/// The number of CLSID slots.",
+    "/// </summary>",
+    "constexpr size_t ClsidSlotCount = $($Slots.Count);",
+    "",
+    "/// <summary>",
+    "/// The CLSID slots. Indexes are stable as the pool grows.",
+    "/// </summary>",
+    "constexpr ClsidSlot ClsidSlots[ClsidSlotCount] = {"
+  )
+
+  for ($i = 0; $i -lt $Slots.Count; $i++) {
+    $comma = if ($i + 1 -lt $Slots.Count) { "," } else { "" }
+    $type = $Slots[$i].Type.Replace("\", "\\")
+    $name = $Slots[$i].Name.Replace("\", "\\")
+    $lines += "  {{ ParseGuid<GUID>(`"{0}`"), L`"{1}`", L`"{2}`" }}{3}" -f $Slots[$i].Clsid, $type, $name, $comma
+  }
+
+  $lines += @(
+    "};",
+    "",
+    "/// <summary>",
+    "/// The multiplier of the perfect hash over <c>Data1</c>.",
+    "/// </summary>",
+    ("constexpr uint32_t ClsidSlotHashMultiplier = 0x{0:x8};" -f $Hash.Multiplier),
+    "",
+    "/// <summary>",
+    "/// The number of bits of the perfect hash.",
+    "/// </summary>",
+    "constexpr unsigned ClsidSlotHashBits = $($Hash.Bits);",
+    "",
+    "/// <summary>",
+    "/// Maps each perfect hash value to a slot index, or <c>0xff</c> if no slot",
+    "/// hashes to it.",
+    "/// </summary>",
+    "constexpr uint8_t ClsidSlotTable[$size] = {"
+  )
+
+  for ($row = 0; $row -lt $size; $row += 8) {
+    $comma = if ($row + 8 -lt $size) { "," } else { "" }
+    $lines += "  " + (($table[$row..($row + 7)] | ForEach-Object { "0x{0:x2}" -f $_ }) -join ", ") + $comma
+  }
+
+  $lines += "};"
+
+  Update-GeneratedFile -Path $Header -Value (($lines -join "`r`n") + "`r`n")
+}
+
+function Write-RegisterScript {
+  param (
+    [object[]]$Slots
+  )
+
+  $lines = @("# BEGIN CLSID SLOTS", "# $Generated", "`$Handlers = @(")
+
+  for ($i = 0; $i -lt $Slots.Count; $i++) {
+    $comma = if ($i + 1 -lt $Slots.Count) { "," } else { "" }
+
+    $lines += @(
+      "  @{",
+      "    Name = `"$($Slots[$i].Name)`"",
+      "    Type = `"$($Slots[$i].Type)`"",
+      "    Verb = `"$(Get-Verb -Name $Slots[$i].Name)`"",
+      "    Clsid = `"{$($Slots[$i].Clsid)}`"",
+      "  }$comma"
+    )
+  }
+
+  $lines += @(")", "# END CLSID SLOTS")
+
+  $script = [IO.File]::ReadAllText($RegisterScript)
+  $script = [regex]::Replace($script, "(?s)# BEGIN CLSID SLOTS.*?# END CLSID SLOTS", { param($m) $lines -join "`r`n" })
+
+  Update-GeneratedFile -Path $RegisterScript -Value $script
+}
+
+function Write-Manifest {
+  param (
+    [object[]]$Slots
+  )
+
+  $indent = " " * 14
+  $classes = @("$indent<!-- BEGIN CLSID SLOTS -->")
+
+  foreach ($slot in $Slots) {
+    $classes += "$indent<com:Class Id=`"$($slot.Clsid)`" Path=`"GenericShellEx.dll`" ThreadingModel=`"Both`"/>"
+  }
+
+  $classes += "$indent<!-- END CLSID SLOTS -->"
+
+  $indent = " " * 12
+  $verbs = @("$indent<!-- BEGIN CLSID SLOT VERBS -->")
+
+  foreach ($type in $Types) {
+    $namespace = if ($type -eq "*") { "desktop4" } else { "desktop5" }
+
+    $verbs += "$indent<${namespace}:ItemType Type=`"$type`">"
+
+    foreach ($slot in ($Slots | Where-Object { $_.Type -eq $type })) {
+      $verbs += "$indent  <${namespace}:Verb Id=`"$(Get-Verb -Name $slot.Name)`" Clsid=`"$($slot.Clsid)`"/>"
+    }
+
+    $verbs += "$indent</${namespace}:ItemType>"
+  }
+
+  $verbs += "$indent<!-- END CLSID SLOT VERBS -->"
+
+  $manifest = [IO.File]::ReadAllText($Manifest)
+  $manifest = [regex]::Replace($manifest, "(?s)[ ]*<!-- BEGIN CLSID SLOTS -->.*?<!-- END CLSID SLOTS -->", { param($m) $classes -join "`r`n" })
+  $manifest = [regex]::Replace($manifest, "(?s)[ ]*<!-- BEGIN CLSID SLOT VERBS -->.*?<!-- END CLSID SLOT VERBS -->", { param($m) $verbs -join "`r`n" })
+
+  Update-GeneratedFile -Path $Manifest -Value $manifest -Encoding ([Text.UTF8Encoding]::new($true))
+}
+
+# Main
+
+$slots = [System.Collections.Generic.List[object]]::new()
+
+foreach ($slot in Get-ExistingSlots) {
+  $slots.Add($slot)
+}
+
+foreach ($type in $Types) {
+  for ($i = 0; $i -lt $SlotsPerType; $i++) {
+    $name = if ($i -eq 0) { $type } else { "$type#$i" }
+
+    if ($slots | Where-Object { $_.Name -eq $name }) {
+      continue
+    }
+
+    # Data1 feeds the perfect hash, so it must be unique
+    do {
+      $clsid = [guid]::NewGuid().ToString()
+    } while ($slots | Where-Object { (Get-Data1 -Clsid $_.Clsid) -eq (Get-Data1 -Clsid $clsid) })
+
+    $slots.Add([pscustomobject]@{
+      Name = $name
+      Type = $type
+      Clsid = $clsid
+    })
+  }
+}
+
+if ($slots.Count -gt 255) {
+  Write-Error "At most 255 CLSID slots are supported."
+  exit 1
+}
+
+$hash = Get-PerfectHash -Slots $slots
+
+Write-Header -Slots $slots -Hash $hash
+Write-RegisterScript -Slots $slots
+Write-Manifest -Slots $slots
+
+Write-Host "Generated $($slots.Count) CLSID slots."
@@ -1,168 +1,302 @@
-param (
-  [string]$PackageName = "GenericShellEx",
-  [string]$DllRelativePath = "GenericShellEx.dll",
-  [switch]$Unregister
-)
-
-$Name = "Generic Shell Extensions ({0})"
-
-$String = "String"
-$Default = "(default)"
-$InprocServer32 = "InprocServer32"
-$GenericShellEx = "GenericShellEx"
-$ThreadingModel = "ThreadingModel"
-$Apartment = "Apartment"
-
-$HKCR = "Registry::HKCR"
-$HKCRClsid = "$HKCR\CLSID"
-$HKCRClsidClsid = "$HKCR\CLSID\{0}"
-$HKCRInprocServer32 = "$HKCRClsidClsid\$InprocServer32"
-$HKCRContextMenuHandlers = "$HKCR\{0}\shellex\ContextMenuHandlers"
-$HKCRGenericShellEx = "$HKCRContextMenuHandlers\$GenericShellEx"
-
-$Handlers = @(
-  @{
-    Type = "*"
-    Clsid = "{ff8b806e-83c6-4df1-9fb4-698133580803}"
-  },
-  @{
-    Type = "Directory"
-    Clsid = "{aeb1215c-84ff-43cc-aec7-e02c2b56e74c}"
-  },
-  @{
-    Type = "Directory\Background"
-    Clsid = "{92fd673f-d257-4ac8-8731-c7cde82fa49e}"
-  }
-)
-
-function Get-DllPath {
-  $package = Get-AppxPackage -Name $PackageName 2> $null
-
-  if (-Not $package) {
-    Write-Error "Package '$PackageName' not found."
-    exit 1
-  }
-
-  return (Join-Path $package.InstallLocation $DllRelativePath)
-}
-
-function New-Key {
-  param (
-    [string]$Path,
-    [string]$Name
-  )
-
-  $Path = [wildcardpattern]::Escape($Path)
-  $Name = [wildcardpattern]::Escape($Name)
-
-  if (-Not (Test-Path -Path $(Join-Path -Path $Path -ChildPath $Name 2> $null))) {
-    New-Item -Path $Path -Name $Name
-  }
-}
-
-function Set-RegSz {
-  param (
-    [string]$Path,
-    [string]$Name,
-    [string]$Value
-  )
-
-  $Path = [wildcardpattern]::Escape($Path)
-
-  if (-Not (Get-ItemProperty -Path $Path -Name $Name 2> $null)) {
-    New-ItemProperty -Path $Path -Name $Name -PropertyType $String -Value $Value
-  } else {
-    if ((Get-ItemProperty -Path $Path -Name $Name 2> $null).$Name -IsNot [string]) {
-      Remove-ItemProperty -Path $Path -Name $Name
-      New-ItemProperty -Path $Path -Name $Name -PropertyType $String -Value $Value
-    }
-  }
-}
-
-function Remove-Key {
-  param(
-    [string]$Path
-  )
-
-  $Path = [wildcardpattern]::Escape($Path)
-
-  if (Test-Path -Path $Path 2> $null) {
-    Remove-Item -Path $Path -Recurse
-  }
-}
-
-function Register-Handler {
-  param(
-    [System.Collections.Hashtable]$Handler,
-    [string]$DllPath
-  )
-
-  Write-Verbose "Registering CLSID $($Handler.Clsid) => $($Name -f $Handler.Type)"
-
-  $hkcrClsidClsid = $($HKCRClsidClsid -f $Handler.Clsid)
-
-  New-Key -Path $HKCRClsid -Name $($Handler.Clsid)
-  Set-RegSz -Path $hkcrClsidClsid -Name $Default -Value $($Name -f $Handler.Type)
-
-  $hkcrInprocServer32 = $($HKCRInprocServer32 -f $Handler.Clsid)
-
-  New-Key -Path $hkcrClsidClsid -Name $InprocServer32
-  Set-RegSz -Path $hkcrInprocServer32 -Name $Default -Value $DllPath
-  Set-RegSz -Path $hkcrInprocServer32 -Name $ThreadingModel -Value $Apartment
-
-  $hkcrContextMenuHandlers = $($HKCRContextMenuHandlers -f $Handler.Type)
-  $hkcrGenericShellEx = $($HKCRGenericShellEx -f $Handler.Type)
-
-  New-Key -Path $hkcrContextMenuHandlers -Name $GenericShellEx
-  Set-RegSz -Path $hkcrGenericShellEx -Name $Default -Value $($Handler.Clsid)
-}
-
-function Unregister-Handler {
-  param(
-    [System.Collections.Hashtable]$Handler
-  )
-
-  Write-Verbose "Unregistering CLSID $($Handler.Clsid) => $($Name -f $Handler.Type)"
-
-  $hkcrClsidClsid = $($HKCRClsidClsid -f $Handler.Clsid)
-  $hkcrGenericShellEx = $($HKCRGenericShellEx -f $Handler.Type)
-
-  Remove-Key -Path $hkcrClsidClsid
-  Remove-Key -Path $hkcrGenericShellEx
-}
-
-# Main
-
-if (-Not ([Security.Principal.WindowsPrincipal] [Security.Principal.WindowsIdentity]::GetCurrent()).IsInRole([Security.Principal.WindowsBuiltInRole]::Administrator)) {
-  $Command = Join-Path -Path $(Get-Location) -ChildPath $($MyInvocation.MyCommand)
-  $Parameters = ""
-
-  foreach ($parameter in $MyInvocation.BoundParameters.Keys) {
-    $Parameters = "$Parameters -$parameter $($MyInvocation.BoundParameters.$parameter)"
-  }
-
-  Start-Process "$PSHOME/pwsh" -ArgumentList ("-NoProfile -ExecutionPolicy Bypass -Command `"{0}`"{1}" -f $Command, $Parameters) -Verb RunAs
-  exit
-}
-
-if ($Unregister) {
-  foreach ($handler in $Handlers) {
-    Unregister-Handler -Handler $handler
-  }
-
-  Write-Host "All handlers unregistered."
-} else {
-  $dllPath = Get-DllPath
-
-  if (-Not (Test-Path $dllPath)) {
-    Write-Error "DLL not found: $dllPath"
-
-    exit 1
-  }
-
-  foreach ($handler in $Handlers) {
-    Register-Handler -Handler $handler -DllPath $dllPath
-  }
-
-  Write-Host "All handlers registered."
-}
+param (
+  [string]$PackageName = "GenericShellEx",
+  [string]$DllRelativePath = "GenericShellEx.dll",
+  [switch]$Unregister
+)
+
+$Name = "Generic Shell Extensions ({0})"
+
+$String = "String"
+$Default = "(default)"
+$InprocServer32 = "InprocServer32"
+$ThreadingModel = "ThreadingModel"
+$Both = "Both"
+
+$HKCR = "Registry::HKCR"
+$HKCRClsid = "$HKCR\CLSID"
+$HKCRClsidClsid = "$HKCR\CLSID\{0}"
+$HKCRInprocServer32 = "$HKCRClsidClsid\$InprocServer32"
+$HKCRContextMenuHandlers = "$HKCR\{0}\shellex\ContextMenuHandlers"
+$HKCRGenericShellEx = "$HKCRContextMenuHandlers\{1}"
+
+# BEGIN CLSID SLOTS
+# Generated by New-ClsidSlotPool.ps1. Do not edit.
+$Handlers = @(
+  @{
+    Name = "*"
+    Type = "*"
+    Verb = "GenericShellEx"
+    Clsid = "{ff8b806e-83c6-4df1-9fb4-698133580803}"
+  },
+  @{
+    Name = "Directory"
+    Type = "Directory"
+    Verb = "GenericShellEx"
+    Clsid = "{aeb1215c-84ff-43cc-aec7-e02c2b56e74c}"
+  },
+  @{
+    Name = "Directory\Background"
+    Type = "Directory\Background"
+    Verb = "GenericShellEx"
+    Clsid = "{92fd673f-d257-4ac8-8731-c7cde82fa49e}"
+  },
+  @{
+    Name = "*#1"
+    Type = "*"
+    Verb = "GenericShellEx1"
+    Clsid = "{9cb2a133-cc18-4c56-bc95-b1d6ad3789a2}"
+  },
+  @{
+    Name = "*#2"
+    Type = "*"
+    Verb = "GenericShellEx2"
+    Clsid = "{612b7fa2-2438-4fd9-a7ce-01381d03f946}"
+  },
+  @{
+    Name = "*#3"
+    Type = "*"
+    Verb = "GenericShellEx3"
+    Clsid = "{c3d15831-5449-40a1-90e2-2c703e8cfd7b}"
+  },
+  @{
+    Name = "*#4"
+    Type = "*"
+    Verb = "GenericShellEx4"
+    Clsid = "{034db281-7dbf-499a-89b6-d87a9f432f11}"
+  },
+  @{
+    Name = "*#5"
+    Type = "*"
+    Verb = "GenericShellEx5"
+    Clsid = "{079bf3ab-b999-4d11-bb17-647c4587e4f9}"
+  },
+  @{
+    Name = "*#6"
+    Type = "*"
+    Verb = "GenericShellEx6"
+    Clsid = "{6e501103-ae36-4d6b-85c8-191af0566af3}"
+  },
+  @{
+    Name = "*#7"
+    Type = "*"
+    Verb = "GenericShellEx7"
+    Clsid = "{dd8d7956-7216-494a-8550-f0a59383d818}"
+  },
+  @{
+    Name = "Directory#1"
+    Type = "Directory"
+    Verb = "GenericShellEx1"
+    Clsid = "{8590b590-4438-44c8-b494-25904c679199}"
+  },
+  @{
+    Name = "Directory#2"
+    Type = "Directory"
+    Verb = "GenericShellEx2"
+    Clsid = "{a63e66c1-c02e-480c-9613-690f254f5957}"
+  },
+  @{
+    Name = "Directory#3"
+    Type = "Directory"
+    Verb = "GenericShellEx3"
+    Clsid = "{996c5867-8bed-417e-be1d-065138390a34}"
+  },
+  @{
+    Name = "Directory#4"
+    Type = "Directory"
+    Verb = "GenericShellEx4"
+    Clsid = "{aeb4f832-e0a0-4f7b-bd4c-93f3e5b5cff3}"
+  },
+  @{
+    Name = "Directory#5"
+    Type = "Directory"
+    Verb = "GenericShellEx5"
+    Clsid = "{915420fe-fda8-4019-bae1-d8a64a57df1d}"
+  },
+  @{
+    Name = "Directory#6"
+    Type = "Directory"
+    Verb = "GenericShellEx6"
+    Clsid = "{d053bc55-bfc9-4fdf-9230-bbe62680458c}"
+  },
+  @{
+    Name = "Directory#7"
+    Type = "Directory"
+    Verb = "GenericShellEx7"
+    Clsid = "{922ee4c7-4116-473f-9bc9-d1d01e60de81}"
+  },
+  @{
+    Name = "Directory\Background#1"
+    Type = "Directory\Background"
+    Verb = "GenericShellEx1"
+    Clsid = "{63e91883-9c52-4986-9f69-f7505f0a61ba}"
+  },
+  @{
+    Name = "Directory\Background#2"
+    Type = "Directory\Background"
+    Verb = "GenericShellEx2"
+    Clsid = "{cb580bec-1e06-4ddf-a914-193a730c03ba}"
+  },
+  @{
+    Name = "Directory\Background#3"
+    Type = "Directory\Background"
+    Verb = "GenericShellEx3"
+    Clsid = "{cbb7b704-831f-482a-afa1-e413fb10a2ad}"
+  },
+  @{
+    Name = "Directory\Background#4"
+    Type = "Directory\Background"
+    Verb = "GenericShellEx4"
+    Clsid = "{a81e6b93-9260-4e2c-8d31-8e2520f78951}"
+  },
+  @{
+    Name = "Directory\Background#5"
+    Type = "Directory\Background"
+    Verb = "GenericShellEx5"
+    Clsid = "{16a5c539-28ad-4315-af2b-779e20e871b9}"
+  },
+  @{
+    Name = "Directory\Background#6"
+    Type = "Directory\Background"
+    Verb = "GenericShellEx6"
+    Clsid = "{5ebd48ed-ad95-485b-a6eb-9a3d5e788f3e}"
+  },
+  @{
+    Name = "Directory\Background#7"
+    Type = "Directory\Background"
+    Verb = "GenericShellEx7"
+    Clsid = "{aace6a39-b1b5-44e6-9ed3-2f74c028271a}"
+  }
+)
+# END CLSID SLOTS
+
+function Get-DllPath {
+  $package = Get-AppxPackage -Name $PackageName 2> $null
+
+  if (-Not $package) {
+    Write-Error "Package '$PackageName' not found."
+    exit 1
+  }
+
+  return (Join-Path $package.InstallLocation $DllRelativePath)
+}
+
+function New-Key {
+  param (
+    [string]$Path,
+    [string]$Name
+  )
+
+  $Path = [wildcardpattern]::Escape($Path)
+  $Name = [wildcardpattern]::Escape($Name)
+
+  if (-Not (Test-Path -Path $(Join-Path -Path $Path -ChildPath $Name 2> $null))) {
+    New-Item -Path $Path -Name $Name
+  }
+}
+
+function Set-RegSz {
+  param (
+    [string]$Path,
+    [string]$Name,
+    [string]$Value
+  )
+
+  $Path = [wildcardpattern]::Escape($Path)
+
+  if (-Not (Get-ItemProperty -Path $Path -Name $Name 2> $null)) {
+    New-ItemProperty -Path $Path -Name $Name -PropertyType $String -Value $Value
+  } else {
+    if ((Get-ItemProperty -Path $Path -Name $Name 2> $null).$Name -IsNot [string]) {
+      Remove-ItemProperty -Path $Path -Name $Name
+      New-ItemProperty -Path $Path -Name $Name -PropertyType $String -Value $Value
+    }
+  }
+}
+
+function Remove-Key {
+  param(
+    [string]$Path
+  )
+
+  $Path = [wildcardpattern]::Escape($Path)
+
+  if (Test-Path -Path $Path 2> $null) {
+    Remove-Item -Path $Path -Recurse
+  }
+}
+
+function Register-Handler {
+  param(
+    [System.Collections.Hashtable]$Handler,
+    [string]$DllPath
+  )
+
+  Write-Verbose "Registering CLSID $($Handler.Clsid) => $($Name -f $Handler.Name)"
+
+  $hkcrClsidClsid = $($HKCRClsidClsid -f $Handler.Clsid)
+
+  New-Key -Path $HKCRClsid -Name $($Handler.Clsid)
+  Set-RegSz -Path $hkcrClsidClsid -Name $Default -Value $($Name -f $Handler.Name)
+
+  $hkcrInprocServer32 = $($HKCRInprocServer32 -f $Handler.Clsid)
+
+  New-Key -Path $hkcrClsidClsid -Name $InprocServer32
+  Set-RegSz -Path $hkcrInprocServer32 -Name $Default -Value $DllPath
+  Set-RegSz -Path $hkcrInprocServer32 -Name $ThreadingModel -Value $Both
+
+  $hkcrContextMenuHandlers = $($HKCRContextMenuHandlers -f $Handler.Type)
+  $hkcrGenericShellEx = $($HKCRGenericShellEx -f $Handler.Type, $Handler.Verb)
+
+  New-Key -Path $hkcrContextMenuHandlers -Name $($Handler.Verb)
+  Set-RegSz -Path $hkcrGenericShellEx -Name $Default -Value $($Handler.Clsid)
+}
+
+function Unregister-Handler {
+  param(
+    [System.Collections.Hashtable]$Handler
+  )
+
+  Write-Verbose "Unregistering CLSID $($Handler.Clsid) => $($Name -f $Handler.Name)"
+
+  $hkcrClsidClsid = $($HKCRClsidClsid -f $Handler.Clsid)
+  $hkcrGenericShellEx = $($HKCRGenericShellEx -f $Handler.Type, $Handler.Verb)
+
+  Remove-Key -Path $hkcrClsidClsid
+  Remove-Key -Path $hkcrGenericShellEx
+}
+
+# Main
+
+if (-Not ([Security.Principal.WindowsPrincipal] [Security.Principal.WindowsIdentity]::GetCurrent()).IsInRole([Security.Principal.WindowsBuiltInRole]::Administrator)) {
+  $Command = Join-Path -Path $(Get-Location) -ChildPath $($MyInvocation.MyCommand)
+  $Parameters = ""
+
+  foreach ($parameter in $MyInvocation.BoundParameters.Keys) {
+    $Parameters = "$Parameters -$parameter $($MyInvocation.BoundParameters.$parameter)"
+  }
+
+  Start-Process "$PSHOME/pwsh" -ArgumentList ("-NoProfile -ExecutionPolicy Bypass -Command `"{0}`"{1}" -f $Command, $Parameters) -Verb RunAs
+  exit
+}
+
+if ($Unregister) {
+  foreach ($handler in $Handlers) {
+    Unregister-Handler -Handler $handler
+  }
+
+  Write-Host "All handlers unregistered."
+} else {
+  $dllPath = Get-DllPath
+
+  if (-Not (Test-Path $dllPath)) {
+    Write-Error "DLL not found: $dllPath"
+
+    exit 1
+  }
+
+  foreach ($handler in $Handlers) {
+    Register-Handler -Handler $handler -DllPath $dllPath
+  }
+
+  Write-Host "All handlers registered."
+}